@@ -10,11 +10,14 @@ El token real de GitHub nunca aparece en logs, eventos ni mensajes.
 """
 
 import asyncio
+import copy
 import os
 import sys
 import json
 import logging
 import signal
+import time
+from collections import deque
 from pathlib import Path
 from typing import Dict, Any, Optional
 from brain.shared.logger import get_logger
@@ -38,8 +41,32 @@ class ServerManager:
     - Route messages between clients (CLI <-> Host)
     - Coordinate ProfileStateManager and EventBus
     - Implement 1MB message size limit
+    - Credit-based flow control with hosts that negotiate it (FLOW_CREDIT)
+    - Rebuild delta-encoded state messages from hosts that negotiate it (STATE_DELTA)
+    - Push per-kind field projections down to hosts (SET_PROJECTION)
+    - Register event subscription filters evaluated by hosts (SET_SUBSCRIPTIONS)
     - Handle graceful shutdown (SIGINT/SIGTERM)
     """
+
+    # Crédito que Brain otorga a cada host que anuncia flow_control en
+    # REGISTER_HOST (ver installer/host/flow_control.h)
+    FLOW_WINDOW_BYTES = 8 * 1024 * 1024
+    FLOW_WINDOW_FRAMES = 256
+
+    # Delta encoding (installer/host/delta_encoder.h): formatos que Brain sabe
+    # aplicar, en orden de preferencia, y documentos recordados por conexión
+    DELTA_FORMATS = ('json-patch', 'merge-patch')
+    DELTA_MAX_DOCS = 1024
+
+    # Proyecciones por kind que cada host aplica antes de reenviar
+    # (installer/host/projection.h): kind → lista de JSON Pointers. Vacío =
+    # mensajes completos. SET_PROJECTION las cambia por conexión en caliente.
+    HOST_PROJECTIONS = {}
+
+    # Suscripciones que cada host evalúa antes de reenviar eventos
+    # (installer/host/subscription_filter.h). None = todo pasa; una lista de
+    # filtros se manda en el REGISTER_ACK y SET_SUBSCRIPTIONS la reemplaza.
+    HOST_SUBSCRIPTIONS = None
     
     def __init__(self, host: str = "127.0.0.1", port: int = 5678):
         """
@@ -64,6 +91,9 @@ class ServerManager:
         
         # Worker files
         self.pid_file = self.workers_brain_dir / "service.pid"
+        # Readiness: los hosts lo sondean mientras esperan para reconectar
+        # (installer/host/reconnect_policy.h). Existe solo mientras escuchamos.
+        self.ready_file = self.workers_brain_dir / "brain.ready"
         self.traffic_log = self.workers_brain_dir / "tcp_traffic.log"
         
         # Initialize Trinity components
@@ -162,6 +192,28 @@ class ServerManager:
                 "data": {"reason": str(e)}
             }
     
+    def _publish_ready(self):
+        """
+        Write brain.ready atomically once the listener is up.
+
+        Hosts waiting to reconnect poll this file and retry as soon as its
+        content changes, instead of sleeping out their backoff. The content
+        (pid + start time) differs on every start, so a restart is always
+        visible even if the previous file was left behind by a crash.
+        """
+        stamp = json.dumps({
+            "pid": os.getpid(),
+            "port": self.port,
+            "started_at": time.time()
+        })
+        tmp = self.ready_file.with_suffix('.ready.tmp')
+        try:
+            tmp.write_text(stamp)
+            os.replace(tmp, self.ready_file)
+            logger.info(f"📣 Readiness published: {self.ready_file}")
+        except OSError as e:
+            logger.warning(f"⚠️ Could not publish readiness file: {e}")
+
     def _get_sentinels(self):
         """Get list of CLI sentinel connections for event broadcasting"""
         return [
@@ -202,6 +254,10 @@ class ServerManager:
                 # Read message body
                 data = await reader.readexactly(msg_len)
                 self.message_counter += 1
+
+                # Flow control: Brain procesa cada frame en este loop, así que
+                # el crédito del host se devuelve al leerlo
+                await self._flow_consume(writer, msg_len)
                 
                 # Log traffic
                 await self._log_traffic(conn_id, 'RECV', data)
@@ -212,6 +268,15 @@ class ServerManager:
                     logger.error(f"❌ [{conn_id}] Invalid JSON: {e}")
                     continue
                 
+                # Delta encoding: rearmar el mensaje completo y seguir como si
+                # hubiera llegado así (ruteo y broadcast usan header + data)
+                if '_delta' in msg and self.clients[writer].get('delta') is not None:
+                    msg = await self._delta_decode(writer, msg)
+                    if msg is None:
+                        continue
+                    data = json.dumps(msg, ensure_ascii=False).encode('utf-8')
+                    header = len(data).to_bytes(4, byteorder='big')
+
                 msg_type = msg.get('type') or msg.get('event')
                 logger.debug(f"📥 [{conn_id}] Message: {msg_type}")
                 
@@ -259,7 +324,39 @@ class ServerManager:
                         "role": "host",
                         "profile_id": profile_id
                     }
+
+                    # Flow control opt-in: el host anuncia su ventana y Brain
+                    # responde con la suya. El ACK es el primer frame descontado.
+                    host_window = msg.get('flow_control')
+                    if self._valid_flow_window(host_window):
+                        self.clients[writer]['flow'] = self._new_flow_state(host_window)
+                        ack['flow_control'] = {
+                            "window_bytes": self.FLOW_WINDOW_BYTES,
+                            "window_frames": self.FLOW_WINDOW_FRAMES
+                        }
+                        logger.info(
+                            f"🚦 [{conn_id}] Flow control: host window "
+                            f"{host_window['window_bytes']}B/{host_window['window_frames']}f"
+                        )
+
+                    # Delta encoding opt-in: el primer formato que ambos hablan
+                    host_delta = msg.get('delta')
+                    if isinstance(host_delta, dict):
+                        offered = host_delta.get('formats') or []
+                        fmt = next((f for f in self.DELTA_FORMATS if f in offered), None)
+                        if fmt:
+                            self.clients[writer]['delta'] = {
+                                'format': fmt, 'docs': {}, 'snapshots': 0, 'deltas': 0, 'resyncs': 0
+                            }
+                            ack['delta'] = {"format": fmt}
+                            logger.info(f"🧩 [{conn_id}] Delta encoding: {fmt} kinds={host_delta.get('kinds')}")
+
+                    if self.HOST_PROJECTIONS:
+                        ack['projections'] = self.HOST_PROJECTIONS
+                    if self.HOST_SUBSCRIPTIONS is not None:
+                        ack['subscriptions'] = self.HOST_SUBSCRIPTIONS
                     await self._send_to_writer(writer, ack)
+                    await self._flow_consume(writer, msg_len)
 
                 elif msg_type in ('REGISTER_CLI', 'REGISTER_SENTINEL'):
                     self.clients[writer]['type'] = 'cli'
@@ -297,6 +394,66 @@ class ServerManager:
                         await self.profile_manager.update_heartbeat(profile_id)
                         logger.debug(f"💓 [{conn_id}] Heartbeat from {profile_id[:8]}")
                 
+                elif msg_type == 'FLOW_CREDIT':
+                    # El host terminó de entregar frames nuestros: reponer y
+                    # liberar lo que esperaba crédito
+                    flow = self.clients[writer].get('flow')
+                    if flow is not None:
+                        flow['credit_bytes'] += int(msg.get('bytes', 0))
+                        flow['credit_frames'] += int(msg.get('frames', 0))
+                        await self._flow_flush(writer, flow)
+
+                elif msg_type == 'ADMISSION_DROPS':
+                    # El host descartó mensajes de Chrome por rate limit o
+                    # sobrecarga (admission control): registrar, nunca difundir
+                    info = self.clients[writer]
+                    dropped = int(msg.get('dropped', 0))
+                    info['admission_drops'] = info.get('admission_drops', 0) + dropped
+                    profile_id = msg.get('profile_id') or info.get('profile_id') or '?'
+                    logger.warning(
+                        f"🚧 [{conn_id}] Admission drops from {profile_id[:8]}: {dropped} "
+                        f"(total {info['admission_drops']}) overload={msg.get('overload')} "
+                        f"kinds={msg.get('kinds')}"
+                    )
+
+                elif msg_type == 'REQUEST_TIMEOUT':
+                    # El host correlaciona comando/RESPONSE por id y vence él
+                    # el deadline: registrar, nunca difundir
+                    info = self.clients[writer]
+                    info['request_timeouts'] = info.get('request_timeouts', 0) + 1
+                    profile_id = msg.get('profile_id') or info.get('profile_id') or '?'
+                    logger.warning(
+                        f"⏱️ [{conn_id}] Request timeout from {profile_id[:8]}: id={msg.get('id')} "
+                        f"command={msg.get('command')} waited_ms={msg.get('waited_ms')} "
+                        f"delivered={msg.get('delivered')} (total {info['request_timeouts']})"
+                    )
+
+                elif msg_type == 'PROJECTION_ACK':
+                    # Confirmación de un SET_PROJECTION: registrar, nunca difundir
+                    log = logger.info if msg.get('ok') else logger.warning
+                    log(
+                        f"🔎 [{conn_id}] Projection {msg.get('kind')}: ok={msg.get('ok')} "
+                        f"fields={msg.get('fields')}"
+                        + (f" error={msg.get('error')}" if msg.get('error') else "")
+                    )
+
+                elif msg_type == 'SUBSCRIPTIONS_ACK':
+                    # Confirmación de un SET_SUBSCRIPTIONS: registrar, nunca difundir
+                    log = logger.info if msg.get('ok') else logger.warning
+                    log(
+                        f"📬 [{conn_id}] Subscriptions: ok={msg.get('ok')} active={msg.get('active')} "
+                        f"filters={msg.get('filters')} generation={msg.get('generation')}"
+                        + (f" error={msg.get('error')}" if msg.get('error') else "")
+                    )
+
+                elif msg_type == 'PING':
+                    # Probe sin registro (bloom-host --health --probe-brain):
+                    # responder solo a quien pregunta, nunca rutear ni broadcast.
+                    pong = {"type": "PONG", "conn_id": conn_id}
+                    if 'seq' in msg:
+                        pong['seq'] = msg['seq']
+                    await self._send_to_writer(writer, pong)
+
                 elif msg_type == 'POLL_EVENTS':
                     # Event polling request
                     since = msg.get('since')
@@ -767,8 +924,7 @@ class ServerManager:
                         
                         if target_writer and target_writer in self.clients:
                             try:
-                                target_writer.write(header + data)
-                                await target_writer.drain()
+                                await self._send_frame_to_host(target_writer, header + data)
                                 logger.info(f"📨 [{conn_id}] Routed to {target_profile[:8]}")
                                 
                                 # ACK to CLI if applicable
@@ -798,8 +954,7 @@ class ServerManager:
                         for client_writer, client_info in list(self.clients.items()):
                             if client_writer != writer and client_info['type'] == 'host':
                                 try:
-                                    client_writer.write(header + data)
-                                    await client_writer.drain()
+                                    await self._send_frame_to_host(client_writer, header + data)
                                     count += 1
                                 except:
                                     await self._cleanup_client(client_writer)
@@ -831,11 +986,204 @@ class ServerManager:
                 return
             
             header = len(resp_bytes).to_bytes(4, byteorder='big')
+            # Mensajes propios de Brain (ACK, PONG, FLOW_CREDIT...) descuentan
+            # crédito pero nunca esperan: pueden sobregirar la ventana
+            flow = self.clients.get(writer, {}).get('flow')
+            if flow is not None:
+                flow['credit_bytes'] -= len(resp_bytes)
+                flow['credit_frames'] -= 1
             writer.write(header + resp_bytes)
             await writer.drain()
             logger.debug(f"📤 Sent: {resp_str[:100]}")
         except Exception as e:
             logger.error(f"❌ Send failed: {e}")
+
+    # === DELTA ENCODING ===
+
+    async def _delta_decode(self, writer: asyncio.StreamWriter, msg: Dict[str, Any]) -> Optional[Dict[str, Any]]:
+        """
+        Rebuild the full message from a snapshot or a STATE_DELTA.
+
+        Returns None when the patch base is missing: the host is asked for a
+        snapshot with DELTA_RESYNC and the message is dropped.
+        """
+        state = self.clients[writer]['delta']
+        meta = msg.pop('_delta')
+        key = meta.get('key') if isinstance(meta, dict) else None
+        if not isinstance(key, str):
+            return msg
+        docs = state['docs']
+
+        if msg.get('type') != 'STATE_DELTA':
+            docs.pop(key, None)
+            docs[key] = (meta.get('seq'), copy.deepcopy(msg))
+            while len(docs) > self.DELTA_MAX_DOCS:
+                docs.pop(next(iter(docs)))
+            state['snapshots'] += 1
+            return msg
+
+        base = docs.get(key)
+        if base is None or base[0] != meta.get('base'):
+            state['resyncs'] += 1
+            logger.warning(
+                f"🧩 [{self.clients[writer]['conn_id']}] Delta base missing for {key} "
+                f"(have {base[0] if base else None}, need {meta.get('base')}): resync"
+            )
+            await self._send_to_writer(writer, {"type": "DELTA_RESYNC", "key": key})
+            return None
+
+        try:
+            if meta.get('format') == 'json-patch':
+                full = self._apply_json_patch(base[1], msg.get('patch', []))
+            else:
+                full = self._apply_merge_patch(base[1], msg.get('patch', {}))
+        except (KeyError, IndexError, TypeError, ValueError) as e:
+            logger.error(f"❌ [{self.clients[writer]['conn_id']}] Bad delta for {key}: {e}")
+            docs.pop(key, None)
+            await self._send_to_writer(writer, {"type": "DELTA_RESYNC", "key": key})
+            return None
+
+        docs[key] = (meta.get('seq'), full)
+        state['deltas'] += 1
+        return copy.deepcopy(full)
+
+    @classmethod
+    def _apply_merge_patch(cls, target, patch):
+        """RFC 7386. Returns a new value; target is not modified."""
+        if not isinstance(patch, dict):
+            return copy.deepcopy(patch)
+        result = dict(target) if isinstance(target, dict) else {}
+        for name, value in patch.items():
+            if value is None:
+                result.pop(name, None)
+            else:
+                result[name] = cls._apply_merge_patch(result.get(name), value)
+        return result
+
+    @staticmethod
+    def _apply_json_patch(doc, ops):
+        """RFC 6902 add/remove/replace (what the host generates). Returns a new value."""
+        doc = copy.deepcopy(doc)
+        for op in ops:
+            tokens = [t.replace('~1', '/').replace('~0', '~') for t in op['path'].split('/')[1:]]
+            if not tokens:
+                if op['op'] == 'remove':
+                    raise ValueError("cannot remove the document root")
+                doc = copy.deepcopy(op['value'])
+                continue
+            parent = doc
+            for token in tokens[:-1]:
+                parent = parent[int(token)] if isinstance(parent, list) else parent[token]
+            last = tokens[-1]
+            if isinstance(parent, list):
+                if op['op'] == 'add':
+                    index = len(parent) if last == '-' else int(last)
+                    parent.insert(index, copy.deepcopy(op['value']))
+                elif op['op'] == 'remove':
+                    del parent[int(last)]
+                elif op['op'] == 'replace':
+                    parent[int(last)] = copy.deepcopy(op['value'])
+                else:
+                    raise ValueError(f"unsupported op {op['op']}")
+            else:
+                if op['op'] in ('add', 'replace'):
+                    parent[last] = copy.deepcopy(op['value'])
+                elif op['op'] == 'remove':
+                    del parent[last]
+                else:
+                    raise ValueError(f"unsupported op {op['op']}")
+        return doc
+
+    # === FLOW CONTROL ===
+
+    @staticmethod
+    def _valid_flow_window(window) -> bool:
+        if not isinstance(window, dict):
+            return False
+        size, frames = window.get('window_bytes'), window.get('window_frames')
+        return isinstance(size, int) and isinstance(frames, int) and size > 0 and frames > 0
+
+    def _new_flow_state(self, host_window: Dict[str, Any]) -> Dict[str, Any]:
+        """Estado de créditos de una conexión host (ambos sentidos)."""
+        return {
+            # Brain → host: crédito que otorgó el host
+            'window_bytes': host_window['window_bytes'],
+            'credit_bytes': host_window['window_bytes'],
+            'credit_frames': host_window['window_frames'],
+            'queue': deque(),          # frames ruteados esperando crédito
+            'stalls': 0,
+            'stall_started': None,
+            'stall_total': 0.0,
+            'stall_max': 0.0,
+            # Host → Brain: consumido y todavía no devuelto con FLOW_CREDIT
+            'pending_bytes': 0,
+            'pending_frames': 0,
+            'grants_sent': 0,
+        }
+
+    async def _send_frame_to_host(self, writer: asyncio.StreamWriter, frame: bytes):
+        """
+        Send a routed frame (header + payload) to a host, honoring its credit.
+
+        Without flow control it is written immediately (legacy path). With it,
+        the frame waits in the per-host queue until a FLOW_CREDIT covers it.
+        """
+        flow = self.clients.get(writer, {}).get('flow')
+        if flow is None:
+            writer.write(frame)
+            await writer.drain()
+            return
+        flow['queue'].append(frame)
+        await self._flow_flush(writer, flow)
+
+    async def _flow_flush(self, writer: asyncio.StreamWriter, flow: Dict[str, Any]):
+        """Write queued routed frames while the host's credit covers them."""
+        queue = flow['queue']
+        while queue:
+            size = len(queue[0]) - 4
+            # Un frame más grande que la ventana pasa sólo con todo el crédito devuelto
+            has_credit = flow['credit_frames'] >= 1 and (
+                flow['credit_bytes'] >= size or flow['credit_bytes'] >= flow['window_bytes'])
+            if not has_credit:
+                if flow['stall_started'] is None:
+                    flow['stalls'] += 1
+                    flow['stall_started'] = time.monotonic()
+                    logger.debug(
+                        f"🚦 [{self.clients[writer]['conn_id']}] Credit stall: "
+                        f"{len(queue)} frames queued, credit={flow['credit_bytes']}B"
+                    )
+                return
+            if flow['stall_started'] is not None:
+                stalled = time.monotonic() - flow['stall_started']
+                flow['stall_total'] += stalled
+                flow['stall_max'] = max(flow['stall_max'], stalled)
+                flow['stall_started'] = None
+
+            frame = queue.popleft()
+            flow['credit_bytes'] -= size
+            flow['credit_frames'] -= 1
+            writer.write(frame)
+            await writer.drain()
+
+    async def _flow_consume(self, writer: asyncio.StreamWriter, size: int):
+        """Account a processed host frame; return credit every half window."""
+        flow = self.clients.get(writer, {}).get('flow')
+        if flow is None:
+            return
+        flow['pending_bytes'] += size
+        flow['pending_frames'] += 1
+        if (flow['pending_bytes'] * 2 < self.FLOW_WINDOW_BYTES and
+                flow['pending_frames'] * 2 < self.FLOW_WINDOW_FRAMES):
+            return
+        grant = {
+            "type": "FLOW_CREDIT",
+            "bytes": flow['pending_bytes'],
+            "frames": flow['pending_frames']
+        }
+        flow['pending_bytes'] = 0
+        flow['pending_frames'] = 0
+        flow['grants_sent'] += 1
+        await self._send_to_writer(writer, grant)
     
     async def _broadcast_event(self, event: Dict[str, Any]):
         """
@@ -883,6 +1231,30 @@ class ServerManager:
             p_id = info.get('profile_id')
             client_type = info.get('type')
             
+            flow = info.get('flow')
+            if flow is not None:
+                logger.info(
+                    f"🚦 [{info.get('conn_id')}] Flow summary: stalls={flow['stalls']} "
+                    f"stall_total={flow['stall_total']:.3f}s stall_max={flow['stall_max']:.3f}s "
+                    f"dropped_queued={len(flow['queue'])} grants_sent={flow['grants_sent']}"
+                )
+            if info.get('admission_drops'):
+                logger.info(
+                    f"🚧 [{info.get('conn_id')}] Admission summary: "
+                    f"chrome_messages_dropped={info['admission_drops']}"
+                )
+            delta = info.get('delta')
+            if delta is not None:
+                logger.info(
+                    f"🧩 [{info.get('conn_id')}] Delta summary: format={delta['format']} "
+                    f"snapshots={delta['snapshots']} deltas={delta['deltas']} resyncs={delta['resyncs']}"
+                )
+            if info.get('request_timeouts'):
+                logger.info(
+                    f"⏱️ [{info.get('conn_id')}] Request summary: "
+                    f"extension_timeouts={info['request_timeouts']}"
+                )
+
             # Handle profile disconnection
             if client_type == 'host' and p_id:
                 # Update profile state (offline)
@@ -988,7 +1360,8 @@ class ServerManager:
             self.server.close()
             await self.server.wait_closed()
         
-        # Remove PID file
+        # Remove PID and readiness files
+        self.ready_file.unlink(missing_ok=True)
         self.pid_file.unlink(missing_ok=True)
         
         logger.info("✅ Shutdown complete")
@@ -1040,6 +1413,7 @@ class ServerManager:
                 asyncio.start_server(self._handle_client, self.host, self.port)
             )
             logger.info(f"✨ Listening on {self.host}:{self.port}")
+            self._publish_ready()
             
             # Emit startup event
             loop.run_until_complete(
@@ -0,0 +1,320 @@
+#include "admission_control.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <sstream>
+#include <vector>
+
+namespace Admission {
+
+namespace {
+
+// Kinds distintos con bucket propio; el resto comparte uno. Una página que
+// inventa un command por mensaje no puede hacer crecer la tabla sin límite.
+const size_t      MAX_TRACKED_KINDS = 128;
+const char*       OVERFLOW_KIND = "*other*";
+const uint64_t    REPORT_MIN_INTERVAL_NS = 1000000000ULL;
+const size_t      REPORT_TOP_KINDS = 10;
+const double      OVERLOAD_FILL = 0.5;
+
+const char* CONTROL_KINDS[] = {
+    "extension_ready", "handshake_confirm", "system_ready", "check_handshake_status",
+    "HEARTBEAT", "keepalive", "PONG", "RESPONSE", "DOM_COMMAND_ACK"
+};
+
+const char* LOW_KINDS[] = { "LOG_ENTRY", "HARNESS_LOG", "log", "METRICS" };
+const char* LOW_PREFIXES[] = { "LOG_", "log_", "TELEMETRY", "telemetry", "METRIC_", "metric_" };
+
+uint64_t now_ns() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+std::string trim(const std::string& s) {
+    size_t b = s.find_first_not_of(" \t");
+    if (b == std::string::npos) return "";
+    size_t e = s.find_last_not_of(" \t");
+    return s.substr(b, e - b + 1);
+}
+
+bool parse_positive(const std::string& s, double& out) {
+    if (s.empty()) return false;
+    char* end = nullptr;
+    out = std::strtod(s.c_str(), &end);
+    return end && *end == '\0' && out > 0;
+}
+
+}  // namespace
+
+// ============================================================================
+// CONFIGURACIÓN
+// ============================================================================
+
+bool parse_limits(const std::string& spec, Config& cfg, std::string& error) {
+    if (trim(spec) == "off") {
+        cfg.enabled = false;
+        return true;
+    }
+    cfg.enabled = true;
+    if (trim(spec) == "on") return true;
+
+    std::stringstream ss(spec);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        item = trim(item);
+        if (item.empty()) continue;
+
+        size_t eq = item.find('=');
+        if (eq == std::string::npos || eq == 0) {
+            error = "expected key=rate[/burst], got '" + item + "'";
+            return false;
+        }
+        std::string key = trim(item.substr(0, eq));
+        std::string value = trim(item.substr(eq + 1));
+
+        Rate rate;
+        size_t slash = value.find('/');
+        if (!parse_positive(value.substr(0, slash), rate.per_sec)) {
+            error = "invalid rate in '" + item + "'";
+            return false;
+        }
+        if (slash == std::string::npos) {
+            rate.burst = rate.per_sec * 2;
+        } else if (!parse_positive(value.substr(slash + 1), rate.burst)) {
+            error = "invalid burst in '" + item + "'";
+            return false;
+        }
+        rate.burst = std::max(rate.burst, 1.0);
+
+        if (key == "@normal")      cfg.normal = rate;
+        else if (key == "@low")    cfg.low = rate;
+        else if (key == "@total")  cfg.total = rate;
+        else if (key[0] == '@') {
+            error = "unknown class '" + key + "' (use @normal, @low or @total)";
+            return false;
+        } else {
+            cfg.per_kind[key] = rate;
+        }
+    }
+    return true;
+}
+
+MessageClass classify(const std::string& kind) {
+    for (const char* k : CONTROL_KINDS) {
+        if (kind == k) return CLASS_CONTROL;
+    }
+    for (const char* k : LOW_KINDS) {
+        if (kind == k) return CLASS_LOW;
+    }
+    for (const char* p : LOW_PREFIXES) {
+        if (kind.rfind(p, 0) == 0) return CLASS_LOW;
+    }
+    return CLASS_NORMAL;
+}
+
+const char* class_name(MessageClass cls) {
+    switch (cls) {
+        case CLASS_CONTROL: return "control";
+        case CLASS_LOW:     return "low";
+        default:            return "normal";
+    }
+}
+
+// ============================================================================
+// TOKEN BUCKET
+// ============================================================================
+
+TokenBucket::TokenBucket(Rate rate, uint64_t now_ns)
+    : rate_(rate), tokens_(rate.burst), last_ns_(now_ns) {}
+
+void TokenBucket::refill(uint64_t now_ns) {
+    if (now_ns <= last_ns_) return;
+    tokens_ = std::min(rate_.burst, tokens_ + (now_ns - last_ns_) * 1e-9 * rate_.per_sec);
+    last_ns_ = now_ns;
+}
+
+bool TokenBucket::try_take(uint64_t now_ns) {
+    refill(now_ns);
+    if (tokens_ < 1.0) return false;
+    tokens_ -= 1.0;
+    return true;
+}
+
+double TokenBucket::fill(uint64_t now_ns) {
+    refill(now_ns);
+    return rate_.burst > 0 ? tokens_ / rate_.burst : 1.0;
+}
+
+// ============================================================================
+// CONTROLLER
+// ============================================================================
+
+Controller::Controller(Config cfg) {
+    configure(cfg);
+}
+
+void Controller::configure(const Config& cfg) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    cfg_ = cfg;
+    kinds_.clear();
+    total_ = TokenBucket(cfg_.total, now_ns());
+}
+
+Controller::KindState& Controller::state_for(const std::string& kind, uint64_t now) {
+    auto it = kinds_.find(kind);
+    if (it != kinds_.end()) return it->second;
+
+    const bool overflow = kinds_.size() >= MAX_TRACKED_KINDS && !cfg_.per_kind.count(kind);
+    std::string key = overflow ? OVERFLOW_KIND : kind;
+    if (overflow) {
+        it = kinds_.find(key);
+        if (it != kinds_.end()) return it->second;
+    }
+
+    KindState state;
+    state.cls = overflow ? CLASS_NORMAL : classify(kind);
+    auto custom = cfg_.per_kind.find(key);
+    Rate rate = custom != cfg_.per_kind.end() ? custom->second
+              : state.cls == CLASS_LOW       ? cfg_.low
+                                             : cfg_.normal;
+    state.bucket = TokenBucket(rate, now);
+    return kinds_.emplace(key, state).first->second;
+}
+
+Verdict Controller::admit(const std::string& kind, bool backlog) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!cfg_.enabled) return ADMIT;
+
+    uint64_t now = now_ns();
+    KindState& state = state_for(kind, now);
+
+    if (state.cls == CLASS_CONTROL) {
+        state.admitted++;
+        admitted_[CLASS_CONTROL]++;
+        return ADMIT;
+    }
+
+    // Sobrecarga: presupuesto global a menos de la mitad o Brain atrasado
+    bool overload = backlog || total_.fill(now) < OVERLOAD_FILL;
+    if (overload != overload_) {
+        overload_ = overload;
+        if (overload) {
+            overload_since_ns_ = now;
+            overload_episodes_++;
+        } else {
+            overload_total_ns_ += now - overload_since_ns_;
+        }
+    }
+
+    Verdict verdict = ADMIT;
+    if (state.cls == CLASS_LOW && overload) {
+        verdict = DROP_SHED;
+    } else if (!state.bucket.try_take(now) || !total_.try_take(now)) {
+        // Primero el bucket del kind: un kind ruidoso se corta sin gastar el
+        // presupuesto global de los demás
+        verdict = DROP_RATE;
+    }
+
+    if (verdict == ADMIT) {
+        state.admitted++;
+        admitted_[state.cls]++;
+    } else if (verdict == DROP_SHED) {
+        state.shed++;
+        shed_[state.cls]++;
+        pending_drops_++;
+    } else {
+        state.rate_limited++;
+        rate_limited_[state.cls]++;
+        pending_drops_++;
+    }
+    return verdict;
+}
+
+bool Controller::take_report(nlohmann::json& report, bool force) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (pending_drops_ == 0) return false;
+
+    uint64_t now = now_ns();
+    if (!force && last_report_ns_ != 0 && now - last_report_ns_ < REPORT_MIN_INTERVAL_NS) return false;
+
+    struct Delta { const std::string* kind; uint64_t rate_limited; uint64_t shed; };
+    std::vector<Delta> deltas;
+    for (auto& entry : kinds_) {
+        KindState& s = entry.second;
+        uint64_t r = s.rate_limited - s.reported_rate_limited;
+        uint64_t sh = s.shed - s.reported_shed;
+        s.reported_rate_limited = s.rate_limited;
+        s.reported_shed = s.shed;
+        if (r + sh > 0) deltas.push_back({&entry.first, r, sh});
+    }
+    std::sort(deltas.begin(), deltas.end(), [](const Delta& a, const Delta& b) {
+        return a.rate_limited + a.shed > b.rate_limited + b.shed;
+    });
+
+    nlohmann::json dropped = nlohmann::json::object();
+    for (size_t i = 0; i < deltas.size() && i < REPORT_TOP_KINDS; ++i) {
+        dropped[*deltas[i].kind] = {{"rate_limited", deltas[i].rate_limited}, {"shed", deltas[i].shed}};
+    }
+
+    report = {
+        {"type",        "ADMISSION_DROPS"},
+        {"dropped",     pending_drops_},
+        {"interval_ms", last_report_ns_ ? (now - last_report_ns_) / 1000000 : 0},
+        {"overload",    overload_},
+        {"kinds",       dropped}
+    };
+    pending_drops_ = 0;
+    last_report_ns_ = now;
+    reports_sent_++;
+    return true;
+}
+
+nlohmann::json Controller::stats_json() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    nlohmann::json out;
+    out["enabled"] = cfg_.enabled;
+    if (!cfg_.enabled) return out;
+
+    for (int c = 0; c < CLASS_COUNT; ++c) {
+        out["classes"][class_name(static_cast<MessageClass>(c))] = {
+            {"admitted",     admitted_[c]},
+            {"rate_limited", rate_limited_[c]},
+            {"shed",         shed_[c]}
+        };
+    }
+
+    uint64_t overload_ns = overload_total_ns_;
+    if (overload_) overload_ns += now_ns() - overload_since_ns_;
+    out["overload"] = {
+        {"active",   overload_},
+        {"episodes", overload_episodes_},
+        {"total_ms", overload_ns / 1000000}
+    };
+    out["tracked_kinds"] = kinds_.size();
+    out["reports_sent"] = reports_sent_;
+
+    // Solo los kinds con descartes: los sanos no aportan y la lista sería larga
+    std::vector<std::pair<std::string, const KindState*>> noisy;
+    for (const auto& entry : kinds_) {
+        if (entry.second.rate_limited + entry.second.shed > 0) noisy.emplace_back(entry.first, &entry.second);
+    }
+    std::sort(noisy.begin(), noisy.end(), [](const auto& a, const auto& b) {
+        return a.second->rate_limited + a.second->shed > b.second->rate_limited + b.second->shed;
+    });
+    nlohmann::json top = nlohmann::json::array();
+    for (size_t i = 0; i < noisy.size() && i < REPORT_TOP_KINDS; ++i) {
+        const KindState& s = *noisy[i].second;
+        top.push_back({
+            {"kind",         noisy[i].first},
+            {"class",        class_name(s.cls)},
+            {"admitted",     s.admitted},
+            {"rate_limited", s.rate_limited},
+            {"shed",         s.shed}
+        });
+    }
+    out["top_dropped"] = top;
+    return out;
+}
+
+}  // namespace Admission
@@ -0,0 +1,137 @@
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <nlohmann/json.hpp>
+
+/**
+ * @brief Admission control de mensajes Chrome → Brain
+ *
+ * Una página de la extensión que se porta mal puede meter miles de mensajes
+ * por segundo en stdin; el host los reenviaba todos a Brain, que además
+ * difunde a todos los hosts lo que no reconoce. Cada mensaje se clasifica por
+ * kind (command / type / event, ver message_kind()):
+ *
+ *   CONTROL  handshake, HEARTBEAT, RESPONSE, acks... Pasan siempre.
+ *   NORMAL   el resto.
+ *   LOW      logs y telemetría (HARNESS_LOG, TELEMETRY*, METRIC*...). LOG_ENTRY no
+ *            llega acá: lo escribe el host (extension_logs.h).
+ *
+ * NORMAL y LOW pasan por un token bucket por kind y luego por uno global. En
+ * sobrecarga (bucket global por debajo de la mitad, o backlog hacia Brain) LOW
+ * se descarta sin gastar tokens: los logs se pierden antes que los comandos.
+ *
+ * Desactivado por defecto: los límites dependen de cuánto tráfico legítimo
+ * genera cada perfil y no hay uno que sirva para todos. --rate-limits lo
+ * activa: "on" con los límites de Config, o una lista "clave=rate[/burst]"
+ * separada por comas que los pisa, con clave = un kind, @normal / @low
+ * (default por kind de cada clase) o @total (bucket global). "off" (default)
+ * lo desactiva.
+ *
+ *   --rate-limits on
+ *   --rate-limits "@total=400/800,DOM_SNAPSHOT=5/10,METRICS=20"
+ *
+ * Lo descartado se reporta a Brain en ADMISSION_DROPS (a lo sumo uno por
+ * segundo mientras haya descartes) y en stats["admission"].
+ */
+namespace Admission {
+
+    enum MessageClass { CLASS_CONTROL = 0, CLASS_NORMAL = 1, CLASS_LOW = 2, CLASS_COUNT = 3 };
+
+    enum Verdict { ADMIT, DROP_RATE, DROP_SHED };
+
+    struct Rate {
+        double per_sec = 0;
+        double burst   = 0;
+    };
+
+    struct Config {
+        bool   enabled = false;
+        Rate   normal  = {100, 200};    // por kind
+        Rate   low     = {50, 100};     // por kind
+        Rate   total   = {400, 800};    // todos los NORMAL + LOW
+        std::map<std::string, Rate> per_kind;
+    };
+
+    /** Parsea --rate-limits sobre cfg. @return false con error si la spec es inválida */
+    bool parse_limits(const std::string& spec, Config& cfg, std::string& error);
+
+    MessageClass classify(const std::string& kind);
+    const char* class_name(MessageClass cls);
+
+    class TokenBucket {
+    public:
+        TokenBucket() = default;
+        TokenBucket(Rate rate, uint64_t now_ns);
+
+        /** Repone según el tiempo transcurrido y toma un token si hay. */
+        bool try_take(uint64_t now_ns);
+
+        /** Tokens disponibles / burst, en [0, 1]. */
+        double fill(uint64_t now_ns);
+
+    private:
+        void refill(uint64_t now_ns);
+
+        Rate     rate_;
+        double   tokens_  = 0;
+        uint64_t last_ns_ = 0;
+    };
+
+    class Controller {
+    public:
+        explicit Controller(Config cfg = Config());
+
+        /** Override de --rate-limits. Solo antes de arrancar el loop de stdin. */
+        void configure(const Config& cfg);
+
+        bool enabled() const { return cfg_.enabled; }
+
+        /**
+         * @brief Decide si un mensaje de Chrome sigue hacia Brain
+         * @param backlog true si la cola BULK hacia Brain ya está cargada
+         */
+        Verdict admit(const std::string& kind, bool backlog);
+
+        /**
+         * @brief ADMISSION_DROPS con lo descartado desde el último reporte
+         * @param force ignorar el mínimo de 1s entre reportes (heartbeat)
+         * @return false si no hay nada que reportar todavía
+         */
+        bool take_report(nlohmann::json& report, bool force);
+
+        nlohmann::json stats_json() const;
+
+    private:
+        struct KindState {
+            MessageClass cls = CLASS_NORMAL;
+            TokenBucket  bucket;
+            uint64_t     admitted     = 0;
+            uint64_t     rate_limited = 0;
+            uint64_t     shed         = 0;
+            uint64_t     reported_rate_limited = 0;
+            uint64_t     reported_shed = 0;
+        };
+
+        KindState& state_for(const std::string& kind, uint64_t now_ns);
+
+        Config                 cfg_;
+        mutable std::mutex     mutex_;
+        std::unordered_map<std::string, KindState> kinds_;
+        TokenBucket            total_;
+        bool                   overload_       = false;
+        uint64_t               overload_since_ns_ = 0;
+        uint64_t               overload_episodes_ = 0;
+        uint64_t               overload_total_ns_ = 0;
+        uint64_t               admitted_[CLASS_COUNT]     = {0, 0, 0};
+        uint64_t               rate_limited_[CLASS_COUNT] = {0, 0, 0};
+        uint64_t               shed_[CLASS_COUNT]         = {0, 0, 0};
+        uint64_t               pending_drops_  = 0;      // descartes sin reportar
+        uint64_t               last_report_ns_ = 0;
+        uint64_t               reports_sent_   = 0;
+    };
+
+}  // namespace Admission
@@ -0,0 +1,264 @@
+#include "alloc_tracker.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <map>
+#include <mutex>
+#include <new>
+
+// ============================================================================
+// ESTADO
+//
+// Todo lo que toca operator new debe ser trivialmente inicializable:
+// un thread_local con constructor dinámico podría asignar memoria la
+// primera vez que se accede y reentrar en operator new.
+// ============================================================================
+
+namespace {
+
+std::atomic<bool> g_enabled{false};
+
+// Kinds distintos con totales propios; el resto va a "{direction}:*other*".
+// El kind sale del mensaje, así que una página no puede hacer crecer la tabla.
+const size_t MAX_TRACKED_KINDS = 128;
+const char*  OVERFLOW_KIND = "*other*";
+
+thread_local uint64_t t_count[AllocTracker::STAGE_COUNT];
+thread_local uint64_t t_bytes[AllocTracker::STAGE_COUNT];
+thread_local int      t_stage     = AllocTracker::STAGE_OTHER;
+thread_local bool     t_internal  = false;   // true mientras el tracker consolida
+thread_local AllocTracker::MessageScope* t_scope = nullptr;
+
+struct StageTotals {
+    uint64_t count = 0;
+    uint64_t bytes = 0;
+};
+
+struct KindTotals {
+    uint64_t    messages = 0;
+    StageTotals stages[AllocTracker::STAGE_COUNT];
+};
+
+std::mutex&                         totals_mutex() { static std::mutex m; return m; }
+std::map<std::string, KindTotals>&  totals()       { static std::map<std::string, KindTotals> t; return t; }
+
+inline void record_allocation(std::size_t size) {
+    if (!g_enabled.load(std::memory_order_relaxed) || t_internal) return;
+    t_count[t_stage] += 1;
+    t_bytes[t_stage] += size;
+}
+
+inline void* tracked_malloc(std::size_t size) {
+    void* p = std::malloc(size ? size : 1);
+    if (p) record_allocation(size);
+    return p;
+}
+
+}  // namespace
+
+// ============================================================================
+// REEMPLAZO GLOBAL DE operator new / delete
+//
+// Solo las variantes no alineadas: las alineadas de la librería estándar usan
+// su propio allocator y no pasan por estas.
+// ============================================================================
+
+// GCC ve malloc/free a través de los operadores inlineados en este mismo TU
+// y emite -Wmismatched-new-delete para cada contenedor usado aquí. Es el
+// emparejamiento correcto: new → malloc, delete → free.
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+
+void* operator new(std::size_t size) {
+    void* p = tracked_malloc(size);
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+
+void* operator new[](std::size_t size) {
+    void* p = tracked_malloc(size);
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    return tracked_malloc(size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+    return tracked_malloc(size);
+}
+
+void operator delete(void* p) noexcept                                  { std::free(p); }
+void operator delete[](void* p) noexcept                                { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept                     { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept                   { std::free(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept           { std::free(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept         { std::free(p); }
+
+namespace AllocTracker {
+
+// ============================================================================
+// CONFIGURACIÓN
+// ============================================================================
+
+const char* stage_name(Stage stage) {
+    switch (stage) {
+        case STAGE_READ:    return "read";
+        case STAGE_PARSE:   return "parse";
+        case STAGE_CHUNK:   return "chunk";
+        case STAGE_LOG:     return "log";
+        case STAGE_FORWARD: return "forward";
+        default:            return "other";
+    }
+}
+
+void set_enabled(bool enabled) {
+    g_enabled.store(enabled);
+}
+
+bool is_enabled() {
+    return g_enabled.load(std::memory_order_relaxed);
+}
+
+// ============================================================================
+// StageScope
+// ============================================================================
+
+StageScope::StageScope(Stage stage) : previous(t_stage) {
+    t_stage = stage;
+}
+
+StageScope::~StageScope() {
+    t_stage = previous;
+}
+
+// ============================================================================
+// MessageScope
+// ============================================================================
+
+MessageScope::MessageScope(const char* p_direction)
+    : direction(p_direction), active(is_enabled()), outer(nullptr) {
+    if (!active) return;
+    for (int s = 0; s < STAGE_COUNT; ++s) {
+        start_count[s] = t_count[s];
+        start_bytes[s] = t_bytes[s];
+    }
+    outer   = t_scope;
+    t_scope = this;
+}
+
+void MessageScope::set_kind(const std::string& p_kind) {
+    if (!active || !kind.empty()) return;
+    t_internal = true;   // la copia del string no es costo del mensaje
+    kind = p_kind;
+    t_internal = false;
+}
+
+MessageScope::~MessageScope() {
+    if (!active) return;
+    t_scope = outer;
+
+    uint64_t delta_count[STAGE_COUNT];
+    uint64_t delta_bytes[STAGE_COUNT];
+    for (int s = 0; s < STAGE_COUNT; ++s) {
+        delta_count[s] = t_count[s] - start_count[s];
+        delta_bytes[s] = t_bytes[s] - start_bytes[s];
+    }
+
+    t_internal = true;
+    {
+        std::lock_guard<std::mutex> lock(totals_mutex());
+        auto& table = totals();
+        const bool full = table.size() >= MAX_TRACKED_KINDS;
+        std::string key = std::string(direction) + ":" + (kind.empty() ? "(unknown)" : kind);
+        auto it = table.find(key);
+        if (it == table.end()) {
+            if (full) key = std::string(direction) + ":" + OVERFLOW_KIND;
+            it = table.emplace(key, KindTotals()).first;
+        }
+        KindTotals& k = it->second;
+        k.messages++;
+        for (int s = 0; s < STAGE_COUNT; ++s) {
+            k.stages[s].count += delta_count[s];
+            k.stages[s].bytes += delta_bytes[s];
+        }
+    }
+    t_internal = false;
+}
+
+void set_message_kind(const std::string& kind) {
+    if (t_scope) t_scope->set_kind(kind);
+}
+
+uint64_t thread_alloc_count() {
+    uint64_t total = 0;
+    for (int s = 0; s < STAGE_COUNT; ++s) total += t_count[s];
+    return total;
+}
+
+uint64_t thread_alloc_bytes() {
+    uint64_t total = 0;
+    for (int s = 0; s < STAGE_COUNT; ++s) total += t_bytes[s];
+    return total;
+}
+
+// ============================================================================
+// REPORTE
+// ============================================================================
+
+nlohmann::json stats_json() {
+    nlohmann::json out;
+    out["enabled"] = is_enabled();
+    if (!is_enabled()) return out;
+
+    std::map<std::string, KindTotals> snapshot;
+    {
+        std::lock_guard<std::mutex> lock(totals_mutex());
+        snapshot = totals();
+    }
+
+    StageTotals all[STAGE_COUNT];
+    nlohmann::json by_message = nlohmann::json::object();
+
+    for (const auto& entry : snapshot) {
+        const KindTotals& k = entry.second;
+        uint64_t msg_count = 0, msg_bytes = 0;
+        nlohmann::json stages = nlohmann::json::object();
+
+        for (int s = 0; s < STAGE_COUNT; ++s) {
+            all[s].count += k.stages[s].count;
+            all[s].bytes += k.stages[s].bytes;
+            msg_count    += k.stages[s].count;
+            msg_bytes    += k.stages[s].bytes;
+            if (k.stages[s].count == 0) continue;
+            stages[stage_name(static_cast<Stage>(s))] = {
+                {"count", k.stages[s].count},
+                {"bytes", k.stages[s].bytes}
+            };
+        }
+
+        double n = k.messages ? static_cast<double>(k.messages) : 1.0;
+        by_message[entry.first] = {
+            {"messages",       k.messages},
+            {"allocs_per_msg", msg_count / n},
+            {"bytes_per_msg",  msg_bytes / n},
+            {"stages",         stages}
+        };
+    }
+
+    nlohmann::json stages = nlohmann::json::object();
+    for (int s = 0; s < STAGE_COUNT; ++s) {
+        stages[stage_name(static_cast<Stage>(s))] = {
+            {"count", all[s].count},
+            {"bytes", all[s].bytes}
+        };
+    }
+
+    out["stages"]     = stages;
+    out["by_message"] = by_message;
+    return out;
+}
+
+}  // namespace AllocTracker
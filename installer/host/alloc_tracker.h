@@ -0,0 +1,113 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <nlohmann/json.hpp>
+
+/**
+ * @brief Contabilidad opcional de asignaciones de heap por etapa del pipeline
+ *
+ * Reemplaza operator new/delete globales (alloc_tracker.cpp). Desactivado por
+ * defecto: el costo en el hot path es un load atómico relaxed por asignación.
+ *
+ * Activación:
+ *   - variable de entorno BLOOM_HOST_ALLOC_TRACK=1
+ *   - flag --alloc-track en la línea de comandos
+ *
+ * Modelo:
+ *   - StageScope marca la etapa actual del thread (read, parse, chunk, log, forward).
+ *     Cada asignación suma count/bytes a la etapa activa del thread que la hace.
+ *   - MessageScope abarca el manejo completo de un mensaje entrante. Al destruirse
+ *     calcula el delta por etapa y lo acumula bajo "{direction}:{kind}". Hasta
+ *     128 kinds distintos; los siguientes van a "{direction}:*other*".
+ *
+ * Los contadores son thread_local: no hay contención entre el thread STDIN y el TCP.
+ * Solo el cierre de un MessageScope toma un mutex para consolidar el agregado.
+ */
+namespace AllocTracker {
+
+    enum Stage {
+        STAGE_OTHER = 0,
+        STAGE_READ,      // lectura de frame (stdin o socket) y copia a std::string
+        STAGE_PARSE,     // json::parse + extracción de campos
+        STAGE_CHUNK,     // ChunkedMessageBuffer (base64, sha256, ensamblado)
+        STAGE_LOG,       // SynapseLogManager + metadata para logs
+        STAGE_FORWARD,   // serialización y escritura hacia Brain / Chrome
+        STAGE_COUNT
+    };
+
+    /** Nombre estable de la etapa, usado como clave en stats. */
+    const char* stage_name(Stage stage);
+
+    /** Habilita/deshabilita la contabilidad. Llamar antes de arrancar threads. */
+    void set_enabled(bool enabled);
+    bool is_enabled();
+
+    /**
+     * @brief Fija la etapa activa del thread durante el scope.
+     * Anidable: restaura la etapa previa al destruirse.
+     */
+    class StageScope {
+    public:
+        explicit StageScope(Stage stage);
+        ~StageScope();
+        StageScope(const StageScope&) = delete;
+        StageScope& operator=(const StageScope&) = delete;
+    private:
+        int previous;
+    };
+
+    /**
+     * @brief Agrupa todas las asignaciones hechas por el thread mientras se
+     *        maneja un mensaje, y las atribuye al tipo de mensaje.
+     *
+     * @param direction "chrome" (stdin) o "brain" (TCP)
+     *
+     * El tipo se conoce recién después del parse: usar set_message_kind().
+     * Si nunca se fija, el mensaje se registra como "(unknown)".
+     */
+    class MessageScope {
+    public:
+        explicit MessageScope(const char* direction);
+        ~MessageScope();
+        MessageScope(const MessageScope&) = delete;
+        MessageScope& operator=(const MessageScope&) = delete;
+
+        void set_kind(const std::string& kind);
+
+    private:
+        const char*   direction;
+        std::string   kind;
+        bool          active;
+        MessageScope* outer;
+        uint64_t      start_count[STAGE_COUNT];
+        uint64_t      start_bytes[STAGE_COUNT];
+    };
+
+    /** Fija el tipo del MessageScope activo en este thread (no-op si no hay). */
+    void set_message_kind(const std::string& kind);
+
+    /**
+     * @brief Totales acumulados por el thread actual (todas las etapas).
+     * Para medir un bloque: leer antes y después y restar. Solo cuentan
+     * asignaciones hechas con la contabilidad habilitada.
+     */
+    uint64_t thread_alloc_count();
+    uint64_t thread_alloc_bytes();
+
+    /**
+     * @brief Snapshot de los agregados por tipo de mensaje.
+     *
+     * {
+     *   "enabled": true,
+     *   "stages":  { "parse": {"count":N, "bytes":N}, ... },
+     *   "by_message": {
+     *     "chrome:LOG_ENTRY": { "messages":N, "allocs_per_msg":x, "bytes_per_msg":x,
+     *                           "stages": { "parse": {"count":N, "bytes":N}, ... } }
+     *   }
+     * }
+     */
+    nlohmann::json stats_json();
+
+}  // namespace AllocTracker
@@ -0,0 +1,813 @@
+#include "bench_common.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+#include <arpa/inet.h>
+#include <dirent.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <signal.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <openssl/sha.h>
+
+namespace Bench {
+
+namespace {
+
+// Con varios hosts vivos, cada hijo heredaría los pipes y sockets de los
+// demás: cerrar el stdin de un host no le llegaría como EOF.
+void set_cloexec(int fd) {
+    int flags = fcntl(fd, F_GETFD);
+    if (flags >= 0) fcntl(fd, F_SETFD, flags | FD_CLOEXEC);
+}
+
+}  // namespace
+
+// ============================================================================
+// TIEMPO / FRAMING
+// ============================================================================
+
+uint64_t now_ns() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+bool write_all(int fd, const char* data, size_t len) {
+    while (len > 0) {
+        ssize_t n = ::write(fd, data, len);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        data += n;
+        len  -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+bool read_exact(int fd, char* data, size_t len) {
+    while (len > 0) {
+        ssize_t n = ::read(fd, data, len);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        if (n == 0) return false;
+        data += n;
+        len  -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+bool write_le_frame(int fd, const std::string& payload) {
+    // Header + payload en un solo write: el host lee el header y el cuerpo
+    // por separado, pero un frame partido en dos syscalls duplica el costo aquí.
+    std::string frame;
+    frame.resize(4 + payload.size());
+    uint32_t len = static_cast<uint32_t>(payload.size());
+    frame[0] = static_cast<char>(len & 0xFF);
+    frame[1] = static_cast<char>((len >> 8) & 0xFF);
+    frame[2] = static_cast<char>((len >> 16) & 0xFF);
+    frame[3] = static_cast<char>((len >> 24) & 0xFF);
+    std::memcpy(&frame[4], payload.data(), payload.size());
+    return write_all(fd, frame.data(), frame.size());
+}
+
+bool read_le_frame(int fd, std::string& out) {
+    unsigned char hdr[4];
+    if (!read_exact(fd, reinterpret_cast<char*>(hdr), 4)) return false;
+    uint32_t len = hdr[0] | (hdr[1] << 8) | (hdr[2] << 16) | (static_cast<uint32_t>(hdr[3]) << 24);
+    out.resize(len);
+    return len == 0 || read_exact(fd, &out[0], len);
+}
+
+bool write_be_frame(int fd, const std::string& payload) {
+    std::string frame;
+    frame.resize(4 + payload.size());
+    uint32_t net_len = htonl(static_cast<uint32_t>(payload.size()));
+    std::memcpy(&frame[0], &net_len, 4);
+    std::memcpy(&frame[4], payload.data(), payload.size());
+    return write_all(fd, frame.data(), frame.size());
+}
+
+bool read_be_frame(int fd, std::string& out) {
+    uint32_t net_len = 0;
+    if (!read_exact(fd, reinterpret_cast<char*>(&net_len), 4)) return false;
+    uint32_t len = ntohl(net_len);
+    out.resize(len);
+    return len == 0 || read_exact(fd, &out[0], len);
+}
+
+int64_t extract_int_field(const std::string& msg, const char* key) {
+    std::string needle = std::string("\"") + key + "\":";
+    size_t pos = msg.find(needle);
+    if (pos == std::string::npos) return -1;
+    pos += needle.size();
+    while (pos < msg.size() && msg[pos] == ' ') ++pos;
+    int64_t value = 0;
+    bool digits = false;
+    while (pos < msg.size() && msg[pos] >= '0' && msg[pos] <= '9') {
+        value = value * 10 + (msg[pos] - '0');
+        digits = true;
+        ++pos;
+    }
+    return digits ? value : -1;
+}
+
+std::string extract_string_field(const std::string& msg, const char* key) {
+    std::string needle = std::string("\"") + key + "\":";
+    size_t pos = msg.find(needle);
+    if (pos == std::string::npos) return "";
+    pos += needle.size();
+    while (pos < msg.size() && msg[pos] == ' ') ++pos;
+    if (pos >= msg.size() || msg[pos] != '"') return "";
+    size_t end = msg.find('"', pos + 1);
+    if (end == std::string::npos) return "";
+    return msg.substr(pos + 1, end - pos - 1);
+}
+
+std::string make_message(const char* kind_field, const std::string& kind,
+                         uint64_t seq, size_t size) {
+    std::string head = std::string("{\"") + kind_field + "\":\"" + kind +
+                       "\",\"seq\":" + std::to_string(seq) + ",\"pad\":\"";
+    std::string tail = "\"}";
+    size_t fixed = head.size() + tail.size();
+    size_t pad   = size > fixed ? size - fixed : 0;
+
+    std::string msg;
+    msg.reserve(fixed + pad);
+    msg += head;
+    msg.append(pad, 'x');
+    msg += tail;
+    return msg;
+}
+
+std::string base64_encode(const std::string& data) {
+    static const char table[] =
+        "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    std::string out;
+    out.reserve(((data.size() + 2) / 3) * 4);
+    size_t i = 0;
+    for (; i + 2 < data.size(); i += 3) {
+        uint32_t v = (static_cast<unsigned char>(data[i]) << 16) |
+                     (static_cast<unsigned char>(data[i + 1]) << 8) |
+                      static_cast<unsigned char>(data[i + 2]);
+        out += table[(v >> 18) & 0x3F];
+        out += table[(v >> 12) & 0x3F];
+        out += table[(v >> 6) & 0x3F];
+        out += table[v & 0x3F];
+    }
+    size_t rest = data.size() - i;
+    if (rest == 1) {
+        uint32_t v = static_cast<unsigned char>(data[i]) << 16;
+        out += table[(v >> 18) & 0x3F];
+        out += table[(v >> 12) & 0x3F];
+        out += "==";
+    } else if (rest == 2) {
+        uint32_t v = (static_cast<unsigned char>(data[i]) << 16) |
+                     (static_cast<unsigned char>(data[i + 1]) << 8);
+        out += table[(v >> 18) & 0x3F];
+        out += table[(v >> 12) & 0x3F];
+        out += table[(v >> 6) & 0x3F];
+        out += '=';
+    }
+    return out;
+}
+
+std::string sha256_hex(const std::string& data) {
+    unsigned char hash[SHA256_DIGEST_LENGTH];
+    SHA256(reinterpret_cast<const unsigned char*>(data.data()), data.size(), hash);
+    std::ostringstream ss;
+    for (int i = 0; i < SHA256_DIGEST_LENGTH; ++i)
+        ss << std::hex << std::setw(2) << std::setfill('0') << static_cast<int>(hash[i]);
+    return ss.str();
+}
+
+std::vector<size_t> parse_size_list(const std::string& list) {
+    std::vector<size_t> sizes;
+    std::stringstream ss(list);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        if (item.empty()) continue;
+        size_t mult = 1;
+        char suffix = item.back();
+        if (suffix == 'K' || suffix == 'k') { mult = 1024;        item.pop_back(); }
+        if (suffix == 'M' || suffix == 'm') { mult = 1024 * 1024; item.pop_back(); }
+        size_t value = static_cast<size_t>(std::strtoull(item.c_str(), nullptr, 10));
+        if (value > 0) sizes.push_back(value * mult);
+    }
+    return sizes;
+}
+
+std::string make_temp_dir(const std::string& prefix) {
+    std::string tmpl = "/tmp/" + prefix + "XXXXXX";
+    std::vector<char> buf(tmpl.begin(), tmpl.end());
+    buf.push_back('\0');
+    if (!mkdtemp(buf.data())) return "";
+    return std::string(buf.data());
+}
+
+// ============================================================================
+// LatencyRecorder
+// ============================================================================
+
+double LatencyRecorder::percentile_us(double p) {
+    if (samples.empty()) return 0.0;
+    if (!sorted) {
+        std::sort(samples.begin(), samples.end());
+        sorted = true;
+    }
+    double rank = (p / 100.0) * static_cast<double>(samples.size() - 1);
+    size_t idx  = static_cast<size_t>(rank + 0.5);
+    if (idx >= samples.size()) idx = samples.size() - 1;
+    return samples[idx] / 1e3;
+}
+
+double LatencyRecorder::mean_us() const {
+    if (samples.empty()) return 0.0;
+    long double total = 0;
+    for (uint64_t s : samples) total += s;
+    return static_cast<double>(total / samples.size() / 1e3);
+}
+
+// ============================================================================
+// MOCK BRAIN
+// ============================================================================
+
+MockBrain::MockBrain(int port) : listen_port(port) {}
+
+MockBrain::~MockBrain() {
+    stop();
+}
+
+bool MockBrain::start() {
+    listen_sock = ::socket(AF_INET, SOCK_STREAM, 0);
+    if (listen_sock < 0) return false;
+    set_cloexec(listen_sock);
+
+    int yes = 1;
+    setsockopt(listen_sock, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes));
+
+    sockaddr_in addr{};
+    addr.sin_family      = AF_INET;
+    addr.sin_port        = htons(static_cast<uint16_t>(listen_port));
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+    if (::bind(listen_sock, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 ||
+        ::listen(listen_sock, 128) != 0) {
+        ::close(listen_sock);
+        listen_sock = -1;
+        return false;
+    }
+
+    running  = true;
+    acceptor = std::thread(&MockBrain::accept_loop, this);
+    return true;
+}
+
+void MockBrain::stop() {
+    if (!running.exchange(false)) return;
+
+    ::shutdown(listen_sock, SHUT_RDWR);
+    ::close(listen_sock);
+    if (acceptor.joinable()) acceptor.join();
+
+    std::map<int, std::shared_ptr<Connection>> snapshot;
+    {
+        std::lock_guard<std::mutex> lock(conn_mutex);
+        snapshot = connections;
+    }
+    for (auto& entry : snapshot) {
+        ::shutdown(entry.second->sock, SHUT_RDWR);
+        std::lock_guard<std::mutex> lock(entry.second->credit_mutex);
+        entry.second->credit_cv.notify_all();
+    }
+    for (auto& entry : snapshot) {
+        if (entry.second->reader.joinable()) entry.second->reader.join();
+        ::close(entry.second->sock);
+    }
+}
+
+void MockBrain::set_frame_handler(FrameHandler handler) {
+    std::lock_guard<std::mutex> lock(handler_mutex);
+    frame_handler = std::move(handler);
+}
+
+void MockBrain::set_flow_control(uint64_t window_bytes, uint64_t window_frames) {
+    flow_window_bytes = window_bytes;
+    flow_window_frames = window_bytes ? window_frames : 0;
+}
+
+void MockBrain::set_delta_format(const std::string& format) {
+    delta_format = format;
+}
+
+std::shared_ptr<MockBrain::Connection> MockBrain::find_connection(int conn_id) {
+    std::lock_guard<std::mutex> lock(conn_mutex);
+    auto it = connections.find(conn_id);
+    return it == connections.end() ? nullptr : it->second;
+}
+
+void MockBrain::accept_loop() {
+    while (running.load()) {
+        int sock = ::accept(listen_sock, nullptr, nullptr);
+        if (sock < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+        set_cloexec(sock);
+        int yes = 1;
+        setsockopt(sock, IPPROTO_TCP, TCP_NODELAY, &yes, sizeof(yes));
+
+        std::lock_guard<std::mutex> lock(conn_mutex);
+        int id = next_conn_id++;
+        auto conn  = std::make_shared<Connection>();
+        conn->sock = sock;
+        connections[id] = conn;
+        conn->reader = std::thread(&MockBrain::reader_loop, this, id);
+        accepted.fetch_add(1);
+    }
+}
+
+void MockBrain::reader_loop(int conn_id) {
+    std::shared_ptr<Connection> conn;
+    {
+        std::lock_guard<std::mutex> lock(conn_mutex);
+        conn = connections[conn_id];
+    }
+
+    std::string frame;
+    while (running.load() && read_be_frame(conn->sock, frame)) {
+        if (conn->frozen.load()) {
+            // Colgado: el socket sigue abierto pero nadie procesa nada
+            while (running.load()) std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            break;
+        }
+        uint64_t recv_ns = now_ns();
+        std::string type = extract_string_field(frame, "type");
+        consume_host_frame(conn, frame.size());
+
+        if (type == "REGISTER_HOST" || type == "PROFILE_CONNECTED" || type == "FLOW_CREDIT" ||
+            type == "PING" || type == "PONG" || type == "HEARTBEAT" || type == "UNREGISTER_HOST") {
+            on_control_frame(conn_id, type, frame);
+            if (type == "UNREGISTER_HOST") break;
+            continue;
+        }
+
+        FrameHandler handler;
+        {
+            std::lock_guard<std::mutex> lock(handler_mutex);
+            handler = frame_handler;
+        }
+        if (handler) handler(conn_id, frame, recv_ns);
+    }
+
+    // Cerrar lado escritura: el host sale de recv() y termina su thread TCP.
+    ::shutdown(conn->sock, SHUT_RDWR);
+
+    // Un send() esperando crédito de este host no lo va a recibir nunca
+    std::lock_guard<std::mutex> lock(conn->credit_mutex);
+    conn->flow = false;
+    conn->credit_cv.notify_all();
+}
+
+void MockBrain::on_control_frame(int conn_id, const std::string& type, const std::string& frame) {
+    if (type == "REGISTER_HOST") {
+        {
+            std::lock_guard<std::mutex> lock(reg_mutex);
+            reg_times.push_back(now_ns());
+            registered.fetch_add(1);
+        }
+        reg_cv.notify_all();
+        std::shared_ptr<Connection> conn = find_connection(conn_id);
+        if (!conn) return;
+
+        // Delta encoding solo si el host lo anunció con este formato
+        std::string delta_ack;
+        if (!delta_format.empty() && frame.find("\"delta\"") != std::string::npos &&
+            frame.find("\"" + delta_format + "\"") != std::string::npos) {
+            delta_ack = ",\"delta\":{\"format\":\"" + delta_format + "\"}";
+        }
+
+        int64_t host_bytes = extract_int_field(frame, "window_bytes");
+        int64_t host_frames = extract_int_field(frame, "window_frames");
+        if (flow_window_bytes == 0 || host_bytes <= 0 || host_frames <= 0) {
+            send_control(conn, "{\"type\":\"REGISTER_ACK\"" + delta_ack + "}");
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(conn->credit_mutex);
+            conn->flow = true;
+            conn->window_bytes = host_bytes;
+            conn->credit_bytes = host_bytes;
+            conn->credit_frames = host_frames;
+        }
+        send_control(conn, "{\"type\":\"REGISTER_ACK\"" + delta_ack + ",\"flow_control\":{\"window_bytes\":" +
+                           std::to_string(flow_window_bytes) + ",\"window_frames\":" +
+                           std::to_string(flow_window_frames) + "}}");
+        consume_host_frame(conn, frame.size());
+    } else if (type == "FLOW_CREDIT") {
+        std::shared_ptr<Connection> conn = find_connection(conn_id);
+        if (!conn) return;
+        std::lock_guard<std::mutex> lock(conn->credit_mutex);
+        conn->credit_bytes += extract_int_field(frame, "bytes");
+        conn->credit_frames += extract_int_field(frame, "frames");
+        conn->credit_cv.notify_all();
+    } else if (type == "PROFILE_CONNECTED") {
+        std::string launch_id = extract_string_field(frame, "launch_id");
+        std::lock_guard<std::mutex> lock(conn_mutex);
+        profiles.push_back(conn_id);
+        if (!launch_id.empty()) launch_connections[launch_id] = conn_id;
+        profiles_cv.notify_all();
+    } else if (type == "PING") {
+        // Probe de liveness del host: como Brain, PONG con el mismo seq
+        std::shared_ptr<Connection> conn = find_connection(conn_id);
+        if (!conn) return;
+        std::string seq = extract_string_field(frame, "seq");
+        send_control(conn, seq.empty() ? "{\"type\":\"PONG\"}"
+                                       : "{\"type\":\"PONG\",\"seq\":\"" + seq + "\"}");
+    } else if (type == "PONG") {
+        std::shared_ptr<Connection> conn = find_connection(conn_id);
+        if (!conn) return;
+        uint64_t sent = conn->ping_sent_ns.exchange(0);
+        if (sent != 0) {
+            std::lock_guard<std::mutex> lock(rtt_mutex);
+            rtts.add(now_ns() - sent);
+        }
+    }
+}
+
+bool MockBrain::send(int conn_id, const std::string& payload) {
+    std::shared_ptr<Connection> conn = find_connection(conn_id);
+    if (!conn) return false;
+    {
+        std::unique_lock<std::mutex> lock(conn->credit_mutex);
+        if (conn->flow) {
+            const int64_t size = static_cast<int64_t>(payload.size());
+            auto has_credit = [&] {
+                return !running.load() || !conn->flow ||
+                       (conn->credit_frames >= 1 &&
+                        (conn->credit_bytes >= size || conn->credit_bytes >= conn->window_bytes));
+            };
+            if (!has_credit()) {
+                uint64_t start = now_ns();
+                stalls.fetch_add(1);
+                conn->credit_cv.wait(lock, has_credit);
+                stall_ns.fetch_add(now_ns() - start);
+            }
+            conn->credit_bytes -= size;
+            conn->credit_frames -= 1;
+        }
+    }
+    std::lock_guard<std::mutex> lock(conn->send_mutex);
+    return write_be_frame(conn->sock, payload);
+}
+
+bool MockBrain::send_control(const std::shared_ptr<Connection>& conn, const std::string& payload) {
+    {
+        std::lock_guard<std::mutex> lock(conn->credit_mutex);
+        if (conn->flow) {
+            conn->credit_bytes -= static_cast<int64_t>(payload.size());
+            conn->credit_frames -= 1;
+        }
+    }
+    std::lock_guard<std::mutex> lock(conn->send_mutex);
+    return write_be_frame(conn->sock, payload);
+}
+
+void MockBrain::consume_host_frame(const std::shared_ptr<Connection>& conn, size_t bytes) {
+    std::string grant;
+    {
+        std::lock_guard<std::mutex> lock(conn->credit_mutex);
+        if (!conn->flow) return;
+        conn->pending_bytes += bytes;
+        conn->pending_frames += 1;
+        if (conn->pending_bytes * 2 < flow_window_bytes && conn->pending_frames * 2 < flow_window_frames) return;
+        grant = "{\"type\":\"FLOW_CREDIT\",\"bytes\":" + std::to_string(conn->pending_bytes) +
+                ",\"frames\":" + std::to_string(conn->pending_frames) + "}";
+        conn->pending_bytes = 0;
+        conn->pending_frames = 0;
+    }
+    send_control(conn, grant);
+}
+
+bool MockBrain::ping(int conn_id) {
+    std::shared_ptr<Connection> conn = find_connection(conn_id);
+    if (!conn) return false;
+    conn->ping_sent_ns.store(now_ns());
+    return send_control(conn, "{\"type\":\"PING\"}");
+}
+
+void MockBrain::freeze_connections() {
+    std::lock_guard<std::mutex> lock(conn_mutex);
+    for (auto& entry : connections) entry.second->frozen.store(true);
+}
+
+bool MockBrain::wait_for_profiles(size_t count, int timeout_ms) {
+    std::unique_lock<std::mutex> lock(conn_mutex);
+    return profiles_cv.wait_for(lock, std::chrono::milliseconds(timeout_ms),
+                                [&] { return profiles.size() >= count; });
+}
+
+std::vector<int> MockBrain::profile_connections() {
+    std::lock_guard<std::mutex> lock(conn_mutex);
+    return profiles;
+}
+
+int MockBrain::connection_for_launch(const std::string& launch_id) {
+    std::lock_guard<std::mutex> lock(conn_mutex);
+    auto it = launch_connections.find(launch_id);
+    return it == launch_connections.end() ? -1 : it->second;
+}
+
+std::vector<uint64_t> MockBrain::registration_times() {
+    std::lock_guard<std::mutex> lock(reg_mutex);
+    return reg_times;
+}
+
+bool MockBrain::wait_for_registrations(size_t count, int timeout_ms) {
+    std::unique_lock<std::mutex> lock(reg_mutex);
+    return reg_cv.wait_for(lock, std::chrono::milliseconds(timeout_ms),
+                           [&] { return reg_times.size() >= count; });
+}
+
+LatencyRecorder MockBrain::ping_rtts() {
+    std::lock_guard<std::mutex> lock(rtt_mutex);
+    return rtts;
+}
+
+void MockBrain::clear_ping_rtts() {
+    std::lock_guard<std::mutex> lock(rtt_mutex);
+    rtts.clear();
+}
+
+// ============================================================================
+// HOST PROCESS
+// ============================================================================
+
+HostProcess::~HostProcess() {
+    if (child > 0) shutdown(2000);
+}
+
+bool HostProcess::spawn(const std::string& binary, const std::vector<std::string>& args,
+                        const std::string& stderr_path) {
+    int in_pipe[2], out_pipe[2];
+    if (pipe(in_pipe) != 0) return false;
+    if (pipe(out_pipe) != 0) {
+        ::close(in_pipe[0]); ::close(in_pipe[1]);
+        return false;
+    }
+
+    child = fork();
+    if (child < 0) return false;
+
+    if (child == 0) {
+        dup2(in_pipe[0], STDIN_FILENO);
+        dup2(out_pipe[1], STDOUT_FILENO);
+        int err = ::open(stderr_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (err >= 0) dup2(err, STDERR_FILENO);
+        ::close(in_pipe[0]);  ::close(in_pipe[1]);
+        ::close(out_pipe[0]); ::close(out_pipe[1]);
+
+        std::vector<char*> argv;
+        argv.push_back(const_cast<char*>(binary.c_str()));
+        for (const auto& a : args) argv.push_back(const_cast<char*>(a.c_str()));
+        argv.push_back(nullptr);
+        execv(binary.c_str(), argv.data());
+        _exit(127);
+    }
+
+    ::close(in_pipe[0]);
+    ::close(out_pipe[1]);
+    in_fd  = in_pipe[1];
+    out_fd = out_pipe[0];
+    set_cloexec(in_fd);
+    set_cloexec(out_fd);
+    return true;
+}
+
+void HostProcess::close_stdin() {
+    if (in_fd >= 0) { ::close(in_fd); in_fd = -1; }
+}
+
+int HostProcess::shutdown(int timeout_ms) {
+    if (child <= 0) return -1;
+
+    close_stdin();
+
+    int status = 0;
+    uint64_t deadline = now_ns() + static_cast<uint64_t>(timeout_ms) * 1000000ULL;
+    while (true) {
+        pid_t r = waitpid(child, &status, WNOHANG);
+        if (r == child) break;
+        if (r < 0 || now_ns() > deadline) {
+            kill(child, SIGKILL);
+            waitpid(child, &status, 0);
+            break;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    }
+
+    if (out_fd >= 0) { ::close(out_fd); out_fd = -1; }
+    child = -1;
+    return WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+}
+
+std::vector<std::string> host_args(const std::string& profile_id, const std::string& launch_id,
+                                   const std::string& base_dir, int port) {
+    return {
+        "--profile-id",    profile_id,
+        "--launch-id",     launch_id,
+        "--user-base-dir", base_dir,
+        "--service-port",  std::to_string(port),
+        // Los benchmarks miden el pipeline, no la política de admisión; la
+        // fase admission de bloom-host-bench lanza su propio host con límites
+        "--rate-limits",   "off"
+    };
+}
+
+// ============================================================================
+// MÉTRICAS DE PROCESO
+// ============================================================================
+
+namespace {
+
+uint64_t status_field(const std::string& path, const char* key) {
+    std::ifstream in(path);
+    std::string line;
+    size_t klen = std::strlen(key);
+    while (std::getline(in, line)) {
+        if (line.compare(0, klen, key) == 0 && line.size() > klen && line[klen] == ':') {
+            return std::strtoull(line.c_str() + klen + 1, nullptr, 10);
+        }
+    }
+    return 0;
+}
+
+}  // namespace
+
+ProcSample sample_process(pid_t pid) {
+    ProcSample s;
+#ifdef __linux__
+    std::string base = "/proc/" + std::to_string(pid);
+
+    std::ifstream stat(base + "/stat");
+    std::string content;
+    if (!std::getline(stat, content)) return s;
+
+    // comm (campo 2) puede tener espacios: parsear desde el último ')'
+    size_t close = content.rfind(')');
+    if (close == std::string::npos) return s;
+    std::istringstream fields(content.substr(close + 2));
+    std::string tok;
+    uint64_t utime = 0, stime = 0;
+    for (int field = 3; fields >> tok; ++field) {
+        if (field == 14) utime = std::strtoull(tok.c_str(), nullptr, 10);
+        if (field == 15) { stime = std::strtoull(tok.c_str(), nullptr, 10); break; }
+    }
+    long ticks = sysconf(_SC_CLK_TCK);
+    s.cpu_ns = (utime + stime) * (1000000000ULL / static_cast<uint64_t>(ticks > 0 ? ticks : 100));
+
+    s.rss_kb  = status_field(base + "/status", "VmRSS");
+    s.threads = static_cast<int>(status_field(base + "/status", "Threads"));
+
+    if (DIR* dir = opendir((base + "/task").c_str())) {
+        while (dirent* entry = readdir(dir)) {
+            if (entry->d_name[0] == '.') continue;
+            std::string task = base + "/task/" + entry->d_name + "/status";
+            s.ctx_voluntary   += status_field(task, "voluntary_ctxt_switches");
+            s.ctx_involuntary += status_field(task, "nonvoluntary_ctxt_switches");
+        }
+        closedir(dir);
+    }
+    s.ok = true;
+#else
+    (void)pid;
+#endif
+    return s;
+}
+
+void raise_fd_limit() {
+    struct rlimit rl;
+    if (getrlimit(RLIMIT_NOFILE, &rl) == 0 && rl.rlim_cur < rl.rlim_max) {
+        rl.rlim_cur = rl.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &rl);
+    }
+}
+
+// ============================================================================
+// CHROME EMULATOR
+// ============================================================================
+
+ChromeEmulator::ChromeEmulator(HostProcess& p_host, const std::string& p_profile_id,
+                               const std::string& p_launch_id)
+    : host(p_host), profile_id(p_profile_id), launch_id(p_launch_id) {}
+
+ChromeEmulator::~ChromeEmulator() {
+    join();
+}
+
+void ChromeEmulator::start(FrameHandler p_handler) {
+    handler = std::move(p_handler);
+    reader  = std::thread(&ChromeEmulator::reader_loop, this);
+}
+
+void ChromeEmulator::join() {
+    if (reader.joinable()) reader.join();
+}
+
+void ChromeEmulator::reader_loop() {
+    std::string frame;
+    while (read_le_frame(host.stdout_fd(), frame)) {
+        uint64_t recv_ns = now_ns();
+        received.fetch_add(1);
+
+        if (extract_string_field(frame, "command") == "host_ready") {
+            std::lock_guard<std::mutex> lock(ready_mutex);
+            host_ready = true;
+            ready_cv.notify_all();
+            continue;
+        }
+        if (extract_string_field(frame, "command") == "keepalive") {
+            std::lock_guard<std::mutex> lock(keepalive_mutex);
+            if (last_keepalive_ns != 0) keepalive_intervals.add(recv_ns - last_keepalive_ns);
+            last_keepalive_ns = recv_ns;
+            continue;
+        }
+
+        if (handler) handler(frame, recv_ns);
+    }
+}
+
+LatencyRecorder ChromeEmulator::keepalive_gaps() {
+    std::lock_guard<std::mutex> lock(keepalive_mutex);
+    return keepalive_intervals;
+}
+
+void ChromeEmulator::clear_keepalive_gaps() {
+    std::lock_guard<std::mutex> lock(keepalive_mutex);
+    keepalive_intervals.clear();
+}
+
+bool ChromeEmulator::handshake(int timeout_ms) {
+    if (!send("{\"command\":\"extension_ready\",\"profile_id\":\"" + profile_id +
+              "\",\"launch_id\":\"" + launch_id + "\"}")) {
+        return false;
+    }
+
+    {
+        std::unique_lock<std::mutex> lock(ready_mutex);
+        if (!ready_cv.wait_for(lock, std::chrono::milliseconds(timeout_ms),
+                               [&] { return host_ready; })) {
+            return false;
+        }
+    }
+
+    return send("{\"command\":\"handshake_confirm\"}");
+}
+
+bool ChromeEmulator::send(const std::string& payload) {
+    std::lock_guard<std::mutex> lock(write_mutex);
+    return write_le_frame(host.stdin_fd(), payload);
+}
+
+bool ChromeEmulator::send_chunked(const std::string& payload, const std::string& message_id,
+                                  size_t chunk_bytes, bool abandon) {
+    if (chunk_bytes == 0) chunk_bytes = 256 * 1024;
+    size_t total_chunks = (payload.size() + chunk_bytes - 1) / chunk_bytes;
+
+    std::lock_guard<std::mutex> lock(write_mutex);
+
+    std::string header = "{\"bloom_chunk\":{\"type\":\"header\",\"message_id\":\"" + message_id +
+                         "\",\"total_chunks\":" + std::to_string(total_chunks) +
+                         ",\"total_size_bytes\":" + std::to_string(payload.size()) + "}}";
+    if (!write_le_frame(host.stdin_fd(), header)) return false;
+
+    for (size_t i = 0; i < total_chunks; ++i) {
+        std::string part = payload.substr(i * chunk_bytes, chunk_bytes);
+        std::string data = "{\"bloom_chunk\":{\"type\":\"data\",\"message_id\":\"" + message_id +
+                           "\",\"seq\":" + std::to_string(i) +
+                           ",\"total\":" + std::to_string(total_chunks) +
+                           ",\"data\":\"" + base64_encode(part) + "\"}}";
+        if (!write_le_frame(host.stdin_fd(), data)) return false;
+        if (abandon) return true;
+    }
+
+    std::string footer = "{\"bloom_chunk\":{\"type\":\"footer\",\"message_id\":\"" + message_id +
+                         "\",\"checksum_verify\":\"" + sha256_hex(payload) + "\"}}";
+    return write_le_frame(host.stdin_fd(), footer);
+}
+
+}  // namespace Bench
@@ -0,0 +1,331 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sys/types.h>
+
+/**
+ * @brief Infraestructura compartida de los benchmarks de bloom-host
+ *
+ * Todo corre dentro del proceso del benchmark:
+ *   - MockBrain:      servidor TCP local con framing big-endian. Responde
+ *                     REGISTER_HOST con REGISTER_ACK y mide RTT de PING/PONG.
+ *                     Opcionalmente negocia flow control por créditos como Brain.
+ *   - HostProcess:    bloom-host real lanzado como hijo con stdin/stdout en pipes.
+ *   - ChromeEmulator: habla Native Messaging (framing little-endian) sobre esos
+ *                     pipes: extension_ready, handshake_confirm, uploads en chunks.
+ *
+ * Como emisor y receptor viven en el mismo proceso, la latencia se mide con un
+ * único reloj monotónico (steady_clock) sin sincronización entre procesos.
+ *
+ * Solo POSIX: el host se lanza con fork/exec y pipes.
+ */
+namespace Bench {
+
+    // ========================================================================
+    // TIEMPO / FRAMING
+    // ========================================================================
+
+    /** Nanosegundos de steady_clock. */
+    uint64_t now_ns();
+
+    bool write_all(int fd, const char* data, size_t len);
+    bool read_exact(int fd, char* data, size_t len);
+
+    /** Frame Native Messaging: longitud uint32 little-endian + payload. */
+    bool write_le_frame(int fd, const std::string& payload);
+    bool read_le_frame(int fd, std::string& out);
+
+    /** Frame Brain: longitud uint32 big-endian + payload. */
+    bool write_be_frame(int fd, const std::string& payload);
+    bool read_be_frame(int fd, std::string& out);
+
+    /** Valor entero de "key": N buscado en crudo (sin construir DOM). -1 si no está. */
+    int64_t extract_int_field(const std::string& msg, const char* key);
+
+    /** Valor string de "key": "..." buscado en crudo. Vacío si no está. */
+    std::string extract_string_field(const std::string& msg, const char* key);
+
+    /** Mensaje JSON de exactamente `size` bytes con {kind_field: kind, "seq": seq, "pad": ...}. */
+    std::string make_message(const char* kind_field, const std::string& kind,
+                             uint64_t seq, size_t size);
+
+    std::string base64_encode(const std::string& data);
+    std::string sha256_hex(const std::string& data);
+
+    /** Lista "a,b,c" de tamaños con sufijos K/M opcionales. */
+    std::vector<size_t> parse_size_list(const std::string& list);
+
+    /** Directorio temporal nuevo (mkdtemp). Vacío si falla. */
+    std::string make_temp_dir(const std::string& prefix);
+
+    // ========================================================================
+    // ESTADÍSTICAS
+    // ========================================================================
+
+    /** Muestras de latencia en ns. Un escritor a la vez (proteger externamente si no). */
+    class LatencyRecorder {
+    public:
+        void   add(uint64_t ns) { samples.push_back(ns); }
+        size_t count() const    { return samples.size(); }
+        void   clear()          { samples.clear(); }
+        /** Percentil p en [0,100], en microsegundos. */
+        double percentile_us(double p);
+        double mean_us() const;
+    private:
+        std::vector<uint64_t> samples;
+        bool sorted = false;
+    };
+
+    // ========================================================================
+    // MOCK BRAIN
+    // ========================================================================
+
+    class MockBrain {
+    public:
+        /** frame: payload recibido de un host. recv_ns: now_ns() al terminar de leerlo. */
+        using FrameHandler = std::function<void(int conn_id, const std::string& frame, uint64_t recv_ns)>;
+
+        explicit MockBrain(int port);
+        ~MockBrain();
+
+        bool start();
+        void stop();
+
+        /** Handler para frames que no son parte del protocolo de control. */
+        void set_frame_handler(FrameHandler handler);
+
+        /**
+         * @brief Negocia flow control (flow_control.h) con hosts que lo anuncien.
+         * Llamar antes de start(). window_bytes = 0 lo deja apagado (Brain viejo).
+         */
+        void set_flow_control(uint64_t window_bytes, uint64_t window_frames);
+
+        /**
+         * @brief Acepta delta encoding (delta_encoder.h) en este formato si el
+         * host lo anuncia. Llamar antes de start(). "" = Brain sin delta.
+         * Rearmar los mensajes queda a cargo del frame handler.
+         */
+        void set_delta_format(const std::string& format);
+
+        /** Frame ruteado: con flow control espera crédito del host. */
+        bool send(int conn_id, const std::string& payload);
+
+        /** Envía PING; el RTT se registra al llegar el PONG. */
+        bool ping(int conn_id);
+
+        /**
+         * @brief Simula un Brain colgado en las conexiones abiertas
+         *
+         * Dejan de leer y responder (ni PONG ni FLOW_CREDIT) sin cerrar el
+         * socket, hasta stop(). Las conexiones nuevas se atienden normalmente.
+         */
+        void freeze_connections();
+
+        /** Espera hasta que `count` hosts hayan enviado PROFILE_CONNECTED. */
+        bool wait_for_profiles(size_t count, int timeout_ms);
+
+        /** conn_id de hosts con handshake completo, en orden de llegada. */
+        std::vector<int> profile_connections();
+
+        /** conn_id del host cuyo PROFILE_CONNECTED trajo este launch_id. -1 si no llegó. */
+        int connection_for_launch(const std::string& launch_id);
+
+        size_t connections_accepted() const { return accepted.load(); }
+        size_t registrations() const        { return registered.load(); }
+
+        /** now_ns() de cada REGISTER_HOST recibido, en orden de llegada. */
+        std::vector<uint64_t> registration_times();
+
+        /** Espera hasta `count` REGISTER_HOST (no requiere handshake con Chrome). */
+        bool wait_for_registrations(size_t count, int timeout_ms);
+
+        /** Copia de las muestras de RTT de PING/PONG. */
+        LatencyRecorder ping_rtts();
+        void clear_ping_rtts();
+
+        /** Veces que send() tuvo que esperar crédito, y tiempo total esperado. */
+        uint64_t credit_stalls() const     { return stalls.load(); }
+        uint64_t credit_stall_ns() const   { return stall_ns.load(); }
+
+        int port() const { return listen_port; }
+
+    private:
+        struct Connection {
+            int               sock = -1;
+            std::mutex        send_mutex;
+            std::thread       reader;
+            std::atomic<uint64_t> ping_sent_ns{0};
+            std::atomic<bool> frozen{false};
+
+            // Flow control (credit_mutex): crédito que otorgó el host y lo
+            // consumido del host sin devolver
+            std::mutex              credit_mutex;
+            std::condition_variable credit_cv;
+            bool                    flow = false;
+            int64_t                 credit_bytes = 0;
+            int64_t                 credit_frames = 0;
+            int64_t                 window_bytes = 0;
+            uint64_t                pending_bytes = 0;
+            uint64_t                pending_frames = 0;
+        };
+
+        void accept_loop();
+        void reader_loop(int conn_id);
+        void on_control_frame(int conn_id, const std::string& type, const std::string& frame);
+        std::shared_ptr<Connection> find_connection(int conn_id);
+        /** Frame propio del mock (ACK, PING, FLOW_CREDIT): descuenta sin esperar. */
+        bool send_control(const std::shared_ptr<Connection>& conn, const std::string& payload);
+        void consume_host_frame(const std::shared_ptr<Connection>& conn, size_t bytes);
+
+        int                   listen_port;
+        int                   listen_sock = -1;
+        std::atomic<bool>     running{false};
+        std::thread           acceptor;
+
+        std::mutex            conn_mutex;
+        std::condition_variable profiles_cv;
+        std::map<int, std::shared_ptr<Connection>> connections;
+        std::vector<int>      profiles;
+        std::map<std::string, int> launch_connections;
+        int                   next_conn_id = 1;
+
+        std::mutex            handler_mutex;
+        FrameHandler          frame_handler;
+
+        std::mutex            rtt_mutex;
+        LatencyRecorder       rtts;
+
+        std::mutex            reg_mutex;
+        std::condition_variable reg_cv;
+        std::vector<uint64_t> reg_times;
+
+        std::atomic<size_t>   accepted{0};
+        std::atomic<size_t>   registered{0};
+
+        uint64_t              flow_window_bytes = 0;
+        uint64_t              flow_window_frames = 0;
+        std::string           delta_format;
+        std::atomic<uint64_t> stalls{0};
+        std::atomic<uint64_t> stall_ns{0};
+    };
+
+    // ========================================================================
+    // HOST PROCESS
+    // ========================================================================
+
+    class HostProcess {
+    public:
+        HostProcess() = default;
+        ~HostProcess();
+
+        /**
+         * @brief Lanza bloom-host con stdin/stdout en pipes.
+         * @param stderr_path destino de stderr del host ("/dev/null" para descartarlo)
+         */
+        bool spawn(const std::string& binary, const std::vector<std::string>& args,
+                   const std::string& stderr_path);
+
+        /** Cierra stdin: el host ve STDIN_EOF y arranca su shutdown. */
+        void close_stdin();
+
+        /** Cierra stdin (STDIN_EOF en el host) y espera la salida. Mata el proceso si excede timeout. */
+        int shutdown(int timeout_ms);
+
+        pid_t pid()       const { return child; }
+        int   stdin_fd()  const { return in_fd; }
+        int   stdout_fd() const { return out_fd; }
+
+    private:
+        pid_t child  = -1;
+        int   in_fd  = -1;
+        int   out_fd = -1;
+    };
+
+    /** Argumentos estándar para un host de benchmark (identidad, base dir, puerto, sin rate limits). */
+    std::vector<std::string> host_args(const std::string& profile_id, const std::string& launch_id,
+                                       const std::string& base_dir, int port);
+
+    // ========================================================================
+    // MÉTRICAS DE PROCESO (Linux: /proc)
+    // ========================================================================
+
+    struct ProcSample {
+        bool     ok              = false;
+        uint64_t rss_kb          = 0;
+        int      threads         = 0;
+        uint64_t ctx_voluntary   = 0;   // suma de todos los threads vivos
+        uint64_t ctx_involuntary = 0;
+        uint64_t cpu_ns          = 0;   // utime + stime del proceso
+    };
+
+    /** Lee /proc/<pid>/{status,stat,task}. ok=false fuera de Linux o si el proceso no existe. */
+    ProcSample sample_process(pid_t pid);
+
+    /** Sube RLIMIT_NOFILE al máximo permitido (varios hosts = varios pipes y sockets). */
+    void raise_fd_limit();
+
+    // ========================================================================
+    // CHROME EMULATOR
+    // ========================================================================
+
+    class ChromeEmulator {
+    public:
+        /** frame: payload que el host escribió a stdout. */
+        using FrameHandler = std::function<void(const std::string& frame, uint64_t recv_ns)>;
+
+        ChromeEmulator(HostProcess& host, const std::string& profile_id, const std::string& launch_id);
+        ~ChromeEmulator();
+
+        /** Arranca el lector de stdout del host. Debe llamarse antes de handshake(). */
+        void start(FrameHandler handler);
+        void join();
+
+        /** extension_ready → espera host_ready → handshake_confirm. */
+        bool handshake(int timeout_ms);
+
+        bool send(const std::string& payload);
+
+        /**
+         * @brief Envía payload con el protocolo bloom_chunk (header, data..., footer sha256).
+         * @param chunk_bytes bytes de payload por chunk antes de base64
+         * @param abandon     solo header + primer data, sin footer (extensión recargada a mitad de upload)
+         */
+        bool send_chunked(const std::string& payload, const std::string& message_id, size_t chunk_bytes,
+                          bool abandon = false);
+
+        uint64_t frames_received() const { return received.load(); }
+
+        /** Intervalos entre keepalives consecutivos del host (ns). */
+        LatencyRecorder keepalive_gaps();
+        void clear_keepalive_gaps();
+
+    private:
+        void reader_loop();
+
+        HostProcess&            host;
+        std::string             profile_id;
+        std::string             launch_id;
+        std::thread             reader;
+        FrameHandler            handler;
+        std::mutex              write_mutex;
+        std::mutex              ready_mutex;
+        std::condition_variable ready_cv;
+        bool                    host_ready = false;
+        std::atomic<uint64_t>   received{0};
+        std::mutex              keepalive_mutex;
+        uint64_t                last_keepalive_ns = 0;
+        LatencyRecorder         keepalive_intervals;
+    };
+
+}  // namespace Bench
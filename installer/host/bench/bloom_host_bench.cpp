@@ -0,0 +1,1634 @@
+// ============================================================================
+// bloom-host-bench
+//
+// Benchmark end-to-end de bloom-host: lanza el binario real contra un mock
+// Brain local y un emulador de Chrome, y mide throughput y latencia por
+// tamaño de payload en ambas direcciones.
+//
+//   chrome_to_brain   stdin (LE frame) → host → TCP (BE frame)
+//   brain_to_chrome   TCP (BE frame)   → host → stdout (LE frame)
+//   chunked_upload    bloom_chunk header/data/footer → host ensambla → TCP
+//   ping_rtt          PING → PONG (manejado localmente por el host)
+//   ping_under_load   PING → PONG mientras Chrome inunda al host con frames
+//                     bulk de --load-size hacia Brain, y luego intervalo entre
+//                     keepalives y PING → PONG con Brain inundando a un
+//                     Chrome lento (PONG y keepalive son CONTROL en el
+//                     OutboundScheduler; con --flow-window el mock Brain deja
+//                     de mandar bulk sin crédito y el PING no queda atrás)
+//   extension_logs    --log-entries LOG_ENTRY de la extensión: frames que
+//                     llegan a Brain y líneas escritas en cortex_extension_*.log
+//   requests          --requests comandos Brain → Chrome con id; el Chrome
+//                     emulado contesta 9 de cada 10. Cuenta RESPONSE y
+//                     REQUEST_TIMEOUT en Brain y lee el tiempo de servicio
+//                     por command de stats["requests"] del host
+//   admission         un segundo host con los límites por defecto; su Chrome
+//                     inunda con TELEMETRY_BENCH (low), un kind normal y HEARTBEAT
+//                     (control) durante --admission-ms, y se cuenta lo que
+//                     llega a Brain por clase y los ADMISSION_DROPS recibidos
+//   dedup             un tercer host con --dedup; Chrome repite unos pocos
+//                     TAB_STATE (timestamp nuevo en cada copia) y Brain unos
+//                     pocos comandos, --dedup-messages en cada dirección. Se
+//                     cuenta lo que llega del otro lado
+//   delta             un host con --delta; Chrome manda TAB_STATE grandes que
+//                     cambian un nodo por vez (--delta-messages). El mock Brain
+//                     acepta json-patch, rearma cada mensaje y compara con lo
+//                     enviado; reporta bytes en el link y el costo de encode
+//   projection        Brain registra con SET_PROJECTION dos campos de un kind
+//                     y Chrome manda --projection-messages de ~64K. Cuenta
+//                     bytes que llegan a Brain y el costo de parsearlos ahí,
+//                     y el parse SAX del host (stats["projections"])
+//   subscriptions     Brain suscribe un kind entero y otro con "where"; Chrome
+//                     manda --subscription-messages repartidos entre esos dos
+//                     y un kind sin suscripción. Cuenta lo que llega a Brain
+//                     por kind y los hits de cada filtro (stats["subscriptions"])
+//   passthrough       frames Chrome → Brain de --passthrough-sizes que ninguna
+//                     etapa del host necesita mirar, --passthrough-count por
+//                     tamaño, contra dos hosts: uno con el fast path de
+//                     splice (--splice on) y otro sin. Reporta MB/s, CPU del
+//                     host y si los bytes llegaron intactos
+//   dead_peer         el mock Brain deja de leer y responder sin cerrar el
+//                     socket; mide hasta que el host lo declara muerto y
+//                     vuelve a mandar REGISTER_HOST (--dead-ms, que se pasa
+//                     al host como --brain-dead-ms)
+//
+// Uso:
+//   bloom-host-bench --host <path/bloom-host> [--port 15678]
+//                    [--sizes 256,4K,64K,512K] [--chunked-sizes 1M,4M]
+//                    [--chunk-bytes 256K] [--count 2000] [--window 32]
+//                    [--warmup 50] [--load-size 512K] [--flow-window 8M]
+//                    [--log-entries 5000] [--requests 500] [--request-timeout-ms 1000]
+//                    [--admission-ms 2000] [--dedup-messages 2000] [--delta-messages 1000]
+//                    [--projection-messages 500] [--subscription-messages 3000]
+//                    [--passthrough-sizes 1M,4M,16M] [--passthrough-count 10]
+//                    [--dead-ms 2000]
+//                    [--json] [--out results.json]
+//
+// --json imprime solo el JSON en stdout (para comparar builds con jq/diff).
+// ============================================================================
+
+#include "bench_common.h"
+
+#include <nlohmann/json.hpp>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <set>
+
+using json = nlohmann::json;
+using namespace Bench;
+
+namespace {
+
+const char* BENCH_PROFILE_ID = "bbbbbbbb-0000-4000-8000-000000000053";
+const char* BENCH_LAUNCH_ID  = "001_bench";
+const char* NOISY_PROFILE_ID = "bbbbbbbb-0000-4000-8000-000000000065";
+const char* NOISY_LAUNCH_ID  = "002_noisy";
+const char* DEDUP_PROFILE_ID = "bbbbbbbb-0000-4000-8000-000000000068";
+const char* DEDUP_LAUNCH_ID  = "003_dedup";
+const char* PASSTHROUGH_PROFILE_ID = "bbbbbbbb-0000-4000-8000-000000000072";
+
+// Ventana de la fase dedup y contenidos distintos que se repiten en ella
+const char*  DEDUP_SPEC      = "TAB_STATE=500,DEDUP_BENCH=500";
+const int    DEDUP_WINDOW_MS = 500;
+const size_t DEDUP_DISTINCT  = 4;
+
+const char* DELTA_PROFILE_ID = "bbbbbbbb-0000-4000-8000-000000000069";
+const char* DELTA_LAUNCH_ID  = "004_delta";
+const char* DELTA_FORMAT     = "json-patch";
+const size_t DELTA_TABS      = 8;
+const size_t DELTA_NODES     = 100;
+
+// Fase projection: kind proyectado, items por mensaje y relleno descartado
+const char*  PROJECTION_KIND       = "BENCH_PROJECT";
+const size_t PROJECTION_ITEMS      = 64;
+const size_t PROJECTION_BLOB_BYTES = 32768;
+
+// Fase subscriptions: kind suscripto entero, kind con "where" y kind sin
+// suscripción (la mitad de lo que manda Chrome)
+const char*  SUBSCRIPTION_KIND_ALL   = "BENCH_SUB_ALL";
+const char*  SUBSCRIPTION_KIND_WHERE = "BENCH_SUB_WHERE";
+const char*  SUBSCRIPTION_KIND_NOISE = "BENCH_SUB_NOISE";
+const size_t SUBSCRIPTION_BLOB_BYTES = 4096;
+
+// Fase passthrough: kind sin proyección, dedup ni suscripción
+const char*  PASSTHROUGH_KIND = "BENCH_PASSTHROUGH";
+
+// Límite de Chrome aplicado por el host (MAX_CHROME_MSG_SIZE). Por encima el
+// host responde MSG_TOO_BIG y el mensaje nunca llega: no tiene sentido medirlo.
+const size_t BRAIN_TO_CHROME_MAX = 1020000;
+
+const int RUN_TIMEOUT_MS = 60000;
+
+struct Options {
+    std::string         host_binary;
+    int                 port         = 15678;
+    std::vector<size_t> sizes        = {256, 4096, 65536, 524288};
+    std::vector<size_t> chunked      = {1048576, 4194304};
+    size_t              chunk_bytes  = 262144;
+    size_t              count        = 2000;
+    size_t              window       = 32;
+    size_t              warmup       = 50;
+    size_t              pings        = 200;
+    size_t              load_size    = 524288;
+    size_t              flow_window  = 8 * 1048576;   // crédito del mock Brain; 0 = Brain sin flow control
+    int                 dead_ms      = 2000;          // --brain-dead-ms del host; 0 = sin fase dead_peer
+    int                 admission_ms = 2000;          // duración del flood de la fase admission; 0 = sin fase
+    size_t              log_entries  = 5000;          // LOG_ENTRY de la fase extension_logs; 0 = sin fase
+    size_t              requests     = 500;           // comandos con id de la fase requests; 0 = sin fase
+    int                 request_timeout_ms = 1000;    // --request-timeout-ms del host
+    size_t              dedup_messages = 2000;        // copias por dirección de la fase dedup; 0 = sin fase
+    size_t              delta_messages = 1000;        // TAB_STATE de la fase delta; 0 = sin fase
+    size_t              projection_messages = 500;    // mensajes de la fase projection; 0 = sin fase
+    size_t              subscription_messages = 3000; // mensajes de la fase subscriptions; 0 = sin fase
+    std::vector<size_t> passthrough_sizes = {1048576, 4194304, 16777216};   // vacío = sin fase
+    size_t              passthrough_count = 10;       // frames por tamaño en la fase passthrough
+    bool                json_only    = false;
+    bool                keep_logs    = false;
+    std::string         out_path;
+};
+
+struct Result {
+    std::string direction;
+    size_t      size      = 0;
+    size_t      sent      = 0;
+    size_t      delivered = 0;
+    double      elapsed_s = 0;
+    LatencyRecorder latency;
+};
+
+// ============================================================================
+// RUN EN CURSO
+//
+// Un único run activo a la vez. El handler del receptor (thread del mock
+// Brain o lector de stdout) marca como entregado el seq si el tag coincide;
+// frames de runs anteriores que lleguen tarde se descartan por tag.
+// ============================================================================
+
+struct ActiveRun {
+    std::string             tag;
+    std::vector<uint64_t>   sent_ns;
+    std::vector<bool>       seen;
+    size_t                  delivered = 0;
+    uint64_t                last_ns   = 0;
+    LatencyRecorder         latency;
+    std::mutex              mutex;
+    std::condition_variable cv;
+};
+
+ActiveRun  g_run;
+std::atomic<int> g_slow_reader_us{0};   // keepalive_gap_under_load: Chrome que consume lento
+
+// Fase requests: el Chrome emulado contesta los BENCH_REQ salvo 1 de cada 10
+const char* REQUEST_BENCH_COMMAND = "BENCH_REQ";
+const int64_t REQUEST_UNANSWERED_EVERY = 10;
+std::atomic<ChromeEmulator*> g_request_responder{nullptr};
+
+void answer_request(ChromeEmulator& chrome, const std::string& frame) {
+    if (extract_string_field(frame, "command") != REQUEST_BENCH_COMMAND) return;
+    int64_t seq = extract_int_field(frame, "seq");
+    if (seq < 0 || seq % REQUEST_UNANSWERED_EVERY == REQUEST_UNANSWERED_EVERY - 1) return;
+    json response = {
+        {"type",    "RESPONSE"},
+        {"id",      extract_string_field(frame, "id")},
+        {"payload", {{"success", true}}}
+    };
+    chrome.send(response.dump());
+}
+
+void on_delivery(const std::string& frame, const char* kind_field, uint64_t recv_ns) {
+    std::string tag = extract_string_field(frame, kind_field);
+    int64_t     seq = extract_int_field(frame, "seq");
+
+    std::lock_guard<std::mutex> lock(g_run.mutex);
+    if (tag.empty() || tag != g_run.tag || seq < 0) return;
+    size_t s = static_cast<size_t>(seq);
+    if (s >= g_run.sent_ns.size() || g_run.seen[s] || g_run.sent_ns[s] == 0) return;
+
+    g_run.seen[s] = true;
+    g_run.latency.add(recv_ns - g_run.sent_ns[s]);
+    g_run.delivered++;
+    g_run.last_ns = recv_ns;
+    g_run.cv.notify_all();
+}
+
+void reset_run(const std::string& tag, size_t count) {
+    std::lock_guard<std::mutex> lock(g_run.mutex);
+    g_run.tag = tag;
+    g_run.sent_ns.assign(count, 0);
+    g_run.seen.assign(count, false);
+    g_run.delivered = 0;
+    g_run.last_ns   = 0;
+    g_run.latency.clear();
+}
+
+/**
+ * @brief Ejecuta un run con a lo sumo `window` mensajes en vuelo.
+ * @param send_one envía el mensaje seq; devuelve false si el canal murió
+ */
+Result run_windowed(const std::string& direction, const std::string& tag, size_t size,
+                    size_t count, size_t window,
+                    const std::function<bool(size_t seq)>& send_one) {
+    reset_run(tag, count);
+
+    Result r;
+    r.direction = direction;
+    r.size      = size;
+
+    uint64_t start = now_ns();
+    for (size_t seq = 0; seq < count; ++seq) {
+        {
+            std::unique_lock<std::mutex> lock(g_run.mutex);
+            bool ok = g_run.cv.wait_for(lock, std::chrono::milliseconds(RUN_TIMEOUT_MS),
+                                        [&] { return seq - g_run.delivered < window; });
+            if (!ok) break;
+            g_run.sent_ns[seq] = now_ns();
+        }
+        if (!send_one(seq)) break;
+        r.sent++;
+    }
+
+    {
+        std::unique_lock<std::mutex> lock(g_run.mutex);
+        g_run.cv.wait_for(lock, std::chrono::milliseconds(RUN_TIMEOUT_MS),
+                          [&] { return g_run.delivered >= r.sent; });
+        r.delivered = g_run.delivered;
+        uint64_t end = g_run.last_ns ? g_run.last_ns : now_ns();
+        r.elapsed_s  = (end - start) / 1e9;
+        r.latency    = g_run.latency;
+        g_run.tag.clear();
+    }
+    return r;
+}
+
+// ============================================================================
+// REPORTE
+// ============================================================================
+
+json result_json(Result& r) {
+    double msg_s = r.elapsed_s > 0 ? r.delivered / r.elapsed_s : 0.0;
+    double mb_s  = r.elapsed_s > 0 ? (static_cast<double>(r.delivered) * r.size) / (1024.0 * 1024.0) / r.elapsed_s : 0.0;
+    return {
+        {"direction",  r.direction},
+        {"size_bytes", r.size},
+        {"sent",       r.sent},
+        {"delivered",  r.delivered},
+        {"elapsed_s",  r.elapsed_s},
+        {"msg_per_s",  msg_s},
+        {"mb_per_s",   mb_s},
+        {"latency_us", {
+            {"mean", r.latency.mean_us()},
+            {"p50",  r.latency.percentile_us(50)},
+            {"p99",  r.latency.percentile_us(99)},
+            {"p999", r.latency.percentile_us(99.9)},
+            {"max",  r.latency.percentile_us(100)}
+        }}
+    };
+}
+
+void print_table(const json& results) {
+    std::printf("%-16s %10s %8s %8s %12s %10s %10s %10s %10s\n",
+                "direction", "size", "sent", "lost", "msg/s", "MB/s", "p50_us", "p99_us", "p999_us");
+    for (const auto& r : results) {
+        std::printf("%-16s %10zu %8zu %8zu %12.0f %10.2f %10.1f %10.1f %10.1f\n",
+                    r["direction"].get<std::string>().c_str(),
+                    r["size_bytes"].get<size_t>(),
+                    r["sent"].get<size_t>(),
+                    r["sent"].get<size_t>() - r["delivered"].get<size_t>(),
+                    r["msg_per_s"].get<double>(),
+                    r["mb_per_s"].get<double>(),
+                    r["latency_us"]["p50"].get<double>(),
+                    r["latency_us"]["p99"].get<double>(),
+                    r["latency_us"]["p999"].get<double>());
+    }
+}
+
+// ============================================================================
+// CLI
+// ============================================================================
+
+void print_usage() {
+    std::cerr <<
+        "Usage: bloom-host-bench --host <path/to/bloom-host> [options]\n"
+        "  --port N             mock Brain port, passed to the host as --service-port (default 15678)\n"
+        "  --sizes LIST         direct message sizes, e.g. 256,4K,64K,512K\n"
+        "  --chunked-sizes LIST chunked upload sizes, e.g. 1M,4M (empty to skip)\n"
+        "  --chunk-bytes N      payload bytes per bloom_chunk data frame (default 256K)\n"
+        "  --count N            messages per size and direction (default 2000)\n"
+        "  --window N           max in-flight messages (default 32)\n"
+        "  --warmup N           unmeasured messages before each run (default 50)\n"
+        "  --pings N            PING/PONG round trips (default 200)\n"
+        "  --load-size N        bulk frame size for ping_under_load, 0 to skip (default 512K)\n"
+        "  --flow-window N      credit window the mock Brain negotiates, 0 = no flow control (default 8M)\n"
+        "  --admission-ms N     flood duration of the admission phase, 0 to skip (default 2000)\n"
+        "  --log-entries N      LOG_ENTRY messages of the extension_logs phase, 0 to skip (default 5000)\n"
+        "  --requests N         Brain commands with an id in the requests phase, 0 to skip (default 500)\n"
+        "  --request-timeout-ms N  host --request-timeout-ms for the requests phase (default 1000)\n"
+        "  --dedup-messages N   repeated messages per direction in the dedup phase, 0 to skip (default 2000)\n"
+        "  --delta-messages N   TAB_STATE messages in the delta phase, 0 to skip (default 1000)\n"
+        "  --projection-messages N  ~64K messages in the projection phase, 0 to skip (default 500)\n"
+        "  --subscription-messages N  ~4K messages in the subscriptions phase, 0 to skip (default 3000)\n"
+        "  --passthrough-sizes LIST  frame sizes of the passthrough phase, \"\" to skip (default 1M,4M,16M)\n"
+        "  --passthrough-count N  frames per size in the passthrough phase (default 10)\n"
+        "  --dead-ms N          host --brain-dead-ms for the dead_peer phase, 0 to skip (default 2000)\n"
+        "  --json               print only the JSON report on stdout\n"
+        "  --out FILE           also write the JSON report to FILE\n"
+        "  --keep-logs          keep the temporary --user-base-dir with host logs\n";
+}
+
+bool parse_options(int argc, char* argv[], Options& o) {
+    for (int i = 1; i < argc; ++i) {
+        std::string a = argv[i];
+        auto next = [&](std::string& out) {
+            if (i + 1 >= argc) return false;
+            out = argv[++i];
+            return true;
+        };
+        std::string v;
+        if      (a == "--host"          && next(v)) o.host_binary = v;
+        else if (a == "--port"          && next(v)) o.port        = std::atoi(v.c_str());
+        else if (a == "--sizes"         && next(v)) o.sizes       = parse_size_list(v);
+        else if (a == "--chunked-sizes" && next(v)) o.chunked     = parse_size_list(v);
+        else if (a == "--chunk-bytes"   && next(v)) { auto s = parse_size_list(v); if (!s.empty()) o.chunk_bytes = s[0]; }
+        else if (a == "--count"         && next(v)) o.count       = std::strtoull(v.c_str(), nullptr, 10);
+        else if (a == "--window"        && next(v)) o.window      = std::max<size_t>(1, std::strtoull(v.c_str(), nullptr, 10));
+        else if (a == "--warmup"        && next(v)) o.warmup      = std::strtoull(v.c_str(), nullptr, 10);
+        else if (a == "--pings"         && next(v)) o.pings       = std::strtoull(v.c_str(), nullptr, 10);
+        else if (a == "--load-size"     && next(v)) { auto s = parse_size_list(v); o.load_size = s.empty() ? 0 : s[0]; }
+        else if (a == "--flow-window"   && next(v)) { auto s = parse_size_list(v); o.flow_window = s.empty() ? 0 : s[0]; }
+        else if (a == "--dead-ms"       && next(v)) o.dead_ms     = std::max(0, std::atoi(v.c_str()));
+        else if (a == "--admission-ms"  && next(v)) o.admission_ms = std::max(0, std::atoi(v.c_str()));
+        else if (a == "--log-entries"   && next(v)) o.log_entries = std::strtoull(v.c_str(), nullptr, 10);
+        else if (a == "--requests"      && next(v)) o.requests    = std::strtoull(v.c_str(), nullptr, 10);
+        else if (a == "--request-timeout-ms" && next(v)) o.request_timeout_ms = std::max(1, std::atoi(v.c_str()));
+        else if (a == "--dedup-messages" && next(v)) o.dedup_messages = std::strtoull(v.c_str(), nullptr, 10);
+        else if (a == "--delta-messages" && next(v)) o.delta_messages = std::strtoull(v.c_str(), nullptr, 10);
+        else if (a == "--projection-messages" && next(v)) o.projection_messages = std::strtoull(v.c_str(), nullptr, 10);
+        else if (a == "--subscription-messages" && next(v)) o.subscription_messages = std::strtoull(v.c_str(), nullptr, 10);
+        else if (a == "--passthrough-sizes" && next(v)) o.passthrough_sizes = parse_size_list(v);
+        else if (a == "--passthrough-count" && next(v)) o.passthrough_count = std::max<size_t>(1, std::strtoull(v.c_str(), nullptr, 10));
+        else if (a == "--out"           && next(v)) o.out_path    = v;
+        else if (a == "--json")      o.json_only = true;
+        else if (a == "--keep-logs") o.keep_logs = true;
+        else if (a == "--help" || a == "-h") return false;
+        else {
+            std::cerr << "Unknown or incomplete option: " << a << "\n";
+            return false;
+        }
+    }
+    return !o.host_binary.empty() && o.port > 0 && o.port < 65536 && o.count > 0;
+}
+
+/**
+ * @brief LOG_ENTRY de la extensión: cuántos llegan a Brain y cuántos al cortex log
+ *
+ * El host los escribe él mismo en cortex_extension_*.log; uno anterior los
+ * reenviaba a Brain (y solo dejaba en el log una línea CHROME_IN sin texto).
+ */
+json run_extension_logs(const Options& opt, ChromeEmulator& chrome, MockBrain& brain,
+                        const std::string& base_dir, std::ostream& info) {
+    struct Counters {
+        std::atomic<size_t>   frames{0};
+        std::atomic<uint64_t> bytes{0};
+    };
+    auto c = std::make_shared<Counters>();
+    brain.set_frame_handler([c](int, const std::string& frame, uint64_t) {
+        if (extract_string_field(frame, "type") != "LOG_ENTRY") return;
+        c->frames++;
+        c->bytes += frame.size();
+    });
+
+    const std::string pad(160, 'x');
+    uint64_t start = now_ns();
+    size_t sent = 0;
+    for (; sent < opt.log_entries; ++sent) {
+        json entry = {
+            {"type",      "LOG_ENTRY"},
+            {"level",     sent % 10 == 0 ? "warn" : "info"},
+            {"source",    "bench"},
+            {"message",   "bench-log-" + std::to_string(sent) + " " + pad},
+            {"timestamp", std::chrono::duration_cast<std::chrono::milliseconds>(
+                              std::chrono::system_clock::now().time_since_epoch()).count()}
+        };
+        if (!chrome.send(entry.dump())) break;
+    }
+    double send_s = (now_ns() - start) / 1e9;
+    std::this_thread::sleep_for(std::chrono::milliseconds(1000));   // lote del writer / cola hacia Brain
+
+    brain.set_frame_handler([](int, const std::string& frame, uint64_t recv_ns) {
+        on_delivery(frame, "event", recv_ns);
+    });
+
+    size_t written = 0;
+    std::error_code ec;
+    for (const auto& f : std::filesystem::recursive_directory_iterator(base_dir, ec)) {
+        if (f.path().filename().string().rfind("cortex_extension", 0) != 0) continue;
+        std::ifstream in(f.path());
+        std::string line;
+        while (std::getline(in, line)) {
+            if (line.find("bench-log-") != std::string::npos) written++;
+        }
+    }
+
+    info << "  extension_logs done\n";
+    return {
+        {"sent",              sent},
+        {"send_s",            send_s},
+        {"to_brain_frames",   c->frames.load()},
+        {"to_brain_bytes",    c->bytes.load()},
+        {"cortex_log_lines",  written}
+    };
+}
+
+/**
+ * @brief Comandos Brain → Chrome con id: RESPONSE, REQUEST_TIMEOUT y tiempo de servicio
+ *
+ * El Chrome emulado deja sin contestar 1 de cada 10. El host debería mandar
+ * un REQUEST_TIMEOUT por cada uno; uno sin correlación no manda nada y Brain
+ * tendría que vencerlos con timers propios.
+ */
+json run_requests(const Options& opt, ChromeEmulator& chrome, MockBrain& brain, int conn, std::ostream& info) {
+    struct Counters {
+        std::atomic<size_t> responses{0};
+        std::atomic<size_t> timeouts{0};
+        std::mutex          mutex;
+        std::condition_variable cv;
+        json                stats;
+    };
+    auto c = std::make_shared<Counters>();
+    brain.set_frame_handler([c](int, const std::string& frame, uint64_t) {
+        std::string type = extract_string_field(frame, "type");
+        if (type == "RESPONSE" && extract_string_field(frame, "id").rfind("bench-req-", 0) == 0) {
+            c->responses++;
+        } else if (type == "REQUEST_TIMEOUT") {
+            c->timeouts++;
+        } else if (type == "STATS_RESPONSE" && extract_string_field(frame, "request_id") == "bench-req-stats") {
+            std::lock_guard<std::mutex> lock(c->mutex);
+            c->stats = json::parse(frame, nullptr, false);
+        } else {
+            return;
+        }
+        c->cv.notify_all();
+    });
+    g_request_responder.store(&chrome);
+
+    size_t sent = 0;
+    for (; sent < opt.requests; ++sent) {
+        json cmd = {
+            {"command", REQUEST_BENCH_COMMAND},
+            {"id",      "bench-req-" + std::to_string(sent)},
+            {"seq",     sent},
+            {"payload", json::object()}
+        };
+        if (!brain.send(conn, cmd.dump())) break;
+    }
+    size_t unanswered = sent / REQUEST_UNANSWERED_EVERY;   // seq % 10 == 9
+
+    // Los no contestados vencen a request_timeout_ms del envío
+    {
+        std::unique_lock<std::mutex> lock(c->mutex);
+        c->cv.wait_for(lock, std::chrono::milliseconds(opt.request_timeout_ms + 3000), [&] {
+            return c->responses.load() + c->timeouts.load() >= sent;
+        });
+    }
+    g_request_responder.store(nullptr);
+
+    brain.send(conn, json({{"type", "REQUEST_STATS"}, {"request_id", "bench-req-stats"}}).dump());
+    json host_requests = nullptr;
+    {
+        std::unique_lock<std::mutex> lock(c->mutex);
+        c->cv.wait_for(lock, std::chrono::milliseconds(2000), [&] { return !c->stats.is_null(); });
+        if (c->stats.is_object() && c->stats["stats"].contains("requests")) {
+            host_requests = c->stats["stats"]["requests"];
+        }
+    }
+
+    brain.set_frame_handler([](int, const std::string& frame, uint64_t recv_ns) {
+        on_delivery(frame, "event", recv_ns);
+    });
+
+    json out = {
+        {"sent",        sent},
+        {"unanswered",  unanswered},
+        {"responses",   c->responses.load()},
+        {"timeouts",    c->timeouts.load()},
+        {"timeout_ms",  opt.request_timeout_ms}
+    };
+    if (host_requests.is_object() && host_requests.value("enabled", false)) {
+        for (const auto& cmd : host_requests["commands"]) {
+            if (cmd.value("command", "") != REQUEST_BENCH_COMMAND) continue;
+            out["service_us"] = {
+                {"avg", cmd["avg_us"]}, {"p50", cmd["p50_us"]}, {"p99", cmd["p99_us"]}, {"max", cmd["max_us"]}
+            };
+        }
+        out["host_max_probe"] = host_requests["max_probe"];
+    }
+    info << "  requests done\n";
+    return out;
+}
+
+/**
+ * @brief Proyección registrada por Brain sobre el host principal
+ *
+ * SET_PROJECTION pide "/payload/title" y el id de cada item; Chrome manda
+ * mensajes con PROJECTION_ITEMS items con html y un blob de relleno. Brain
+ * mide lo que recibe y cuánto tarda en parsearlo. Al final se borra la
+ * proyección para no afectar las fases siguientes. Un host sin proyecciones
+ * no contesta PROJECTION_ACK y reenvía todo completo.
+ */
+json run_projection(const Options& opt, ChromeEmulator& chrome, MockBrain& brain, int conn, std::ostream& info) {
+    struct State {
+        std::mutex              mutex;
+        std::condition_variable cv;
+        size_t                  received   = 0;
+        size_t                  complete   = 0;     // title + todos los ids
+        uint64_t                wire_bytes = 0;
+        uint64_t                parse_ns   = 0;
+        bool                    acked      = false;
+        json                    stats;
+    };
+    auto st = std::make_shared<State>();
+    brain.set_frame_handler([st](int, const std::string& frame, uint64_t) {
+        std::string type = extract_string_field(frame, "type");
+        std::lock_guard<std::mutex> lock(st->mutex);
+        if (type == "PROJECTION_ACK") {
+            st->acked = extract_string_field(frame, "kind") == PROJECTION_KIND &&
+                        frame.find("\"ok\":true") != std::string::npos;
+        } else if (type == "STATS_RESPONSE") {
+            if (extract_string_field(frame, "request_id") != "bench-projection-stats") return;
+            st->stats = json::parse(frame, nullptr, false);
+        } else if (extract_string_field(frame, "event") == PROJECTION_KIND) {
+            // Lo que le cuesta a Brain: el parse del frame tal como llega
+            uint64_t start = now_ns();
+            json msg = json::parse(frame, nullptr, false);
+            st->parse_ns += now_ns() - start;
+            st->wire_bytes += frame.size();
+            st->received++;
+            if (!msg.is_object() || !msg["payload"].is_object()) return;
+            const json& items = msg["payload"]["items"];
+            if (msg["payload"].value("title", "") != "" && items.is_array() && items.size() == PROJECTION_ITEMS &&
+                items.back().contains("id")) {
+                st->complete++;
+            }
+        } else {
+            return;
+        }
+        st->cv.notify_all();
+    });
+
+    json set = {
+        {"type",   "SET_PROJECTION"},
+        {"kind",   PROJECTION_KIND},
+        {"fields", json::array({"/payload/title", "/payload/items/*/id"})}
+    };
+    brain.send(conn, set.dump());
+    {
+        std::unique_lock<std::mutex> lock(st->mutex);
+        st->cv.wait_for(lock, std::chrono::milliseconds(2000), [&] { return st->acked; });
+    }
+
+    json items = json::array();
+    for (size_t i = 0; i < PROJECTION_ITEMS; ++i) {
+        items.push_back({{"id", i}, {"html", "<li>" + std::string(256, 'h') + "</li>"}, {"visible", i % 2 == 0}});
+    }
+    json msg = {
+        {"event",   PROJECTION_KIND},
+        {"payload", {{"title", "bench page"}, {"items", items}, {"blob", std::string(PROJECTION_BLOB_BYTES, 'b')}}}
+    };
+
+    uint64_t full_bytes = 0;
+    size_t sent = 0;
+    for (; sent < opt.projection_messages; ++sent) {
+        msg["seq"] = sent;
+        std::string payload = msg.dump();
+        full_bytes += payload.size();
+        if (!chrome.send(payload)) break;
+    }
+
+    json host_projections = nullptr;
+    {
+        std::unique_lock<std::mutex> lock(st->mutex);
+        st->cv.wait_for(lock, std::chrono::milliseconds(5000), [&] { return st->received >= sent; });
+    }
+    brain.send(conn, json({{"type", "REQUEST_STATS"}, {"request_id", "bench-projection-stats"}}).dump());
+    {
+        std::unique_lock<std::mutex> lock(st->mutex);
+        st->cv.wait_for(lock, std::chrono::milliseconds(2000), [&] { return !st->stats.is_null(); });
+        if (st->stats.is_object() && st->stats["stats"].contains("projections")) {
+            host_projections = st->stats["stats"]["projections"];
+        }
+    }
+    brain.send(conn, json({{"type", "SET_PROJECTION"}, {"kind", PROJECTION_KIND}, {"fields", json::array()}}).dump());
+
+    brain.set_frame_handler([](int, const std::string& frame, uint64_t recv_ns) {
+        on_delivery(frame, "event", recv_ns);
+    });
+
+    std::lock_guard<std::mutex> lock(st->mutex);
+    json out = {
+        {"acked",             st->acked},
+        {"sent",              sent},
+        {"received",          st->received},
+        {"complete",          st->complete},
+        {"full_bytes",        full_bytes},
+        {"wire_bytes",        st->wire_bytes},
+        {"brain_parse_us_avg", st->received ? st->parse_ns / st->received / 1000.0 : 0.0}
+    };
+    if (host_projections.is_object() && host_projections["kinds"].contains(PROJECTION_KIND)) {
+        out["host_sax_us_avg"] = host_projections["kinds"][PROJECTION_KIND]["sax_us_avg"];
+    }
+    info << "  projection done\n";
+    return out;
+}
+
+/**
+ * @brief Suscripciones evaluadas en el host
+ *
+ * SET_SUBSCRIPTIONS con dos filtros: SUBSCRIPTION_KIND_ALL entero y
+ * SUBSCRIPTION_KIND_WHERE solo con "frame": 0. Chrome reparte los mensajes
+ * entre ALL, WHERE (frame 0 y 1 alternados) y NOISE, sin suscripción. Un
+ * ALL con "last" al final marca que ya pasó todo (el orden se conserva). Al
+ * terminar se desactivan las suscripciones. Un host sin suscripciones no
+ * contesta SUBSCRIPTIONS_ACK y reenvía todo.
+ */
+json run_subscriptions(const Options& opt, ChromeEmulator& chrome, MockBrain& brain, int conn, std::ostream& info) {
+    struct State {
+        std::mutex              mutex;
+        std::condition_variable cv;
+        std::map<std::string, size_t> received;
+        uint64_t                wire_bytes = 0;
+        bool                    acked      = false;
+        bool                    last       = false;
+        uint64_t                last_ns    = 0;
+        json                    stats;
+    };
+    auto st = std::make_shared<State>();
+    brain.set_frame_handler([st](int, const std::string& frame, uint64_t recv_ns) {
+        std::string type = extract_string_field(frame, "type");
+        std::lock_guard<std::mutex> lock(st->mutex);
+        if (type == "SUBSCRIPTIONS_ACK") {
+            st->acked = frame.find("\"ok\":true") != std::string::npos;
+        } else if (type == "STATS_RESPONSE") {
+            if (extract_string_field(frame, "request_id") != "bench-subscription-stats") return;
+            st->stats = json::parse(frame, nullptr, false);
+        } else {
+            std::string event = extract_string_field(frame, "event");
+            if (event.compare(0, 10, "BENCH_SUB_") != 0) return;
+            st->received[event]++;
+            st->wire_bytes += frame.size();
+            if (frame.find("\"last\":true") != std::string::npos) {
+                st->last = true;
+                st->last_ns = recv_ns;
+            }
+        }
+        st->cv.notify_all();
+    });
+
+    json set = {
+        {"type",    "SET_SUBSCRIPTIONS"},
+        {"filters", json::array({
+            {{"id", "all"},   {"kinds", json::array({SUBSCRIPTION_KIND_ALL})}},
+            {{"id", "where"}, {"kinds", json::array({SUBSCRIPTION_KIND_WHERE})},
+             {"where", json::array({{{"field", "frame"}, {"op", "eq"}, {"value", 0}}})}}
+        })}
+    };
+    brain.send(conn, set.dump());
+    {
+        std::unique_lock<std::mutex> lock(st->mutex);
+        st->cv.wait_for(lock, std::chrono::milliseconds(2000), [&] { return st->acked; });
+    }
+
+    const char* kinds[] = {SUBSCRIPTION_KIND_ALL, SUBSCRIPTION_KIND_WHERE, SUBSCRIPTION_KIND_NOISE,
+                           SUBSCRIPTION_KIND_NOISE};
+    json msg = {{"payload", {{"blob", std::string(SUBSCRIPTION_BLOB_BYTES, 's')}}}};
+    std::map<std::string, size_t> sent;
+    size_t expected = 1;                                // el "last"
+    uint64_t start = now_ns();
+    for (size_t i = 0; i < opt.subscription_messages; ++i) {
+        const char* kind = kinds[i % 4];
+        msg["event"] = kind;
+        msg["seq"] = i;
+        msg["frame"] = (i / 4) % 2;
+        if (!chrome.send(msg.dump())) break;
+        sent[kind]++;
+        if (kind == SUBSCRIPTION_KIND_ALL || (kind == SUBSCRIPTION_KIND_WHERE && msg["frame"] == 0)) expected++;
+    }
+    msg["event"] = SUBSCRIPTION_KIND_ALL;
+    msg["last"] = true;
+    chrome.send(msg.dump());
+    sent[SUBSCRIPTION_KIND_ALL]++;
+
+    json host_subscriptions = nullptr;
+    double elapsed_ms = -1;
+    {
+        std::unique_lock<std::mutex> lock(st->mutex);
+        st->cv.wait_for(lock, std::chrono::milliseconds(10000), [&] { return st->last; });
+        if (st->last) elapsed_ms = (st->last_ns - start) / 1e6;
+    }
+    brain.send(conn, json({{"type", "REQUEST_STATS"}, {"request_id", "bench-subscription-stats"}}).dump());
+    {
+        std::unique_lock<std::mutex> lock(st->mutex);
+        st->cv.wait_for(lock, std::chrono::milliseconds(2000), [&] { return !st->stats.is_null(); });
+        if (st->stats.is_object() && st->stats["stats"].contains("subscriptions")) {
+            host_subscriptions = st->stats["stats"]["subscriptions"];
+        }
+    }
+    brain.send(conn, json({{"type", "SET_SUBSCRIPTIONS"}, {"filters", nullptr}}).dump());
+
+    brain.set_frame_handler([](int, const std::string& frame, uint64_t recv_ns) {
+        on_delivery(frame, "event", recv_ns);
+    });
+
+    std::lock_guard<std::mutex> lock(st->mutex);
+    json kinds_out = json::object();
+    for (const auto& kv : sent) {
+        kinds_out[kv.first] = {{"sent", kv.second}, {"received", st->received[kv.first]}};
+    }
+    json out = {
+        {"acked",      st->acked},
+        {"expected",   expected},
+        {"kinds",      kinds_out},
+        {"wire_bytes", st->wire_bytes},
+        {"elapsed_ms", elapsed_ms}
+    };
+    if (host_subscriptions.is_object()) {
+        json hits = json::object();
+        for (const auto& f : host_subscriptions["filters"]) hits[f.value("id", "")] = f["hits"];
+        out["host_hits"] = hits;
+        out["host_dropped"] = host_subscriptions["dropped"];
+    }
+    info << "  subscriptions done\n";
+    return out;
+}
+
+/**
+ * @brief Host "ruidoso" con admission control por defecto contra el mismo mock Brain
+ *
+ * Reemplaza temporalmente el frame handler del mock para contar por kind lo
+ * que llega de ese host; el flood es lo más rápido que acepta el pipe de stdin.
+ */
+json run_admission(const Options& opt, MockBrain& brain, const std::string& base_dir, std::ostream& info) {
+    struct Counters {
+        const char* kinds[3]   = {"TELEMETRY_BENCH", "BENCH_FLOOD", "HEARTBEAT"};
+        const char* classes[3] = {"low", "normal", "control"};
+        size_t      sent[3]    = {0, 0, 0};
+        std::atomic<size_t>   delivered[3] = {{0}, {0}, {0}};
+        std::atomic<size_t>   reports{0};
+        std::atomic<uint64_t> reported_drops{0};
+    };
+    // shared_ptr: el reader del mock puede estar dentro de una copia del handler
+    auto c = std::make_shared<Counters>();
+
+    std::vector<std::string> args = host_args(NOISY_PROFILE_ID, NOISY_LAUNCH_ID, base_dir, opt.port);
+    auto off = std::find(args.begin(), args.end(), "--rate-limits");
+    if (off != args.end()) *(off + 1) = "on";   // límites de Admission::Config
+
+    HostProcess noisy;
+    if (!noisy.spawn(opt.host_binary, args, "/dev/null")) {
+        info << "  admission skipped (spawn failed)\n";
+        return nullptr;
+    }
+    brain.set_frame_handler([c](int, const std::string& frame, uint64_t) {
+        if (extract_string_field(frame, "type") == "ADMISSION_DROPS") {
+            c->reports++;
+            c->reported_drops += static_cast<uint64_t>(std::max<int64_t>(0, extract_int_field(frame, "dropped")));
+            return;
+        }
+        std::string kind = extract_string_field(frame, "event");
+        for (int i = 0; i < 3; ++i) {
+            if (kind == c->kinds[i]) c->delivered[i]++;
+        }
+    });
+
+    ChromeEmulator chrome(noisy, NOISY_PROFILE_ID, NOISY_LAUNCH_ID);
+    chrome.start([](const std::string&, uint64_t) {});
+    bool ready = chrome.handshake(10000);
+
+    uint64_t start = now_ns();
+    uint64_t end = start + static_cast<uint64_t>(opt.admission_ms) * 1000000ULL;
+    uint64_t next_control = start;
+    for (size_t seq = 0; ready && now_ns() < end; ++seq) {
+        // Control cada 10 ms; entre medio, low y normal alternados
+        int i = static_cast<int>(seq % 2);
+        if (now_ns() >= next_control) {
+            i = 2;
+            next_control += 10000000ULL;
+        }
+        if (!chrome.send(make_message("event", c->kinds[i], seq, 256))) break;
+        c->sent[i]++;
+    }
+    double elapsed_s = (now_ns() - start) / 1e9;
+    if (ready) std::this_thread::sleep_for(std::chrono::milliseconds(1500));   // colas y reporte final
+
+    noisy.shutdown(5000);
+    chrome.join();
+    brain.set_frame_handler([](int, const std::string& frame, uint64_t recv_ns) {
+        on_delivery(frame, "event", recv_ns);
+    });
+    if (!ready) {
+        info << "  admission skipped (handshake failed)\n";
+        return nullptr;
+    }
+
+    json out = {
+        {"flood_ms",       opt.admission_ms},
+        {"reports",        c->reports.load()},
+        {"reported_drops", c->reported_drops.load()}
+    };
+    for (int i = 0; i < 3; ++i) {
+        out["classes"][c->classes[i]] = {
+            {"kind",            c->kinds[i]},
+            {"sent",            c->sent[i]},
+            {"delivered",       c->delivered[i].load()},
+            {"delivered_per_s", c->delivered[i].load() / elapsed_s}
+        };
+    }
+    info << "  admission done\n";
+    return out;
+}
+
+/**
+ * @brief Host con --dedup: cuántas copias repetidas cruzan en cada dirección
+ *
+ * Chrome manda TAB_STATE que rotan entre DEDUP_DISTINCT estados (cada copia
+ * con su timestamp) y Brain comandos DEDUP_BENCH que rotan igual, en ráfaga.
+ * Con la ventana de DEDUP_WINDOW_MS debería pasar cada estado una vez por
+ * ventana; un host sin dedup (o que ignore el flag) los pasa todos.
+ */
+json run_dedup(const Options& opt, MockBrain& brain, const std::string& base_dir, std::ostream& info) {
+    struct Counters {
+        std::atomic<size_t>   to_brain{0};
+        std::atomic<size_t>   to_chrome{0};
+        std::atomic<uint64_t> to_brain_bytes{0};
+    };
+    auto c = std::make_shared<Counters>();
+
+    std::vector<std::string> args = host_args(DEDUP_PROFILE_ID, DEDUP_LAUNCH_ID, base_dir, opt.port);
+    args.push_back("--dedup");
+    args.push_back(DEDUP_SPEC);
+
+    HostProcess deduped;
+    if (!deduped.spawn(opt.host_binary, args, "/dev/null")) {
+        info << "  dedup skipped (spawn failed)\n";
+        return nullptr;
+    }
+    brain.set_frame_handler([c](int, const std::string& frame, uint64_t) {
+        if (extract_string_field(frame, "type") != "TAB_STATE") return;
+        c->to_brain++;
+        c->to_brain_bytes += frame.size();
+    });
+
+    ChromeEmulator chrome(deduped, DEDUP_PROFILE_ID, DEDUP_LAUNCH_ID);
+    chrome.start([c](const std::string& frame, uint64_t) {
+        if (extract_string_field(frame, "command") == "DEDUP_BENCH") c->to_chrome++;
+    });
+    bool ready = chrome.handshake(10000);
+    // PROFILE_CONNECTED puede llegar a Brain después del host_ready a Chrome
+    int conn = -1;
+    for (int i = 0; ready && conn < 0 && i < 100; ++i) {
+        conn = brain.connection_for_launch(DEDUP_LAUNCH_ID);
+        if (conn < 0) std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    }
+
+    const std::string pad(512, 'd');
+    uint64_t start = now_ns();
+    size_t sent = 0;
+    for (; ready && conn >= 0 && sent < opt.dedup_messages; ++sent) {
+        size_t state = sent % DEDUP_DISTINCT;
+        json tab = {
+            {"type",      "TAB_STATE"},
+            {"tab_id",    state},
+            {"url",       "https://bench.invalid/" + std::to_string(state) + "/" + pad},
+            {"timestamp", std::chrono::duration_cast<std::chrono::milliseconds>(
+                              std::chrono::system_clock::now().time_since_epoch()).count()}
+        };
+        json cmd = {
+            {"command", "DEDUP_BENCH"},
+            {"payload", {{"state", state}}}
+        };
+        if (!chrome.send(tab.dump()) || !brain.send(conn, cmd.dump())) break;
+    }
+    double elapsed_s = (now_ns() - start) / 1e9;
+    if (ready) std::this_thread::sleep_for(std::chrono::milliseconds(1000));
+
+    deduped.shutdown(5000);
+    chrome.join();
+    brain.set_frame_handler([](int, const std::string& frame, uint64_t recv_ns) {
+        on_delivery(frame, "event", recv_ns);
+    });
+    if (!ready || conn < 0) {
+        info << "  dedup skipped (handshake failed)\n";
+        return nullptr;
+    }
+
+    // Cota de lo que debería pasar: cada estado una vez por ventana empezada
+    size_t windows = static_cast<size_t>(elapsed_s * 1000 / DEDUP_WINDOW_MS) + 1;
+    info << "  dedup done\n";
+    return {
+        {"spec",              DEDUP_SPEC},
+        {"sent_per_link",     sent},
+        {"distinct",          DEDUP_DISTINCT},
+        {"send_s",            elapsed_s},
+        {"expected_max",      windows * DEDUP_DISTINCT},
+        {"to_brain",          c->to_brain.load()},
+        {"to_brain_bytes",    c->to_brain_bytes.load()},
+        {"to_chrome",         c->to_chrome.load()}
+    };
+}
+
+/**
+ * @brief Host con --delta: bytes en el link Chrome → Brain para estado repetitivo
+ *
+ * Cada TAB_STATE trae DELTA_NODES nodos y cambia uno solo respecto del
+ * anterior de su tab. El mock Brain rearma snapshots y STATE_DELTA como lo
+ * haría Brain y cuenta cuántos coinciden exactamente con lo que mandó Chrome.
+ * Un host sin delta encoding manda todo completo (wire_bytes = full_bytes).
+ */
+json run_delta(const Options& opt, MockBrain& brain, const std::string& base_dir, std::ostream& info) {
+    struct State {
+        std::mutex              mutex;
+        std::condition_variable cv;
+        std::vector<json>       expected;
+        size_t                  received   = 0;
+        size_t                  exact      = 0;
+        size_t                  snapshots  = 0;
+        size_t                  deltas     = 0;
+        size_t                  unapplied  = 0;
+        uint64_t                wire_bytes = 0;
+        std::map<std::string, std::pair<uint64_t, json>> docs;
+        json                    stats;
+    };
+    auto st = std::make_shared<State>();
+
+    std::vector<std::string> args = host_args(DELTA_PROFILE_ID, DELTA_LAUNCH_ID, base_dir, opt.port);
+    args.push_back("--delta");
+    args.push_back("TAB_STATE:tab_id");
+
+    HostProcess encoder;
+    if (!encoder.spawn(opt.host_binary, args, "/dev/null")) {
+        info << "  delta skipped (spawn failed)\n";
+        return nullptr;
+    }
+    brain.set_frame_handler([st](int, const std::string& frame, uint64_t) {
+        std::string type = extract_string_field(frame, "type");
+        std::lock_guard<std::mutex> lock(st->mutex);
+        if (type == "STATS_RESPONSE") {
+            if (extract_string_field(frame, "request_id") == "bench-delta-stats") {
+                st->stats = json::parse(frame, nullptr, false);
+                st->cv.notify_all();
+            }
+            return;
+        }
+        if (type != "TAB_STATE" && type != "STATE_DELTA") return;
+
+        json msg = json::parse(frame, nullptr, false);
+        if (msg.is_discarded()) return;
+        st->wire_bytes += frame.size();
+        if (msg.contains("_delta")) {
+            json meta = msg["_delta"];
+            std::string key = meta.value("key", "");
+            msg.erase("_delta");
+            if (type == "STATE_DELTA") {
+                auto base = st->docs.find(key);
+                if (base == st->docs.end() || base->second.first != meta.value("base", uint64_t{0})) {
+                    st->unapplied++;
+                    msg = nullptr;
+                } else {
+                    json patch = msg["patch"];
+                    const json& doc = base->second.second;
+                    try {
+                        if (meta.value("format", "") == "merge-patch") {
+                            msg = doc;
+                            msg.merge_patch(patch);
+                        } else {
+                            msg = doc.patch(patch);
+                        }
+                        st->deltas++;
+                    } catch (const json::exception&) {
+                        st->unapplied++;
+                        msg = nullptr;
+                    }
+                }
+            } else {
+                st->snapshots++;
+            }
+            if (!msg.is_null()) st->docs[key] = {meta.value("seq", uint64_t{0}), msg};
+        }
+        if (st->received < st->expected.size() && msg == st->expected[st->received]) st->exact++;
+        st->received++;
+        st->cv.notify_all();
+    });
+
+    ChromeEmulator chrome(encoder, DELTA_PROFILE_ID, DELTA_LAUNCH_ID);
+    chrome.start([](const std::string&, uint64_t) {});
+    bool ready = chrome.handshake(10000);
+    int conn = -1;
+    for (int i = 0; ready && conn < 0 && i < 100; ++i) {
+        conn = brain.connection_for_launch(DELTA_LAUNCH_ID);
+        if (conn < 0) std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    }
+
+    std::vector<json> tabs(DELTA_TABS);
+    for (size_t t = 0; t < DELTA_TABS; ++t) {
+        json nodes = json::array();
+        for (size_t n = 0; n < DELTA_NODES; ++n) {
+            nodes.push_back({{"id", n}, {"tag", "div"}, {"text", "node " + std::to_string(n) + std::string(40, 'n')}});
+        }
+        tabs[t] = {{"type", "TAB_STATE"}, {"tab_id", t}, {"url", "https://bench.invalid/" + std::to_string(t)},
+                   {"dom", {{"nodes", nodes}, {"scroll", 0}}}};
+    }
+
+    uint64_t full_bytes = 0;
+    size_t sent = 0;
+    for (; ready && conn >= 0 && sent < opt.delta_messages; ++sent) {
+        json& tab = tabs[sent % DELTA_TABS];
+        tab["dom"]["nodes"][(sent * 7) % DELTA_NODES]["text"] = "changed " + std::to_string(sent);
+        tab["dom"]["scroll"] = sent;
+        tab["timestamp"] = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+        std::string payload = tab.dump();
+        full_bytes += payload.size();
+        {
+            std::lock_guard<std::mutex> lock(st->mutex);
+            st->expected.push_back(tab);
+        }
+        if (!chrome.send(payload)) break;
+    }
+
+    json host_delta = nullptr;
+    if (ready && conn >= 0) {
+        std::unique_lock<std::mutex> lock(st->mutex);
+        st->cv.wait_for(lock, std::chrono::milliseconds(5000), [&] { return st->received >= sent; });
+        lock.unlock();
+        brain.send(conn, json({{"type", "REQUEST_STATS"}, {"request_id", "bench-delta-stats"}}).dump());
+        lock.lock();
+        st->cv.wait_for(lock, std::chrono::milliseconds(2000), [&] { return !st->stats.is_null(); });
+        if (st->stats.is_object() && st->stats["stats"].contains("delta")) host_delta = st->stats["stats"]["delta"];
+    }
+
+    encoder.shutdown(5000);
+    chrome.join();
+    brain.set_frame_handler([](int, const std::string& frame, uint64_t recv_ns) {
+        on_delivery(frame, "event", recv_ns);
+    });
+    if (!ready || conn < 0) {
+        info << "  delta skipped (handshake failed)\n";
+        return nullptr;
+    }
+
+    std::lock_guard<std::mutex> lock(st->mutex);
+    json out = {
+        {"format",     DELTA_FORMAT},
+        {"sent",       sent},
+        {"received",   st->received},
+        {"exact",      st->exact},
+        {"snapshots",  st->snapshots},
+        {"deltas",     st->deltas},
+        {"unapplied",  st->unapplied},
+        {"full_bytes", full_bytes},
+        {"wire_bytes", st->wire_bytes}
+    };
+    if (host_delta.is_object()) {
+        out["host_encode_us_avg"] = host_delta["encode_us_avg"];
+        out["host_encode_us_max"] = host_delta["encode_us_max"];
+        out["host_fallbacks"] = host_delta["fallbacks"];
+    }
+    info << "  delta done\n";
+    return out;
+}
+
+/**
+ * @brief Frames grandes que el host reenvía sin mirar: splice contra copia
+ *
+ * Un host por modo (mismo binario, --splice on / off) contra el
+ * mismo mock Brain. Por tamaño, Chrome manda passthrough_count frames
+ * {"event", "payload": {"blob"}, "seq"} (claves en el orden en que nlohmann
+ * las serializa, así los dos caminos entregan los mismos bytes) y se mide
+ * desde el primer envío hasta el último recibido, más el CPU del host.
+ */
+json run_passthrough(const Options& opt, MockBrain& brain, const std::string& base_dir, std::ostream& info) {
+    struct State {
+        std::mutex              mutex;
+        std::condition_variable cv;
+        std::string             head;         // todo lo anterior a "seq"
+        size_t                  size     = 0;
+        size_t                  received = 0;
+        size_t                  intact   = 0;
+        uint64_t                last_ns  = 0;
+        json                    stats;
+    };
+
+    json out = json::object();
+    for (const char* mode : {"splice", "copy"}) {
+        auto st = std::make_shared<State>();
+        const std::string launch_id = std::string(mode == std::string("splice") ? "005" : "006") + "_passthrough";
+        std::vector<std::string> args = host_args(PASSTHROUGH_PROFILE_ID, launch_id, base_dir, opt.port);
+        args.push_back("--splice");
+        args.push_back(mode == std::string("splice") ? "on" : "off");
+        args.push_back("--validate-frames");   // splice lo exige; los dos modos igual
+        args.push_back("off");
+
+        HostProcess host;
+        if (!host.spawn(opt.host_binary, args, "/dev/null")) {
+            info << "  passthrough skipped (spawn failed)\n";
+            return nullptr;
+        }
+        brain.set_frame_handler([st](int, const std::string& frame, uint64_t recv_ns) {
+            std::lock_guard<std::mutex> lock(st->mutex);
+            if (frame.compare(0, 10, "{\"event\":\"") == 0 &&
+                frame.compare(10, std::strlen(PASSTHROUGH_KIND), PASSTHROUGH_KIND) == 0) {
+                st->received++;
+                st->last_ns = recv_ns;
+                if (frame.size() == st->size && frame.compare(0, st->head.size(), st->head) == 0) st->intact++;
+            } else if (extract_string_field(frame, "type") == "STATS_RESPONSE" &&
+                       extract_string_field(frame, "request_id") == "bench-passthrough-stats") {
+                st->stats = json::parse(frame, nullptr, false);
+            } else {
+                return;
+            }
+            st->cv.notify_all();
+        });
+
+        ChromeEmulator chrome(host, PASSTHROUGH_PROFILE_ID, launch_id);
+        chrome.start([](const std::string&, uint64_t) {});
+        bool ready = chrome.handshake(10000);
+        int conn = -1;
+        for (int i = 0; ready && conn < 0 && i < 100; ++i) {
+            conn = brain.connection_for_launch(launch_id);
+            if (conn < 0) std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        }
+
+        json sizes = json::object();
+        for (size_t size : opt.passthrough_sizes) {
+            if (!ready || conn < 0) break;
+            const std::string head = std::string("{\"event\":\"") + PASSTHROUGH_KIND + "\",\"payload\":{\"blob\":\"";
+            const std::string tail_fmt = "\"},\"seq\":";
+            const size_t overhead = head.size() + tail_fmt.size() + 6 + 1;   // seq de 6 dígitos (100000..) y '}'
+            if (size <= overhead) continue;
+            const std::string body = head + std::string(size - overhead, 'p') + tail_fmt;
+            {
+                std::lock_guard<std::mutex> lock(st->mutex);
+                st->head = body;
+                st->size = size;
+                st->received = 0;
+                st->intact = 0;
+            }
+
+            ProcSample before = sample_process(host.pid());
+            uint64_t start = now_ns();
+            size_t sent = 0;
+            char seq[8];
+            for (; sent < opt.passthrough_count; ++sent) {
+                std::snprintf(seq, sizeof(seq), "%zu", 100000 + sent % 900000);
+                if (!chrome.send(body + seq + "}")) break;
+            }
+            double elapsed_ms = -1;
+            {
+                std::unique_lock<std::mutex> lock(st->mutex);
+                st->cv.wait_for(lock, std::chrono::milliseconds(60000), [&] { return st->received >= sent; });
+                if (st->received >= sent && sent > 0) elapsed_ms = (st->last_ns - start) / 1e6;
+            }
+            ProcSample after = sample_process(host.pid());
+
+            std::lock_guard<std::mutex> lock(st->mutex);
+            sizes[std::to_string(size)] = {
+                {"sent",        sent},
+                {"received",    st->received},
+                {"intact",      st->intact},
+                {"elapsed_ms",  elapsed_ms},
+                {"mb_per_s",    elapsed_ms > 0 ? sent * size / (elapsed_ms / 1000.0) / 1e6 : 0.0},
+                {"host_cpu_ms", after.ok && before.ok ? (after.cpu_ns - before.cpu_ns) / 1e6 : -1.0}
+            };
+        }
+
+        json host_splice = nullptr;
+        if (ready && conn >= 0) {
+            brain.send(conn, json({{"type", "REQUEST_STATS"}, {"request_id", "bench-passthrough-stats"}}).dump());
+            std::unique_lock<std::mutex> lock(st->mutex);
+            st->cv.wait_for(lock, std::chrono::milliseconds(2000), [&] { return !st->stats.is_null(); });
+            if (st->stats.is_object() && st->stats["stats"].contains("splice")) host_splice = st->stats["stats"]["splice"];
+        }
+
+        host.shutdown(5000);
+        chrome.join();
+        brain.set_frame_handler([](int, const std::string& frame, uint64_t recv_ns) {
+            on_delivery(frame, "event", recv_ns);
+        });
+        if (!ready || conn < 0) {
+            info << "  passthrough skipped (handshake failed)\n";
+            return nullptr;
+        }
+
+        out[mode] = {{"sizes", sizes}};
+        if (host_splice.is_object()) {
+            out[mode]["host_spliced_frames"] = host_splice["frames"];
+            out[mode]["host_splice_calls"] = host_splice["splice_calls"];
+        }
+    }
+    info << "  passthrough done\n";
+    return out;
+}
+
+}  // namespace
+
+// ============================================================================
+// MAIN
+// ============================================================================
+
+int main(int argc, char* argv[]) {
+    Options opt;
+    if (!parse_options(argc, argv, opt)) {
+        print_usage();
+        return 2;
+    }
+
+    std::ostream& info = opt.json_only ? std::cerr : std::cout;
+
+    std::string base_dir = make_temp_dir("bloom-host-bench-");
+    if (base_dir.empty()) {
+        std::cerr << "✗ mkdtemp failed\n";
+        return 1;
+    }
+
+    MockBrain brain(opt.port);
+    brain.set_flow_control(opt.flow_window, 256);
+    brain.set_delta_format(DELTA_FORMAT);
+    if (!brain.start()) {
+        std::cerr << "✗ Cannot listen on 127.0.0.1:" << opt.port << "\n";
+        return 1;
+    }
+
+    HostProcess host;
+    std::vector<std::string> args = host_args(BENCH_PROFILE_ID, BENCH_LAUNCH_ID, base_dir, opt.port);
+    if (opt.dead_ms > 0) {
+        args.push_back("--brain-dead-ms");
+        args.push_back(std::to_string(opt.dead_ms));
+    }
+    args.push_back("--request-timeout-ms");
+    args.push_back(std::to_string(opt.request_timeout_ms));
+    if (!host.spawn(opt.host_binary, args, "/dev/null")) {
+        std::cerr << "✗ Cannot spawn " << opt.host_binary << "\n";
+        return 1;
+    }
+
+    ChromeEmulator chrome(host, BENCH_PROFILE_ID, BENCH_LAUNCH_ID);
+    chrome.start([](const std::string& frame, uint64_t recv_ns) {
+        on_delivery(frame, "type", recv_ns);
+        if (int us = g_slow_reader_us.load()) std::this_thread::sleep_for(std::chrono::microseconds(us));
+        if (ChromeEmulator* responder = g_request_responder.load()) answer_request(*responder, frame);
+    });
+    brain.set_frame_handler([](int, const std::string& frame, uint64_t recv_ns) {
+        on_delivery(frame, "event", recv_ns);
+    });
+
+    if (!chrome.handshake(10000) || !brain.wait_for_profiles(1, 10000)) {
+        std::cerr << "✗ Handshake did not complete (host_ready / PROFILE_CONNECTED)\n";
+        host.shutdown(2000);
+        brain.stop();
+        return 1;
+    }
+    int conn = brain.profile_connections().front();
+    info << "✓ Host connected (pid " << host.pid() << ", base dir " << base_dir << ")\n";
+
+    json results = json::array();
+    uint64_t chunk_msg_id = 0;
+
+    // ------------------------------------------------------------------------
+    // chrome_to_brain
+    // ------------------------------------------------------------------------
+    for (size_t size : opt.sizes) {
+        std::string tag = "BENCH_C2B_" + std::to_string(size);
+        auto send_one = [&](size_t seq) {
+            return chrome.send(make_message("event", tag, seq, size));
+        };
+        run_windowed("warmup", tag, size, opt.warmup, opt.window, send_one);
+        Result r = run_windowed("chrome_to_brain", tag, size, opt.count, opt.window, send_one);
+        results.push_back(result_json(r));
+        info << "  chrome_to_brain " << size << " B done\n";
+    }
+
+    // ------------------------------------------------------------------------
+    // brain_to_chrome
+    // ------------------------------------------------------------------------
+    for (size_t size : opt.sizes) {
+        if (size > BRAIN_TO_CHROME_MAX) {
+            info << "  brain_to_chrome " << size << " B skipped (> MAX_CHROME_MSG_SIZE)\n";
+            continue;
+        }
+        std::string tag = "BENCH_B2C_" + std::to_string(size);
+        auto send_one = [&](size_t seq) {
+            return brain.send(conn, make_message("type", tag, seq, size));
+        };
+        run_windowed("warmup", tag, size, opt.warmup, opt.window, send_one);
+        Result r = run_windowed("brain_to_chrome", tag, size, opt.count, opt.window, send_one);
+        results.push_back(result_json(r));
+        info << "  brain_to_chrome " << size << " B done\n";
+    }
+
+    // ------------------------------------------------------------------------
+    // chunked_upload: latencia desde el header hasta la entrega del ensamblado
+    // ------------------------------------------------------------------------
+    for (size_t size : opt.chunked) {
+        std::string tag = "BENCH_CHUNK_" + std::to_string(size);
+        size_t count = std::max<size_t>(1, opt.count / 20);
+        auto send_one = [&](size_t seq) {
+            return chrome.send_chunked(make_message("event", tag, seq, size),
+                                       "bench-" + std::to_string(++chunk_msg_id), opt.chunk_bytes);
+        };
+        Result r = run_windowed("chunked_upload", tag, size, count, std::min<size_t>(opt.window, 4), send_one);
+        results.push_back(result_json(r));
+        info << "  chunked_upload " << size << " B done\n";
+    }
+
+    // ------------------------------------------------------------------------
+    // ping_rtt
+    // ------------------------------------------------------------------------
+    // Cada PING espera su PONG hasta max_wait_ms (un PONG tardío se atribuiría
+    // al PING siguiente); corta al llegar a deadline_ns si no es 0
+    auto run_pings_until = [&](int max_wait_ms, uint64_t deadline_ns) {
+        for (size_t i = 0; i < opt.pings && (deadline_ns == 0 || now_ns() < deadline_ns); ++i) {
+            size_t before = brain.ping_rtts().count();
+            brain.ping(conn);
+            for (int spin = 0; spin < max_wait_ms * 5 && brain.ping_rtts().count() == before; ++spin) {
+                std::this_thread::sleep_for(std::chrono::microseconds(200));
+            }
+        }
+    };
+    auto run_pings = [&]() { run_pings_until(1000, 0); };
+    run_pings();
+    LatencyRecorder rtt = brain.ping_rtts();
+
+    // ------------------------------------------------------------------------
+    // ping_under_load: frames bulk chrome→brain sin ventana mientras se mide
+    // PING/PONG (PONG compite con BULK en el sink de Brain)
+    // ------------------------------------------------------------------------
+    LatencyRecorder loaded_rtt;
+    LatencyRecorder b2c_loaded_rtt;
+    LatencyRecorder keepalive_gaps;
+    std::atomic<size_t> load_frames{0};
+    auto flood = [&](const std::function<bool(size_t seq)>& send_one, const std::function<void()>& measure) {
+        std::atomic<bool> loading{true};
+        std::thread loader([&] {
+            for (size_t seq = 0; loading.load(); ++seq) {
+                if (!send_one(seq)) break;
+                load_frames++;
+            }
+        });
+        std::this_thread::sleep_for(std::chrono::milliseconds(200));   // colas llenas antes de medir
+        measure();
+        loading.store(false);
+        loader.join();
+    };
+    if (opt.load_size > 0) {
+        brain.clear_ping_rtts();
+        flood([&](size_t seq) { return chrome.send(make_message("event", "BENCH_LOAD", seq, opt.load_size)); },
+              run_pings);
+        loaded_rtt = brain.ping_rtts();
+
+        // keepalive_gap_under_load: brain→chrome sin ventana contra un Chrome
+        // lento (2 ms por frame); el keepalive compite con BULK en stdout y el
+        // PING con BULK en el socket (sin créditos queda detrás de lo que el
+        // host no pudo encolar hacia Chrome)
+        size_t b2c_size = std::min(opt.load_size, BRAIN_TO_CHROME_MAX - 1024);
+        g_slow_reader_us.store(2000);
+        chrome.clear_keepalive_gaps();
+        brain.clear_ping_rtts();
+        flood([&](size_t seq) { return brain.send(conn, make_message("type", "BENCH_LOAD", seq, b2c_size)); },
+              [&] {
+                  uint64_t deadline = now_ns() + 13000000000ULL;
+                  run_pings_until(10000, deadline);
+                  while (now_ns() < deadline) std::this_thread::sleep_for(std::chrono::milliseconds(50));
+              });
+        keepalive_gaps = chrome.keepalive_gaps();
+        b2c_loaded_rtt = brain.ping_rtts();
+        g_slow_reader_us.store(0);
+        info << "  ping_under_load " << opt.load_size << " B done (" << load_frames.load() << " bulk frames)\n";
+    }
+
+    // ------------------------------------------------------------------------
+    // dead_peer: Brain colgado con el socket abierto. Sin detección el host
+    // queda bloqueado en recv() para siempre (failover_ms = -1)
+    // ------------------------------------------------------------------------
+    json extension_logs = nullptr;
+    if (opt.log_entries > 0) extension_logs = run_extension_logs(opt, chrome, brain, base_dir, info);
+
+    json requests = nullptr;
+    if (opt.requests > 0) requests = run_requests(opt, chrome, brain, conn, info);
+
+    json projection = nullptr;
+    if (opt.projection_messages > 0) projection = run_projection(opt, chrome, brain, conn, info);
+
+    json subscriptions = nullptr;
+    if (opt.subscription_messages > 0) subscriptions = run_subscriptions(opt, chrome, brain, conn, info);
+
+    json admission = nullptr;
+    if (opt.admission_ms > 0) admission = run_admission(opt, brain, base_dir, info);
+
+    json dedup = nullptr;
+    if (opt.dedup_messages > 0) dedup = run_dedup(opt, brain, base_dir, info);
+
+    json delta = nullptr;
+    if (opt.delta_messages > 0) delta = run_delta(opt, brain, base_dir, info);
+
+    json passthrough = nullptr;
+    if (!opt.passthrough_sizes.empty()) passthrough = run_passthrough(opt, brain, base_dir, info);
+
+    json dead_peer = nullptr;
+    if (opt.dead_ms > 0) {
+        size_t regs = brain.registrations();
+        uint64_t frozen_ns = now_ns();
+        brain.freeze_connections();
+        bool back = brain.wait_for_registrations(regs + 1, opt.dead_ms * 3 + 5000);
+        double failover_ms = back ? (brain.registration_times().back() - frozen_ns) / 1e6 : -1;
+        dead_peer = {
+            {"dead_ms",     opt.dead_ms},
+            {"reconnected", back},
+            {"failover_ms", failover_ms}
+        };
+        info << "  dead_peer done (" << (back ? "re-registered" : "no reconnect") << ")\n";
+    }
+
+    host.shutdown(15000);
+    chrome.join();
+    brain.stop();
+
+    if (!opt.keep_logs) {
+        std::error_code ec;
+        std::filesystem::remove_all(base_dir, ec);
+    }
+
+    json report = {
+        {"bench",       "bloom-host-bench"},
+        {"host_binary", opt.host_binary},
+        {"count",       opt.count},
+        {"window",      opt.window},
+        {"chunk_bytes", opt.chunk_bytes},
+        {"results",     results},
+        {"ping_rtt_us", {
+            {"samples", rtt.count()},
+            {"p50",     rtt.percentile_us(50)},
+            {"p99",     rtt.percentile_us(99)},
+            {"p999",    rtt.percentile_us(99.9)}
+        }},
+        {"ping_under_load_us", {
+            {"load_size",   opt.load_size},
+            {"load_frames", load_frames.load()},
+            {"samples",     loaded_rtt.count()},
+            {"p50",         loaded_rtt.percentile_us(50)},
+            {"p99",         loaded_rtt.percentile_us(99)},
+            {"p999",        loaded_rtt.percentile_us(99.9)}
+        }},
+        {"ping_under_b2c_load_us", {
+            {"flow_window", opt.flow_window},
+            {"samples",     b2c_loaded_rtt.count()},
+            {"p50",         b2c_loaded_rtt.percentile_us(50)},
+            {"p99",         b2c_loaded_rtt.percentile_us(99)},
+            {"credit_stalls",   brain.credit_stalls()},
+            {"credit_stall_ms", brain.credit_stall_ns() / 1e6}
+        }},
+        {"keepalive_gap_under_load_ms", {
+            {"samples", keepalive_gaps.count()},
+            {"p50",     keepalive_gaps.percentile_us(50) / 1000.0},
+            {"max",     keepalive_gaps.percentile_us(100) / 1000.0}
+        }},
+        {"extension_logs", extension_logs},
+        {"requests", requests},
+        {"projection", projection},
+        {"subscriptions", subscriptions},
+        {"admission", admission},
+        {"dedup", dedup},
+        {"delta", delta},
+        {"passthrough", passthrough},
+        {"dead_peer", dead_peer}
+    };
+
+    if (opt.json_only) {
+        std::cout << report.dump(2) << std::endl;
+    } else {
+        std::cout << "\n";
+        print_table(results);
+        std::printf("\nping_rtt: samples=%zu p50=%.1fus p99=%.1fus p999=%.1fus\n",
+                    rtt.count(), rtt.percentile_us(50), rtt.percentile_us(99), rtt.percentile_us(99.9));
+        if (opt.load_size > 0) {
+            std::printf("ping_under_load (%zu B bulk): samples=%zu p50=%.1fus p99=%.1fus p999=%.1fus\n",
+                        opt.load_size, loaded_rtt.count(), loaded_rtt.percentile_us(50),
+                        loaded_rtt.percentile_us(99), loaded_rtt.percentile_us(99.9));
+            std::printf("ping_under_b2c_load (flow window %zu B): samples=%zu p50=%.1fus p99=%.1fus "
+                        "credit_stalls=%llu\n", opt.flow_window, b2c_loaded_rtt.count(),
+                        b2c_loaded_rtt.percentile_us(50), b2c_loaded_rtt.percentile_us(99),
+                        static_cast<unsigned long long>(brain.credit_stalls()));
+            std::printf("keepalive_gap_under_load: samples=%zu p50=%.1fms max=%.1fms\n", keepalive_gaps.count(),
+                        keepalive_gaps.percentile_us(50) / 1000.0, keepalive_gaps.percentile_us(100) / 1000.0);
+        }
+        if (!extension_logs.is_null()) {
+            std::printf("extension_logs: sent=%zu to_brain=%zu frames (%llu B) cortex_log_lines=%zu\n",
+                        extension_logs["sent"].get<size_t>(), extension_logs["to_brain_frames"].get<size_t>(),
+                        static_cast<unsigned long long>(extension_logs["to_brain_bytes"].get<uint64_t>()),
+                        extension_logs["cortex_log_lines"].get<size_t>());
+        }
+        if (!requests.is_null()) {
+            std::printf("requests (timeout %d ms): sent=%zu unanswered=%zu responses=%zu timeouts=%zu",
+                        opt.request_timeout_ms, requests["sent"].get<size_t>(), requests["unanswered"].get<size_t>(),
+                        requests["responses"].get<size_t>(), requests["timeouts"].get<size_t>());
+            if (requests.contains("service_us")) {
+                const json& st = requests["service_us"];
+                std::printf(" service p50<=%lluus p99<=%lluus max=%lluus",
+                            static_cast<unsigned long long>(st["p50"].get<uint64_t>()),
+                            static_cast<unsigned long long>(st["p99"].get<uint64_t>()),
+                            static_cast<unsigned long long>(st["max"].get<uint64_t>()));
+            }
+            std::printf("\n");
+        }
+        if (!projection.is_null()) {
+            std::printf("projection: acked=%s sent=%zu complete=%zu full=%lluB wire=%lluB brain_parse avg=%.1fus",
+                        projection["acked"].get<bool>() ? "yes" : "no", projection["sent"].get<size_t>(),
+                        projection["complete"].get<size_t>(),
+                        static_cast<unsigned long long>(projection["full_bytes"].get<uint64_t>()),
+                        static_cast<unsigned long long>(projection["wire_bytes"].get<uint64_t>()),
+                        projection["brain_parse_us_avg"].get<double>());
+            if (projection.contains("host_sax_us_avg")) {
+                std::printf(" host_sax avg=%.1fus", projection["host_sax_us_avg"].get<double>());
+            }
+            std::printf("\n");
+        }
+        if (!subscriptions.is_null()) {
+            std::printf("subscriptions: acked=%s expected=%zu wire=%lluB elapsed=%.1fms",
+                        subscriptions["acked"].get<bool>() ? "yes" : "no", subscriptions["expected"].get<size_t>(),
+                        static_cast<unsigned long long>(subscriptions["wire_bytes"].get<uint64_t>()),
+                        subscriptions["elapsed_ms"].get<double>());
+            for (const auto& kv : subscriptions["kinds"].items()) {
+                std::printf(" %s %zu/%zu", kv.key().c_str(), kv.value()["received"].get<size_t>(),
+                            kv.value()["sent"].get<size_t>());
+            }
+            if (subscriptions.contains("host_hits")) {
+                std::printf(" host_hits=%s host_dropped=%llu", subscriptions["host_hits"].dump().c_str(),
+                            static_cast<unsigned long long>(subscriptions["host_dropped"].get<uint64_t>()));
+            }
+            std::printf("\n");
+        }
+        if (!admission.is_null()) {
+            std::printf("admission (%d ms flood):", opt.admission_ms);
+            for (const char* cls : {"control", "normal", "low"}) {
+                const json& c = admission["classes"][cls];
+                std::printf(" %s %zu/%zu", cls, c["delivered"].get<size_t>(), c["sent"].get<size_t>());
+            }
+            std::printf(" reports=%zu reported_drops=%llu\n", admission["reports"].get<size_t>(),
+                        static_cast<unsigned long long>(admission["reported_drops"].get<uint64_t>()));
+        }
+        if (!dedup.is_null()) {
+            std::printf("dedup (%s): sent=%zu per link to_brain=%zu to_chrome=%zu expected<=%zu\n",
+                        DEDUP_SPEC, dedup["sent_per_link"].get<size_t>(), dedup["to_brain"].get<size_t>(),
+                        dedup["to_chrome"].get<size_t>(), dedup["expected_max"].get<size_t>());
+        }
+        if (!delta.is_null()) {
+            std::printf("delta (%s): sent=%zu exact=%zu snapshots=%zu deltas=%zu full=%lluB wire=%lluB",
+                        DELTA_FORMAT, delta["sent"].get<size_t>(), delta["exact"].get<size_t>(),
+                        delta["snapshots"].get<size_t>(), delta["deltas"].get<size_t>(),
+                        static_cast<unsigned long long>(delta["full_bytes"].get<uint64_t>()),
+                        static_cast<unsigned long long>(delta["wire_bytes"].get<uint64_t>()));
+            if (delta.contains("host_encode_us_avg")) {
+                std::printf(" encode avg=%.1fus max=%lluus", delta["host_encode_us_avg"].get<double>(),
+                            static_cast<unsigned long long>(delta["host_encode_us_max"].get<uint64_t>()));
+            }
+            std::printf("\n");
+        }
+        if (!passthrough.is_null()) {
+            for (const auto& mode : passthrough.items()) {
+                std::printf("passthrough %s:", mode.key().c_str());
+                for (const auto& size : mode.value()["sizes"].items()) {
+                    const json& r = size.value();
+                    std::printf(" %s %.0fMB/s cpu=%.0fms intact=%zu/%zu", size.key().c_str(),
+                                r["mb_per_s"].get<double>(), r["host_cpu_ms"].get<double>(),
+                                r["intact"].get<size_t>(), r["sent"].get<size_t>());
+                }
+                if (mode.value().contains("host_spliced_frames")) {
+                    std::printf(" spliced=%llu",
+                                static_cast<unsigned long long>(mode.value()["host_spliced_frames"].get<uint64_t>()));
+                }
+                std::printf("\n");
+            }
+        }
+        if (!dead_peer.is_null()) {
+            std::printf("dead_peer (bound %d ms): reconnected=%s failover=%.0fms\n", opt.dead_ms,
+                        dead_peer["reconnected"].get<bool>() ? "yes" : "no",
+                        dead_peer["failover_ms"].get<double>());
+        }
+    }
+
+    if (!opt.out_path.empty()) {
+        std::ofstream out(opt.out_path);
+        out << report.dump(2) << std::endl;
+        if (!out) {
+            std::cerr << "✗ Cannot write " << opt.out_path << "\n";
+            return 1;
+        }
+    }
+
+    size_t lost = 0;
+    for (const auto& r : results) lost += r["sent"].get<size_t>() - r["delivered"].get<size_t>();
+    return lost == 0 ? 0 : 3;
+}
@@ -0,0 +1,476 @@
+// ============================================================================
+// bloom-host-microbench
+//
+// Micro-benchmarks aislados de los hot paths del host, enlazados contra los
+// mismos fuentes que el binario (chunked_buffer.cpp, chunk_checksum.cpp,
+// frame_validator.cpp, fast_hash.cpp, synapse_logger.cpp, message_utils.cpp,
+// alloc_tracker.cpp, projection.cpp):
+//
+//   process_chunk/{header,data,footer}   por tamaño de chunk
+//   base64_decode, calculate_sha256      por tamaño de entrada
+//   checksum/{crc32c,xxh64,sha256}       1M, 10M y 50M de a 256K (como los
+//                                        chunks de un upload)
+//   validate/{utf8,structure}/<isa>      frame_validator.h por ISA disponible,
+//   validate/check, validate/json_parse  4K, 64K, 1M y 16M de JSON con UTF-8
+//   json_get_string_safe                 hit string / hit numérico / miss
+//   extract_profile_id_from_raw          hit / miss en mensaje grande
+//   json_parse                           mensaje típico y grande
+//   projection                           parse + dump completo contra SAX
+//                                        proyectado + dump, mensaje de 64K
+//   get_timestamp_ms, format_line        SynapseLogManager
+//
+// Reporta ns/op, allocs/op y bytes/op (AllocTracker habilitado), y MB/s en
+// los casos con tamaño de entrada.
+//
+// Uso:
+//   bloom-host-microbench [--filter substr] [--min-time-ms 200] [--json] [--out FILE]
+// ============================================================================
+
+#include "chunked_buffer.h"
+#include "chunk_checksum.h"
+#include "frame_validator.h"
+#include "synapse_logger.h"
+#include "message_utils.h"
+#include "alloc_tracker.h"
+#include "projection.h"
+
+#include <nlohmann/json.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using json = nlohmann::json;
+
+namespace {
+
+// Evita que el compilador elimine el trabajo medido.
+volatile size_t g_sink = 0;
+inline void consume(size_t v) { g_sink = g_sink + v; }
+
+struct Options {
+    std::string filter;
+    int         min_time_ms = 200;
+    bool        json_only   = false;
+    std::string out_path;
+};
+
+struct Measurement {
+    std::string name;
+    uint64_t    iterations = 0;
+    double      ns_per_op  = 0;
+    double      allocs_per_op = 0;
+    double      bytes_per_op  = 0;
+    double      mb_per_sec    = 0;   // solo casos con tamaño de entrada
+};
+
+uint64_t now_ns() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+/** Acumulador de una operación: tiempo y asignaciones del thread. */
+struct OpCounter {
+    uint64_t ns     = 0;
+    uint64_t allocs = 0;
+    uint64_t bytes  = 0;
+    uint64_t ops    = 0;
+
+    template <typename Fn>
+    void run(Fn&& fn) {
+        uint64_t a0 = AllocTracker::thread_alloc_count();
+        uint64_t b0 = AllocTracker::thread_alloc_bytes();
+        uint64_t t0 = now_ns();
+        fn();
+        ns     += now_ns() - t0;
+        allocs += AllocTracker::thread_alloc_count() - a0;
+        bytes  += AllocTracker::thread_alloc_bytes() - b0;
+        ops++;
+    }
+
+    Measurement result(const std::string& name) const {
+        double n = ops ? static_cast<double>(ops) : 1.0;
+        return { name, ops, ns / n, allocs / n, bytes / n };
+    }
+};
+
+// ============================================================================
+// HARNESS
+// ============================================================================
+
+class Suite {
+public:
+    explicit Suite(const Options& o) : opt(o) {}
+
+    bool selected(const std::string& name) const {
+        return opt.filter.empty() || name.find(opt.filter) != std::string::npos;
+    }
+
+    /**
+     * @brief Ejecuta fn en lotes crecientes hasta superar min_time_ms.
+     * El overhead del reloj se amortiza sobre el lote, no por operación.
+     */
+    void bench(const std::string& name, const std::function<void()>& fn, size_t input_bytes = 0) {
+        if (!selected(name)) return;
+
+        fn();  // warmup: primera asignación de buffers internos, caches
+
+        OpCounter c;
+        uint64_t budget = static_cast<uint64_t>(opt.min_time_ms) * 1000000ULL;
+        uint64_t batch  = 1;
+        while (c.ns < budget) {
+            uint64_t a0 = AllocTracker::thread_alloc_count();
+            uint64_t b0 = AllocTracker::thread_alloc_bytes();
+            uint64_t t0 = now_ns();
+            for (uint64_t i = 0; i < batch; ++i) fn();
+            c.ns     += now_ns() - t0;
+            c.allocs += AllocTracker::thread_alloc_count() - a0;
+            c.bytes  += AllocTracker::thread_alloc_bytes() - b0;
+            c.ops    += batch;
+            if (batch < (1u << 20)) batch *= 2;
+        }
+        Measurement m = c.result(name);
+        if (input_bytes > 0 && m.ns_per_op > 0) m.mb_per_sec = input_bytes * 1000.0 / m.ns_per_op;
+        add(m);
+    }
+
+    void add(const Measurement& m) {
+        results.push_back(m);
+        if (!opt.json_only) {
+            std::printf("%-44s %10llu %12.1f %10.2f %12.1f", m.name.c_str(),
+                        static_cast<unsigned long long>(m.iterations),
+                        m.ns_per_op, m.allocs_per_op, m.bytes_per_op);
+            if (m.mb_per_sec > 0) std::printf(" %10.1f", m.mb_per_sec);
+            std::printf("\n");
+            std::fflush(stdout);
+        }
+    }
+
+    uint64_t budget_ns() const { return static_cast<uint64_t>(opt.min_time_ms) * 1000000ULL; }
+
+    json to_json() const {
+        json arr = json::array();
+        for (const auto& m : results) {
+            json entry = {
+                {"name",          m.name},
+                {"iterations",    m.iterations},
+                {"ns_per_op",     m.ns_per_op},
+                {"allocs_per_op", m.allocs_per_op},
+                {"bytes_per_op",  m.bytes_per_op}
+            };
+            if (m.mb_per_sec > 0) entry["mb_per_sec"] = m.mb_per_sec;
+            arr.push_back(entry);
+        }
+        return arr;
+    }
+
+private:
+    const Options&           opt;
+    std::vector<Measurement> results;
+};
+
+// ============================================================================
+// FIXTURES
+// ============================================================================
+
+std::string base64_encode(const std::string& data) {
+    static const char table[] =
+        "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    std::string out;
+    size_t i = 0;
+    for (; i + 2 < data.size(); i += 3) {
+        uint32_t v = (static_cast<unsigned char>(data[i]) << 16) |
+                     (static_cast<unsigned char>(data[i + 1]) << 8) |
+                      static_cast<unsigned char>(data[i + 2]);
+        out += table[(v >> 18) & 0x3F];
+        out += table[(v >> 12) & 0x3F];
+        out += table[(v >> 6) & 0x3F];
+        out += table[v & 0x3F];
+    }
+    if (data.size() - i == 1) {
+        uint32_t v = static_cast<unsigned char>(data[i]) << 16;
+        out += table[(v >> 18) & 0x3F];
+        out += table[(v >> 12) & 0x3F];
+        out += "==";
+    } else if (data.size() - i == 2) {
+        uint32_t v = (static_cast<unsigned char>(data[i]) << 16) |
+                     (static_cast<unsigned char>(data[i + 1]) << 8);
+        out += table[(v >> 18) & 0x3F];
+        out += table[(v >> 12) & 0x3F];
+        out += table[(v >> 6) & 0x3F];
+        out += '=';
+    }
+    return out;
+}
+
+std::string random_bytes(size_t n) {
+    std::string s(n, '\0');
+    uint64_t x = 0x9E3779B97F4A7C15ULL;
+    for (size_t i = 0; i < n; ++i) {
+        x ^= x << 13; x ^= x >> 7; x ^= x << 17;
+        s[i] = static_cast<char>(x & 0xFF);
+    }
+    return s;
+}
+
+// Mensaje JSON de ~n bytes con texto mezclado (ASCII con ~10% de acentos,
+// símbolos y emoji) en objetos y arrays anidados, como un DOM serializado
+std::string utf8_message(size_t n) {
+    static const char* const WORDS[] = {"página", "título", "naïve", "€ 12,50", "日本語", "🚀", "item", "text"};
+    std::string out = R"({"event":"BENCH_VALIDATE","payload":{"items":[)";
+    for (size_t i = 0; out.size() < n; ++i) {
+        if (i > 0) out += ',';
+        out += R"({"id":)" + std::to_string(i) + R"(,"tags":["a","b"],"text":")";
+        for (int w = 0; w < 12; ++w) {
+            out += w % 4 == 3 ? WORDS[(i + w) % 8] : "lorem ipsum dolor";
+            out += ' ';
+        }
+        out += R"(\"quoted\" [x]"})";
+    }
+    out += "]}}";
+    return out;
+}
+
+std::string size_label(size_t n) {
+    if (n >= 1024 * 1024 && n % (1024 * 1024) == 0) return std::to_string(n / (1024 * 1024)) + "M";
+    if (n >= 1024 && n % 1024 == 0) return std::to_string(n / 1024) + "K";
+    return std::to_string(n);
+}
+
+// ============================================================================
+// CASOS
+// ============================================================================
+
+/**
+ * process_chunk: un ciclo header → data × 4 → footer por iteración, con
+ * cada fase medida por separado. El footer incluye el sha256 del ensamblado
+ * y la entrega del mensaje (por move, sin copia).
+ */
+void bench_process_chunk(Suite& suite, size_t chunk_bytes) {
+    const std::string base = "process_chunk/" + size_label(chunk_bytes);
+    if (!suite.selected(base)) return;
+
+    const size_t chunks = 4;
+    std::string payload = random_bytes(chunk_bytes * chunks);
+    std::vector<uint8_t> bytes(payload.begin(), payload.end());
+    std::string checksum = ChunkedMessageBuffer::calculate_sha256(bytes);
+
+    json header = {{"bloom_chunk", {
+        {"type", "header"}, {"message_id", "mb"},
+        {"total_chunks", chunks}, {"total_size_bytes", payload.size()}}}};
+    std::vector<json> data;
+    for (size_t i = 0; i < chunks; ++i) {
+        data.push_back({{"bloom_chunk", {
+            {"type", "data"}, {"message_id", "mb"}, {"seq", i}, {"total", chunks},
+            {"data", base64_encode(payload.substr(i * chunk_bytes, chunk_bytes))}}}});
+    }
+    json footer = {{"bloom_chunk", {
+        {"type", "footer"}, {"message_id", "mb"}, {"checksum_verify", checksum}}}};
+
+    ChunkedMessageBuffer buffer;
+    OpCounter h, d, f;
+    ChunkedMessageBuffer::Processed out;
+    while (h.ns + d.ns + f.ns < suite.budget_ns()) {
+        h.run([&] { consume(buffer.process_chunk(header).result); });
+        for (const auto& chunk : data) {
+            d.run([&] { consume(buffer.process_chunk(chunk).result); });
+        }
+        f.run([&] { out = buffer.process_chunk(footer); consume(out.result); });
+        consume(out.message.size());
+    }
+
+    suite.add(h.result(base + "/header"));
+    suite.add(d.result(base + "/data"));
+    suite.add(f.result(base + "/footer"));
+}
+
+void run_all(Suite& suite) {
+    for (size_t size : {4096u, 65536u, 262144u}) {
+        bench_process_chunk(suite, size);
+    }
+
+    for (size_t size : {4096u, 65536u, 262144u}) {
+        std::string encoded = base64_encode(random_bytes(size));
+        suite.bench("base64_decode/" + size_label(size), [&] {
+            consume(ChunkedMessageBuffer::base64_decode(encoded).size());
+        });
+    }
+
+    for (size_t size : {4096u, 65536u, 1048576u}) {
+        std::string raw = random_bytes(size);
+        std::vector<uint8_t> bytes(raw.begin(), raw.end());
+        suite.bench("calculate_sha256/" + size_label(size), [&] {
+            consume(ChunkedMessageBuffer::calculate_sha256(bytes).size());
+        });
+    }
+
+    // Checksum de upload incremental por chunk; el nombre lleva MISMATCH si
+    // el digest por partes no coincide con el de una sola vez
+    const size_t checksum_piece = 262144;
+    for (size_t size : {1048576u, 10485760u, 52428800u}) {
+        std::string raw = random_bytes(size);
+        for (Checksum::Algo algo : {Checksum::ALGO_CRC32C, Checksum::ALGO_XXH64, Checksum::ALGO_SHA256}) {
+            std::string name = std::string("checksum/") + Checksum::algo_name(algo) + "/" + size_label(size);
+            if (!suite.selected(name)) continue;
+            auto incremental = [&] {
+                Checksum::Hasher hasher(algo);
+                for (size_t off = 0; off < raw.size(); off += checksum_piece) {
+                    hasher.update(raw.data() + off, std::min(checksum_piece, raw.size() - off));
+                }
+                return hasher.hex_digest();
+            };
+            if (incremental() != Checksum::hex_digest(algo, raw.data(), raw.size())) name += " (MISMATCH)";
+            suite.bench(name, [&] { consume(incremental().size()); }, raw.size());
+        }
+    }
+
+    // Validación de frames crudos (frame_validator.h) por ISA, contra el parse
+    // completo que reemplaza en los caminos sin parse
+    for (size_t size : {4096UL, 65536UL, 1048576UL, 16777216UL}) {
+        std::string frame = utf8_message(size);
+        const std::string label = size_label(size);
+        for (FrameValidator::Isa isa : {FrameValidator::ISA_SCALAR, FrameValidator::ISA_SSE42, FrameValidator::ISA_AVX2}) {
+            if (!FrameValidator::isa_supported(isa)) continue;
+            const std::string suffix = std::string("/") + FrameValidator::isa_name(isa) + "/" + label;
+            suite.bench("validate/utf8" + suffix, [&] {
+                consume(FrameValidator::utf8_valid(frame.data(), frame.size(), isa));
+            }, frame.size());
+            suite.bench("validate/structure" + suffix, [&] {
+                consume(FrameValidator::structure_valid(frame.data(), frame.size(), isa));
+            }, frame.size());
+        }
+        std::string check_name = "validate/check/" + label;
+        if (FrameValidator::check(frame.data(), frame.size()) != FrameValidator::VALID) check_name += " (INVALID)";
+        suite.bench(check_name, [&] {
+            consume(FrameValidator::check(frame.data(), frame.size()));
+        }, frame.size());
+        suite.bench("validate/json_parse/" + label, [&] {
+            consume(json::parse(frame).size());
+        }, frame.size());
+    }
+
+    json msg = json::parse(R"({"command":"tab.query","id":"req-1","timestamp":1718000000000,)"
+                           R"("payload":{"url":"https://example.com","active":true}})");
+    suite.bench("json_get_string_safe/hit_string", [&] {
+        consume(MessageUtils::json_get_string_safe(msg, "command").size());
+    });
+    suite.bench("json_get_string_safe/hit_number", [&] {
+        consume(MessageUtils::json_get_string_safe(msg, "timestamp").size());
+    });
+    suite.bench("json_get_string_safe/miss", [&] {
+        consume(MessageUtils::json_get_string_safe(msg, "type").size());
+    });
+
+    std::string ext_ready = R"({"command":"extension_ready","profile_id":"11111111-2222-3333-4444-555555555555",)"
+                            R"("launch_id":"001_test"})";
+    std::string big_event = R"({"event":"TAB_STATE","data":")" + std::string(65536, 'x') + "\"}";
+    suite.bench("extract_profile_id_from_raw/hit", [&] {
+        std::string out;
+        consume(MessageUtils::extract_profile_id_from_raw(ext_ready, out));
+    });
+    suite.bench("extract_profile_id_from_raw/miss_64K", [&] {
+        std::string out;
+        consume(MessageUtils::extract_profile_id_from_raw(big_event, out));
+    });
+
+    std::string small_json = msg.dump();
+    suite.bench("json_parse/" + size_label(small_json.size()), [&] {
+        consume(json::parse(small_json).size());
+    });
+    suite.bench("json_parse/64K", [&] {
+        consume(json::parse(big_event).size());
+    });
+
+    // Lo que el host hace con un kind proyectado contra lo que hacía antes
+    json items = json::array();
+    for (int i = 0; i < 64; ++i) {
+        items.push_back({{"id", i}, {"html", "<li>" + std::string(256, 'h') + "</li>"}, {"visible", i % 2 == 0}});
+    }
+    std::string heavy = json({{"event", "BENCH_PROJECT"}, {"seq", 1},
+                              {"payload", {{"title", "bench page"}, {"items", items},
+                                           {"blob", std::string(32768, 'b')}}}}).dump();
+    Projection::Spec spec;
+    std::string spec_error;
+    Projection::build_spec("BENCH_PROJECT", json::array({"/payload/title", "/payload/items/*/id"}),
+                           spec, spec_error);
+    Projection::Envelope env;
+    suite.bench("projection/scan_envelope/" + size_label(heavy.size()), [&] {
+        consume(Projection::scan_envelope(heavy, env));
+    });
+    suite.bench("projection/full_parse_dump/" + size_label(heavy.size()), [&] {
+        consume(json::parse(heavy).dump().size());
+    });
+    suite.bench("projection/sax_project_dump/" + size_label(heavy.size()), [&] {
+        json out;
+        Projection::project(spec, heavy, out);
+        consume(out.dump().size());
+    });
+
+    suite.bench("log/get_timestamp_ms", [&] {
+        consume(SynapseLogManager::get_timestamp_ms().size());
+    });
+    std::string ts = SynapseLogManager::get_timestamp_ms();
+    suite.bench("log/format_line", [&] {
+        consume(SynapseLogManager::format_line(ts, "INFO", "HOST",
+                                               "CHROME_MSG command=tab.query type= size=128").size());
+    });
+}
+
+bool parse_options(int argc, char* argv[], Options& o) {
+    for (int i = 1; i < argc; ++i) {
+        std::string a = argv[i];
+        if      (a == "--filter"      && i + 1 < argc) o.filter      = argv[++i];
+        else if (a == "--min-time-ms" && i + 1 < argc) o.min_time_ms = std::max(1, std::atoi(argv[++i]));
+        else if (a == "--out"         && i + 1 < argc) o.out_path    = argv[++i];
+        else if (a == "--json") o.json_only = true;
+        else {
+            std::cerr << "Usage: bloom-host-microbench [--filter substr] [--min-time-ms N] [--json] [--out FILE]\n";
+            return false;
+        }
+    }
+    return true;
+}
+
+}  // namespace
+
+// ============================================================================
+// MAIN
+// ============================================================================
+
+int main(int argc, char* argv[]) {
+    Options opt;
+    if (!parse_options(argc, argv, opt)) return 2;
+
+    AllocTracker::set_enabled(true);
+
+    if (!opt.json_only) {
+        std::printf("%-44s %10s %12s %10s %12s %10s\n", "benchmark", "iters", "ns/op", "allocs/op", "bytes/op", "MB/s");
+    }
+
+    Suite suite(opt);
+    run_all(suite);
+
+    json report = {
+        {"bench",       "bloom-host-microbench"},
+        {"min_time_ms", opt.min_time_ms},
+        {"results",     suite.to_json()}
+    };
+
+    if (opt.json_only) std::cout << report.dump(2) << std::endl;
+
+    if (!opt.out_path.empty()) {
+        std::ofstream out(opt.out_path);
+        out << report.dump(2) << std::endl;
+        if (!out) {
+            std::cerr << "✗ Cannot write " << opt.out_path << "\n";
+            return 1;
+        }
+    }
+    return 0;
+}
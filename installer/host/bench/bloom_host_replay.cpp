@@ -0,0 +1,343 @@
+// ============================================================================
+// bloom-host-replay
+//
+// Reproduce una captura .bcap (bloom-host --capture / --capture-redact) contra
+// un bloom-host real: los frames chrome_in se reinyectan por stdin y los
+// brain_in por el mock Brain, respetando los tiempos originales escalados.
+//
+//   --speed 1     tiempo real
+//   --speed N     N veces más rápido
+//   --speed max   sin esperas (throughput máximo; los pipes/sockets dan backpressure)
+//
+// Cada frame de entrada lleva "_rseq":N agregado al inicio del objeto. El
+// host lo conserva al reenviar, y eso permite medir la latencia de cada frame
+// de punta a punta. Los frames que el host consume localmente (PING,
+// REQUEST_IDENTITY, chunks intermedios) cuentan para throughput pero no
+// tienen latencia.
+//
+// Capturas redactadas: el payload se sintetiza con la metadata + relleno hasta
+// original_len. Los frames bloom_chunk redactados se reenvían como frames
+// planos del mismo tamaño (no hay datos para reensamblar).
+//
+// El handshake lo hace el propio harness; se omiten extension_ready y
+// handshake_confirm (chrome_in) y REGISTER_ACK (brain_in) de la captura.
+//
+// Uso:
+//   bloom-host-replay --host <path/bloom-host> --capture <file.bcap>
+//                     [--speed 1|N|max] [--port 15678] [--json] [--out FILE]
+// ============================================================================
+
+#include "bench_common.h"
+#include "traffic_capture.h"
+
+#include <nlohmann/json.hpp>
+
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+using json = nlohmann::json;
+using namespace Bench;
+
+namespace {
+
+const char* REPLAY_PROFILE_ID = "4e91a700-0000-4000-8000-000000000056";
+const char* REPLAY_LAUNCH_ID  = "001_replay";
+
+struct Options {
+    std::string host_binary;
+    std::string capture_path;
+    double      speed     = 1.0;   // 0 = max
+    int         port      = 15678;
+    bool        json_only = false;
+    std::string out_path;
+};
+
+struct ReplayFrame {
+    bool        to_chrome_stdin;   // true: chrome_in, false: brain_in
+    uint64_t    t_ns;
+    std::string payload;
+};
+
+struct DirectionStats {
+    size_t          frames  = 0;
+    uint64_t        bytes   = 0;
+    size_t          tagged  = 0;
+    LatencyRecorder latency;
+    uint64_t        max_lag_ns = 0;   // retraso máximo del emisor respecto del cronograma
+};
+
+/** Inserta "_rseq":N como primera clave si el payload es un objeto JSON. */
+bool tag_payload(std::string& payload, size_t seq) {
+    size_t open = payload.find_first_not_of(" \t\r\n");
+    if (open == std::string::npos || payload[open] != '{') return false;
+    size_t next = payload.find_first_not_of(" \t\r\n", open + 1);
+    bool empty = next != std::string::npos && payload[next] == '}';
+    payload.insert(open + 1, "\"_rseq\":" + std::to_string(seq) + (empty ? "" : ","));
+    return true;
+}
+
+/** Payload sintético para un registro redactado: metadata + relleno hasta original_len. */
+std::string synthesize(const TrafficCapture::Record& rec) {
+    json meta = json::parse(rec.payload, nullptr, false);
+    if (!meta.is_object()) meta = json::object();
+    if (meta.contains("chunk")) {
+        meta["replayed_chunk"] = meta["chunk"];
+        meta.erase("chunk");
+    }
+    std::string base = meta.dump();
+    size_t overhead = base.size() + std::string(",\"pad\":\"\"").size();
+    meta["pad"] = std::string(rec.original_len > overhead ? rec.original_len - overhead : 0, 'x');
+    return meta.dump();
+}
+
+bool skip_record(const TrafficCapture::Record& rec, const std::string& payload) {
+    if (rec.direction == TrafficCapture::CHROME_IN) {
+        std::string cmd = extract_string_field(payload, "command");
+        return cmd == "extension_ready" || cmd == "handshake_confirm";
+    }
+    return extract_string_field(payload, "type") == "REGISTER_ACK";
+}
+
+bool parse_options(int argc, char* argv[], Options& o) {
+    for (int i = 1; i < argc; ++i) {
+        std::string a = argv[i];
+        auto next = [&](std::string& out) {
+            if (i + 1 >= argc) return false;
+            out = argv[++i];
+            return true;
+        };
+        std::string v;
+        if      (a == "--host"    && next(v)) o.host_binary  = v;
+        else if (a == "--capture" && next(v)) o.capture_path = v;
+        else if (a == "--port"    && next(v)) o.port         = std::atoi(v.c_str());
+        else if (a == "--out"     && next(v)) o.out_path     = v;
+        else if (a == "--speed"   && next(v)) o.speed        = (v == "max") ? 0.0 : std::atof(v.c_str());
+        else if (a == "--json") o.json_only = true;
+        else return false;
+    }
+    return !o.host_binary.empty() && !o.capture_path.empty() && o.speed >= 0.0 &&
+           o.port > 0 && o.port < 65536;
+}
+
+json direction_json(DirectionStats& d, double wall_s) {
+    return {
+        {"frames",     d.frames},
+        {"bytes",      d.bytes},
+        {"msg_per_s",  wall_s > 0 ? d.frames / wall_s : 0.0},
+        {"mb_per_s",   wall_s > 0 ? d.bytes / (1024.0 * 1024.0) / wall_s : 0.0},
+        {"tagged",     d.tagged},
+        {"delivered",  d.latency.count()},
+        {"max_lag_ms", d.max_lag_ns / 1e6},
+        {"latency_us", {
+            {"p50",  d.latency.percentile_us(50)},
+            {"p99",  d.latency.percentile_us(99)},
+            {"p999", d.latency.percentile_us(99.9)},
+            {"max",  d.latency.percentile_us(100)}
+        }}
+    };
+}
+
+}  // namespace
+
+// ============================================================================
+// MAIN
+// ============================================================================
+
+int main(int argc, char* argv[]) {
+    Options opt;
+    if (!parse_options(argc, argv, opt)) {
+        std::cerr <<
+            "Usage: bloom-host-replay --host <path/to/bloom-host> --capture <file.bcap> [options]\n"
+            "  --speed X     1 = real time, N = N times faster, max = no pacing (default 1)\n"
+            "  --port N      mock Brain port (default 15678)\n"
+            "  --json        print only the JSON report on stdout\n"
+            "  --out FILE    also write the JSON report to FILE\n";
+        return 2;
+    }
+    std::ostream& info = opt.json_only ? std::cerr : std::cout;
+
+    // ------------------------------------------------------------------------
+    // Cargar captura
+    // ------------------------------------------------------------------------
+    TrafficCapture::Reader reader;
+    if (!reader.open(opt.capture_path)) {
+        std::cerr << "✗ Not a valid capture: " << opt.capture_path << "\n";
+        return 1;
+    }
+
+    std::vector<ReplayFrame> frames;
+    size_t captured_out = 0, skipped = 0;
+    TrafficCapture::Record rec;
+    while (reader.next(rec)) {
+        if (rec.direction == TrafficCapture::CHROME_OUT || rec.direction == TrafficCapture::BRAIN_OUT) {
+            captured_out++;
+            continue;
+        }
+        std::string payload = rec.redacted ? synthesize(rec) : rec.payload;
+        if (skip_record(rec, payload)) {
+            skipped++;
+            continue;
+        }
+        frames.push_back({rec.direction == TrafficCapture::CHROME_IN, rec.t_ns, std::move(payload)});
+    }
+    if (frames.empty()) {
+        std::cerr << "✗ Capture has no replayable input frames\n";
+        return 1;
+    }
+
+    uint64_t t0 = frames.front().t_ns;
+    uint64_t capture_span_ns = frames.back().t_ns - t0;
+
+    DirectionStats chrome_stats, brain_stats;
+    std::vector<uint64_t> sent_ns(frames.size(), 0);
+    std::vector<char>     is_chrome(frames.size(), 0);
+    for (size_t i = 0; i < frames.size(); ++i) {
+        is_chrome[i] = frames[i].to_chrome_stdin;
+        DirectionStats& d = frames[i].to_chrome_stdin ? chrome_stats : brain_stats;
+        if (tag_payload(frames[i].payload, i)) d.tagged++;
+    }
+
+    info << "✓ Loaded " << frames.size() << " input frames (" << skipped << " handshake frames skipped, "
+         << captured_out << " captured outputs) spanning " << capture_span_ns / 1e6 << " ms"
+         << (reader.redacted() ? " [redacted]" : "") << "\n";
+
+    // ------------------------------------------------------------------------
+    // Host + mock Brain + emulador
+    // ------------------------------------------------------------------------
+    std::string base_dir = make_temp_dir("bloom-host-replay-");
+    MockBrain brain(opt.port);
+    if (!brain.start()) {
+        std::cerr << "✗ Cannot listen on 127.0.0.1:" << opt.port << "\n";
+        return 1;
+    }
+
+    std::mutex stats_mutex;
+    auto on_frame = [&](const std::string& frame, uint64_t recv_ns) {
+        int64_t seq = extract_int_field(frame, "_rseq");
+        if (seq < 0 || static_cast<size_t>(seq) >= sent_ns.size()) return;
+        std::lock_guard<std::mutex> lock(stats_mutex);
+        uint64_t sent = sent_ns[static_cast<size_t>(seq)];
+        if (sent == 0) return;
+        sent_ns[static_cast<size_t>(seq)] = 0;
+        (is_chrome[static_cast<size_t>(seq)] ? chrome_stats : brain_stats).latency.add(recv_ns - sent);
+    };
+
+    HostProcess host;
+    if (!host.spawn(opt.host_binary, host_args(REPLAY_PROFILE_ID, REPLAY_LAUNCH_ID, base_dir, opt.port),
+                    "/dev/null")) {
+        std::cerr << "✗ Cannot spawn " << opt.host_binary << "\n";
+        return 1;
+    }
+    ChromeEmulator chrome(host, REPLAY_PROFILE_ID, REPLAY_LAUNCH_ID);
+    chrome.start(on_frame);
+    brain.set_frame_handler([&](int, const std::string& frame, uint64_t recv_ns) { on_frame(frame, recv_ns); });
+
+    if (!chrome.handshake(10000) || !brain.wait_for_profiles(1, 10000)) {
+        std::cerr << "✗ Handshake did not complete\n";
+        host.shutdown(2000);
+        brain.stop();
+        return 1;
+    }
+    int conn = brain.profile_connections().front();
+
+    // ------------------------------------------------------------------------
+    // Replay: un emisor por dirección, ambos sobre el mismo cronograma
+    // ------------------------------------------------------------------------
+    uint64_t start_ns = now_ns() + 5000000ULL;   // 5ms para arrancar ambos emisores
+    auto sender = [&](bool chrome_side) {
+        DirectionStats& d = chrome_side ? chrome_stats : brain_stats;
+        std::this_thread::sleep_for(std::chrono::nanoseconds(start_ns - std::min(start_ns, now_ns())));
+        for (size_t i = 0; i < frames.size(); ++i) {
+            if (frames[i].to_chrome_stdin != chrome_side) continue;
+            if (opt.speed > 0) {
+                uint64_t due = start_ns + static_cast<uint64_t>((frames[i].t_ns - t0) / opt.speed);
+                uint64_t now = now_ns();
+                if (due > now) {
+                    std::this_thread::sleep_for(std::chrono::nanoseconds(due - now));
+                } else {
+                    d.max_lag_ns = std::max(d.max_lag_ns, now - due);
+                }
+            }
+            {
+                std::lock_guard<std::mutex> lock(stats_mutex);
+                sent_ns[i] = now_ns();
+            }
+            bool ok = chrome_side ? chrome.send(frames[i].payload) : brain.send(conn, frames[i].payload);
+            if (!ok) break;
+            d.frames++;
+            d.bytes += frames[i].payload.size();
+        }
+    };
+    std::thread chrome_sender(sender, true);
+    std::thread brain_sender(sender, false);
+    chrome_sender.join();
+    brain_sender.join();
+    uint64_t send_end_ns = now_ns();
+
+    // Drenar: esperar hasta que no lleguen entregas nuevas durante 500ms
+    size_t last_delivered = SIZE_MAX;
+    for (int i = 0; i < 40; ++i) {
+        size_t delivered;
+        {
+            std::lock_guard<std::mutex> lock(stats_mutex);
+            delivered = chrome_stats.latency.count() + brain_stats.latency.count();
+        }
+        if (delivered == last_delivered) break;
+        last_delivered = delivered;
+        std::this_thread::sleep_for(std::chrono::milliseconds(500));
+    }
+
+    host.shutdown(15000);
+    chrome.join();
+    brain.stop();
+    std::error_code ec;
+    std::filesystem::remove_all(base_dir, ec);
+
+    // ------------------------------------------------------------------------
+    // Reporte
+    // ------------------------------------------------------------------------
+    double wall_s = (send_end_ns - start_ns) / 1e9;
+    json report;
+    {
+        std::lock_guard<std::mutex> lock(stats_mutex);
+        report = {
+            {"bench",            "bloom-host-replay"},
+            {"capture",          opt.capture_path},
+            {"redacted",         reader.redacted()},
+            {"speed",            opt.speed > 0 ? json(opt.speed) : json("max")},
+            {"capture_span_ms",  capture_span_ns / 1e6},
+            {"replay_wall_ms",   wall_s * 1e3},
+            {"skipped_handshake", skipped},
+            {"chrome_to_brain",  direction_json(chrome_stats, wall_s)},
+            {"brain_to_chrome",  direction_json(brain_stats, wall_s)}
+        };
+    }
+
+    if (opt.json_only) {
+        std::cout << report.dump(2) << std::endl;
+    } else {
+        for (const char* dir : {"chrome_to_brain", "brain_to_chrome"}) {
+            const json& d = report[dir];
+            std::printf("%-16s frames=%zu delivered=%zu %.0f msg/s %.2f MB/s p50=%.1fus p99=%.1fus p999=%.1fus lag_max=%.1fms\n",
+                        dir, d["frames"].get<size_t>(), d["delivered"].get<size_t>(),
+                        d["msg_per_s"].get<double>(), d["mb_per_s"].get<double>(),
+                        d["latency_us"]["p50"].get<double>(), d["latency_us"]["p99"].get<double>(),
+                        d["latency_us"]["p999"].get<double>(), d["max_lag_ms"].get<double>());
+        }
+        std::printf("capture span %.1f ms, replay wall %.1f ms\n",
+                    report["capture_span_ms"].get<double>(), report["replay_wall_ms"].get<double>());
+    }
+
+    if (!opt.out_path.empty()) {
+        std::ofstream out(opt.out_path);
+        out << report.dump(2) << std::endl;
+        if (!out) {
+            std::cerr << "✗ Cannot write " << opt.out_path << "\n";
+            return 1;
+        }
+    }
+    return 0;
+}
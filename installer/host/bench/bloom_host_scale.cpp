@@ -0,0 +1,514 @@
+// ============================================================================
+// bloom-host-scale
+//
+// Benchmark de escala: en producción cada perfil de Chrome lanza su propio
+// bloom-host y todos hablan con un único Brain. Este harness lanza N hosts
+// reales contra un mock Brain compartido, cada uno con su emulador de
+// extensión, y mide por cada N:
+//
+//   - tiempo hasta que los N hosts completan el handshake (PROFILE_CONNECTED)
+//   - RSS y threads por host, en reposo y bajo tráfico
+//   - context switches por host y por segundo (suma de /proc/<pid>/task/*)
+//   - CPU total de los N hosts durante la fase de tráfico
+//   - latencia p50/p99/p999 vista desde el mock Brain (chrome_to_brain) y
+//     desde los emuladores (brain_to_chrome)
+//   - reinicio de Brain: el mock cierra todas las conexiones, queda caído
+//     --restart-down-ms y vuelve a escuchar (publicando brain.ready salvo
+//     --no-ready-signal). Se mide el tiempo desde que vuelve hasta cada
+//     REGISTER_HOST y el pico de registros por ventana de 100 ms (herd)
+//
+// Tráfico: cada host recibe --rate mensajes/s en cada dirección, de --size
+// bytes, durante --duration segundos, con fases desfasadas entre hosts.
+//
+// Uso:
+//   bloom-host-scale --host <path/bloom-host> [--hosts 10,50,200] [--port 15678]
+//                    [--rate 20] [--size 1024] [--duration 10]
+//                    [--restart-down-ms 3000] [--no-ready-signal] [--json] [--out FILE]
+//
+// Métricas de proceso solo en Linux (/proc); en otras plataformas se reportan en 0.
+// ============================================================================
+
+#include "bench_common.h"
+
+#include <nlohmann/json.hpp>
+
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+#include <sys/resource.h>
+
+using json = nlohmann::json;
+using namespace Bench;
+
+namespace {
+
+struct Options {
+    std::string         host_binary;
+    int                 port      = 15678;
+    std::vector<size_t> hosts     = {10, 50, 200};
+    size_t              rate      = 20;
+    size_t              size      = 1024;
+    int                 duration  = 10;
+    int                 restart_down_ms = 3000;   // 0 = sin fase de reinicio
+    bool                ready_signal = true;
+    bool                json_only = false;
+    std::string         out_path;
+};
+
+/** Estado por host: proceso, emulador y timestamps de envío por seq. */
+struct HostSlot {
+    size_t                          index = 0;
+    std::string                     profile_id;
+    std::string                     launch_id;
+    HostProcess                     process;
+    std::unique_ptr<ChromeEmulator> chrome;
+    int                             conn = -1;
+    std::unique_ptr<std::atomic<uint64_t>[]> c2b_sent;
+    std::unique_ptr<std::atomic<uint64_t>[]> b2c_sent;
+    size_t                          capacity = 0;
+    ProcSample                      idle;
+    ProcSample                      start;
+    ProcSample                      end;
+};
+
+struct Aggregate {
+    std::mutex      mutex;
+    LatencyRecorder c2b;
+    LatencyRecorder b2c;
+    size_t          c2b_sent = 0;
+    size_t          b2c_sent = 0;
+};
+
+std::string profile_for(size_t run, size_t index) {
+    char buf[40];
+    std::snprintf(buf, sizeof(buf), "5ca1e000-%04zx-4000-8000-%012zx", run, index);
+    return buf;
+}
+
+/** Mensaje de escala: {kind_field:"SCALE","host":i,"seq":s,"pad":...}. */
+std::string scale_message(const char* kind_field, size_t host, size_t seq, size_t size) {
+    std::string head = std::string("{\"") + kind_field + "\":\"SCALE\",\"host\":" +
+                       std::to_string(host) + ",\"seq\":" + std::to_string(seq) + ",\"pad\":\"";
+    size_t fixed = head.size() + 2;
+    std::string msg = head;
+    if (size > fixed) msg.append(size - fixed, 'x');
+    msg += "\"}";
+    return msg;
+}
+
+void record(Aggregate& agg, std::vector<std::unique_ptr<HostSlot>>& slots, const std::string& frame,
+            const char* kind_field, bool c2b, uint64_t recv_ns) {
+    if (extract_string_field(frame, kind_field) != "SCALE") return;
+    int64_t host = extract_int_field(frame, "host");
+    int64_t seq  = extract_int_field(frame, "seq");
+    if (host < 0 || seq < 0 || static_cast<size_t>(host) >= slots.size()) return;
+
+    HostSlot& slot = *slots[static_cast<size_t>(host)];
+    if (static_cast<size_t>(seq) >= slot.capacity) return;
+    auto& sent_slot = c2b ? slot.c2b_sent[seq] : slot.b2c_sent[seq];
+    uint64_t sent = sent_slot.exchange(0);
+    if (sent == 0) return;
+
+    std::lock_guard<std::mutex> lock(agg.mutex);
+    (c2b ? agg.c2b : agg.b2c).add(recv_ns - sent);
+}
+
+const uint64_t HERD_BUCKET_NS = 100000000ULL;   // 100 ms
+
+/** Lo que publica Brain al escuchar (server_manager.py _publish_ready). */
+void write_brain_ready(const std::string& base_dir, int port, size_t generation) {
+    std::filesystem::path dir = std::filesystem::path(base_dir) / "workers" / "brain";
+    std::error_code ec;
+    std::filesystem::create_directories(dir, ec);
+    std::filesystem::path tmp = dir / "brain.ready.tmp";
+    {
+        std::ofstream out(tmp);
+        out << "{\"pid\": " << generation << ", \"port\": " << port
+            << ", \"started_at\": " << now_ns() << "}";
+    }
+    std::filesystem::rename(tmp, dir / "brain.ready", ec);
+}
+
+void remove_brain_ready(const std::string& base_dir) {
+    std::error_code ec;
+    std::filesystem::remove(std::filesystem::path(base_dir) / "workers" / "brain" / "brain.ready", ec);
+}
+
+/**
+ * Reinicio de Brain: cae `brain`, vuelve `reborn` en el mismo puerto y se
+ * espera el REGISTER_HOST de los `expected` hosts.
+ */
+json run_restart(const Options& opt, MockBrain& brain, std::unique_ptr<MockBrain>& reborn,
+                 const std::string& base_dir, size_t expected, std::ostream& info) {
+    remove_brain_ready(base_dir);
+    brain.stop();
+    std::this_thread::sleep_for(std::chrono::milliseconds(opt.restart_down_ms));
+
+    reborn = std::make_unique<MockBrain>(opt.port);
+    if (!reborn->start()) return {{"error", "relisten_failed"}};
+    uint64_t up_ns = now_ns();
+    if (opt.ready_signal) write_brain_ready(base_dir, opt.port, 2);
+
+    bool all = reborn->wait_for_registrations(expected, 60000);
+    std::vector<uint64_t> times = reborn->registration_times();
+
+    LatencyRecorder reconnect;
+    std::map<uint64_t, size_t> buckets;
+    for (uint64_t t : times) {
+        reconnect.add(t > up_ns ? t - up_ns : 0);
+        buckets[(t > up_ns ? t - up_ns : 0) / HERD_BUCKET_NS]++;
+    }
+    size_t herd_peak = 0;
+    for (const auto& b : buckets) herd_peak = std::max(herd_peak, b.second);
+
+    json r = {
+        {"down_ms",          opt.restart_down_ms},
+        {"ready_signal",     opt.ready_signal},
+        {"reregistered",     times.size()},
+        {"all_reregistered", all},
+        {"reconnect_ms", {
+            {"p50", reconnect.percentile_us(50) / 1000.0},
+            {"p99", reconnect.percentile_us(99) / 1000.0},
+            {"max", reconnect.percentile_us(100) / 1000.0}
+        }},
+        {"herd_peak_per_100ms", herd_peak},
+        {"herd_buckets",        buckets.size()}
+    };
+    info << "  restart: " << times.size() << "/" << expected << " re-registered, p50="
+         << static_cast<int>(reconnect.percentile_us(50) / 1000.0) << " ms max="
+         << static_cast<int>(reconnect.percentile_us(100) / 1000.0) << " ms, peak "
+         << herd_peak << " per 100 ms\n";
+    return r;
+}
+
+json latency_json(LatencyRecorder& l, size_t sent) {
+    return {
+        {"sent",      sent},
+        {"delivered", l.count()},
+        {"p50_us",    l.percentile_us(50)},
+        {"p99_us",    l.percentile_us(99)},
+        {"p999_us",   l.percentile_us(99.9)},
+        {"max_us",    l.percentile_us(100)}
+    };
+}
+
+// ============================================================================
+// UN RUN CON N HOSTS
+// ============================================================================
+
+json run_scale(const Options& opt, size_t run_index, size_t n, std::ostream& info) {
+    std::string base_dir = make_temp_dir("bloom-host-scale-");
+
+    MockBrain brain(opt.port);
+    std::unique_ptr<MockBrain> reborn;   // fase de reinicio
+    if (!brain.start()) {
+        info << "✗ Cannot listen on 127.0.0.1:" << opt.port << "\n";
+        return {{"hosts", n}, {"error", "listen_failed"}};
+    }
+    if (opt.ready_signal) write_brain_ready(base_dir, opt.port, 1);
+
+    Aggregate agg;
+    std::vector<std::unique_ptr<HostSlot>> slots;
+    slots.reserve(n);
+    size_t capacity = opt.rate * static_cast<size_t>(opt.duration) + 16;
+
+    brain.set_frame_handler([&](int, const std::string& frame, uint64_t recv_ns) {
+        record(agg, slots, frame, "event", true, recv_ns);
+    });
+
+    // ------------------------------------------------------------------------
+    // Lanzamiento: todos a la vez, como un arranque de Chrome con N perfiles
+    // ------------------------------------------------------------------------
+    uint64_t launch_ns = now_ns();
+    for (size_t i = 0; i < n; ++i) {
+        auto slot = std::make_unique<HostSlot>();
+        slot->index      = i;
+        slot->profile_id = profile_for(run_index, i);
+        slot->launch_id  = "scale_" + std::to_string(run_index) + "_" + std::to_string(i);
+        slot->capacity   = capacity;
+        slot->c2b_sent.reset(new std::atomic<uint64_t>[capacity]());
+        slot->b2c_sent.reset(new std::atomic<uint64_t>[capacity]());
+        if (!slot->process.spawn(opt.host_binary,
+                                 host_args(slot->profile_id, slot->launch_id, base_dir, opt.port),
+                                 "/dev/null")) {
+            info << "✗ spawn failed at host " << i << "\n";
+            break;
+        }
+        slots.push_back(std::move(slot));
+    }
+
+    for (auto& slot : slots) {
+        HostSlot* s = slot.get();
+        s->chrome = std::make_unique<ChromeEmulator>(s->process, s->profile_id, s->launch_id);
+        s->chrome->start([&agg, &slots](const std::string& frame, uint64_t recv_ns) {
+            record(agg, slots, frame, "type", false, recv_ns);
+        });
+    }
+
+    std::vector<std::thread> handshakes;
+    std::atomic<size_t> handshake_failures{0};
+    for (auto& slot : slots) {
+        handshakes.emplace_back([&, s = slot.get()] {
+            if (!s->chrome->handshake(30000)) handshake_failures.fetch_add(1);
+        });
+    }
+    for (auto& t : handshakes) t.join();
+
+    bool all_connected = brain.wait_for_profiles(slots.size(), 30000);
+    double handshake_ms = (now_ns() - launch_ns) / 1e6;
+    size_t connected = 0;
+    for (auto& slot : slots) {
+        slot->conn = brain.connection_for_launch(slot->launch_id);
+        if (slot->conn >= 0) connected++;
+    }
+    info << "  N=" << n << ": " << connected << "/" << slots.size() << " connected in "
+         << static_cast<int>(handshake_ms) << " ms" << (all_connected ? "" : " (timeout)") << "\n";
+
+    // Reposo: dejar que terminen los threads detached del handshake y que
+    // pase al menos un keepalive.
+    std::this_thread::sleep_for(std::chrono::milliseconds(3500));
+    for (auto& slot : slots) slot->idle = sample_process(slot->process.pid());
+
+    // ------------------------------------------------------------------------
+    // Tráfico
+    // ------------------------------------------------------------------------
+    for (auto& slot : slots) slot->start = sample_process(slot->process.pid());
+    struct rusage self_before;
+    getrusage(RUSAGE_SELF, &self_before);
+
+    uint64_t traffic_start = now_ns();
+    uint64_t traffic_end   = traffic_start + static_cast<uint64_t>(opt.duration) * 1000000000ULL;
+    uint64_t period_ns     = 1000000000ULL / std::max<size_t>(1, opt.rate);
+
+    std::vector<std::thread> senders;
+    for (auto& slot : slots) {
+        if (slot->conn < 0) continue;
+        senders.emplace_back([&, s = slot.get()] {
+            // Desfase por host para no enviar todos en el mismo instante.
+            uint64_t next = traffic_start + (period_ns * s->index) / std::max<size_t>(1, slots.size());
+            size_t sent_c2b = 0, sent_b2c = 0;
+            for (size_t seq = 0; seq < s->capacity; ++seq) {
+                uint64_t now = now_ns();
+                if (next > now) std::this_thread::sleep_for(std::chrono::nanoseconds(next - now));
+                if (now_ns() >= traffic_end) break;
+
+                s->c2b_sent[seq].store(now_ns());
+                if (s->chrome->send(scale_message("event", s->index, seq, opt.size))) sent_c2b++;
+
+                s->b2c_sent[seq].store(now_ns());
+                if (brain.send(s->conn, scale_message("type", s->index, seq, opt.size))) sent_b2c++;
+
+                next += period_ns;
+            }
+            std::lock_guard<std::mutex> lock(agg.mutex);
+            agg.c2b_sent += sent_c2b;
+            agg.b2c_sent += sent_b2c;
+        });
+    }
+    for (auto& t : senders) t.join();
+
+    // Drenar lo que quede en vuelo
+    std::this_thread::sleep_for(std::chrono::milliseconds(1000));
+    double traffic_s = (now_ns() - traffic_start) / 1e9;
+    for (auto& slot : slots) slot->end = sample_process(slot->process.pid());
+    struct rusage self_after;
+    getrusage(RUSAGE_SELF, &self_after);
+
+    // ------------------------------------------------------------------------
+    // Agregados
+    // ------------------------------------------------------------------------
+    uint64_t rss_idle_sum = 0, rss_idle_max = 0, rss_load_sum = 0, rss_load_max = 0;
+    int      threads_idle_max = 0, threads_load_max = 0;
+    uint64_t threads_idle_sum = 0, threads_load_sum = 0;
+    uint64_t cpu_ns = 0, ctx_vol = 0, ctx_invol = 0;
+    size_t   sampled = 0;
+    for (auto& slot : slots) {
+        if (!slot->idle.ok || !slot->end.ok) continue;
+        sampled++;
+        rss_idle_sum     += slot->idle.rss_kb;
+        rss_idle_max      = std::max(rss_idle_max, slot->idle.rss_kb);
+        rss_load_sum     += slot->end.rss_kb;
+        rss_load_max      = std::max(rss_load_max, slot->end.rss_kb);
+        threads_idle_sum += static_cast<uint64_t>(slot->idle.threads);
+        threads_idle_max  = std::max(threads_idle_max, slot->idle.threads);
+        threads_load_sum += static_cast<uint64_t>(slot->end.threads);
+        threads_load_max  = std::max(threads_load_max, slot->end.threads);
+        cpu_ns           += slot->end.cpu_ns - slot->start.cpu_ns;
+        ctx_vol          += slot->end.ctx_voluntary - slot->start.ctx_voluntary;
+        ctx_invol        += slot->end.ctx_involuntary - slot->start.ctx_involuntary;
+    }
+    double per = sampled ? static_cast<double>(sampled) : 1.0;
+
+    auto tv_ns = [](const timeval& tv) {
+        return static_cast<uint64_t>(tv.tv_sec) * 1000000000ULL + static_cast<uint64_t>(tv.tv_usec) * 1000ULL;
+    };
+    uint64_t bench_cpu_ns = (tv_ns(self_after.ru_utime) + tv_ns(self_after.ru_stime)) -
+                            (tv_ns(self_before.ru_utime) + tv_ns(self_before.ru_stime));
+
+    json result;
+    {
+        std::lock_guard<std::mutex> lock(agg.mutex);
+        result = {
+            {"hosts",             n},
+            {"connected",         connected},
+            {"handshake_all_ms",  handshake_ms},
+            {"handshake_failures", handshake_failures.load()},
+            {"traffic_s",         traffic_s},
+            {"rss_kb", {
+                {"idle_avg", rss_idle_sum / per}, {"idle_max", rss_idle_max},
+                {"load_avg", rss_load_sum / per}, {"load_max", rss_load_max}
+            }},
+            {"threads", {
+                {"idle_avg", threads_idle_sum / per}, {"idle_max", threads_idle_max},
+                {"load_avg", threads_load_sum / per}, {"load_max", threads_load_max}
+            }},
+            {"ctx_switches_per_host_per_s", {
+                {"voluntary",   ctx_vol / per / traffic_s},
+                {"involuntary", ctx_invol / per / traffic_s}
+            }},
+            {"cpu", {
+                {"hosts_total_pct",  100.0 * (cpu_ns / 1e9) / traffic_s},
+                {"per_host_pct",     100.0 * (cpu_ns / 1e9) / traffic_s / per},
+                {"bench_process_pct", 100.0 * (bench_cpu_ns / 1e9) / traffic_s}
+            }},
+            {"chrome_to_brain", latency_json(agg.c2b, agg.c2b_sent)},
+            {"brain_to_chrome", latency_json(agg.b2c, agg.b2c_sent)}
+        };
+    }
+
+    if (opt.restart_down_ms > 0 && connected > 0) {
+        result["restart"] = run_restart(opt, brain, reborn, base_dir, connected, info);
+    }
+
+    // ------------------------------------------------------------------------
+    // Cierre en paralelo: todos ven STDIN_EOF a la vez
+    // ------------------------------------------------------------------------
+    for (auto& slot : slots) slot->process.close_stdin();
+    for (auto& slot : slots) slot->process.shutdown(15000);
+    for (auto& slot : slots) slot->chrome->join();
+    brain.stop();
+    if (reborn) reborn->stop();
+
+    std::error_code ec;
+    std::filesystem::remove_all(base_dir, ec);
+    return result;
+}
+
+void print_table(const json& runs) {
+    std::printf("%6s %9s %10s %10s %8s %10s %10s %10s %11s %11s %11s %10s %10s %6s\n",
+                "hosts", "conn", "hs_all_ms", "rss_kb", "threads", "cpu_%", "ctxsw/h/s",
+                "c2b_lost", "c2b_p99_us", "b2c_p99_us", "b2c_p999_us", "rc_p50_ms", "rc_max_ms", "herd");
+    for (const auto& r : runs) {
+        if (r.contains("error")) continue;
+        double rc_p50 = -1, rc_max = -1;
+        size_t herd = 0;
+        if (r.contains("restart") && r["restart"].contains("reconnect_ms")) {
+            rc_p50 = r["restart"]["reconnect_ms"]["p50"].get<double>();
+            rc_max = r["restart"]["reconnect_ms"]["max"].get<double>();
+            herd   = r["restart"]["herd_peak_per_100ms"].get<size_t>();
+        }
+        std::printf("%6zu %9zu %10.0f %10.0f %8.1f %10.1f %10.1f %10zu %11.1f %11.1f %11.1f %10.0f %10.0f %6zu\n",
+                    r["hosts"].get<size_t>(),
+                    r["connected"].get<size_t>(),
+                    r["handshake_all_ms"].get<double>(),
+                    r["rss_kb"]["load_avg"].get<double>(),
+                    r["threads"]["idle_avg"].get<double>(),
+                    r["cpu"]["hosts_total_pct"].get<double>(),
+                    r["ctx_switches_per_host_per_s"]["voluntary"].get<double>() +
+                        r["ctx_switches_per_host_per_s"]["involuntary"].get<double>(),
+                    r["chrome_to_brain"]["sent"].get<size_t>() - r["chrome_to_brain"]["delivered"].get<size_t>(),
+                    r["chrome_to_brain"]["p99_us"].get<double>(),
+                    r["brain_to_chrome"]["p99_us"].get<double>(),
+                    r["brain_to_chrome"]["p999_us"].get<double>(),
+                    rc_p50, rc_max, herd);
+    }
+}
+
+bool parse_options(int argc, char* argv[], Options& o) {
+    for (int i = 1; i < argc; ++i) {
+        std::string a = argv[i];
+        auto next = [&](std::string& out) {
+            if (i + 1 >= argc) return false;
+            out = argv[++i];
+            return true;
+        };
+        std::string v;
+        if      (a == "--host"     && next(v)) o.host_binary = v;
+        else if (a == "--port"     && next(v)) o.port        = std::atoi(v.c_str());
+        else if (a == "--hosts"    && next(v)) o.hosts       = parse_size_list(v);
+        else if (a == "--rate"     && next(v)) o.rate        = std::strtoull(v.c_str(), nullptr, 10);
+        else if (a == "--size"     && next(v)) { auto s = parse_size_list(v); if (!s.empty()) o.size = s[0]; }
+        else if (a == "--duration" && next(v)) o.duration    = std::max(1, std::atoi(v.c_str()));
+        else if (a == "--restart-down-ms" && next(v)) o.restart_down_ms = std::max(0, std::atoi(v.c_str()));
+        else if (a == "--out"      && next(v)) o.out_path    = v;
+        else if (a == "--no-ready-signal") o.ready_signal = false;
+        else if (a == "--json") o.json_only = true;
+        else return false;
+    }
+    return !o.host_binary.empty() && !o.hosts.empty() && o.port > 0 && o.port < 65536 &&
+           o.rate > 0 && o.size < 1020000;
+}
+
+}  // namespace
+
+// ============================================================================
+// MAIN
+// ============================================================================
+
+int main(int argc, char* argv[]) {
+    Options opt;
+    if (!parse_options(argc, argv, opt)) {
+        std::cerr <<
+            "Usage: bloom-host-scale --host <path/to/bloom-host> [options]\n"
+            "  --hosts LIST     host counts to run, e.g. 10,50,200\n"
+            "  --port N         mock Brain port (default 15678)\n"
+            "  --rate N         messages/s per host in each direction (default 20)\n"
+            "  --size N         message size in bytes (default 1024, < 1020000)\n"
+            "  --duration S     traffic phase per run in seconds (default 10)\n"
+            "  --restart-down-ms N  Brain downtime in the restart phase, 0 to skip (default 3000)\n"
+            "  --no-ready-signal    restart without publishing workers/brain/brain.ready\n"
+            "  --json           print only the JSON report on stdout\n"
+            "  --out FILE       also write the JSON report to FILE\n";
+        return 2;
+    }
+
+    std::ostream& info = opt.json_only ? std::cerr : std::cout;
+    raise_fd_limit();
+
+    json runs = json::array();
+    for (size_t i = 0; i < opt.hosts.size(); ++i) {
+        runs.push_back(run_scale(opt, i, opt.hosts[i], info));
+    }
+
+    json report = {
+        {"bench",       "bloom-host-scale"},
+        {"host_binary", opt.host_binary},
+        {"rate",        opt.rate},
+        {"size",        opt.size},
+        {"duration_s",  opt.duration},
+        {"restart_down_ms", opt.restart_down_ms},
+        {"ready_signal", opt.ready_signal},
+        {"runs",        runs}
+    };
+
+    if (opt.json_only) {
+        std::cout << report.dump(2) << std::endl;
+    } else {
+        std::cout << "\n";
+        print_table(runs);
+    }
+
+    if (!opt.out_path.empty()) {
+        std::ofstream out(opt.out_path);
+        out << report.dump(2) << std::endl;
+        if (!out) {
+            std::cerr << "✗ Cannot write " << opt.out_path << "\n";
+            return 1;
+        }
+    }
+    return 0;
+}
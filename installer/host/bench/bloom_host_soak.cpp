@@ -0,0 +1,494 @@
+// ============================================================================
+// bloom-host-soak
+//
+// Soak de larga duración: un host vive lo que vive un perfil de Chrome (días).
+// Las fugas lentas (active_buffers abandonados, pending_queue del logger,
+// descriptores, fragmentación del heap) solo aparecen después de horas.
+//
+// Carga mixta sintética contra un único host durante --duration:
+//   - chrome_to_brain  --rate msg/s, tamaños rotando 256 / 4K / 64K
+//   - brain_to_chrome  --rate/2 msg/s, mismos tamaños
+//   - chunked upload   un mensaje de --chunked-size cada --chunked-every segundos
+//   - PING             uno por segundo
+//   - uploads abandonados (--abandoned N): header + primer data sin footer, N por intervalo
+//
+// Cada --interval segundos el mock Brain envía REQUEST_STATS y el host responde
+// STATS_RESPONSE (RSS, heap, fds, threads, active_chunk_buffers, colas). Con eso
+// se arma la serie temporal (--csv para graficar) y se evalúa el drift contra la
+// línea base tomada al terminar --warmup:
+//
+//   rss / heap_in_use   crecimiento % de la mediana de las 3 últimas muestras
+//   open_fds            crecimiento absoluto
+//   colas y buffers     mínimo de las 3 últimas muestras por encima de la base
+//
+// Sale con código 1 si algún umbral se excede.
+//
+// Uso:
+//   bloom-host-soak --host <path/bloom-host> [--duration 10m] [--interval 10]
+//                   [--warmup 30] [--rate 50] [--chunked-size 1M] [--chunked-every 5]
+//                   [--abandoned 0] [--max-rss-growth 10] [--max-heap-growth 10]
+//                   [--max-fd-growth 2] [--csv FILE] [--json] [--out FILE]
+// ============================================================================
+
+#include "bench_common.h"
+
+#include <nlohmann/json.hpp>
+
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+using json = nlohmann::json;
+using namespace Bench;
+
+namespace {
+
+const char* SOAK_PROFILE_ID = "50a50a50-0000-4000-8000-000000000057";
+const char* SOAK_LAUNCH_ID  = "001_soak";
+
+const size_t SOAK_SIZES[] = {256, 4096, 65536};
+const int    STATS_TIMEOUT_MS = 5000;
+const size_t TAIL_SAMPLES     = 3;
+
+struct Options {
+    std::string host_binary;
+    int         port            = 15678;
+    int         duration_s      = 600;
+    int         interval_s      = 10;
+    int         warmup_s        = 30;
+    size_t      rate            = 50;
+    size_t      chunked_size    = 1048576;
+    int         chunked_every_s = 5;
+    size_t      abandoned       = 0;
+    double      max_rss_growth  = 10.0;   // %
+    double      max_heap_growth = 10.0;   // %
+    int64_t     max_fd_growth   = 2;
+    bool        json_only       = false;
+    std::string csv_path;
+    std::string out_path;
+};
+
+struct Sample {
+    double  t_s                  = 0;
+    int64_t rss_kb               = -1;
+    int64_t heap_in_use          = -1;
+    int64_t heap_free            = -1;
+    int64_t open_fds             = -1;
+    int64_t threads              = -1;
+    int64_t active_chunk_buffers = -1;
+    int64_t chunk_buffered_bytes = -1;
+    int64_t pending_queue        = -1;
+    int64_t log_pending_queue    = -1;
+    int64_t host_sent            = -1;
+    int64_t host_received        = -1;
+    uint64_t c2b_sent = 0, c2b_delivered = 0;
+    uint64_t b2c_sent = 0, b2c_delivered = 0;
+};
+
+/** Columnas de la serie temporal, en el orden del CSV. */
+const char* const COLUMNS[] = {
+    "t_s", "rss_kb", "heap_in_use", "heap_free", "open_fds", "threads",
+    "active_chunk_buffers", "chunk_buffered_bytes", "pending_queue", "log_pending_queue",
+    "host_sent", "host_received", "c2b_sent", "c2b_delivered", "b2c_sent", "b2c_delivered"
+};
+
+json sample_json(const Sample& s) {
+    return json::array({s.t_s, s.rss_kb, s.heap_in_use, s.heap_free, s.open_fds, s.threads,
+                        s.active_chunk_buffers, s.chunk_buffered_bytes, s.pending_queue,
+                        s.log_pending_queue, s.host_sent, s.host_received,
+                        s.c2b_sent, s.c2b_delivered, s.b2c_sent, s.b2c_delivered});
+}
+
+int64_t get_int(const json& obj, const char* key) {
+    auto it = obj.find(key);
+    return (it != obj.end() && it->is_number()) ? it->get<int64_t>() : -1;
+}
+
+/** "600", "30s", "10m", "2h" → segundos. */
+int parse_duration(const std::string& v) {
+    if (v.empty()) return -1;
+    int mult = 1;
+    char unit = v.back();
+    if (unit == 's') mult = 1;
+    else if (unit == 'm') mult = 60;
+    else if (unit == 'h') mult = 3600;
+    std::string digits = (unit >= '0' && unit <= '9') ? v : v.substr(0, v.size() - 1);
+    return std::atoi(digits.c_str()) * mult;
+}
+
+bool parse_options(int argc, char* argv[], Options& o) {
+    for (int i = 1; i < argc; ++i) {
+        std::string a = argv[i];
+        auto next = [&](std::string& out) {
+            if (i + 1 >= argc) return false;
+            out = argv[++i];
+            return true;
+        };
+        std::string v;
+        if      (a == "--host"            && next(v)) o.host_binary     = v;
+        else if (a == "--port"            && next(v)) o.port            = std::atoi(v.c_str());
+        else if (a == "--duration"        && next(v)) o.duration_s      = parse_duration(v);
+        else if (a == "--interval"        && next(v)) o.interval_s      = parse_duration(v);
+        else if (a == "--warmup"          && next(v)) o.warmup_s        = parse_duration(v);
+        else if (a == "--rate"            && next(v)) o.rate            = std::strtoull(v.c_str(), nullptr, 10);
+        else if (a == "--chunked-every"   && next(v)) o.chunked_every_s = parse_duration(v);
+        else if (a == "--abandoned"       && next(v)) o.abandoned       = std::strtoull(v.c_str(), nullptr, 10);
+        else if (a == "--max-rss-growth"  && next(v)) o.max_rss_growth  = std::atof(v.c_str());
+        else if (a == "--max-heap-growth" && next(v)) o.max_heap_growth = std::atof(v.c_str());
+        else if (a == "--max-fd-growth"   && next(v)) o.max_fd_growth   = std::atoll(v.c_str());
+        else if (a == "--csv"             && next(v)) o.csv_path        = v;
+        else if (a == "--out"             && next(v)) o.out_path        = v;
+        else if (a == "--chunked-size"    && next(v)) { auto s = parse_size_list(v); o.chunked_size = s.empty() ? 0 : s[0]; }
+        else if (a == "--json") o.json_only = true;
+        else return false;
+    }
+    return !o.host_binary.empty() && o.duration_s > 0 && o.interval_s > 0 && o.warmup_s >= 0 &&
+           o.warmup_s < o.duration_s && o.chunked_every_s > 0 && o.port > 0 && o.port < 65536;
+}
+
+// ============================================================================
+// EVALUACIÓN DE DRIFT
+// ============================================================================
+
+int64_t tail_median(const std::vector<Sample>& s, int64_t Sample::*field) {
+    std::vector<int64_t> v;
+    for (size_t i = s.size() - std::min(TAIL_SAMPLES, s.size()); i < s.size(); ++i) v.push_back(s[i].*field);
+    std::sort(v.begin(), v.end());
+    return v[v.size() / 2];
+}
+
+int64_t tail_min(const std::vector<Sample>& s, int64_t Sample::*field) {
+    int64_t m = INT64_MAX;
+    for (size_t i = s.size() - std::min(TAIL_SAMPLES, s.size()); i < s.size(); ++i) m = std::min(m, s[i].*field);
+    return m;
+}
+
+/** Pendiente por mínimos cuadrados, en unidades/hora, sobre las muestras post-warmup. */
+double slope_per_hour(const std::vector<Sample>& s, size_t from, int64_t Sample::*field) {
+    double n = 0, sx = 0, sy = 0, sxx = 0, sxy = 0;
+    for (size_t i = from; i < s.size(); ++i) {
+        if (s[i].*field < 0) continue;
+        double x = s[i].t_s / 3600.0, y = static_cast<double>(s[i].*field);
+        n++; sx += x; sy += y; sxx += x * x; sxy += x * y;
+    }
+    double den = n * sxx - sx * sx;
+    return (n < 2 || den == 0) ? 0.0 : (n * sxy - sx * sy) / den;
+}
+
+struct Check {
+    std::string metric;
+    double      baseline;
+    double      final_value;
+    double      growth;
+    double      limit;
+    bool        passed;
+};
+
+json check_json(const Check& c) {
+    return {{"metric", c.metric}, {"baseline", c.baseline}, {"final", c.final_value},
+            {"growth", c.growth}, {"limit", c.limit}, {"passed", c.passed}};
+}
+
+std::vector<Check> evaluate(const std::vector<Sample>& s, size_t base_index, const Options& opt) {
+    std::vector<Check> checks;
+    const Sample& base = s[base_index];
+
+    auto pct_check = [&](const char* name, int64_t Sample::*field, double limit) {
+        if (base.*field <= 0 || tail_min(s, field) < 0) return;
+        double final_value = static_cast<double>(tail_median(s, field));
+        double growth = (final_value - base.*field) * 100.0 / base.*field;
+        checks.push_back({std::string(name) + "_growth_pct", double(base.*field), final_value, growth, limit,
+                          growth <= limit});
+    };
+    auto abs_check = [&](const char* name, int64_t Sample::*field, double limit, bool use_min) {
+        if (base.*field < 0 || tail_min(s, field) < 0) return;
+        double final_value = static_cast<double>(use_min ? tail_min(s, field) : tail_median(s, field));
+        double growth = final_value - base.*field;
+        checks.push_back({name, double(base.*field), final_value, growth, limit, growth <= limit});
+    };
+
+    pct_check("rss_kb",      &Sample::rss_kb,      opt.max_rss_growth);
+    pct_check("heap_in_use", &Sample::heap_in_use, opt.max_heap_growth);
+    abs_check("open_fds",             &Sample::open_fds,             double(opt.max_fd_growth), false);
+    abs_check("threads",              &Sample::threads,              0, false);
+    abs_check("active_chunk_buffers", &Sample::active_chunk_buffers, 0, true);
+    abs_check("pending_queue",        &Sample::pending_queue,        0, true);
+    abs_check("log_pending_queue",    &Sample::log_pending_queue,    0, true);
+    return checks;
+}
+
+}  // namespace
+
+// ============================================================================
+// MAIN
+// ============================================================================
+
+int main(int argc, char* argv[]) {
+    Options opt;
+    if (!parse_options(argc, argv, opt)) {
+        std::cerr <<
+            "Usage: bloom-host-soak --host <path/to/bloom-host> [options]\n"
+            "  --duration T         total soak time: 600, 30s, 10m, 2h (default 10m)\n"
+            "  --interval T         sampling interval (default 10s)\n"
+            "  --warmup T           time before the baseline sample (default 30s)\n"
+            "  --rate N             chrome_to_brain msg/s; brain_to_chrome runs at N/2 (default 50)\n"
+            "  --chunked-size N     chunked upload size, 0 to skip (default 1M)\n"
+            "  --chunked-every T    seconds between chunked uploads (default 5)\n"
+            "  --abandoned N        abandoned chunked uploads per interval (default 0)\n"
+            "  --max-rss-growth P   max RSS growth %% after warmup (default 10)\n"
+            "  --max-heap-growth P  max heap-in-use growth %% after warmup (default 10)\n"
+            "  --max-fd-growth N    max open fd growth after warmup (default 2)\n"
+            "  --port N             mock Brain port (default 15678)\n"
+            "  --csv FILE           write the time series as CSV\n"
+            "  --json               print only the JSON report on stdout\n"
+            "  --out FILE           also write the JSON report to FILE\n";
+        return 2;
+    }
+    std::ostream& info = opt.json_only ? std::cerr : std::cout;
+
+    std::string base_dir = make_temp_dir("bloom-host-soak-");
+    MockBrain brain(opt.port);
+    if (!brain.start()) {
+        std::cerr << "✗ Cannot listen on 127.0.0.1:" << opt.port << "\n";
+        return 1;
+    }
+
+    // ------------------------------------------------------------------------
+    // Receptores: conteo de entregas + STATS_RESPONSE
+    // ------------------------------------------------------------------------
+    std::atomic<uint64_t> c2b_sent{0}, c2b_delivered{0}, b2c_sent{0}, b2c_delivered{0};
+    std::mutex              stats_mutex;
+    std::condition_variable stats_cv;
+    json                    last_stats;
+    int64_t                 last_stats_id = -1;
+
+    brain.set_frame_handler([&](int, const std::string& frame, uint64_t) {
+        std::string type = extract_string_field(frame, "type");
+        if (type == "STATS_RESPONSE") {
+            json msg = json::parse(frame, nullptr, false);
+            if (!msg.is_object()) return;
+            std::lock_guard<std::mutex> lock(stats_mutex);
+            last_stats    = msg.value("stats", json::object());
+            last_stats_id = msg.value("request_id", int64_t(-1));
+            stats_cv.notify_all();
+        } else if (extract_string_field(frame, "event").compare(0, 4, "SOAK") == 0) {
+            c2b_delivered.fetch_add(1);
+        }
+    });
+
+    HostProcess host;
+    if (!host.spawn(opt.host_binary, host_args(SOAK_PROFILE_ID, SOAK_LAUNCH_ID, base_dir, opt.port),
+                    "/dev/null")) {
+        std::cerr << "✗ Cannot spawn " << opt.host_binary << "\n";
+        return 1;
+    }
+    ChromeEmulator chrome(host, SOAK_PROFILE_ID, SOAK_LAUNCH_ID);
+    chrome.start([&](const std::string& frame, uint64_t) {
+        if (extract_string_field(frame, "type") == "SOAK") b2c_delivered.fetch_add(1);
+    });
+
+    if (!chrome.handshake(10000) || !brain.wait_for_profiles(1, 10000)) {
+        std::cerr << "✗ Handshake did not complete\n";
+        host.shutdown(2000);
+        brain.stop();
+        return 1;
+    }
+    int conn = brain.profile_connections().front();
+
+    info << "✓ Soak: " << opt.duration_s << "s, sample every " << opt.interval_s << "s, warmup "
+         << opt.warmup_s << "s, " << opt.rate << " msg/s c2b + " << opt.rate / 2 << " msg/s b2c\n";
+
+    // ------------------------------------------------------------------------
+    // Carga: ticks de 10ms, emisiones repartidas por acumulación fraccional
+    // ------------------------------------------------------------------------
+    std::atomic<bool> running{true};
+    uint64_t start_ns = now_ns();
+
+    std::thread workload([&] {
+        const uint64_t tick_ns = 10000000ULL;
+        double c2b_credit = 0, b2c_credit = 0;
+        uint64_t seq = 0, uploads = 0, last_ping_s = 0, last_upload_s = 0, last_abandon_s = 0;
+        uint64_t next_tick = now_ns();
+
+        while (running.load()) {
+            next_tick += tick_ns;
+            c2b_credit += opt.rate * 0.01;
+            b2c_credit += opt.rate * 0.005;
+
+            while (c2b_credit >= 1.0 && running.load()) {
+                c2b_credit -= 1.0;
+                size_t size = SOAK_SIZES[seq % 3];
+                if (!chrome.send(make_message("event", "SOAK", seq++, size))) { running = false; break; }
+                c2b_sent.fetch_add(1);
+            }
+            while (b2c_credit >= 1.0 && running.load()) {
+                b2c_credit -= 1.0;
+                size_t size = SOAK_SIZES[seq % 3];
+                if (!brain.send(conn, make_message("type", "SOAK", seq++, size))) { running = false; break; }
+                b2c_sent.fetch_add(1);
+            }
+
+            uint64_t elapsed_s = (now_ns() - start_ns) / 1000000000ULL;
+            if (elapsed_s != last_ping_s) {
+                last_ping_s = elapsed_s;
+                brain.ping(conn);
+            }
+            if (opt.chunked_size > 0 && elapsed_s - last_upload_s >= static_cast<uint64_t>(opt.chunked_every_s)) {
+                last_upload_s = elapsed_s;
+                std::string id = "soak-" + std::to_string(uploads++);
+                if (chrome.send_chunked(make_message("event", "SOAK_CHUNKED", seq++, opt.chunked_size), id, 256 * 1024)) {
+                    c2b_sent.fetch_add(1);
+                }
+            }
+            if (opt.abandoned > 0 && elapsed_s - last_abandon_s >= static_cast<uint64_t>(opt.interval_s)) {
+                last_abandon_s = elapsed_s;
+                for (size_t i = 0; i < opt.abandoned; ++i) {
+                    std::string id = "soak-abandoned-" + std::to_string(uploads++);
+                    chrome.send_chunked(make_message("event", "SOAK_ABANDONED", seq++, 512 * 1024), id, 128 * 1024, true);
+                }
+            }
+
+            uint64_t now = now_ns();
+            if (next_tick > now) {
+                std::this_thread::sleep_for(std::chrono::nanoseconds(next_tick - now));
+            } else {
+                next_tick = now;   // atrasados: no acumular ráfagas
+            }
+        }
+    });
+
+    // ------------------------------------------------------------------------
+    // Muestreo
+    // ------------------------------------------------------------------------
+    std::ofstream csv;
+    if (!opt.csv_path.empty()) {
+        csv.open(opt.csv_path);
+        for (size_t i = 0; i < std::size(COLUMNS); ++i) csv << (i ? "," : "") << COLUMNS[i];
+        csv << "\n";
+    }
+    if (!opt.json_only) {
+        std::printf("%8s %10s %12s %6s %7s %8s %8s %8s %10s %10s\n", "t_s", "rss_kb", "heap_in_use",
+                    "fds", "threads", "chunks", "pending", "log_pend", "c2b_deliv", "b2c_deliv");
+    }
+
+    std::vector<Sample> samples;
+    size_t base_index = SIZE_MAX;
+    bool host_alive = true;
+    for (int64_t k = 0; host_alive; ++k) {
+        uint64_t due = start_ns + static_cast<uint64_t>(k) * opt.interval_s * 1000000000ULL;
+        if (due > start_ns + static_cast<uint64_t>(opt.duration_s) * 1000000000ULL) break;
+        uint64_t now = now_ns();
+        if (due > now) std::this_thread::sleep_for(std::chrono::nanoseconds(due - now));
+
+        brain.send(conn, "{\"type\":\"REQUEST_STATS\",\"request_id\":" + std::to_string(k) + "}");
+        json stats;
+        {
+            std::unique_lock<std::mutex> lock(stats_mutex);
+            if (!stats_cv.wait_for(lock, std::chrono::milliseconds(STATS_TIMEOUT_MS),
+                                   [&] { return last_stats_id == k; })) {
+                info << "✗ No STATS_RESPONSE for sample " << k << " (host dead or unresponsive)\n";
+                host_alive = false;
+                break;
+            }
+            stats = last_stats;
+        }
+
+        Sample s;
+        s.t_s = (now_ns() - start_ns) / 1e9;
+        json process = stats.value("process", json::object());
+        s.rss_kb               = get_int(process, "rss_kb");
+        s.heap_in_use          = get_int(process, "heap_in_use_bytes");
+        s.heap_free            = get_int(process, "heap_free_bytes");
+        s.open_fds             = get_int(process, "open_fds");
+        s.threads              = get_int(process, "threads");
+        s.active_chunk_buffers = get_int(stats, "active_chunk_buffers");
+        s.chunk_buffered_bytes = get_int(stats, "chunk_buffered_bytes");
+        s.pending_queue        = get_int(stats, "pending_queue");
+        s.log_pending_queue    = get_int(stats, "log_pending_queue");
+        s.host_sent            = get_int(stats, "messages_sent");
+        s.host_received        = get_int(stats, "messages_received");
+        s.c2b_sent = c2b_sent.load();  s.c2b_delivered = c2b_delivered.load();
+        s.b2c_sent = b2c_sent.load();  s.b2c_delivered = b2c_delivered.load();
+        if (s.rss_kb < 0) {
+            ProcSample p = sample_process(host.pid());
+            if (p.ok) s.rss_kb = static_cast<int64_t>(p.rss_kb);
+        }
+        samples.push_back(s);
+        if (base_index == SIZE_MAX && s.t_s >= opt.warmup_s) base_index = samples.size() - 1;
+
+        if (csv.is_open()) {
+            json row = sample_json(s);
+            for (size_t i = 0; i < row.size(); ++i) csv << (i ? "," : "") << row[i].dump();
+            csv << "\n" << std::flush;
+        }
+        if (!opt.json_only) {
+            std::printf("%8.1f %10lld %12lld %6lld %7lld %8lld %8lld %8lld %10llu %10llu\n", s.t_s,
+                        (long long)s.rss_kb, (long long)s.heap_in_use, (long long)s.open_fds,
+                        (long long)s.threads, (long long)s.active_chunk_buffers, (long long)s.pending_queue,
+                        (long long)s.log_pending_queue, (unsigned long long)s.c2b_delivered,
+                        (unsigned long long)s.b2c_delivered);
+            std::fflush(stdout);
+        }
+    }
+
+    running = false;
+    workload.join();
+    host.shutdown(15000);
+    chrome.join();
+    brain.stop();
+    std::error_code ec;
+    std::filesystem::remove_all(base_dir, ec);
+
+    // ------------------------------------------------------------------------
+    // Veredicto
+    // ------------------------------------------------------------------------
+    json report = {
+        {"bench",      "bloom-host-soak"},
+        {"duration_s", opt.duration_s},
+        {"interval_s", opt.interval_s},
+        {"warmup_s",   opt.warmup_s},
+        {"rate",       opt.rate},
+        {"abandoned_per_interval", opt.abandoned},
+        {"columns",    json(std::vector<std::string>(std::begin(COLUMNS), std::end(COLUMNS)))},
+        {"samples",    json::array()}
+    };
+    for (const auto& s : samples) report["samples"].push_back(sample_json(s));
+
+    bool passed = host_alive;
+    if (base_index == SIZE_MAX || base_index + 1 >= samples.size()) {
+        report["error"] = host_alive ? "not_enough_samples_after_warmup" : "host_unresponsive";
+        passed = false;
+    } else {
+        report["baseline_t_s"] = samples[base_index].t_s;
+        report["slope_per_hour"] = {
+            {"rss_kb",      slope_per_hour(samples, base_index, &Sample::rss_kb)},
+            {"heap_in_use", slope_per_hour(samples, base_index, &Sample::heap_in_use)},
+            {"open_fds",    slope_per_hour(samples, base_index, &Sample::open_fds)}
+        };
+        report["checks"] = json::array();
+        for (const auto& c : evaluate(samples, base_index, opt)) {
+            report["checks"].push_back(check_json(c));
+            if (!c.passed) passed = false;
+            if (!opt.json_only) {
+                std::printf("%s %-26s base=%.0f final=%.0f growth=%.2f limit=%.2f\n",
+                            c.passed ? "✓" : "✗", c.metric.c_str(), c.baseline, c.final_value,
+                            c.growth, c.limit);
+            }
+        }
+        if (!host_alive) report["error"] = "host_unresponsive";
+    }
+    report["passed"] = passed;
+
+    if (opt.json_only) {
+        std::cout << report.dump(2) << std::endl;
+    } else {
+        std::printf("%s\n", passed ? "SOAK PASSED" : "SOAK FAILED");
+    }
+    if (!opt.out_path.empty()) {
+        std::ofstream out(opt.out_path);
+        out << report.dump(2) << std::endl;
+    }
+    return passed ? 0 : 1;
+}
@@ -7,10 +7,28 @@
 #include <chrono>
 #include <queue>
 #include <condition_variable>
+#include <cstring>
 #include <nlohmann/json.hpp>
 
 #include "synapse_logger.h"
 #include "chunked_buffer.h"
+#include "alloc_tracker.h"
+#include "cpu_profiler.h"
+#include "message_utils.h"
+#include "traffic_capture.h"
+#include "outbound_scheduler.h"
+#include "flow_control.h"
+#include "reconnect_policy.h"
+#include "link_liveness.h"
+#include "admission_control.h"
+#include "extension_logs.h"
+#include "request_tracker.h"
+#include "dedup_filter.h"
+#include "delta_encoder.h"
+#include "projection.h"
+#include "subscription_filter.h"
+#include "splice_forward.h"
+#include "frame_validator.h"
 #include "platform_utils.h"
 #include "build_info.h"
 #include "cli_parser.h"
@@ -26,11 +44,29 @@ const int BUILD = BUILD_NUMBER;
 const int SERVICE_PORT = 5678;
 const size_t MAX_MESSAGE_SIZE = 50 * 1024 * 1024;
 const size_t MAX_CHROME_MSG_SIZE = 1020000; // � MURO DE 1MB (con margen de seguridad)
-const int RECONNECT_DELAY_MS = 500;
+const int RECONNECT_DELAY_MS = 500;                          // base del backoff con jitter
+const int RECONNECT_MAX_DELAY_MS = 16000;
+const int RECONNECT_READY_SPREAD_MS = 100;                  // dispersión tras brain.ready
+const int BRAIN_DEAD_PEER_MS = 10000;                       // silencio máximo de Brain (--brain-dead-ms)
 const size_t MAX_QUEUED_MESSAGES = 500;
 const int MAX_IDENTITY_WAIT_MS = 10000;
 const int HEARTBEAT_INTERVAL_SEC = 10;
 const int CHROME_KEEPALIVE_INTERVAL_MS = 3000; // < 6s Chrome NM idle timeout
+const size_t CPU_TOP_N = 10;                   // tipos de mensaje reportados en HEARTBEAT / shutdown
+const size_t OUTBOUND_CHROME_MAX_BULK = 8 * 1024 * 1024;   // backpressure BULK hacia Chrome
+const size_t OUTBOUND_BRAIN_MAX_BULK = 64 * 1024 * 1024;   // admite un upload reensamblado de 50MB
+const int OUTBOUND_DRAIN_MS = 500;                          // flush de colas en shutdown
+const uint64_t FLOW_WINDOW_BYTES = OUTBOUND_CHROME_MAX_BULK; // crédito que el host otorga a Brain
+const uint64_t FLOW_WINDOW_FRAMES = 256;
+const uint64_t ADMISSION_BACKLOG_BYTES = OUTBOUND_BRAIN_MAX_BULK / 4; // BULK hacia Brain = sobrecarga
+const size_t EXTENSION_LOG_MAX_QUEUED = 4 * 1024 * 1024;    // LOG_ENTRY pendientes de escribir a disco
+const int REQUEST_TIMEOUT_MS = 30000;                       // deadline de un comando con id (--request-timeout-ms)
+const size_t REQUEST_TABLE_SLOTS = 1024;                    // requests pendientes: hasta 3/4 de esto
+const size_t DELTA_SNAPSHOT_EVERY = 32;                     // deltas seguidos por key antes de un snapshot
+const uint32_t DELTA_SNAPSHOT_INTERVAL_MS = 10000;          // snapshot por key al menos cada 10s
+const size_t DELTA_MAX_KEYS = 256;                          // documentos recordados (se olvida el más viejo)
+const size_t SPLICE_MIN_BYTES = 256 * 1024;                 // umbral de --splice on (desactivado por defecto)
+const size_t SPLICE_PREFIX_BYTES = 4096;                    // prefijo leído para decidir la ruta
 
 // ============================================================================
 // HANDSHAKE DE 3 FASES
@@ -56,6 +92,10 @@ std::mutex service_mutex;  // protege escrituras concurrentes al socket TCP de B
 std::atomic<bool> shutdown_requested{false};
 std::atomic<bool> identity_resolved{false};
 
+// Puerto de Brain. SERVICE_PORT salvo override --service-port (benchmarks con
+// mock Brain en paralelo a un Brain real). Se fija en main() antes de los threads.
+int g_service_port = SERVICE_PORT;
+
 std::string g_profile_id = "";
 std::string g_launch_id = "";
 std::string g_extension_id = "";
@@ -72,45 +112,18 @@ std::atomic<uint64_t> g_heartbeat_count{0};
 std::atomic<uint64_t> g_messages_sent{0};
 std::atomic<uint64_t> g_messages_received{0};
 
+// <base_dir>/workers/brain/brain.ready (reconnect_policy.h). Se fija en main()
+// antes de lanzar el thread TCP; vacío = solo backoff.
+std::string g_brain_ready_file;
+
+const auto g_process_start = std::chrono::steady_clock::now();
+
 // ============================================================================
-// HELPERS SEGUROS PARA JSON
+// HELPERS SEGUROS PARA JSON (message_utils.h)
 // ============================================================================
 
-std::string json_get_string_safe(const json& j, const std::string& key, const std::string& fallback = "") {
-    try {
-        if (!j.contains(key)) return fallback;
-        
-        const auto& val = j[key];
-        
-        if (val.is_string()) {
-            return val.get<std::string>();
-        } else if (val.is_number_integer()) {
-            return std::to_string(val.get<int64_t>());
-        } else if (val.is_number_float()) {
-            return std::to_string(val.get<double>());
-        } else if (val.is_boolean()) {
-            return val.get<bool>() ? "true" : "false";
-        }
-        
-        return fallback;
-    } catch (const std::exception& e) {
-        std::cerr << "[JSON_SAFE] Error extracting '" << key << "': " << e.what() << std::endl;
-        return fallback;
-    }
-}
-
-std::string json_value_to_string(const json& val) {
-    try {
-        if (val.is_string()) return val.get<std::string>();
-        if (val.is_number_integer()) return std::to_string(val.get<int64_t>());
-        if (val.is_number_float()) return std::to_string(val.get<double>());
-        if (val.is_boolean()) return val.get<bool>() ? "true" : "false";
-        if (val.is_null()) return "";
-        return val.dump();
-    } catch (...) {
-        return "";
-    }
-}
+using MessageUtils::json_get_string_safe;
+using MessageUtils::message_kind;
 
 uint64_t get_timestamp_ms() {
     auto now = std::chrono::system_clock::now();
@@ -135,43 +148,184 @@ static std::string get_default_base_dir() {
 // FUNCIONES DE COMUNICACIÓN - CON VALIDACIÓN DE TAMAÑO
 // ============================================================================
 
-// Forward declaration
-void write_to_service(const std::string& s);
+// Forward declarations
+bool write_chrome_frame(OutboundFrame& frame);
+bool write_service_frame(OutboundFrame& frame);
+void write_to_service(OutboundFrame frame, OutboundScheduler::Priority priority = OutboundScheduler::BULK);
+void write_to_service(const std::string& s, OutboundScheduler::Priority priority = OutboundScheduler::BULK);
+
+// Un writer thread por sink: CONTROL (keepalive, host_ready, PONG, HEARTBEAT...)
+// adelanta a BULK (mensajes ruteados) en cada límite de frame
+OutboundScheduler g_chrome_out("chrome", write_chrome_frame, OUTBOUND_CHROME_MAX_BULK);
+OutboundScheduler g_brain_out("brain", write_service_frame, OUTBOUND_BRAIN_MAX_BULK);
+
+// Crédito que el host otorga a Brain (flow_control.h). El crédito que Brain
+// otorga al host lo administra g_brain_out.
+FlowControl::CreditGrantor g_brain_credits({FLOW_WINDOW_BYTES, FLOW_WINDOW_FRAMES});
+
+// Liveness del link con Brain (link_liveness.h). --brain-dead-ms lo ajusta en
+// main() antes de lanzar el thread TCP.
+Liveness::PeerMonitor g_brain_liveness(BRAIN_DEAD_PEER_MS);
+
+// Token buckets por kind para lo que Chrome manda a Brain (admission_control.h).
+// Desactivado hasta que --rate-limits lo configure en main() antes del loop de stdin.
+Admission::Controller g_admission;
+
+// LOG_ENTRY de la extensión → cortex log en lotes, sin pasar por Brain
+// (extension_logs.h). Arranca en main() junto con los writers de salida.
+ExtensionLogs::BatchedWriter g_extension_logs(
+    [](const std::string& block, size_t) { g_logger.write_browser_block(block); },
+    EXTENSION_LOG_MAX_QUEUED);
+
+// Comandos Brain → Chrome con id pendientes de RESPONSE (request_tracker.h).
+// --request-timeout-ms lo ajusta en main() antes de arrancar el timer.
+Correlation::Tracker g_requests(REQUEST_TIMEOUT_MS, REQUEST_TABLE_SLOTS);
+
+// Supresión de duplicados por dirección (dedup_filter.h). Desactivada salvo
+// que main() los configure con --dedup.
+Dedup::Filter g_dedup_to_brain("chrome_to_brain");
+Dedup::Filter g_dedup_to_chrome("brain_to_chrome");
+
+// Último documento enviado por key para los kinds de --delta (delta_encoder.h).
+// Se activa por conexión si el REGISTER_ACK de Brain acepta el formato.
+Delta::Encoder g_delta(DELTA_SNAPSHOT_EVERY, DELTA_SNAPSHOT_INTERVAL_MS, DELTA_MAX_KEYS);
+
+// Campos por kind que Brain pidió (projection.h). La tabla llega en el
+// REGISTER_ACK y SET_PROJECTION la cambia en caliente desde el thread TCP.
+Projection::Registry g_projections;
+
+// Filtros de suscripción de Brain (subscription_filter.h). Sin SET_SUBSCRIPTIONS
+// pasa todo; el thread TCP publica el matcher nuevo sin frenar a stdin.
+Subscription::Registry g_subscriptions;
+
+// Fast path de frames grandes stdin → socket de Brain (splice_forward.h).
+// Opt-in: main() lo abre sobre stdin solo con --splice; fuera de Linux no existe.
+Splice::Forwarder g_splice(0);
+
+// UTF-8 y balance de llaves de cada frame crudo (frame_validator.h) antes de
+// parsearlo o reenviarlo tal cual; --validate-frames off lo desactiva.
+FrameValidator::Gate g_frame_validator;
+
+// Frame malformado: se descarta y se loguea con el motivo
+bool frame_is_valid(FrameValidator::Gate::Source source, const char* data, size_t size) {
+    FrameValidator::Result result = g_frame_validator.check(source, data, size);
+    if (result == FrameValidator::VALID) return true;
+
+    const char* origin = source == FrameValidator::Gate::FROM_CHROME ? "CHROME"
+                       : source == FrameValidator::Gate::FROM_BRAIN  ? "BRAIN" : "CHUNK";
+    std::string line = std::string(origin) + "_INVALID_FRAME reason=" + FrameValidator::result_name(result) +
+                       " size=" + std::to_string(size);
+    std::cerr << "[VALIDATE] ✗ " << line << std::endl;
+    if (g_logger.is_ready()) {
+        g_logger.log_native("WARN", line);
+        if (source != FrameValidator::Gate::FROM_BRAIN) g_logger.log_browser("WARN", line);
+    }
+    return false;
+}
+
+// Timer de g_requests: la extensión no contestó a tiempo
+void send_request_timeout(const Correlation::Pending& entry, const std::string& command, uint64_t waited_ms) {
+    json timeout;
+    timeout["type"] = "REQUEST_TIMEOUT";
+    // Mismo tipo de id que mandó Brain (la key de un id entero es su dump())
+    timeout["id"] = entry.numeric_id ? json::parse(entry.key) : json(entry.key);
+    timeout["command"] = command;
+    timeout["waited_ms"] = waited_ms;
+    timeout["delivered"] = entry.written_ns != 0;
+    {
+        std::lock_guard<std::mutex> lock(g_identity_mutex);
+        timeout["profile_id"] = g_profile_id;
+        timeout["launch_id"] = g_launch_id;
+    }
+    timeout["timestamp"] = get_timestamp_ms();
+    std::cerr << "[REQUEST] ✗ Timeout id=" << entry.key << " command=" << command << std::endl;
+    if (g_logger.is_ready()) {
+        g_logger.log_native("WARN", "REQUEST_TIMEOUT id=" + entry.key + " command=" + command +
+                            " waited_ms=" + std::to_string(waited_ms) +
+                            " delivered=" + (entry.written_ns ? "true" : "false"));
+    }
+    write_to_service(timeout.dump(), OutboundScheduler::CONTROL);
+}
 
-void write_message_to_chrome(const std::string& s) {
-    try {
-        std::lock_guard<std::mutex> lock(stdout_mutex);
-        uint32_t len = static_cast<uint32_t>(s.size());
+// ADMISSION_DROPS hacia Brain si hubo descartes (force: sin el mínimo de 1s)
+void send_admission_report(bool force) {
+    json report;
+    if (!g_admission.take_report(report, force)) return;
+    {
+        std::lock_guard<std::mutex> lock(g_identity_mutex);
+        report["profile_id"] = g_profile_id;
+        report["launch_id"] = g_launch_id;
+    }
+    report["timestamp"] = get_timestamp_ms();
+    std::cerr << "[ADMISSION] Dropped " << report["dropped"] << " Chrome messages" << std::endl;
+    if (g_logger.is_ready()) {
+        g_logger.log_native("WARN", "ADMISSION_DROPS dropped=" + report["dropped"].dump() +
+                            " overload=" + report["overload"].dump() +
+                            " kinds=" + report["kinds"].dump());
+    }
+    write_to_service(report.dump(), OutboundScheduler::CONTROL);
+}
+
+// Devuelve a Brain el crédito de un frame ya procesado (cualquier thread)
+void consume_brain_credit(uint64_t epoch, size_t bytes) {
+    FlowControl::Window grant;
+    if (g_brain_credits.consume(epoch, bytes, grant)) {
+        write_to_service(FlowControl::credit_message(grant).dump(), OutboundScheduler::CONTROL);
+    }
+}
+
+bool write_message_to_chrome(const std::string& s, OutboundScheduler::Priority priority = OutboundScheduler::BULK,
+                             const OutboundScheduler::DoneFn& on_done = nullptr) {
+    uint32_t len = static_cast<uint32_t>(s.size());
+
+    // � VALIDACIÓN DEL MURO DE 1MB
+    if (len > MAX_CHROME_MSG_SIZE) {
+        std::cerr << "[WRITE_CHROME] ✗ MENSAJE DEMASIADO GRANDE: " << len 
+                  << " bytes (límite: " << MAX_CHROME_MSG_SIZE << ")" << std::endl;
         
-        // � VALIDACIÓN DEL MURO DE 1MB
-        if (len > MAX_CHROME_MSG_SIZE) {
-            std::cerr << "[WRITE_CHROME] ✗ MENSAJE DEMASIADO GRANDE: " << len 
-                      << " bytes (límite: " << MAX_CHROME_MSG_SIZE << ")" << std::endl;
-            
-            // Emitir error hacia el Brain vía TCP
-            json error_msg;
-            error_msg["type"] = "EXTENSION_ERROR";
-            error_msg["payload"]["code"] = "MSG_TOO_BIG";
-            error_msg["payload"]["size"] = len;
-            error_msg["payload"]["max_allowed"] = MAX_CHROME_MSG_SIZE;
-            error_msg["timestamp"] = get_timestamp_ms();
-            
-            std::string error_str = error_msg.dump();
-            write_to_service(error_str);
-            
-            if (g_logger.is_ready()) {
-                g_logger.log_native("ERROR", "MSG_TOO_BIG Size=" + std::to_string(len));
-            }
-            
-            return; // ⚠️ ABORTAR envío
+        // Emitir error hacia el Brain vía TCP
+        json error_msg;
+        error_msg["type"] = "EXTENSION_ERROR";
+        error_msg["payload"]["code"] = "MSG_TOO_BIG";
+        error_msg["payload"]["size"] = len;
+        error_msg["payload"]["max_allowed"] = MAX_CHROME_MSG_SIZE;
+        error_msg["timestamp"] = get_timestamp_ms();
+        
+        std::string error_str = error_msg.dump();
+        write_to_service(error_str, OutboundScheduler::CONTROL);
+        
+        if (g_logger.is_ready()) {
+            g_logger.log_native("ERROR", "MSG_TOO_BIG Size=" + std::to_string(len));
         }
         
+        return false; // ⚠️ ABORTAR envío
+    }
+
+    if (!g_chrome_out.enqueue(OutboundFrame::copy_of(s), priority, on_done)) {
+        std::cerr << "[WRITE_CHROME] ✗ Outbound queue stopped - message dropped" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// Writer thread de g_chrome_out: único escritor de stdout durante la sesión NM
+bool write_chrome_frame(OutboundFrame& frame) {
+    AllocTracker::StageScope alloc_stage(AllocTracker::STAGE_FORWARD);
+    try {
+        std::lock_guard<std::mutex> lock(stdout_mutex);
+        uint32_t len = static_cast<uint32_t>(frame.size());
+        
         std::cerr << "[WRITE_CHROME] Size=" << len << " bytes" << std::endl;
         
-        // Little Endian para Chrome
-        std::cout.write(reinterpret_cast<const char*>(&len), 4);
-        std::cout.write(s.c_str(), len);
+        // Little Endian para Chrome, header y payload en un solo write
+        const std::string& wire = frame.with_header_le();
+        std::cout.write(wire.data(), static_cast<std::streamsize>(wire.size()));
         std::cout.flush();
+        if (!std::cout.good()) {
+            std::cerr << "[WRITE_CHROME] ✗ stdout write failed" << std::endl;
+            return false;
+        }
+        TrafficCapture::record(TrafficCapture::CHROME_OUT, frame.payload(), frame.size());
         
         g_messages_sent.fetch_add(1);
         
@@ -179,9 +333,10 @@ void write_message_to_chrome(const std::string& s) {
 
         if (g_logger.is_ready()) {
             // Parse only command/type metadata — never log string content
+            AllocTracker::StageScope log_stage(AllocTracker::STAGE_LOG);
             std::string log_cmd, log_type;
             try {
-                auto j = json::parse(s);
+                auto j = json::parse(frame.payload(), frame.payload() + frame.size());
                 log_cmd  = json_get_string_safe(j, "command");
                 log_type = json_get_string_safe(j, "type");
             } catch (...) {}
@@ -189,30 +344,68 @@ void write_message_to_chrome(const std::string& s) {
                                           " type=" + log_type +
                                           " size=" + std::to_string(len));
         }
+        return true;
     } catch (const std::exception& e) {
         std::cerr << "[WRITE_CHROME] ✗ Exception: " << e.what() << std::endl;
+        return false;
     }
 }
 
-void write_to_service(const std::string& s) {
+void write_to_service(OutboundFrame frame, OutboundScheduler::Priority priority) {
+    if (service_socket.load() == INVALID_SOCK) {
+        std::cerr << "[WRITE_SERVICE] ✗ No active socket - message dropped" << std::endl;
+        return;
+    }
+    if (!g_brain_out.enqueue(std::move(frame), priority)) {
+        std::cerr << "[WRITE_SERVICE] ✗ Outbound queue stopped - message dropped" << std::endl;
+    }
+}
+
+void write_to_service(const std::string& s, OutboundScheduler::Priority priority) {
+    if (service_socket.load() == INVALID_SOCK) {
+        std::cerr << "[WRITE_SERVICE] ✗ No active socket - message dropped" << std::endl;
+        return;
+    }
+    write_to_service(OutboundFrame::copy_of(s), priority);
+}
+
+// Writer thread de g_brain_out
+bool write_service_frame(OutboundFrame& frame) {
+    AllocTracker::StageScope alloc_stage(AllocTracker::STAGE_FORWARD);
     try {
         std::lock_guard<std::mutex> lock(service_mutex);
         socket_t sock = service_socket.load();
-        if (sock != INVALID_SOCK) {
-            uint32_t len = static_cast<uint32_t>(s.size());
-            uint32_t net_len = htonl(len); // Big Endian para Brain
-            
-            std::cerr << "[WRITE_SERVICE] Socket=" << sock << " Size=" << len << " bytes" << std::endl;
-            
-            send(sock, (const char*)&net_len, 4, 0);
-            send(sock, s.c_str(), len, 0);
-            
-            std::cerr << "[WRITE_SERVICE] ✓ Sent successfully" << std::endl;
-        } else {
-            std::cerr << "[WRITE_SERVICE] ✗ No active socket - message queued" << std::endl;
+        if (sock == INVALID_SOCK) {
+            std::cerr << "[WRITE_SERVICE] ✗ Socket closed before write - message dropped" << std::endl;
+            return false;
+        }
+
+        uint32_t len = static_cast<uint32_t>(frame.size());
+        
+        std::cerr << "[WRITE_SERVICE] Socket=" << sock << " Size=" << len << " bytes" << std::endl;
+        
+        // Big Endian para Brain. Header y payload en un solo buffer: separados
+        // dejaban un segmento de 4 bytes que Nagle retenía hasta el ACK
+        const std::string& wire = frame.with_header_be();
+        size_t sent = 0;
+        while (sent < wire.size()) {
+            int n = send(sock, wire.data() + sent, static_cast<int>(wire.size() - sent), 0);
+            if (n <= 0) {
+                std::cerr << "[WRITE_SERVICE] ✗ send() failed after " << sent << " of "
+                          << wire.size() << " bytes" << std::endl;
+                // Frame cortado: Brain ya no puede seguir el framing, que reconecte
+                if (sent > 0) PlatformUtils::shutdown_socket(sock);
+                return false;
+            }
+            sent += static_cast<size_t>(n);
         }
+        TrafficCapture::record(TrafficCapture::BRAIN_OUT, frame.payload(), frame.size());
+        
+        std::cerr << "[WRITE_SERVICE] ✓ Sent successfully" << std::endl;
+        return true;
     } catch (const std::exception& e) {
         std::cerr << "[WRITE_SERVICE] ✗ Exception: " << e.what() << std::endl;
+        return false;
     }
 }
 
@@ -222,33 +415,19 @@ void write_to_service(const std::string& s) {
 
 bool try_extract_profile_id_from_raw(const std::string& msg_str) {
     try {
-        size_t pos = msg_str.find("\"profile_id\"");
-        if (pos == std::string::npos) return false;
-        
-        size_t start = msg_str.find("\"", pos + 13);
-        if (start == std::string::npos) return false;
-        start++;
-        
-        size_t end = msg_str.find("\"", start);
-        if (end == std::string::npos) return false;
+        std::string candidate;
+        if (!MessageUtils::extract_profile_id_from_raw(msg_str, candidate)) return false;
         
-        std::string candidate = msg_str.substr(start, end - start);
-        
-        if (candidate.length() == 36 && 
-            candidate[8] == '-' && candidate[13] == '-' &&
-            candidate[18] == '-' && candidate[23] == '-') {
+        std::lock_guard<std::mutex> lock(g_identity_mutex);
+        if (g_profile_id.empty()) {
+            // Guardamos el profile_id para que try_extract_identity lo tenga listo,
+            // pero NO inicializamos el logger aquí: se requiere también el launch_id
+            // para crear la estructura de directorios completa.
+            g_profile_id = candidate;
             
-            std::lock_guard<std::mutex> lock(g_identity_mutex);
-            if (g_profile_id.empty()) {
-                // Guardamos el profile_id para que try_extract_identity lo tenga listo,
-                // pero NO inicializamos el logger aquí: se requiere también el launch_id
-                // para crear la estructura de directorios completa.
-                g_profile_id = candidate;
-                
-                std::cerr << "[IDENTITY_EXTRACT_RAW] ✓ profile=" << candidate
-                          << " (logger pending launch_id)" << std::endl;
-                return true;
-            }
+            std::cerr << "[IDENTITY_EXTRACT_RAW] ✓ profile=" << candidate
+                      << " (logger pending launch_id)" << std::endl;
+            return true;
         }
     } catch (const std::exception& e) {
         std::cerr << "[EXTRACT_RAW] ✗ Exception: " << e.what() << std::endl;
@@ -323,6 +502,11 @@ void send_host_ready_to_chrome() {
         "size_validation"
     });
     response["max_message_size"] = MAX_CHROME_MSG_SIZE;
+    // Todavía sin extension_ready: se sugiere el preferido del host; si la
+    // extensión no lo sabe calcular elige otro de la lista. Lo que vale es el
+    // checksum_algo de cada header de upload.
+    response["checksum_algos"] = Checksum::supported_algos();
+    response["checksum_algo"] = Checksum::algo_name(Checksum::negotiate(Checksum::supported_algos()));
     response["timestamp"] = get_timestamp_ms();
 
     if (g_logger.is_ready() && !g_logger.get_cortex_log_path().empty()) {
@@ -330,7 +514,7 @@ void send_host_ready_to_chrome() {
     }
 
     std::string response_str = response.dump();
-    write_message_to_chrome(response_str);
+    write_message_to_chrome(response_str, OutboundScheduler::CONTROL);
 
     std::cerr << "[HOST_READY] sent to Chrome (proactive after REGISTER_ACK)" << std::endl;
     if (g_logger.is_ready()) {
@@ -358,7 +542,7 @@ void send_host_ready_to_chrome() {
                 notify["host_version"] = VERSION;
                 notify["host_build"]   = BUILD;
                 notify["timestamp"]    = get_timestamp_ms();
-                write_to_service(notify.dump());
+                write_to_service(notify.dump(), OutboundScheduler::CONTROL);
                 std::cerr << "[HANDSHAKE] FASE 3: Host -> Brain (PROFILE_CONNECTED)" << std::endl;
                 {
                     std::lock_guard<std::mutex> lk(g_handshake_mutex);
@@ -441,6 +625,9 @@ void handle_extension_ready(const json& msg) {
         "size_validation"
     });
     response["max_message_size"] = MAX_CHROME_MSG_SIZE;
+    Checksum::Algo checksum_algo = Checksum::negotiate(msg.value("checksum_algos", json()));
+    response["checksum_algos"] = Checksum::supported_algos();
+    response["checksum_algo"] = Checksum::algo_name(checksum_algo);
     response["timestamp"] = get_timestamp_ms();
 
     // Include cortex log path so the extension knows where to route LOG_ENTRY
@@ -451,11 +638,12 @@ void handle_extension_ready(const json& msg) {
     }
     
     std::string response_str = response.dump();
-    write_message_to_chrome(response_str);
+    write_message_to_chrome(response_str, OutboundScheduler::CONTROL);
     
     std::cerr << "[HANDSHAKE] FASE 2: Host → Extension (host_ready)" << std::endl;
     if (g_logger.is_ready()) {
-        g_logger.log_native("INFO", "HANDSHAKE_FASE2 host_ready sent version=" + VERSION + " build=" + std::to_string(BUILD));
+        g_logger.log_native("INFO", "HANDSHAKE_FASE2 host_ready sent version=" + VERSION + " build=" + std::to_string(BUILD) +
+                                    " checksum=" + Checksum::algo_name(checksum_algo));
         g_logger.log_browser("INFO", "CHROME_OUT command=host_ready version=" + VERSION + " build=" + std::to_string(BUILD));
     }
     g_handshake_state.store(HANDSHAKE_HOST_READY);
@@ -484,7 +672,7 @@ void handle_extension_ready(const json& msg) {
                 brain_notify["timestamp"] = get_timestamp_ms();
                 
                 std::string notify_str = brain_notify.dump();
-                write_to_service(notify_str);
+                write_to_service(notify_str, OutboundScheduler::CONTROL);
                 
                 std::cerr << "[HANDSHAKE] FASE 3: Host → Brain (PROFILE_CONNECTED)" << std::endl;
                 
@@ -520,16 +708,109 @@ bool is_handshake_confirmed() {
 // MANEJO DE MENSAJES DESDE CHROME
 // ============================================================================
 
+// Proyección que corresponde a un mensaje de Chrome, null si va entero.
+// Nunca el handshake, los chunks ni los logs de la extensión (el host los
+// consume completos). Un RESPONSE busca primero por el command que lo pidió.
+Projection::SpecPtr find_projection(const Projection::Envelope& env) {
+    if (!g_projections.active() || env.has_chunk) return nullptr;
+
+    const std::string& kind = env.kind();
+    if (kind == "extension_ready" || ExtensionLogs::is_log_entry(kind)) return nullptr;
+    if (kind == "RESPONSE") {
+        std::string command = g_requests.pending_command(env.id);
+        Projection::SpecPtr spec = command.empty() ? nullptr : g_projections.find("RESPONSE/" + command);
+        if (spec) return spec;
+    }
+    return g_projections.find(kind);
+}
+
+// Sobre del mensaje si alguien lo necesita (proyecciones o suscripciones)
+bool scan_chrome_envelope(const char* data, size_t size, Projection::Envelope& env) {
+    return (g_projections.active() || g_subscriptions.active()) && Projection::scan_envelope(data, size, env);
+}
+
+// Suscripciones por kind (subscription_filter.h). Los chunks se deciden al
+// reensamblar; los logs de la extensión no van a Brain de todos modos.
+Subscription::Decision check_subscription(const std::string& kind, bool chunk, size_t bytes) {
+    if (!g_subscriptions.active() || chunk || ExtensionLogs::is_log_entry(kind)) return {};
+    return g_subscriptions.check_kind(kind, bytes);
+}
+
+// Upload bloom_chunk reensamblado: es el mensaje original, así que pasa por
+// las mismas suscripciones y proyección que uno directo. Sin proyección el
+// buffer del reensamblado es el frame que sale (por move, sin copiarlo).
+void forward_assembled_message(OutboundFrame message) {
+    const char* data = message.payload();
+    const size_t size = message.size();
+    // Sin proyección ni "where" nadie parsea el ensamblado antes de Brain
+    if (!frame_is_valid(FrameValidator::Gate::ASSEMBLED, data, size)) return;
+
+    Projection::Envelope env;
+    bool scanned = scan_chrome_envelope(data, size, env);
+    if (scanned) {
+        Subscription::Decision subscription = check_subscription(env.kind(), false, size);
+        if (subscription.verdict == Subscription::DROP) return;
+        if (subscription.verdict == Subscription::CHECK) {
+            json full = json::parse(data, data + size, nullptr, false);
+            if (full.is_object() &&
+                !g_subscriptions.check_fields(subscription, env.kind(), full, size)) {
+                return;
+            }
+        }
+    }
+
+    Projection::SpecPtr projection = scanned ? find_projection(env) : nullptr;
+    json projected;
+    if (projection && g_projections.project(*projection, data, size, projected)) {
+        std::string projected_str = projected.dump();
+        g_projections.on_forwarded(*projection, size, projected_str.size());
+        write_to_service(projected_str);
+    } else {
+        write_to_service(std::move(message));
+    }
+}
+
 void handle_chrome_message(const std::string& msg_str) {
+    CpuProfiler::Scope cpu_scope("chrome");
     try {
+        AllocTracker::StageScope parse_stage(AllocTracker::STAGE_PARSE);
+
         // Intentar extraer identidad RAW primero
         if (!identity_resolved.load()) {
             if (try_extract_profile_id_from_raw(msg_str)) {
                 std::cerr << "[CHROME_MSG] ✓ Identity extracted from raw message" << std::endl;
             }
         }
+
+        if (!frame_is_valid(FrameValidator::Gate::FROM_CHROME, msg_str.data(), msg_str.size())) return;
         
-        json msg = json::parse(msg_str);
+        // Suscripciones: un kind que Brain no pidió se descarta acá, con el
+        // kind leído del texto crudo y antes de cualquier parse
+        Projection::Envelope env;
+        bool scanned = scan_chrome_envelope(msg_str.data(), msg_str.size(), env);
+        Subscription::Decision subscription;
+        if (scanned) {
+            subscription = check_subscription(env.kind(), env.has_chunk, msg_str.size());
+            if (subscription.verdict == Subscription::DROP) return;
+        }
+
+        // Con proyección el mensaje se arma por SAX con solo los campos
+        // pedidos; si el texto no es un objeto válido, parse completo (y su
+        // parse_error de siempre). Un filtro con "where" mira campos que la
+        // proyección puede sacar: se decide sobre el parse completo primero.
+        json msg;
+        Projection::SpecPtr projection = scanned ? find_projection(env) : nullptr;
+        if (subscription.verdict == Subscription::CHECK) {
+            msg = json::parse(msg_str);
+            if (!g_subscriptions.check_fields(subscription, env.kind(), msg, msg_str.size())) return;
+        }
+        json projected;
+        if (projection && g_projections.project(*projection, msg_str, projected)) {
+            msg = std::move(projected);
+        } else {
+            projection = nullptr;
+            if (msg.is_null()) msg = json::parse(msg_str);
+        }
         
         // Intentar extracción JSON
         if (!identity_resolved.load()) {
@@ -538,6 +819,40 @@ void handle_chrome_message(const std::string& msg_str) {
         
         std::string command = json_get_string_safe(msg, "command");
         std::string type = json_get_string_safe(msg, "type");
+        std::string kind = message_kind(msg, command, type);
+        AllocTracker::set_message_kind(kind);
+        cpu_scope.set_kind(kind);
+
+        // Sin scan (un kind con escapes): la misma decisión sobre el parse
+        if (!scanned && g_subscriptions.active()) {
+            subscription = check_subscription(kind, msg.contains("bloom_chunk"), msg_str.size());
+            if (!g_subscriptions.check_fields(subscription, kind, msg, msg_str.size())) return;
+        }
+
+        // Logs de la extensión: se escriben acá mismo en el cortex log. No
+        // cuentan contra el admission control (ya no llegan a Brain); si el
+        // disco no da abasto, la cola acotada del writer descarta y cuenta.
+        if (ExtensionLogs::is_log_entry(kind)) {
+            std::string level = ExtensionLogs::normalize_level(msg);
+            g_extension_logs.append(ExtensionLogs::format_entry(msg, level), level);
+            return;
+        }
+
+        // Admission control antes de loguear: un flood descartado no debe
+        // convertirse en un flood de líneas de log. Los chunks quedan afuera
+        // (perder uno invalida todo el mensaje reensamblado).
+        if (!msg.contains("bloom_chunk")) {
+            bool backlog = g_brain_out.bulk_queued_bytes() > ADMISSION_BACKLOG_BYTES;
+            if (g_admission.admit(kind, backlog) != Admission::ADMIT) {
+                send_admission_report(false);
+                return;
+            }
+
+            // Copia de algo ya reenviado dentro de la ventana del kind
+            if (command != "extension_ready" && !g_dedup_to_brain.admit(kind, msg, msg_str.size())) {
+                return;
+            }
+        }
         
         std::cerr << "[CHROME_MSG] command='" << command << "' type='" << type << "'" << std::endl;
         if (g_logger.is_ready()) {
@@ -564,16 +879,20 @@ void handle_chrome_message(const std::string& msg_str) {
                 g_logger.log_browser("INFO", "CHUNK_IN seq=" + seq_str + " total=" + total_str);
             }
 
-            std::string complete_msg;
-            auto result = g_chunked_buffer.process_chunk(msg, complete_msg);
+            ChunkedMessageBuffer::Processed processed;
+            {
+                AllocTracker::StageScope chunk_stage(AllocTracker::STAGE_CHUNK);
+                processed = g_chunked_buffer.process_chunk(msg);
+            }
+            const ChunkedMessageBuffer::ChunkResult result = processed.result;
             
             if (result == ChunkedMessageBuffer::COMPLETE_VALID) {
                 std::cerr << "[CHUNK] ✓ Message assembled - Size: " 
-                          << complete_msg.size() << " bytes" << std::endl;
+                          << processed.message.size() << " bytes" << std::endl;
                 if (g_logger.is_ready()) {
-                    g_logger.log_browser("INFO", "CHUNK_ASSEMBLED size=" + std::to_string(complete_msg.size()));
+                    g_logger.log_browser("INFO", "CHUNK_ASSEMBLED size=" + std::to_string(processed.message.size()));
                 }
-                write_to_service(complete_msg);
+                forward_assembled_message(std::move(processed.message));
             } else if (result == ChunkedMessageBuffer::COMPLETE_INVALID_CHECKSUM) {
                 std::cerr << "[CHUNK] ✗ Invalid checksum" << std::endl;
                 if (g_logger.is_ready()) {
@@ -587,8 +906,17 @@ void handle_chrome_message(const std::string& msg_str) {
             return;
         }
         
-        // Rutear mensaje hacia Brain
-        std::string forwarded = msg.dump();
+        // RESPONSE a un comando de Brain: cierra la entrada y suma el tiempo
+        // de servicio. Se rutea igual, también si llega después del timeout.
+        if (type == "RESPONSE") {
+            g_requests.on_response(msg);
+        }
+
+        // Rutear mensaje hacia Brain (snapshot o patch si el kind va en delta)
+        AllocTracker::StageScope forward_stage(AllocTracker::STAGE_FORWARD);
+        std::string forwarded;
+        if (!g_delta.encode(kind, msg, forwarded)) forwarded = msg.dump();
+        if (projection) g_projections.on_forwarded(*projection, msg_str.size(), forwarded.size());
         write_to_service(forwarded);
         
         if (g_logger.is_ready()) {
@@ -611,16 +939,168 @@ void handle_chrome_message(const std::string& msg_str) {
     }
 }
 
+// ============================================================================
+// SPLICE CHROME → BRAIN
+// ============================================================================
+
+// Frame grande con el prefijo ya leído de stdin: si nada necesita el cuerpo,
+// el resto va de stdin al socket sin pasar por memoria (splice_forward.h).
+// Las decisiones por kind son las mismas de handle_chrome_message().
+// @return false si el caller tiene que leer el resto y seguir como siempre
+bool splice_chrome_frame(const std::string& prefix, uint32_t len) {
+    Projection::Envelope env;
+    if (!Projection::scan_envelope_prefix(prefix.data(), prefix.size(), env)) {
+        g_splice.on_skipped("envelope");
+        return false;
+    }
+
+    const std::string& kind = env.kind();
+    const char* reason = nullptr;
+    if (!identity_resolved.load() || !is_handshake_confirmed()) reason = "handshake";
+    else if (service_socket.load() == INVALID_SOCK)             reason = "disconnected";
+    else if (g_frame_validator.enabled())                       reason = "validate";
+    else if (TrafficCapture::is_enabled())                      reason = "capture";
+    else if (env.has_chunk || kind == "extension_ready" || ExtensionLogs::is_log_entry(kind)) reason = "kind";
+    else if (g_dedup_to_brain.window_ms(kind) > 0)              reason = "dedup";
+    else if (g_delta.encodes(kind) && g_delta.active())         reason = "delta";
+    else if (find_projection(env))                              reason = "projection";
+    // PASS y DROP ya quedan contados; CHECK no cuenta nada hasta check_fields()
+    Subscription::Decision subscription;
+    if (!reason) {
+        subscription = check_subscription(kind, false, len);
+        if (subscription.verdict == Subscription::CHECK) reason = "subscription";   // "where" mira el cuerpo
+    }
+    if (reason) {
+        g_splice.on_skipped(reason);
+        return false;
+    }
+
+    // Desde acá el frame se consume: descartado o reenviado
+    const size_t body = len - prefix.size();
+    if (subscription.verdict == Subscription::DROP) {
+        g_splice.discard(body);
+        return true;
+    }
+    bool backlog = g_brain_out.bulk_queued_bytes() > ADMISSION_BACKLOG_BYTES;
+    if (g_admission.admit(kind, backlog) != Admission::ADMIT) {
+        send_admission_report(false);
+        g_splice.discard(body);
+        return true;
+    }
+    if (env.type == "RESPONSE") g_requests.on_response_key(env.id);
+
+    // Header big endian para Brain + el prefijo, y el cuerpo por splice
+    std::string head(4, '\0');
+    uint32_t net_len = htonl(len);
+    std::memcpy(&head[0], &net_len, 4);
+    head += prefix;
+
+    size_t consumed = 0;
+    bool ok = g_brain_out.write_direct(len, [&] {
+        std::lock_guard<std::mutex> lock(service_mutex);
+        socket_t sock = service_socket.load();
+        if (sock == INVALID_SOCK) return false;
+        if (g_splice.send_frame(sock, head, body, consumed)) return true;
+        // Frame cortado: Brain ya no puede seguir el framing, que reconecte
+        PlatformUtils::shutdown_socket(sock);
+        return false;
+    });
+    if (consumed < body) g_splice.discard(body - consumed);
+
+    std::cerr << "[SPLICE] " << (ok ? "✓" : "✗") << " kind='" << kind << "' size=" << len << std::endl;
+    if (g_logger.is_ready()) {
+        g_logger.log_native(ok ? "INFO" : "WARN", "CHROME_SPLICE kind=" + kind + " size=" + std::to_string(len) +
+                            (ok ? "" : " failed"));
+    }
+    return true;
+}
+
+// ============================================================================
+// ESTADÍSTICAS DE RUNTIME
+// Compartidas por HEARTBEAT (periódico) y STATS_RESPONSE (a pedido de Brain o
+// del soak benchmark). Todo lo que pueda crecer sin límite durante la vida
+// del perfil debe aparecer acá.
+// ============================================================================
+
+json build_runtime_stats() {
+    json stats;
+    stats["messages_sent"] = g_messages_sent.load();
+    stats["messages_received"] = g_messages_received.load();
+    stats["heartbeat_count"] = g_heartbeat_count.load();
+    stats["handshake_state"] = g_handshake_state.load();
+    stats["uptime_s"] = std::chrono::duration_cast<std::chrono::seconds>(
+        std::chrono::steady_clock::now() - g_process_start).count();
+
+    {
+        std::lock_guard<std::mutex> lock(g_pending_mutex);
+        stats["pending_queue"] = g_pending_messages.size();
+    }
+    stats["active_chunk_buffers"] = g_chunked_buffer.get_active_buffers_count();
+    stats["chunk_checksum"] = {
+        {"crc32c_hardware", Checksum::crc32c_accelerated()},
+        {"algos",           g_chunked_buffer.get_checksum_stats()}
+    };
+    stats["chunk_buffered_bytes"] = g_chunked_buffer.get_buffered_bytes();
+    stats["log_pending_queue"] = g_logger.get_pending_count();
+    stats["outbound"]["chrome"] = g_chrome_out.stats_json();
+    stats["outbound"]["brain"] = g_brain_out.stats_json();
+    stats["flow_control"]["granted_to_brain"] = g_brain_credits.stats_json();
+    stats["brain_link"] = g_brain_liveness.stats_json();
+    stats["admission"] = g_admission.stats_json();
+    stats["extension_logs"] = g_extension_logs.stats_json();
+    stats["requests"] = g_requests.stats_json();
+    stats["dedup"]["chrome_to_brain"] = g_dedup_to_brain.stats_json();
+    stats["dedup"]["brain_to_chrome"] = g_dedup_to_chrome.stats_json();
+    if (g_delta.configured()) stats["delta"] = g_delta.stats_json();
+    stats["projections"] = g_projections.stats_json();
+    stats["subscriptions"] = g_subscriptions.stats_json();
+    stats["splice"] = g_splice.stats_json();
+    stats["frame_validation"] = g_frame_validator.stats_json();
+
+    PlatformUtils::ProcessStats proc = PlatformUtils::get_process_stats();
+    json& process = stats["process"];
+    if (proc.rss_kb >= 0)      process["rss_kb"] = proc.rss_kb;
+    if (proc.open_fds >= 0)    process["open_fds"] = proc.open_fds;
+    if (proc.threads >= 0)     process["threads"] = proc.threads;
+    if (proc.heap_in_use >= 0) process["heap_in_use_bytes"] = proc.heap_in_use;
+    if (proc.heap_free >= 0)   process["heap_free_bytes"] = proc.heap_free;
+
+    stats["cpu_top"] = CpuProfiler::top_json(CPU_TOP_N);
+
+    if (AllocTracker::is_enabled()) {
+        stats["allocations"] = AllocTracker::stats_json();
+    }
+    return stats;
+}
+
 // ============================================================================
 // MANEJO DE MENSAJES DESDE BRAIN (TCP)
 // ============================================================================
 
 void handle_service_message(const std::string& msg_str) {
+    CpuProfiler::Scope cpu_scope("brain");
+
+    // Todo frame de Brain consume crédito; se devuelve al salir de esta
+    // función salvo que viaje a Chrome (lo devuelve el writer de stdout)
+    const uint64_t credit_epoch = g_brain_credits.epoch();
+    bool credit_deferred = false;
+    struct CreditRefund {
+        const uint64_t& epoch; const size_t bytes; const bool& deferred;
+        ~CreditRefund() { if (!deferred) consume_brain_credit(epoch, bytes); }
+    } credit_refund{credit_epoch, msg_str.size(), credit_deferred};
+
+    if (!frame_is_valid(FrameValidator::Gate::FROM_BRAIN, msg_str.data(), msg_str.size())) return;
+
     try {
+        AllocTracker::StageScope parse_stage(AllocTracker::STAGE_PARSE);
+
         json msg = json::parse(msg_str);
         
         std::string type = json_get_string_safe(msg, "type");
         std::string command = json_get_string_safe(msg, "command");
+        std::string kind = message_kind(msg, command, type);
+        AllocTracker::set_message_kind(kind);
+        cpu_scope.set_kind(kind);
         
         std::cerr << "[SERVICE_MSG] type='" << type << "' command='" << command << "'" << std::endl;
         if (g_logger.is_ready()) {
@@ -637,6 +1117,65 @@ void handle_service_message(const std::string& msg_str) {
             if (g_logger.is_ready()) {
                 g_logger.log_native("INFO", "REGISTER_ACK_RECEIVED brain registration confirmed");
             }
+
+            // Flow control sólo si Brain también lo anuncia; el ACK mismo ya
+            // cuenta como primer frame consumido (CreditRefund)
+            FlowControl::Window brain_window;
+            if (FlowControl::parse_window(msg, brain_window)) {
+                g_brain_out.enable_credits(brain_window.bytes, brain_window.frames);
+                g_brain_credits.enable();
+                if (g_logger.is_ready()) {
+                    g_logger.log_native("INFO", "FLOW_CONTROL_ENABLED to_brain_window=" +
+                                        std::to_string(brain_window.bytes) + "/" +
+                                        std::to_string(brain_window.frames) + " from_brain_window=" +
+                                        std::to_string(FLOW_WINDOW_BYTES) + "/" +
+                                        std::to_string(FLOW_WINDOW_FRAMES));
+                }
+            } else {
+                g_brain_out.disable_credits();
+            }
+
+            // Delta encoding: conexión nueva, Brain no tiene ningún documento
+            g_delta.on_register_ack(msg);
+            if (g_delta.active() && g_logger.is_ready()) {
+                g_logger.log_native("INFO", "DELTA_ENABLED format=" + msg["delta"].value("format", std::string()));
+            }
+
+            // Proyecciones: la tabla de la conexión anterior ya no vale
+            std::vector<std::string> rejected;
+            json projections = msg.value("projections", json::object());
+            g_projections.replace_all(projections, rejected);
+            if (g_logger.is_ready() && projections.is_object() && !projections.empty()) {
+                std::string detail;
+                for (const auto& r : rejected) detail += " rejected=\"" + r + "\"";
+                g_logger.log_native(rejected.empty() ? "INFO" : "WARN",
+                                    "PROJECTIONS_REGISTERED kinds=" +
+                                    std::to_string(projections.size() - rejected.size()) + detail);
+            }
+
+            // Suscripciones: vuelve a pasar todo salvo que el ACK traiga filtros
+            std::string subscription_error;
+            json subscriptions = msg.value("subscriptions", json());
+            if (!g_subscriptions.replace(subscriptions, subscription_error)) {
+                g_subscriptions.replace(nullptr, subscription_error);
+                if (g_logger.is_ready()) {
+                    g_logger.log_native("WARN", "SUBSCRIPTIONS_REJECTED " + subscription_error);
+                }
+            } else if (g_subscriptions.active() && g_logger.is_ready()) {
+                g_logger.log_native("INFO", "SUBSCRIPTIONS_REGISTERED filters=" + std::to_string(subscriptions.size()));
+            }
+
+            int64_t detect_ms = 0, reconnect_ms = 0, total_ms = 0;
+            if (g_brain_liveness.on_registered(detect_ms, reconnect_ms, total_ms)) {
+                std::cerr << "[TCP] Failover complete in " << total_ms << "ms (detect " << detect_ms
+                          << "ms + reconnect " << reconnect_ms << "ms)" << std::endl;
+                if (g_logger.is_ready()) {
+                    g_logger.log_native("INFO", "BRAIN_FAILOVER detect_ms=" + std::to_string(detect_ms) +
+                                        " reconnect_ms=" + std::to_string(reconnect_ms) +
+                                        " total_ms=" + std::to_string(total_ms));
+                }
+            }
+
             // Send host_ready proactively so Chrome does not time out.
             // Chrome NM idle-kills the host after ~6s with no stdout activity.
             // handle_extension_ready() will be a no-op if called later because
@@ -645,6 +1184,80 @@ void handle_service_message(const std::string& msg_str) {
             return;
         }
 
+        if (type == "FLOW_CREDIT") {
+            uint64_t bytes = msg.value("bytes", uint64_t{0});
+            uint64_t frames = msg.value("frames", uint64_t{0});
+            g_brain_out.grant(bytes, frames);
+            return;
+        }
+
+        // Brain perdió la base de un documento delta: el próximo va completo
+        if (type == "DELTA_RESYNC") {
+            g_delta.request_resync(json_get_string_safe(msg, "key"));
+            return;
+        }
+
+        // Brain cambia los campos que quiere de un kind. Antes del guard de
+        // handshake: vale también para lo que Chrome mande apenas conecte.
+        if (type == "SET_PROJECTION") {
+            std::string projection_kind = json_get_string_safe(msg, "kind");
+            json fields = msg.value("fields", json::array());
+            std::string error;
+            bool ok = g_projections.set(projection_kind, fields, error);
+
+            json ack;
+            ack["type"] = "PROJECTION_ACK";
+            ack["kind"] = projection_kind;
+            ack["fields"] = fields;
+            ack["ok"] = ok;
+            if (!ok) ack["error"] = error;
+            if (msg.contains("request_id")) ack["request_id"] = msg["request_id"];
+            ack["timestamp"] = get_timestamp_ms();
+
+            if (g_logger.is_ready()) {
+                g_logger.log_native(ok ? "INFO" : "WARN", "SET_PROJECTION kind=" + projection_kind +
+                                    " fields=" + std::to_string(fields.is_array() ? fields.size() : 0) +
+                                    (ok ? "" : " error=" + error));
+            }
+            std::string ack_str = ack.dump();
+            write_to_service(ack_str, OutboundScheduler::CONTROL);
+            return;
+        }
+
+        // Brain cambia qué eventos quiere recibir. El matcher nuevo se publica
+        // de una vez: el thread de stdin ve el anterior o este, nunca una mezcla.
+        if (type == "SET_SUBSCRIPTIONS") {
+            json filters = msg.value("filters", json());
+            std::string error;
+            bool ok = g_subscriptions.replace(filters, error);
+
+            json ack;
+            ack["type"] = "SUBSCRIPTIONS_ACK";
+            ack["ok"] = ok;
+            ack["active"] = g_subscriptions.active();
+            ack["filters"] = g_subscriptions.filter_count();
+            ack["generation"] = g_subscriptions.generation();
+            if (!ok) ack["error"] = error;
+            if (msg.contains("request_id")) ack["request_id"] = msg["request_id"];
+            ack["timestamp"] = get_timestamp_ms();
+
+            if (g_logger.is_ready()) {
+                g_logger.log_native(ok ? "INFO" : "WARN", "SET_SUBSCRIPTIONS filters=" +
+                                    (filters.is_null() ? std::string("off") : std::to_string(filters.size())) +
+                                    " generation=" + std::to_string(g_subscriptions.generation()) +
+                                    (ok ? "" : " error=" + error));
+            }
+            std::string ack_str = ack.dump();
+            write_to_service(ack_str, OutboundScheduler::CONTROL);
+            return;
+        }
+
+        // Respuesta a un probe de liveness: ya contó como actividad al leerse
+        if (type == "PONG" && Liveness::PeerMonitor::is_probe_reply(msg)) {
+            g_brain_liveness.on_probe_reply(msg);
+            return;
+        }
+
         // Solo rutear si handshake confirmado
         if (!is_handshake_confirmed()) {
             std::cerr << "[SERVICE_MSG] Handshake NO confirmado - descartado type=" + type << std::endl;
@@ -662,10 +1275,22 @@ void handle_service_message(const std::string& msg_str) {
             pong["handshake_state"] = g_handshake_state.load();
             
             std::string pong_str = pong.dump();
-            write_to_service(pong_str);
+            write_to_service(pong_str, OutboundScheduler::CONTROL);
             return;
         }
         
+        if (type == "REQUEST_STATS") {
+            json response;
+            response["type"] = "STATS_RESPONSE";
+            response["timestamp"] = get_timestamp_ms();
+            response["stats"] = build_runtime_stats();
+            if (msg.contains("request_id")) response["request_id"] = msg["request_id"];
+
+            std::string response_str = response.dump();
+            write_to_service(response_str, OutboundScheduler::CONTROL);
+            return;
+        }
+
         if (type == "REQUEST_IDENTITY") {
             json identity;
             identity["type"] = "IDENTITY_RESPONSE";
@@ -681,13 +1306,28 @@ void handle_service_message(const std::string& msg_str) {
             identity["timestamp"] = get_timestamp_ms();
             
             std::string identity_str = identity.dump();
-            write_to_service(identity_str);
+            write_to_service(identity_str, OutboundScheduler::CONTROL);
             return;
         }
         
-        // Rutear hacia Chrome
+        // Copia de un comando ya reenviado dentro de la ventana: no llega a
+        // Chrome ni se registra como request (CreditRefund devuelve el crédito)
+        if (!g_dedup_to_chrome.admit(kind, msg, msg_str.size())) {
+            return;
+        }
+
+        // Rutear hacia Chrome. Un comando con id queda pendiente de su
+        // RESPONSE desde antes de encolarlo (la respuesta no puede ganarle)
+        AllocTracker::StageScope forward_stage(AllocTracker::STAGE_FORWARD);
         std::string forwarded = msg.dump();
-        write_message_to_chrome(forwarded);
+        size_t credit_bytes = msg_str.size();
+        std::string request_key = g_requests.track(msg, command);
+        credit_deferred = write_message_to_chrome(forwarded, OutboundScheduler::BULK,
+            [credit_epoch, credit_bytes, request_key] {
+                consume_brain_credit(credit_epoch, credit_bytes);
+                if (!request_key.empty()) g_requests.on_written(request_key);
+            });
+        if (!credit_deferred && !request_key.empty()) g_requests.cancel(request_key);
         
         if (g_logger.is_ready()) {
             g_logger.log_native("INFO", "BRAIN_TO_CHROME type=" + type);
@@ -718,19 +1358,14 @@ void heartbeat_loop() {
             
             socket_t sock = service_socket.load();
             if (sock == INVALID_SOCK) continue;
+
+            // Descartes que quedaron sin reportar al terminar un flood
+            send_admission_report(true);
             
             json hb;
             hb["type"] = "HEARTBEAT";
             hb["timestamp"] = get_timestamp_ms();
-            hb["stats"]["messages_sent"] = g_messages_sent.load();
-            hb["stats"]["messages_received"] = g_messages_received.load();
-            hb["stats"]["heartbeat_count"] = g_heartbeat_count.load();
-            hb["stats"]["handshake_state"] = g_handshake_state.load();
-            
-            {
-                std::lock_guard<std::mutex> lock(g_pending_mutex);
-                hb["stats"]["pending_queue"] = g_pending_messages.size();
-            }
+            hb["stats"] = build_runtime_stats();
             
             {
                 std::lock_guard<std::mutex> lock(g_identity_mutex);
@@ -738,7 +1373,7 @@ void heartbeat_loop() {
             }
             
             std::string hb_str = hb.dump();
-            write_to_service(hb_str);
+            write_to_service(hb_str, OutboundScheduler::CONTROL);
             
             g_heartbeat_count.fetch_add(1);
         }
@@ -777,7 +1412,7 @@ void chrome_keepalive_loop() {
             ka["heartbeat_count"] = g_heartbeat_count.load();
             
             std::string ka_str = ka.dump();
-            write_message_to_chrome(ka_str);
+            write_message_to_chrome(ka_str, OutboundScheduler::CONTROL);
             
             std::cerr << "[CHROME_KA] ✓ Keepalive sent to Chrome" << std::endl;
             if (g_logger.is_ready()) {
@@ -799,19 +1434,31 @@ void tcp_client_loop() {
     std::cerr << "[TCP_THREAD] Started" << std::endl;
     
     int reconnect_attempts = 0;
+    Reconnect::Backoff backoff(RECONNECT_DELAY_MS, RECONNECT_MAX_DELAY_MS);
+    std::string ready_baseline;            // brain.ready antes del último connect()
+    auto outage_start = std::chrono::steady_clock::now();
+    Reconnect::WakeReason last_wake = Reconnect::WAKE_TIMER;
     
     try {
         while (!shutdown_requested.load()) {
             if (reconnect_attempts > 0) {
-                int delay = RECONNECT_DELAY_MS * (1 << std::min(reconnect_attempts - 1, 5));
+                int delay = backoff.next_ms();
                 std::cerr << "[TCP] Reconnect attempt " << reconnect_attempts 
-                          << " - Waiting " << delay << "ms" << std::endl;
-                std::this_thread::sleep_for(std::chrono::milliseconds(delay));
+                          << " - Waiting up to " << delay << "ms (or brain.ready)" << std::endl;
+                last_wake = Reconnect::wait_for_brain(g_brain_ready_file, ready_baseline, delay,
+                                                      shutdown_requested);
+                if (last_wake == Reconnect::WAKE_READY) {
+                    // Todos los hosts ven el archivo en la misma ventana de
+                    // sondeo: dispersar un poco el connect() y el REGISTER_HOST
+                    std::this_thread::sleep_for(std::chrono::milliseconds(
+                        backoff.spread_ms(RECONNECT_READY_SPREAD_MS)));
+                }
             }
             
             if (shutdown_requested.load()) break;
+            ready_baseline = Reconnect::read_ready_stamp(g_brain_ready_file);
             
-            std::cerr << "[TCP] Connecting to localhost:" << SERVICE_PORT << std::endl;
+            std::cerr << "[TCP] Connecting to localhost:" << g_service_port << std::endl;
             
             socket_t sock = socket(AF_INET, SOCK_STREAM, 0);
             if (sock == INVALID_SOCK) {
@@ -822,7 +1469,7 @@ void tcp_client_loop() {
             
             sockaddr_in addr{};
             addr.sin_family = AF_INET;
-            addr.sin_port = htons(SERVICE_PORT);
+            addr.sin_port = htons(static_cast<uint16_t>(g_service_port));
             
 #ifdef _WIN32
             addr.sin_addr.S_un.S_addr = htonl(INADDR_LOOPBACK);
@@ -838,12 +1485,33 @@ void tcp_client_loop() {
             }
             
             std::cerr << "[TCP] ✓ Connected - Socket " << sock << std::endl;
+
+            if (!PlatformUtils::set_tcp_nodelay(sock)) {
+                std::cerr << "[TCP] ⚠️ Could not set TCP_NODELAY" << std::endl;
+            }
+            if (g_brain_liveness.enabled()) {
+                // Keepalive del SO como red de seguridad (peer que desaparece
+                // sin FIN); el bound real lo aplica el monitor con el timeout
+                int dead_s = std::max(1, g_brain_liveness.dead_ms() / 1000);
+                if (!PlatformUtils::set_tcp_keepalive(sock, std::max(1, dead_s / 3), std::max(1, dead_s / 6),
+                                                      3, g_brain_liveness.dead_ms()) ||
+                    !PlatformUtils::set_recv_timeout(sock, g_brain_liveness.tick_ms())) {
+                    std::cerr << "[TCP] ⚠️ Could not set keepalive / receive timeout" << std::endl;
+                }
+            }
             service_socket.store(sock);
-            reconnect_attempts = 0;
             
             if (g_logger.is_ready()) {
-                g_logger.log_native("INFO", "TCP_CONNECTED Socket=" + std::to_string(sock));
+                auto outage_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                    std::chrono::steady_clock::now() - outage_start).count();
+                g_logger.log_native("INFO", "TCP_CONNECTED Socket=" + std::to_string(sock) +
+                                   " Attempts=" + std::to_string(reconnect_attempts) +
+                                   " OutageMs=" + std::to_string(outage_ms) +
+                                   " Wake=" + (reconnect_attempts > 0
+                                       ? Reconnect::wake_reason_name(last_wake) : "none"));
             }
+            reconnect_attempts = 0;
+            backoff.reset();
 
             // ---------------------------------------------------------------
             // FIX: Esperar identidad antes de enviar REGISTER_HOST.
@@ -887,9 +1555,16 @@ void tcp_client_loop() {
             }
             reg["pid"]       = PlatformUtils::get_current_pid();
             reg["timestamp"] = get_timestamp_ms();
+            reg["flow_control"] = FlowControl::window_json({FLOW_WINDOW_BYTES, FLOW_WINDOW_FRAMES});
+            if (g_delta.configured()) reg["delta"] = g_delta.announce_json();
+
+            // Conexión nueva: contadores de crédito desde cero en ambos sentidos.
+            // Hasta el REGISTER_ACK no se sabe si Brain habla flow control.
+            g_brain_credits.reset();
+            g_brain_out.begin_credits();
 
             std::string reg_str = reg.dump();
-            write_to_service(reg_str);
+            write_to_service(reg_str, OutboundScheduler::CONTROL);
             
             // Flush pending messages
             {
@@ -908,17 +1583,24 @@ void tcp_client_loop() {
                 }
             }
             
+            Liveness::RecvStatus link_status = Liveness::RECV_OK;
+            uint64_t messages_received_from_service = 0;
             try {
                 std::vector<char> buffer;
                 buffer.reserve(MAX_MESSAGE_SIZE);
-                uint64_t messages_received_from_service = 0;
+                g_brain_liveness.on_connected();
+                auto send_probe = [] {
+                    write_to_service(g_brain_liveness.probe_frame(), OutboundScheduler::CONTROL);
+                };
                 
                 while (!shutdown_requested.load()) {
                     uint32_t net_len;
                     
-                    int received = recv(sock, (char*)&net_len, 4, MSG_WAITALL);
-                    if (received <= 0) {
-                        std::cerr << "[TCP] ✗ Recv header failed: " << received << std::endl;
+                    link_status = Liveness::recv_exact(sock, (char*)&net_len, 4, g_brain_liveness,
+                                                       send_probe, shutdown_requested);
+                    if (link_status != Liveness::RECV_OK) {
+                        std::cerr << "[TCP] ✗ Recv header failed: "
+                                  << Liveness::recv_status_name(link_status) << std::endl;
                         break;
                     }
                     
@@ -929,21 +1611,33 @@ void tcp_client_loop() {
                         break;
                     }
                     
-                    buffer.resize(len);
-                    received = recv(sock, buffer.data(), len, MSG_WAITALL);
-                    
-                    if (received != (int)len) {
-                        std::cerr << "[TCP] ✗ Recv body incomplete" << std::endl;
-                        break;
+                    AllocTracker::MessageScope alloc_scope("brain");
+                    std::string msg;
+                    {
+                        AllocTracker::StageScope read_stage(AllocTracker::STAGE_READ);
+                        buffer.resize(len);
+                        link_status = Liveness::recv_exact(sock, buffer.data(), len, g_brain_liveness,
+                                                           send_probe, shutdown_requested);
+
+                        if (link_status != Liveness::RECV_OK) {
+                            std::cerr << "[TCP] ✗ Recv body incomplete: "
+                                      << Liveness::recv_status_name(link_status) << std::endl;
+                            break;
+                        }
+
+                        msg.assign(buffer.begin(), buffer.end());
                     }
+                    TrafficCapture::record(TrafficCapture::BRAIN_IN, msg);
                     
                     messages_received_from_service++;
-                    std::string msg(buffer.begin(), buffer.end());
                     
                     std::cerr << "[TCP] ✓ Received message #" << messages_received_from_service 
                               << " - Size: " << len << " bytes" << std::endl;
                     
                     handle_service_message(msg);
+                    // Lo que tardó el handler (p.ej. backpressure hacia Chrome)
+                    // no es silencio de Brain
+                    g_brain_liveness.on_activity();
                 }
                 
                 std::cerr << "[TCP] Connection loop exited - received " 
@@ -956,9 +1650,30 @@ void tcp_client_loop() {
                 }
             }
             
+            if (link_status == Liveness::RECV_DEAD) {
+                int64_t idle_ms = g_brain_liveness.on_dead();
+                std::cerr << "[TCP] ✗ Brain silent for " << idle_ms << "ms - declaring peer dead" << std::endl;
+                if (g_logger.is_ready()) {
+                    g_logger.log_native("WARN", "BRAIN_DEAD idle_ms=" + std::to_string(idle_ms) +
+                                       " bound_ms=" + std::to_string(g_brain_liveness.dead_ms()) +
+                                       " frames=" + std::to_string(messages_received_from_service));
+                }
+                // Reconexión inmediata; pero si Brain acepta conexiones y nunca
+                // responde ni al REGISTER_HOST, que los reintentos usen backoff
+                if (messages_received_from_service == 0) reconnect_attempts++;
+            }
+
             service_socket.store(INVALID_SOCK);
+            outage_start = std::chrono::steady_clock::now();
+            g_brain_out.disable_credits();
+            g_brain_credits.reset();
             if (sock != INVALID_SOCK) {
                 std::cerr << "[TCP] Closing socket " << sock << std::endl;
+                // Con Brain colgado el writer puede estar bloqueado en send()
+                // con el buffer del kernel lleno: shutdown() lo despierta y
+                // service_mutex asegura que soltó el socket antes del close()
+                PlatformUtils::shutdown_socket(sock);
+                { std::lock_guard<std::mutex> lock(service_mutex); }
                 close_socket(sock);
             }
             
@@ -1278,16 +1993,159 @@ int main(int argc, char* argv[]) {
         
         std::string cli_profile_id = PlatformUtils::get_cli_argument(argc, argv, "--profile-id");
         std::string cli_launch_id = PlatformUtils::get_cli_argument(argc, argv, "--launch-id");
+
+        // Contabilidad de asignaciones (opt-in). Debe activarse antes de arrancar
+        // los threads para que todos los MessageScope vean el mismo estado.
+        {
+            const char* env_track = std::getenv("BLOOM_HOST_ALLOC_TRACK");
+            bool track = (env_track && std::string(env_track) == "1") ||
+                         CLIParser::has_flag(argc, argv, "--alloc-track");
+            AllocTracker::set_enabled(track);
+        }
+
+        {
+            // Captura de tráfico: --capture (payload completo) o --capture-redact
+            // (solo tamaños + metadata). Se abre al resolver el directorio de logs.
+            bool redact = CLIParser::has_flag(argc, argv, "--capture-redact");
+            if (redact || CLIParser::has_flag(argc, argv, "--capture")) {
+                TrafficCapture::set_enabled(true, redact);
+            }
+        }
+
+        {
+            std::string port_arg = PlatformUtils::get_cli_argument(argc, argv, "--service-port");
+            if (!port_arg.empty()) {
+                int port = std::atoi(port_arg.c_str());
+                if (port > 0 && port < 65536) {
+                    g_service_port = port;
+                } else {
+                    std::cerr << "[HOST] ⚠️ Invalid --service-port '" << port_arg
+                              << "' - using " << SERVICE_PORT << std::endl;
+                }
+            }
+
+            std::string limits_arg = PlatformUtils::get_cli_argument(argc, argv, "--rate-limits");
+            if (!limits_arg.empty()) {
+                Admission::Config admission_cfg;
+                std::string error;
+                if (Admission::parse_limits(limits_arg, admission_cfg, error)) {
+                    g_admission.configure(admission_cfg);
+                } else {
+                    std::cerr << "[HOST] ⚠️ Invalid --rate-limits: " << error << " - admission control off" << std::endl;
+                }
+            }
+
+            // --request-timeout-ms 0 desactiva la correlación de requests
+            std::string request_timeout_arg = PlatformUtils::get_cli_argument(argc, argv, "--request-timeout-ms");
+            if (!request_timeout_arg.empty()) {
+                char* end = nullptr;
+                long timeout_ms = std::strtol(request_timeout_arg.c_str(), &end, 10);
+                if (end != request_timeout_arg.c_str() && *end == '\0' && timeout_ms >= 0 && timeout_ms <= 600000) {
+                    g_requests.set_timeout_ms(static_cast<int>(timeout_ms));
+                } else {
+                    std::cerr << "[HOST] ⚠️ Invalid --request-timeout-ms '" << request_timeout_arg
+                              << "' - using " << REQUEST_TIMEOUT_MS << std::endl;
+                }
+            }
+
+            std::string dedup_arg = PlatformUtils::get_cli_argument(argc, argv, "--dedup");
+            if (!dedup_arg.empty()) {
+                Dedup::Config dedup_cfg;
+                std::string error;
+                if (Dedup::parse_config(dedup_arg, dedup_cfg, error)) {
+                    g_dedup_to_brain.configure(dedup_cfg);
+                    g_dedup_to_chrome.configure(dedup_cfg);
+                } else {
+                    std::cerr << "[HOST] ⚠️ Invalid --dedup: " << error << " - dedup disabled" << std::endl;
+                }
+            }
+
+            std::string delta_arg = PlatformUtils::get_cli_argument(argc, argv, "--delta");
+            if (!delta_arg.empty()) {
+                Delta::Config delta_cfg;
+                std::string error;
+                if (Delta::parse_config(delta_arg, delta_cfg, error)) {
+                    g_delta.configure(delta_cfg);
+                } else {
+                    std::cerr << "[HOST] ⚠️ Invalid --delta: " << error << " - delta encoding disabled" << std::endl;
+                }
+            }
+
+            // --validate-frames off: sin chequeo de UTF-8 / estructura antes del parse
+            std::string validate_arg = PlatformUtils::get_cli_argument(argc, argv, "--validate-frames");
+            if (validate_arg == "off") {
+                g_frame_validator.set_enabled(false);
+            } else if (!validate_arg.empty() && validate_arg != "on") {
+                std::cerr << "[HOST] ⚠️ Invalid --validate-frames '" << validate_arg << "' - using on" << std::endl;
+            }
+
+            // --splice N: frames Chrome → Brain de N bytes o más van por
+            // splice(2); "on" = SPLICE_MIN_BYTES, 0 u "off" (default) lo
+            // desactiva. stdin queda sin buffer de stdio para que lo leído
+            // coincida con la posición del fd.
+            std::string splice_arg = PlatformUtils::get_cli_argument(argc, argv, "--splice");
+            if (!splice_arg.empty()) {
+                char* end = nullptr;
+                unsigned long long min_bytes = std::strtoull(splice_arg.c_str(), &end, 10);
+                if (splice_arg == "off") {
+                    g_splice.set_min_bytes(0);
+                } else if (splice_arg == "on") {
+                    g_splice.set_min_bytes(SPLICE_MIN_BYTES);
+                } else if (end != splice_arg.c_str() && *end == '\0' && min_bytes <= MAX_MESSAGE_SIZE) {
+                    g_splice.set_min_bytes(static_cast<size_t>(min_bytes));
+                } else {
+                    std::cerr << "[HOST] ⚠️ Invalid --splice '" << splice_arg
+                              << "' - splice off" << std::endl;
+                }
+            }
+            // El cuerpo spliceado no pasa por el validador: con la validación
+            // activa el fast path no se abre.
+            if (g_splice.min_bytes() > 0 && g_frame_validator.enabled()) {
+                std::cerr << "[HOST] ⚠️ --splice needs --validate-frames off - splice off" << std::endl;
+                g_splice.set_min_bytes(0);
+            }
+            if (g_splice.min_bytes() > 0 && Splice::supported()) {
+                std::string error;
+                if (g_splice.open(fileno(stdin), error)) {
+                    setvbuf(stdin, nullptr, _IONBF, 0);
+                } else {
+                    std::cerr << "[HOST] ⚠️ Splice disabled: " << error << std::endl;
+                }
+            }
+
+            // --brain-dead-ms 0 desactiva la detección de Brain colgado
+            std::string dead_arg = PlatformUtils::get_cli_argument(argc, argv, "--brain-dead-ms");
+            if (!dead_arg.empty()) {
+                char* end = nullptr;
+                long dead_ms = std::strtol(dead_arg.c_str(), &end, 10);
+                if (end != dead_arg.c_str() && *end == '\0' && dead_ms >= 0 && dead_ms <= 600000) {
+                    g_brain_liveness.set_dead_ms(static_cast<int>(dead_ms));
+                } else {
+                    std::cerr << "[HOST] ⚠️ Invalid --brain-dead-ms '" << dead_arg
+                              << "' - using " << BRAIN_DEAD_PEER_MS << std::endl;
+                }
+            }
+        }
         
         std::cerr << "============================================" << std::endl;
         std::cerr << "[HOST] bloom-host.cpp - Build " << BUILD << std::endl;
         std::cerr << "[HOST] Version: " << VERSION << " (Synapse Protocol)" << std::endl;
         std::cerr << "[HOST] PID: " << PlatformUtils::get_current_pid() << std::endl;
-        std::cerr << "[HOST] Service Port: " << SERVICE_PORT << std::endl;
+        std::cerr << "[HOST] Service Port: " << g_service_port << std::endl;
         std::cerr << "[HOST] Max Chrome Message: " << MAX_CHROME_MSG_SIZE << " bytes" << std::endl;
-        std::cerr << "[HOST] Reconnect Delay: " << RECONNECT_DELAY_MS << "ms" << std::endl;
+        std::cerr << "[HOST] Reconnect Delay: " << RECONNECT_DELAY_MS << "-" << RECONNECT_MAX_DELAY_MS
+                  << "ms (decorrelated jitter)" << std::endl;
+        std::cerr << "[HOST] Splice Chrome->Brain: "
+                  << (g_splice.enabled() ? ">= " + std::to_string(g_splice.min_bytes()) + " bytes" : std::string("off"))
+                  << std::endl;
+        std::cerr << "[HOST] Frame Validation: "
+                  << (g_frame_validator.enabled() ? FrameValidator::isa_name(FrameValidator::best_isa()) : "off")
+                  << std::endl;
+        std::cerr << "[HOST] Brain Dead-Peer Bound: " << g_brain_liveness.dead_ms() << "ms"
+                  << (g_brain_liveness.enabled() ? "" : " (disabled)") << std::endl;
         std::cerr << "[HOST] Max Queue Size: " << MAX_QUEUED_MESSAGES << std::endl;
         std::cerr << "[HOST] Heartbeat Interval: " << HEARTBEAT_INTERVAL_SEC << "s" << std::endl;
+        std::cerr << "[HOST] Alloc Tracking: " << (AllocTracker::is_enabled() ? "ON" : "OFF") << std::endl;
         std::cerr << "============================================" << std::endl;
         
         std::cerr << "[HOST] CLI args: profile='" << cli_profile_id 
@@ -1452,6 +2310,7 @@ int main(int argc, char* argv[]) {
             }
 
             std::string msg_str(buf.begin(), buf.end());
+            TrafficCapture::record(TrafficCapture::CHROME_IN, msg_str);
             write_boot_log("[BOOT] First stdin message: " + msg_str.substr(0, 200));
 
             try {
@@ -1499,6 +2358,38 @@ int main(int argc, char* argv[]) {
             std::cerr << "[HOST] ✓ Identity from extension_ready" << std::endl;
         }
 
+        if (TrafficCapture::is_enabled()) {
+            std::string log_dir = g_logger.get_log_directory();
+            if (log_dir.empty()) {
+                std::cerr << "[CAPTURE] ⚠️ No log directory - capture disabled" << std::endl;
+                TrafficCapture::set_enabled(false, false);
+            } else {
+#if defined(_WIN32) || defined(__MINGW32__) || defined(__MINGW64__)
+                std::string capture_path = log_dir + "\\capture_" + cli_launch_id + ".bcap";
+#else
+                std::string capture_path = log_dir + "/capture_" + cli_launch_id + ".bcap";
+#endif
+                if (TrafficCapture::open(capture_path)) {
+                    std::cerr << "[CAPTURE] ✓ Recording frames to " << capture_path << std::endl;
+                    if (g_logger.is_ready()) {
+                        g_logger.log_native("INFO", "CAPTURE_OPEN path=" + capture_path);
+                    }
+                } else {
+                    std::cerr << "[CAPTURE] ✗ Cannot open " << capture_path << std::endl;
+                    TrafficCapture::set_enabled(false, false);
+                }
+            }
+        }
+
+        std::cerr << "[HOST] Starting outbound writer threads..." << std::endl;
+        g_chrome_out.start();
+        g_brain_out.start();
+        g_extension_logs.start();
+        g_requests.start(send_request_timeout);
+
+        g_brain_ready_file = Reconnect::ready_file_path(
+            !cli_user_base_dir.empty() ? cli_user_base_dir : get_default_base_dir());
+
         std::cerr << "[HOST] Starting TCP client thread..." << std::endl;
         std::thread tcp_thread(tcp_client_loop);
 
@@ -1553,18 +2444,39 @@ int main(int argc, char* argv[]) {
                 continue;
             }
             
-            std::vector<char> buf(len);
-            if (!std::cin.read(buf.data(), len)) {
-                std::cerr << "[STDIN] ✗ Read incomplete - expected " << len << " bytes" << std::endl;
-                if (g_logger.is_ready()) {
-                    g_logger.log_native("ERROR", "STDIN_READ_INCOMPLETE Expected=" + std::to_string(len));
+            AllocTracker::MessageScope alloc_scope("chrome");
+            std::string msg_str;
+            bool spliced = false;
+            {
+                AllocTracker::StageScope read_stage(AllocTracker::STAGE_READ);
+                // Frame grande: primero solo el prefijo, por si el resto puede
+                // ir directo de stdin al socket de Brain
+                size_t have = 0;
+                bool read_ok = true;
+                if (g_splice.enabled() && len >= g_splice.min_bytes()) {
+                    have = std::min<size_t>(len, SPLICE_PREFIX_BYTES);
+                    msg_str.resize(have);
+                    read_ok = static_cast<bool>(std::cin.read(&msg_str[0], have));
+                    if (read_ok) spliced = splice_chrome_frame(msg_str, len);
+                }
+                if (read_ok && !spliced) {
+                    msg_str.resize(len);
+                    read_ok = static_cast<bool>(std::cin.read(&msg_str[have], len - have));
+                }
+                if (!read_ok) {
+                    std::cerr << "[STDIN] ✗ Read incomplete - expected " << len << " bytes" << std::endl;
+                    if (g_logger.is_ready()) {
+                        g_logger.log_native("ERROR", "STDIN_READ_INCOMPLETE Expected=" + std::to_string(len));
+                    }
+                    break;
                 }
-                break;
             }
-            
+
             stdin_messages++;
             g_messages_received.fetch_add(1);
-            std::string msg_str(buf.begin(), buf.end());
+            if (spliced) continue;
+
+            TrafficCapture::record(TrafficCapture::CHROME_IN, msg_str);
             
             std::cerr << "[STDIN] ✓ Read message #" << stdin_messages 
                       << " - Size: " << len << " bytes" << std::endl;
@@ -1579,29 +2491,37 @@ int main(int argc, char* argv[]) {
         
         if (g_logger.is_ready()) {
             g_logger.log_native("INFO", "SHUTDOWN StdinMessages=" + std::to_string(stdin_messages));
+            g_logger.log_native("INFO", "CPU_SUMMARY total_ms=" + std::to_string(CpuProfiler::total_ms()) +
+                                " top=" + CpuProfiler::top_json(CPU_TOP_N).dump());
+            if (AllocTracker::is_enabled()) {
+                g_logger.log_native("INFO", "ALLOC_SUMMARY " + AllocTracker::stats_json().dump());
+            }
         }
 
         // ── GRACEFUL DISCONNECT ───────────────────────────────────────────────
         // Notificar a Brain ANTES de cerrar el socket para que pueda cerrar
         // la conexión desde su lado limpiamente (evita WinError 64 en readexactly).
-        // Se envía directamente al socket sin pasar por write_to_service
-        // para evitar el lock de service_mutex que puede estar tomado por otro thread.
+        // Primero se vacía lo ya encolado hacia Brain; UNREGISTER_HOST va por
+        // la cola de control para no intercalarse con un frame en escritura.
         {
             socket_t sock_notify = service_socket.load();
             if (sock_notify != INVALID_SOCK) {
+                if (!g_brain_out.drain(OUTBOUND_DRAIN_MS)) {
+                    std::cerr << "[HOST] ⚠️ Brain outbound queue not drained in " << OUTBOUND_DRAIN_MS << "ms" << std::endl;
+                }
+                send_admission_report(true);
                 json unreg;
                 unreg["type"]       = "UNREGISTER_HOST";
                 unreg["profile_id"] = g_profile_id;
                 unreg["launch_id"]  = g_launch_id;
                 unreg["reason"]     = "STDIN_EOF";
                 unreg["timestamp"]  = get_timestamp_ms();
-                std::string unreg_str = unreg.dump();
-                uint32_t net_len = htonl(static_cast<uint32_t>(unreg_str.size()));
-                send(sock_notify, (const char*)&net_len, 4, 0);
-                send(sock_notify, unreg_str.c_str(), unreg_str.size(), 0);
-                std::cerr << "[HOST] UNREGISTER_HOST sent to Brain (graceful disconnect)" << std::endl;
-                if (g_logger.is_ready()) {
-                    g_logger.log_native("INFO", "UNREGISTER_HOST_SENT reason=STDIN_EOF");
+                write_to_service(unreg.dump(), OutboundScheduler::CONTROL);
+                if (g_brain_out.drain(OUTBOUND_DRAIN_MS)) {
+                    std::cerr << "[HOST] UNREGISTER_HOST sent to Brain (graceful disconnect)" << std::endl;
+                    if (g_logger.is_ready()) {
+                        g_logger.log_native("INFO", "UNREGISTER_HOST_SENT reason=STDIN_EOF");
+                    }
                 }
             }
         }
@@ -1614,6 +2534,8 @@ int main(int argc, char* argv[]) {
             close_socket(sock);
         }
         
+        g_requests.stop();
+
         std::cerr << "[HOST] Waiting for TCP thread to exit..." << std::endl;
         if (tcp_thread.joinable()) tcp_thread.join();
         std::cerr << "[HOST] ✓ TCP thread joined" << std::endl;
@@ -1626,7 +2548,49 @@ int main(int argc, char* argv[]) {
         if (chrome_keepalive_thread.joinable()) chrome_keepalive_thread.join();
         std::cerr << "[HOST] ✓ Chrome keepalive thread joined" << std::endl;
 
+        g_brain_out.stop();
+        g_chrome_out.stop();
+        g_extension_logs.stop();
+        std::cerr << "[HOST] ✓ Outbound writer threads stopped" << std::endl;
+        if (g_logger.is_ready()) {
+            json outbound;
+            outbound["chrome"] = g_chrome_out.stats_json();
+            outbound["brain"] = g_brain_out.stats_json();
+            g_logger.log_native("INFO", "OUTBOUND_SUMMARY " + outbound.dump());
+            g_logger.log_native("INFO", "EXTENSION_LOG_SUMMARY " + g_extension_logs.stats_json().dump());
+            g_logger.log_native("INFO", "REQUEST_SUMMARY " + g_requests.stats_json().dump());
+            if (g_dedup_to_brain.enabled()) {
+                json dedup;
+                dedup["chrome_to_brain"] = g_dedup_to_brain.stats_json();
+                dedup["brain_to_chrome"] = g_dedup_to_chrome.stats_json();
+                g_logger.log_native("INFO", "DEDUP_SUMMARY " + dedup.dump());
+            }
+            if (g_delta.configured()) {
+                g_logger.log_native("INFO", "DELTA_SUMMARY " + g_delta.stats_json().dump());
+            }
+            json projections = g_projections.stats_json();
+            if (projections["updates"] > 0 || !projections["kinds"].empty()) {
+                g_logger.log_native("INFO", "PROJECTION_SUMMARY " + projections.dump());
+            }
+            if (g_subscriptions.generation() > 0) {
+                g_logger.log_native("INFO", "SUBSCRIPTION_SUMMARY " + g_subscriptions.stats_json().dump());
+            }
+            json splice = g_splice.stats_json();
+            if (splice["frames"].get<uint64_t>() > 0 || !splice["skipped"].empty()) {
+                g_logger.log_native("INFO", "SPLICE_SUMMARY " + splice.dump());
+            }
+        }
+
         PlatformUtils::cleanup_networking();
+
+        if (TrafficCapture::is_enabled()) {
+            uint64_t records = TrafficCapture::close();
+            std::cerr << "[CAPTURE] ✓ Closed " << TrafficCapture::path()
+                      << " records=" << records << std::endl;
+            if (g_logger.is_ready()) {
+                g_logger.log_native("INFO", "CAPTURE_CLOSED records=" + std::to_string(records));
+            }
+        }
         
         std::cerr << "============================================" << std::endl;
         std::cerr << "[HOST] Clean shutdown complete" << std::endl;
@@ -1635,6 +2599,14 @@ int main(int argc, char* argv[]) {
         std::cerr << "  Total received from Chrome: " << g_messages_received.load() << std::endl;
         std::cerr << "  Total heartbeats: " << g_heartbeat_count.load() << std::endl;
         std::cerr << "  Handshake final state: " << g_handshake_state.load() << std::endl;
+        std::cerr << "  Message CPU total: " << CpuProfiler::total_ms() << " ms" << std::endl;
+        for (const auto& entry : CpuProfiler::top_json(CPU_TOP_N)) {
+            std::cerr << "    " << entry["kind"].get<std::string>()
+                      << " count=" << entry["count"].get<uint64_t>()
+                      << " total_ms=" << entry["cpu_total_ms"].get<double>()
+                      << " avg_us=" << entry["cpu_avg_us"].get<double>()
+                      << " max_us=" << entry["cpu_max_us"].get<double>() << std::endl;
+        }
         std::cerr << "============================================" << std::endl;
         
         return 0;
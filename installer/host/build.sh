@@ -22,6 +22,28 @@ SOURCE_FILES=(
     "platform_utils.cpp"
     "cli_handler.cpp"
     "help_renderer.cpp"
+    "alloc_tracker.cpp"
+    "cpu_profiler.cpp"
+    "message_utils.cpp"
+    "traffic_capture.cpp"
+    "self_bench.cpp"
+    "health_probe.cpp"
+    "log_analyzer.cpp"
+    "outbound_scheduler.cpp"
+    "flow_control.cpp"
+    "reconnect_policy.cpp"
+    "link_liveness.cpp"
+    "admission_control.cpp"
+    "extension_logs.cpp"
+    "request_tracker.cpp"
+    "fast_hash.cpp"
+    "dedup_filter.cpp"
+    "delta_encoder.cpp"
+    "projection.cpp"
+    "subscription_filter.cpp"
+    "splice_forward.cpp"
+    "chunk_checksum.cpp"
+    "frame_validator.cpp"
 )
 
 HEADER_FILES=(
@@ -30,6 +52,29 @@ HEADER_FILES=(
     "platform_utils.h"
     "cli_handler.h"
     "help_renderer.h"
+    "alloc_tracker.h"
+    "cpu_profiler.h"
+    "message_utils.h"
+    "traffic_capture.h"
+    "self_bench.h"
+    "health_probe.h"
+    "log_analyzer.h"
+    "outbound_scheduler.h"
+    "outbound_frame.h"
+    "flow_control.h"
+    "reconnect_policy.h"
+    "link_liveness.h"
+    "admission_control.h"
+    "extension_logs.h"
+    "request_tracker.h"
+    "fast_hash.h"
+    "dedup_filter.h"
+    "delta_encoder.h"
+    "projection.h"
+    "subscription_filter.h"
+    "splice_forward.h"
+    "chunk_checksum.h"
+    "frame_validator.h"
 )
 
 HEADER_DIR="nlohmann"
@@ -206,7 +251,7 @@ if command -v x86_64-w64-mingw32-g++ &> /dev/null; then
         -o "$OUT_DIR/win64/host/bloom-host.exe" \
         -L"$OPENSSL_LIB" \
         "$OPENSSL_LIB/libssl.a" "$OPENSSL_LIB/libcrypto.a" \
-        -lws2_32 -lshell32 -lcrypt32 -luser32 -lgdi32 \
+        -lws2_32 -lshell32 -lcrypt32 -luser32 -lgdi32 -lpsapi \
         -static-libgcc -static-libstdc++ \
         -Wl,--subsystem,console
     
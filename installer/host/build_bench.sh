@@ -0,0 +1,65 @@
+#!/bin/bash
+set -e
+
+RED='\033[0;31m'
+GREEN='\033[0;32m'
+YELLOW='\033[1;33m'
+NC='\033[0m'
+
+echo -e "${YELLOW}⚙️ Building Bloom Host benchmarks${NC}"
+
+SCRIPT_DIR="$( cd "$( dirname "${BASH_SOURCE[0]}" )" && pwd )"
+cd "$SCRIPT_DIR"
+
+# ============================================================================
+# TARGETS
+#
+# Solo POSIX (Linux/macOS): el harness lanza bloom-host con fork/exec.
+# No toca build_number.txt: los benchmarks no son artefactos de release.
+# ============================================================================
+# Formato: "nombre:fuente1 fuente2 ..."
+# Los micro-benchmarks enlazan los mismos .cpp que bloom-host (sin main).
+BENCH_TARGETS=(
+    "bloom-host-bench:bench/bloom_host_bench.cpp bench/bench_common.cpp"
+    "bloom-host-scale:bench/bloom_host_scale.cpp bench/bench_common.cpp"
+    "bloom-host-microbench:bench/bloom_host_microbench.cpp chunked_buffer.cpp chunk_checksum.cpp frame_validator.cpp fast_hash.cpp synapse_logger.cpp message_utils.cpp alloc_tracker.cpp projection.cpp"
+    "bloom-host-replay:bench/bloom_host_replay.cpp bench/bench_common.cpp traffic_capture.cpp"
+    "bloom-host-soak:bench/bloom_host_soak.cpp bench/bench_common.cpp"
+)
+
+OUT_DIR="$SCRIPT_DIR/bench/bin"
+mkdir -p "$OUT_DIR"
+
+CXX="${CXX:-g++}"
+CXXFLAGS="${CXXFLAGS:--std=c++20 -O2}"
+
+# OpenSSL en Homebrew (macOS)
+EXTRA_INC=""
+EXTRA_LIB=""
+for prefix in /opt/homebrew/opt/openssl@3 /usr/local/opt/openssl@3; do
+    if [ -d "$prefix/include" ]; then
+        EXTRA_INC="-I$prefix/include"
+        EXTRA_LIB="-L$prefix/lib"
+        break
+    fi
+done
+
+for target in "${BENCH_TARGETS[@]}"; do
+    name="${target%%:*}"
+    srcs=(${target#*:})
+    for src in "${srcs[@]}"; do
+        if [ ! -f "$src" ]; then
+            echo -e "${RED}✗ Missing source file: $src${NC}"
+            exit 1
+        fi
+    done
+    echo -e "${YELLOW}  Compiling $name...${NC}"
+    $CXX $CXXFLAGS -I. -Ibench $EXTRA_INC \
+        "${srcs[@]}" \
+        -o "$OUT_DIR/$name" \
+        $EXTRA_LIB -lpthread -lcrypto
+    echo -e "${GREEN}✓ $OUT_DIR/$name${NC}"
+done
+
+echo ""
+echo -e "${GREEN}Run: $OUT_DIR/bloom-host-bench --host <path/to/bloom-host>${NC}"
@@ -0,0 +1,237 @@
+#include "chunk_checksum.h"
+
+#include <cstring>
+#include <openssl/evp.h>
+
+#include "fast_hash.h"
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+    #include <nmmintrin.h>
+    #define CHECKSUM_CRC32C_SSE42 1
+#elif defined(__aarch64__) && defined(__ARM_FEATURE_CRC32)
+    #include <arm_acle.h>
+    #define CHECKSUM_CRC32C_ARM 1
+#endif
+
+namespace Checksum {
+
+namespace {
+
+const uint32_t CRC32C_POLY = 0x82F63B78;   // Castagnoli, reflejado
+
+// Orden de preferencia del host: el más barato primero
+const Algo PREFERENCE[] = {ALGO_CRC32C, ALGO_XXH64, ALGO_SHA256};
+
+std::string to_hex(const unsigned char* bytes, size_t len) {
+    static const char DIGITS[] = "0123456789abcdef";
+    std::string out(len * 2, '\0');
+    for (size_t i = 0; i < len; ++i) {
+        out[2 * i]     = DIGITS[bytes[i] >> 4];
+        out[2 * i + 1] = DIGITS[bytes[i] & 0x0f];
+    }
+    return out;
+}
+
+// Big endian: el hex se lee como el número ("%08x" / "%016llx")
+std::string to_hex(uint64_t value, size_t bytes) {
+    unsigned char buf[8];
+    for (size_t i = 0; i < bytes; ++i) buf[i] = static_cast<unsigned char>(value >> (8 * (bytes - 1 - i)));
+    return to_hex(buf, bytes);
+}
+
+// Slicing-by-8 para CPUs sin la instrucción
+struct Crc32cTable {
+    uint32_t t[8][256];
+    Crc32cTable() {
+        for (uint32_t i = 0; i < 256; ++i) {
+            uint32_t c = i;
+            for (int k = 0; k < 8; ++k) c = (c >> 1) ^ (CRC32C_POLY & (0u - (c & 1)));
+            t[0][i] = c;
+        }
+        for (uint32_t i = 0; i < 256; ++i) {
+            for (int s = 1; s < 8; ++s) t[s][i] = (t[s - 1][i] >> 8) ^ t[0][t[s - 1][i] & 0xff];
+        }
+    }
+};
+
+uint32_t crc32c_software(uint32_t crc, const unsigned char* p, size_t len) {
+    static const Crc32cTable table;
+    const auto& t = table.t;
+    while (len >= 8) {
+        uint32_t lo, hi;
+        std::memcpy(&lo, p, 4);       // little endian en todas las plataformas soportadas
+        std::memcpy(&hi, p + 4, 4);
+        lo ^= crc;
+        crc = t[7][lo & 0xff] ^ t[6][(lo >> 8) & 0xff] ^ t[5][(lo >> 16) & 0xff] ^ t[4][lo >> 24] ^
+              t[3][hi & 0xff] ^ t[2][(hi >> 8) & 0xff] ^ t[1][(hi >> 16) & 0xff] ^ t[0][hi >> 24];
+        p += 8;
+        len -= 8;
+    }
+    while (len--) crc = (crc >> 8) ^ t[0][(crc ^ *p++) & 0xff];
+    return crc;
+}
+
+#if defined(CHECKSUM_CRC32C_SSE42)
+
+__attribute__((target("sse4.2")))
+uint32_t crc32c_hardware(uint32_t crc, const unsigned char* p, size_t len) {
+  #if defined(__x86_64__)
+    uint64_t c = crc;
+    while (len >= 8) {
+        uint64_t v;
+        std::memcpy(&v, p, 8);
+        c = _mm_crc32_u64(c, v);
+        p += 8;
+        len -= 8;
+    }
+    crc = static_cast<uint32_t>(c);
+  #endif
+    while (len >= 4) {
+        uint32_t v;
+        std::memcpy(&v, p, 4);
+        crc = _mm_crc32_u32(crc, v);
+        p += 4;
+        len -= 4;
+    }
+    while (len--) crc = _mm_crc32_u8(crc, *p++);
+    return crc;
+}
+
+bool detect_hardware() { return __builtin_cpu_supports("sse4.2"); }
+
+#elif defined(CHECKSUM_CRC32C_ARM)
+
+uint32_t crc32c_hardware(uint32_t crc, const unsigned char* p, size_t len) {
+    while (len >= 8) {
+        uint64_t v;
+        std::memcpy(&v, p, 8);
+        crc = __crc32cd(crc, v);
+        p += 8;
+        len -= 8;
+    }
+    while (len--) crc = __crc32cb(crc, *p++);
+    return crc;
+}
+
+bool detect_hardware() { return true; }
+
+#else
+
+uint32_t crc32c_hardware(uint32_t crc, const unsigned char* p, size_t len) {
+    return crc32c_software(crc, p, len);
+}
+
+bool detect_hardware() { return false; }
+
+#endif
+
+const bool HARDWARE_CRC32C = detect_hardware();
+
+}  // namespace
+
+// ============================================================================
+// ALGORITMOS
+// ============================================================================
+
+const char* algo_name(Algo algo) {
+    switch (algo) {
+        case ALGO_CRC32C: return "crc32c";
+        case ALGO_XXH64:  return "xxh64";
+        default:          return "sha256";
+    }
+}
+
+bool parse_algo(const std::string& name, Algo& algo) {
+    if      (name == "sha256") algo = ALGO_SHA256;
+    else if (name == "crc32c") algo = ALGO_CRC32C;
+    else if (name == "xxh64")  algo = ALGO_XXH64;
+    else return false;
+    return true;
+}
+
+nlohmann::json supported_algos() {
+    nlohmann::json names = nlohmann::json::array();
+    for (Algo algo : PREFERENCE) names.push_back(algo_name(algo));
+    return names;
+}
+
+Algo negotiate(const nlohmann::json& offered) {
+    if (!offered.is_array()) return ALGO_SHA256;
+    for (Algo algo : PREFERENCE) {
+        for (const auto& name : offered) {
+            if (name.is_string() && name == algo_name(algo)) return algo;
+        }
+    }
+    return ALGO_SHA256;
+}
+
+bool crc32c_accelerated() { return HARDWARE_CRC32C; }
+
+uint32_t crc32c(uint32_t crc, const void* data, size_t len) {
+    const unsigned char* p = static_cast<const unsigned char*>(data);
+    crc = ~crc;
+    crc = HARDWARE_CRC32C ? crc32c_hardware(crc, p, len) : crc32c_software(crc, p, len);
+    return ~crc;
+}
+
+// ============================================================================
+// HASHER
+// ============================================================================
+
+struct Hasher::State {
+    EVP_MD_CTX*          sha = nullptr;
+    uint32_t             crc = 0;
+    FastHash::Xxh64State xxh;
+
+    ~State() {
+        if (sha) EVP_MD_CTX_free(sha);
+    }
+};
+
+Hasher::Hasher(Algo algo) : algo_(algo), state_(new State()) {
+    if (algo_ == ALGO_SHA256) {
+        state_->sha = EVP_MD_CTX_new();
+        if (state_->sha && EVP_DigestInit_ex(state_->sha, EVP_sha256(), nullptr) != 1) {
+            EVP_MD_CTX_free(state_->sha);
+            state_->sha = nullptr;
+        }
+    }
+}
+
+Hasher::~Hasher() = default;
+Hasher::Hasher(Hasher&& other) noexcept = default;
+Hasher& Hasher::operator=(Hasher&& other) noexcept = default;
+
+void Hasher::update(const void* data, size_t len) {
+    if (!state_ || len == 0) return;
+    switch (algo_) {
+        case ALGO_CRC32C: state_->crc = crc32c(state_->crc, data, len); break;
+        case ALGO_XXH64:  state_->xxh.update(data, len); break;
+        default:
+            if (state_->sha) EVP_DigestUpdate(state_->sha, data, len);
+            break;
+    }
+}
+
+std::string Hasher::hex_digest() {
+    if (!state_) return std::string();
+    switch (algo_) {
+        case ALGO_CRC32C: return to_hex(state_->crc, 4);
+        case ALGO_XXH64:  return to_hex(state_->xxh.digest(), 8);
+        default: {
+            unsigned char digest[EVP_MAX_MD_SIZE];
+            unsigned int len = 0;
+            // Sin contexto (EVP sin memoria) el digest queda vacío: no coincide con nada
+            if (!state_->sha || EVP_DigestFinal_ex(state_->sha, digest, &len) != 1) return std::string();
+            return to_hex(digest, len);
+        }
+    }
+}
+
+std::string hex_digest(Algo algo, const void* data, size_t len) {
+    Hasher hasher(algo);
+    hasher.update(data, len);
+    return hasher.hex_digest();
+}
+
+}  // namespace Checksum
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <nlohmann/json.hpp>
+
+/**
+ * @brief Checksum de integridad de los uploads bloom_chunk (chunked_buffer.h)
+ *
+ * El footer de cada upload trae "checksum_verify" del payload completo.
+ * Era siempre SHA-256: en un pipe local no hay adversario y un hash
+ * criptográfico cuesta bastante más CPU que lo que hace falta para detectar
+ * un chunk perdido o corrupto. Algoritmos:
+ *
+ *   crc32c   CRC-32C (Castagnoli), SSE4.2 / ARMv8 CRC si hay; 8 hex
+ *   xxh64    XXH64 (fast_hash.h), 16 hex
+ *   sha256   SHA-256 por EVP de OpenSSL (usa SHA-NI / ARMv8 SHA2), 64 hex
+ *
+ * Negociación: host_ready manda "checksum_algos" (los del host, en orden de
+ * preferencia) y "checksum_algo", una sugerencia: el primero de esos que la
+ * extensión ofreció en extension_ready ("checksum_algos": [...]; sha256 si
+ * no ofreció nada), o el preferido del host en el host_ready proactivo, que
+ * sale antes de extension_ready. Lo que decide es cada header de upload
+ * ("checksum_algo"); sin él se verifica con sha256, como antes. El host no
+ * guarda un algoritmo acordado.
+ *
+ * El hash se actualiza con cada chunk de datos ya decodificado; el footer
+ * solo cierra y compara.
+ */
+namespace Checksum {
+
+    enum Algo { ALGO_SHA256 = 0, ALGO_CRC32C, ALGO_XXH64 };
+
+    const char* algo_name(Algo algo);
+
+    /** @return false si name no es un algoritmo conocido */
+    bool parse_algo(const std::string& name, Algo& algo);
+
+    /** Algoritmos del host en orden de preferencia (host_ready). */
+    nlohmann::json supported_algos();
+
+    /** Primero de supported_algos() que esté en offered; ALGO_SHA256 si ninguno. */
+    Algo negotiate(const nlohmann::json& offered);
+
+    /** true si crc32c() usa la instrucción de hardware. */
+    bool crc32c_accelerated();
+
+    /** CRC-32C incremental: crc = 0 para empezar, el resultado de la parte anterior para seguir. */
+    uint32_t crc32c(uint32_t crc, const void* data, size_t len);
+
+    /** Digest incremental de un algoritmo; move-only. */
+    class Hasher {
+    public:
+        explicit Hasher(Algo algo = ALGO_SHA256);
+        ~Hasher();
+
+        Hasher(Hasher&& other) noexcept;
+        Hasher& operator=(Hasher&& other) noexcept;
+        Hasher(const Hasher&) = delete;
+        Hasher& operator=(const Hasher&) = delete;
+
+        Algo algo() const { return algo_; }
+
+        void update(const void* data, size_t len);
+
+        /** Digest en hex minúscula; cierra el hasher (no llamar a update() después). */
+        std::string hex_digest();
+
+    private:
+        struct State;
+
+        Algo                   algo_;
+        std::unique_ptr<State> state_;
+    };
+
+    /** Digest de un buffer entero. */
+    std::string hex_digest(Algo algo, const void* data, size_t len);
+
+}  // namespace Checksum
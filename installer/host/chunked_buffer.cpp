@@ -1,12 +1,16 @@
 #include "chunked_buffer.h"
-#include <openssl/sha.h>
-#include <sstream>
-#include <iomanip>
 
-std::vector<uint8_t> ChunkedMessageBuffer::base64_decode(const std::string& encoded) {
+namespace {
+
+template <typename Out>
+void base64_decode_into(const std::string& encoded, Out& decoded) {
     static const std::string base64_chars = 
         "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
-    std::vector<uint8_t> decoded;
+    // Tamaño exacto (sin el padding): un reserve de más realocaría el buffer
+    // que el header del mensaje ya dimensionó
+    size_t padding = 0;
+    while (padding < 2 && padding < encoded.size() && encoded[encoded.size() - 1 - padding] == '=') padding++;
+    decoded.reserve(decoded.size() + encoded.size() / 4 * 3 - padding);
     int val = 0, valb = -8;
     for (unsigned char c : encoded) {
         if (c == '=') break;
@@ -15,29 +19,40 @@ std::vector<uint8_t> ChunkedMessageBuffer::base64_decode(const std::string& enco
         val = (val << 6) + (int)pos;
         valb += 6;
         if (valb >= 0) {
-            decoded.push_back((val >> valb) & 0xFF);
+            decoded.push_back(static_cast<typename Out::value_type>((val >> valb) & 0xFF));
             valb -= 8;
         }
     }
+}
+
+}  // namespace
+
+std::vector<uint8_t> ChunkedMessageBuffer::base64_decode(const std::string& encoded) {
+    std::vector<uint8_t> decoded;
+    base64_decode_into(encoded, decoded);
     return decoded;
 }
 
+void ChunkedMessageBuffer::base64_decode_append(const std::string& encoded, std::string& out) {
+    base64_decode_into(encoded, out);
+}
+
 std::string ChunkedMessageBuffer::calculate_sha256(const std::vector<uint8_t>& data) {
-    unsigned char hash[SHA256_DIGEST_LENGTH];
-    SHA256(data.data(), data.size(), hash);
-    std::stringstream ss;
-    for(int i = 0; i < SHA256_DIGEST_LENGTH; i++)
-        ss << std::hex << std::setw(2) << std::setfill('0') << (int)hash[i];
-    return ss.str();
+    return calculate_sha256(data.data(), data.size());
+}
+
+std::string ChunkedMessageBuffer::calculate_sha256(const uint8_t* data, size_t size) {
+    return Checksum::hex_digest(Checksum::ALGO_SHA256, data, size);
 }
 
-ChunkedMessageBuffer::ChunkResult ChunkedMessageBuffer::process_chunk(
-    const json& msg, std::string& out_complete_msg) {
+ChunkedMessageBuffer::Processed ChunkedMessageBuffer::process_chunk(const json& msg) {
     
     std::lock_guard<std::mutex> lock(buffer_mutex);
+    Processed out;
     
     if (!msg.contains("bloom_chunk")) {
-        return CHUNK_ERROR;
+        out.result = CHUNK_ERROR;
+        return out;
     }
     
     const auto& chunk = msg["bloom_chunk"];
@@ -45,42 +60,84 @@ ChunkedMessageBuffer::ChunkResult ChunkedMessageBuffer::process_chunk(
     std::string msg_id = chunk.value("message_id", "");
     
     if (type == "header") {
+        Checksum::Algo algo = Checksum::ALGO_SHA256;
+        if (chunk.contains("checksum_algo") &&
+            !Checksum::parse_algo(chunk.value("checksum_algo", ""), algo)) {
+            out.result = CHUNK_ERROR;
+            return out;
+        }
         InProgressMessage ipm;
+        ipm.hasher = Checksum::Hasher(algo);
         ipm.total_chunks = chunk.value("total_chunks", 0);
         ipm.received_chunks = 0;
         ipm.expected_size = chunk.value("total_size_bytes", 0);
-        ipm.buffer.reserve(ipm.expected_size);
+        ipm.frame.data.reserve(OutboundFrame::HEADER_ROOM + ipm.expected_size);
         active_buffers[msg_id] = std::move(ipm);
-        return INCOMPLETE;
+        return out;
     }
     
     auto it = active_buffers.find(msg_id);
     if (it == active_buffers.end()) {
-        return CHUNK_ERROR;
+        out.result = CHUNK_ERROR;
+        return out;
     }
     
     if (type == "data") {
-        std::vector<uint8_t> decoded = base64_decode(chunk.value("data", ""));
-        it->second.buffer.insert(it->second.buffer.end(), decoded.begin(), decoded.end());
+        auto data = chunk.find("data");
+        if (data != chunk.end() && data->is_string()) {
+            std::string& buffer = it->second.frame.data;
+            const size_t before = buffer.size();
+            base64_decode_append(data->get_ref<const std::string&>(), buffer);
+            it->second.hasher.update(buffer.data() + before, buffer.size() - before);
+        }
         it->second.received_chunks++;
-        return INCOMPLETE;
+        return out;
     }
     
     if (type == "footer") {
-        std::string computed = calculate_sha256(it->second.buffer);
-        if (computed != chunk.value("checksum_verify", "")) {
+        ChecksumStats& st = checksum_stats[it->second.hasher.algo()];
+        std::string computed = it->second.hasher.hex_digest();
+        if (computed.empty() || computed != chunk.value("checksum_verify", "")) {
+            st.failed++;
             active_buffers.erase(it);
-            return COMPLETE_INVALID_CHECKSUM;
+            out.result = COMPLETE_INVALID_CHECKSUM;
+            return out;
         }
-        out_complete_msg = std::string(it->second.buffer.begin(), it->second.buffer.end());
+        st.messages++;
+        st.bytes += it->second.frame.size();
+        out.message = std::move(it->second.frame);
         active_buffers.erase(it);
-        return COMPLETE_VALID;
+        out.result = COMPLETE_VALID;
+        return out;
     }
     
-    return CHUNK_ERROR;
+    out.result = CHUNK_ERROR;
+    return out;
 }
 
 size_t ChunkedMessageBuffer::get_active_buffers_count() const {
     std::lock_guard<std::mutex> lock(buffer_mutex);
     return active_buffers.size();
+}
+
+json ChunkedMessageBuffer::get_checksum_stats() const {
+    std::lock_guard<std::mutex> lock(buffer_mutex);
+    json out = json::object();
+    for (const auto& entry : checksum_stats) {
+        out[Checksum::algo_name(entry.first)] = {
+            {"messages", entry.second.messages},
+            {"bytes",    entry.second.bytes},
+            {"failed",   entry.second.failed}
+        };
+    }
+    return out;
+}
+
+size_t ChunkedMessageBuffer::get_buffered_bytes() const {
+    std::lock_guard<std::mutex> lock(buffer_mutex);
+    size_t total = 0;
+    for (const auto& entry : active_buffers) {
+        total += entry.second.frame.data.capacity();
+    }
+    return total;
 }
\ No newline at end of file
@@ -7,16 +7,27 @@
 #include <cstdint>
 #include <nlohmann/json.hpp>
 
+#include "chunk_checksum.h"
+#include "outbound_frame.h"
+
 using json = nlohmann::json;
 
 /**
  * @brief Manejador de mensajes fragmentados entre Extension y Host
  * 
  * Protocolo de chunks:
- * 1. HEADER: {"bloom_chunk": {"type":"header", "message_id":"...", "total_chunks":N}}
+ * 1. HEADER: {"bloom_chunk": {"type":"header", "message_id":"...", "total_chunks":N,
+ *                             "checksum_algo":"crc32c"}}
  * 2. DATA:   {"bloom_chunk": {"type":"data", "message_id":"...", "data":"base64..."}}
- * 3. FOOTER: {"bloom_chunk": {"type":"footer", "message_id":"...", "checksum_verify":"sha256"}}
+ * 3. FOOTER: {"bloom_chunk": {"type":"footer", "message_id":"...", "checksum_verify":"hex"}}
+ * 
+ * checksum_algo: crc32c, xxh64 o sha256 (default si falta); ver
+ * chunk_checksum.h. El hash avanza con cada DATA; el footer solo compara.
  * 
+ * Los datos se decodifican directo en un OutboundFrame (lugar para el header
+ * de longitud delante): el mensaje completo sale por move hasta el writer de
+ * Brain y se manda como un solo frame, sin copiarlo.
+ *
  * Thread-safe mediante mutex interno.
  */
 class ChunkedMessageBuffer {
@@ -28,42 +39,70 @@ public:
         CHUNK_ERROR                  // Error en estructura del chunk
     };
     
+    struct Processed {
+        ChunkResult   result = INCOMPLETE;
+        OutboundFrame message;   // Mensaje ensamblado (solo si COMPLETE_VALID)
+    };
+
     /**
      * @brief Procesa un fragmento de mensaje
      * @param msg JSON del chunk recibido
-     * @param out_complete_msg String completo ensamblado (solo si COMPLETE_VALID)
-     * @return Estado del procesamiento
+     * @return Estado del procesamiento y, si se completó, el mensaje (se toma por move)
      */
-    ChunkResult process_chunk(const json& msg, std::string& out_complete_msg);
+    Processed process_chunk(const json& msg);
     
     /**
      * @brief Obtiene número de mensajes en progreso
      * @return Cantidad de buffers activos
      */
     size_t get_active_buffers_count() const;
-    
-private:
-    struct InProgressMessage {
-        std::vector<uint8_t> buffer;
-        size_t total_chunks;
-        size_t received_chunks;
-        size_t expected_size;
-    };
-    
-    std::map<std::string, InProgressMessage> active_buffers;
-    mutable std::mutex buffer_mutex;
+
+    /**
+     * @brief Bytes reservados por los buffers en progreso
+     * @return Suma de la capacidad de cada buffer (memoria retenida, no solo recibida)
+     */
+    size_t get_buffered_bytes() const;
     
     /**
      * @brief Decodifica string base64 a bytes
      * @param encoded String en base64
      * @return Vector de bytes decodificado
      */
-    std::vector<uint8_t> base64_decode(const std::string& encoded);
+    static std::vector<uint8_t> base64_decode(const std::string& encoded);
+
+    /** base64_decode() agregando al final de out. */
+    static void base64_decode_append(const std::string& encoded, std::string& out);
     
     /**
-     * @brief Calcula SHA256 de un buffer
+     * @brief Uploads verificados por algoritmo
+     * @return {"crc32c": {"messages", "bytes", "failed"}, ...} (solo los usados)
+     */
+    json get_checksum_stats() const;
+
+    /**
+     * @brief Calcula SHA256 de un buffer (EVP)
      * @param data Vector de bytes
      * @return Hash hexadecimal
      */
-    std::string calculate_sha256(const std::vector<uint8_t>& data);
+    static std::string calculate_sha256(const std::vector<uint8_t>& data);
+    static std::string calculate_sha256(const uint8_t* data, size_t size);
+    
+private:
+    struct InProgressMessage {
+        OutboundFrame    frame;
+        Checksum::Hasher hasher;
+        size_t total_chunks;
+        size_t received_chunks;
+        size_t expected_size;
+    };
+    
+    struct ChecksumStats {
+        uint64_t messages = 0;
+        uint64_t bytes    = 0;
+        uint64_t failed   = 0;
+    };
+
+    std::map<std::string, InProgressMessage> active_buffers;
+    std::map<Checksum::Algo, ChecksumStats>  checksum_stats;
+    mutable std::mutex buffer_mutex;
 };
\ No newline at end of file
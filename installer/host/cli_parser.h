@@ -11,6 +11,9 @@
 #include <cstdio>
 #include "build_info.h"  // For BUILD_NUMBER
 #include "help_renderer.h"
+#include "self_bench.h"
+#include "health_probe.h"
+#include "log_analyzer.h"
 #include <nlohmann/json.hpp>
 
 #ifdef _WIN32
@@ -357,58 +360,170 @@ namespace CLICommands {
         HelpRenderer::render();
     }
     
-    inline int check_health() {
-        std::cout << "=== BLOOM-HOST HEALTH CHECK ===" << std::endl;
-        std::cout << std::endl;
-        
+    struct HealthOptions {
+        bool        as_json     = false;
+        bool        probe_brain = false;   // --probe-brain: conecta a Brain (PING/PONG)
+        int         port        = 5678;    // --service-port
+        int         pings       = 20;      // --pings
+        std::string base_dir;              // --user-base-dir, o derivado de argv[0]
+        std::string launch_id;             // --launch-id: clave host_{launch_id} en telemetry.json
+    };
+
+    inline int check_health(const HealthOptions& opt = HealthOptions()) {
+        const int total = 7;
+        int step = 0;
         int exit_code = 0;
+        nlohmann::json out;
+        out["checks"] = nlohmann::json::array();
+
+        auto section = [&](const std::string& title) {
+            ++step;
+            if (!opt.as_json) {
+                if (step > 1) std::cout << std::endl;
+                std::cout << "[" << step << "/" << total << "] " << title << "..." << std::endl;
+            }
+        };
+        // status: OK | WARN | FAIL | SKIP
+        auto report = [&](const std::string& status, const std::string& line) {
+            if (status == "FAIL") exit_code = 1;
+            if (opt.as_json) {
+                out["checks"].push_back({{"step", step}, {"status", status}, {"detail", line}});
+            } else {
+                std::cout << "  [" << status << "] " << line << std::endl;
+            }
+        };
+        auto fmt = [](double v, int decimals) {
+            std::ostringstream oss;
+            oss << std::fixed << std::setprecision(decimals) << v;
+            return oss.str();
+        };
+
+        if (!opt.as_json) {
+            std::cout << "=== BLOOM-HOST HEALTH CHECK ===" << std::endl;
+            std::cout << std::endl;
+        }
         
         // Check 1: Platform info
-        std::cout << "[1/4] Platform Detection..." << std::endl;
+        section("Platform Detection");
         auto platform = SystemInfo::get_platform_info();
-        std::cout << "  [OK] OS: " << platform.os_name << " " << platform.os_version << std::endl;
-        std::cout << "  [OK] Arch: " << platform.arch << std::endl;
-        std::cout << std::endl;
+        report("OK", "OS: " + platform.os_name + " " + platform.os_version);
+        report("OK", "Arch: " + platform.arch);
         
         // Check 2: STDIN/STDOUT availability
-        std::cout << "[2/4] STDIO Availability..." << std::endl;
+        section("STDIO Availability");
         try {
             if (std::cin.good() && std::cout.good()) {
-                std::cout << "  [OK] STDIN/STDOUT available" << std::endl;
+                report("OK", "STDIN/STDOUT available");
             } else {
-                std::cout << "  [FAIL] STDIO not properly configured" << std::endl;
-                exit_code = 1;
+                report("FAIL", "STDIO not properly configured");
             }
         } catch (...) {
-            std::cout << "  [FAIL] STDIO check failed" << std::endl;
-            exit_code = 1;
+            report("FAIL", "STDIO check failed");
         }
-        std::cout << std::endl;
         
         // Check 3: Network stack
-        std::cout << "[3/4] Network Stack..." << std::endl;
+        section("Network Stack");
 #ifdef _WIN32
         WSADATA wsaData;
         if (WSAStartup(MAKEWORD(2, 2), &wsaData) == 0) {
-            std::cout << "  [OK] Winsock initialized" << std::endl;
+            report("OK", "Winsock initialized");
             WSACleanup();
         } else {
-            std::cout << "  [FAIL] Winsock initialization failed" << std::endl;
-            exit_code = 1;
+            report("FAIL", "Winsock initialization failed");
         }
 #else
-        std::cout << "  [OK] POSIX sockets available" << std::endl;
+        report("OK", "POSIX sockets available");
 #endif
-        std::cout << std::endl;
         
         // Check 4: Configuration
-        std::cout << "[4/4] Configuration..." << std::endl;
-        std::cout << "  [OK] Version: 2.1.0" << std::endl;
-        std::cout << "  [OK] Build: " << BUILD_NUMBER << std::endl;
-        std::cout << "  [OK] Target Port: 5678" << std::endl;
-        std::cout << "  [OK] Max Message: 1020000 bytes" << std::endl;
+        section("Configuration");
+        report("OK", "Version: 2.1.0");
+        report("OK", "Build: " + std::to_string(BUILD_NUMBER));
+        report("OK", "Target Port: " + std::to_string(opt.port));
+        report("OK", "Max Message: 1020000 bytes");
+
+#ifdef _WIN32
+        const std::string sep = "\\";
+#else
+        const std::string sep = "/";
+#endif
+        std::string logs_dir = opt.base_dir.empty() ? "" : opt.base_dir + sep + "logs";
+
+        // Check 5: Log directory write latency
+        section("Log Directory Write Latency");
+        if (logs_dir.empty()) {
+            report("SKIP", "Base dir unknown (pass --user-base-dir)");
+        } else {
+            auto disk = HealthProbe::probe_disk(logs_dir, 50);
+            if (!disk.ok) {
+                report("WARN", "Cannot write to " + logs_dir + ": " + disk.error);
+            } else {
+                report("OK", "Directory: " + logs_dir);
+                report("OK", "Write+flush p50=" + fmt(disk.write_us.p50, 1) + "us p99=" +
+                       fmt(disk.write_us.p99, 1) + "us max=" + fmt(disk.write_us.max, 1) + "us (" +
+                       std::to_string(disk.writes) + " lines)");
+                if (disk.fsync_ms >= 0) report("OK", "fsync: " + fmt(disk.fsync_ms, 2) + "ms");
+            }
+            out["disk"] = {{"path", logs_dir}, {"ok", disk.ok}, {"writes", disk.writes},
+                           {"write_us", {{"p50", disk.write_us.p50}, {"p99", disk.write_us.p99}, {"max", disk.write_us.max}}},
+                           {"fsync_ms", disk.fsync_ms}};
+        }
+
+        // Check 6: telemetry.json lookup
+        section("Telemetry Lookup");
+        if (logs_dir.empty()) {
+            report("SKIP", "Base dir unknown (pass --user-base-dir)");
+        } else {
+            auto tel = HealthProbe::probe_telemetry(logs_dir + sep + "telemetry.json", opt.launch_id);
+            if (!tel.file_found) {
+                report("WARN", "telemetry.json not found: " + tel.path + " (host falls back to directory init)");
+            } else {
+                report("OK", "Read " + std::to_string(tel.bytes) + " bytes in " + fmt(tel.read_ms, 2) + "ms");
+                if (opt.launch_id.empty()) {
+                    report("SKIP", "Stream lookup (pass --launch-id)");
+                } else if (tel.key_found) {
+                    report("OK", "host_" + opt.launch_id + " found in " + fmt(tel.lookup_us, 1) + "us: " + tel.host_log_path);
+                } else {
+                    report("WARN", "host_" + opt.launch_id + " not registered (lookup " + fmt(tel.lookup_us, 1) + "us)");
+                }
+            }
+            out["telemetry"] = {{"path", tel.path}, {"found", tel.file_found}, {"bytes", tel.bytes},
+                                {"read_ms", tel.read_ms}, {"key_found", tel.key_found}, {"lookup_us", tel.lookup_us}};
+        }
+
+        // Check 7: Brain probe
+        section("Brain Probe");
+        if (!opt.probe_brain) {
+            report("SKIP", "Not requested (pass --probe-brain)");
+        } else {
+            auto brain = HealthProbe::probe_brain(opt.port, opt.pings, 64 * 1024);
+            if (!brain.connected) {
+                report("FAIL", brain.error);
+            } else {
+                report("OK", "Connected to 127.0.0.1:" + std::to_string(opt.port) + " in " + fmt(brain.connect_ms, 2) + "ms");
+                if (brain.pongs > 0) {
+                    report("OK", "PING/PONG x" + std::to_string(brain.pongs) + " RTT p50=" + fmt(brain.rtt_ms.p50, 2) +
+                           "ms p99=" + fmt(brain.rtt_ms.p99, 2) + "ms max=" + fmt(brain.rtt_ms.max, 2) + "ms");
+                }
+                if (brain.burst_bytes > 0) {
+                    report("OK", "Framing throughput: " + fmt(brain.burst_mb_s, 1) + " MB/s (" +
+                           std::to_string(brain.burst_bytes) + " bytes)");
+                }
+                if (!brain.error.empty()) report("FAIL", brain.error);
+            }
+            out["brain"] = {{"port", opt.port}, {"connected", brain.connected}, {"error", brain.error},
+                            {"connect_ms", brain.connect_ms}, {"pings_sent", brain.pings_sent}, {"pongs", brain.pongs},
+                            {"rtt_ms", {{"p50", brain.rtt_ms.p50}, {"p99", brain.rtt_ms.p99}, {"max", brain.rtt_ms.max}}},
+                            {"throughput_mb_s", brain.burst_mb_s}};
+        }
+
+        if (opt.as_json) {
+            out["passed"] = exit_code == 0;
+            std::cout << out.dump(2) << std::endl;
+            return exit_code;
+        }
+
         std::cout << std::endl;
-        
         if (exit_code == 0) {
             std::cout << "[OK] All health checks passed" << std::endl;
         } else {
@@ -479,12 +594,63 @@ namespace CLIParser {
         
         // Priority 3: Health
         if (has_flag(argc, argv, "--health")) {
-            result.exit_code = CLICommands::check_health();
+            CLICommands::HealthOptions health;
+            health.as_json     = as_json;
+            health.probe_brain = has_flag(argc, argv, "--probe-brain");
+            health.launch_id   = get_value(argc, argv, "--launch-id");
+            std::string port   = get_value(argc, argv, "--service-port");
+            std::string pings  = get_value(argc, argv, "--pings");
+            if (!port.empty())  health.port  = std::atoi(port.c_str());
+            if (!pings.empty()) health.pings = std::max(1, std::atoi(pings.c_str()));
+
+            // Misma cascada que main(): --user-base-dir, o tres niveles arriba del
+            // ejecutable (BloomNucleus/bin/host/bloom-host → BloomNucleus).
+            health.base_dir = get_value(argc, argv, "--user-base-dir");
+            if (health.base_dir.empty()) {
+                std::string exe = SystemInfo::get_executable_path();
+                for (int i = 0; i < 3 && !exe.empty(); ++i) {
+                    size_t pos = exe.find_last_of("/\\");
+                    exe = (pos == std::string::npos) ? "" : exe.substr(0, pos);
+                }
+                health.base_dir = exe;
+            }
+
+            result.exit_code = CLICommands::check_health(health);
             result.handled = true;
             return result;
         }
         
-        // Priority 4: Help
+        // Priority 4: Self benchmark
+        if (has_flag(argc, argv, "--bench")) {
+            result.exit_code = SelfBench::run(as_json);
+            result.handled = true;
+            return result;
+        }
+        
+        // Priority 5: Offline log analysis (--analyze-log repetible)
+        {
+            LogAnalyzer::Options analyze;
+            for (int i = 1; i < argc; ++i) {
+                std::string arg(argv[i]);
+                if (arg.find("--analyze-log=") == 0) {
+                    analyze.roots.push_back(arg.substr(14));
+                } else if (arg == "--analyze-log" && i + 1 < argc) {
+                    analyze.roots.push_back(argv[++i]);
+                }
+            }
+            if (!analyze.roots.empty()) {
+                analyze.as_json = as_json;
+                std::string gap     = get_value(argc, argv, "--gap-sec");
+                std::string threads = get_value(argc, argv, "--threads");
+                if (!gap.empty())     analyze.gap_sec = std::max(1, std::atoi(gap.c_str()));
+                if (!threads.empty()) analyze.threads = static_cast<unsigned>(std::max(0, std::atoi(threads.c_str())));
+                result.exit_code = LogAnalyzer::run(analyze);
+                result.handled = true;
+                return result;
+            }
+        }
+        
+        // Priority 6: Help
         if (has_flag(argc, argv, "--help") || has_flag(argc, argv, "-h")) {
             CLICommands::print_help();
             result.handled = true;
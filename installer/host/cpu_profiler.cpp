@@ -0,0 +1,125 @@
+#include "cpu_profiler.h"
+
+#include <algorithm>
+#include <map>
+#include <mutex>
+#include <vector>
+
+#ifdef _WIN32
+    #ifndef WIN32_LEAN_AND_MEAN
+        #define WIN32_LEAN_AND_MEAN
+    #endif
+    #include <windows.h>
+#else
+    #include <time.h>
+#endif
+
+namespace CpuProfiler {
+
+namespace {
+
+struct KindCost {
+    uint64_t count    = 0;
+    uint64_t total_ns = 0;
+    uint64_t max_ns   = 0;
+};
+
+// Kinds distintos con costo propio; el resto va a "{direction}:*other*". El
+// kind sale del mensaje, así que una página no puede hacer crecer la tabla.
+const size_t MAX_TRACKED_KINDS = 128;
+const char*  OVERFLOW_KIND = "*other*";
+
+std::mutex                      g_costs_mutex;
+std::map<std::string, KindCost> g_costs;
+
+}  // namespace
+
+// ============================================================================
+// RELOJ DE CPU DEL THREAD
+// ============================================================================
+
+uint64_t thread_cpu_ns() {
+#ifdef _WIN32
+    FILETIME creation, exit_time, kernel, user;
+    if (!GetThreadTimes(GetCurrentThread(), &creation, &exit_time, &kernel, &user)) {
+        return 0;
+    }
+    ULARGE_INTEGER k, u;
+    k.LowPart  = kernel.dwLowDateTime;
+    k.HighPart = kernel.dwHighDateTime;
+    u.LowPart  = user.dwLowDateTime;
+    u.HighPart = user.dwHighDateTime;
+    return (k.QuadPart + u.QuadPart) * 100;  // unidades de 100ns
+#else
+    struct timespec ts;
+    if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) != 0) return 0;
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000ULL +
+           static_cast<uint64_t>(ts.tv_nsec);
+#endif
+}
+
+// ============================================================================
+// Scope
+// ============================================================================
+
+Scope::Scope(const char* p_direction)
+    : direction(p_direction), start_ns(thread_cpu_ns()) {}
+
+void Scope::set_kind(const std::string& p_kind) {
+    kind = p_kind;
+}
+
+Scope::~Scope() {
+    uint64_t elapsed = thread_cpu_ns() - start_ns;
+
+    std::lock_guard<std::mutex> lock(g_costs_mutex);
+    const bool full = g_costs.size() >= MAX_TRACKED_KINDS;
+    std::string key = std::string(direction) + ":" + (kind.empty() ? "(unknown)" : kind);
+    auto it = g_costs.find(key);
+    if (it == g_costs.end()) {
+        if (full) key = std::string(direction) + ":" + OVERFLOW_KIND;
+        it = g_costs.emplace(key, KindCost()).first;
+    }
+    KindCost& c = it->second;
+    c.count++;
+    c.total_ns += elapsed;
+    c.max_ns    = std::max(c.max_ns, elapsed);
+}
+
+// ============================================================================
+// REPORTE
+// ============================================================================
+
+nlohmann::json top_json(size_t n) {
+    std::vector<std::pair<std::string, KindCost>> ranked;
+    {
+        std::lock_guard<std::mutex> lock(g_costs_mutex);
+        ranked.assign(g_costs.begin(), g_costs.end());
+    }
+
+    std::sort(ranked.begin(), ranked.end(),
+              [](const auto& a, const auto& b) { return a.second.total_ns > b.second.total_ns; });
+    if (ranked.size() > n) ranked.resize(n);
+
+    nlohmann::json out = nlohmann::json::array();
+    for (const auto& entry : ranked) {
+        const KindCost& c = entry.second;
+        out.push_back({
+            {"kind",         entry.first},
+            {"count",        c.count},
+            {"cpu_total_ms", c.total_ns / 1e6},
+            {"cpu_avg_us",   c.count ? (c.total_ns / 1e3) / c.count : 0.0},
+            {"cpu_max_us",   c.max_ns / 1e3}
+        });
+    }
+    return out;
+}
+
+double total_ms() {
+    std::lock_guard<std::mutex> lock(g_costs_mutex);
+    uint64_t total = 0;
+    for (const auto& entry : g_costs) total += entry.second.total_ns;
+    return total / 1e6;
+}
+
+}  // namespace CpuProfiler
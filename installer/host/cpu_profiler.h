@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <nlohmann/json.hpp>
+
+/**
+ * @brief Atribución de CPU por tipo de mensaje manejado
+ *
+ * Mide tiempo de CPU del thread (no wall-clock) entre la entrada a
+ * handle_chrome_message / handle_service_message y su salida, y lo acumula
+ * bajo "{direction}:{kind}" donde kind = command | type | event.
+ *
+ * Reloj:
+ *   POSIX:   clock_gettime(CLOCK_THREAD_CPUTIME_ID)
+ *   Windows: GetThreadTimes (kernel + user; granularidad del tick del scheduler)
+ *
+ * Siempre activo: el costo es una lectura del reloj al entrar y otra al salir.
+ * Hasta 128 kinds distintos; los siguientes se acumulan en "{direction}:*other*".
+ */
+namespace CpuProfiler {
+
+    /** Tiempo de CPU consumido por el thread actual, en nanosegundos. */
+    uint64_t thread_cpu_ns();
+
+    /**
+     * @brief Mide el CPU del thread durante el scope y lo registra al destruirse.
+     * @param direction "chrome" (stdin) o "brain" (TCP)
+     */
+    class Scope {
+    public:
+        explicit Scope(const char* direction);
+        ~Scope();
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+        /** Tipo de mensaje; se conoce recién después del parse. */
+        void set_kind(const std::string& kind);
+
+    private:
+        const char* direction;
+        std::string kind;
+        uint64_t    start_ns;
+    };
+
+    /**
+     * @brief Top-N tipos de mensaje por CPU total acumulado.
+     *
+     * [ { "kind":"chrome:LOG_ENTRY", "count":N, "cpu_total_ms":x,
+     *     "cpu_avg_us":x, "cpu_max_us":x }, ... ]
+     */
+    nlohmann::json top_json(size_t n);
+
+    /** CPU total atribuido a mensajes desde el arranque, en milisegundos. */
+    double total_ms();
+
+}  // namespace CpuProfiler
@@ -0,0 +1,194 @@
+#include "dedup_filter.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <sstream>
+#include <vector>
+
+#include "admission_control.h"
+#include "fast_hash.h"
+
+namespace Dedup {
+
+namespace {
+
+// Hashes recordados por kind: un kind con contenido siempre distinto no
+// puede crecer sin límite; al pasarse se olvida el más viejo
+const size_t   MAX_ENTRIES_PER_KIND = 1024;
+// Kinds con ventana propia; los que vengan después pasan sin deduplicar
+const size_t   MAX_TRACKED_KINDS = 128;
+const uint32_t MAX_WINDOW_MS = 600000;
+const size_t   STATS_TOP_KINDS = 10;
+const char*    IGNORED_FIELD = "timestamp";
+
+uint64_t now_ns() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+std::string trim(const std::string& s) {
+    size_t b = s.find_first_not_of(" \t");
+    if (b == std::string::npos) return "";
+    size_t e = s.find_last_not_of(" \t");
+    return s.substr(b, e - b + 1);
+}
+
+bool parse_window(const std::string& s, uint32_t& out) {
+    if (s.empty()) return false;
+    char* end = nullptr;
+    long value = std::strtol(s.c_str(), &end, 10);
+    if (!end || *end != '\0' || value < 0 || value > static_cast<long>(MAX_WINDOW_MS)) return false;
+    out = static_cast<uint32_t>(value);
+    return true;
+}
+
+}  // namespace
+
+// ============================================================================
+// CONFIGURACIÓN
+// ============================================================================
+
+bool parse_config(const std::string& spec, Config& cfg, std::string& error) {
+    if (trim(spec) == "off") {
+        cfg.enabled = false;
+        return true;
+    }
+
+    std::stringstream ss(spec);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        item = trim(item);
+        if (item.empty()) continue;
+
+        size_t eq = item.find('=');
+        if (eq == std::string::npos || eq == 0) {
+            error = "expected kind=ms, got '" + item + "'";
+            return false;
+        }
+        std::string key = trim(item.substr(0, eq));
+        uint32_t window = 0;
+        if (!parse_window(trim(item.substr(eq + 1)), window)) {
+            error = "invalid window in '" + item + "' (0-" + std::to_string(MAX_WINDOW_MS) + " ms)";
+            return false;
+        }
+
+        if (key == "*") cfg.default_window_ms = window;
+        else            cfg.per_kind[key] = window;
+    }
+
+    cfg.enabled = cfg.default_window_ms > 0 ||
+                  std::any_of(cfg.per_kind.begin(), cfg.per_kind.end(),
+                              [](const auto& kv) { return kv.second > 0; });
+    return true;
+}
+
+// ============================================================================
+// FILTER
+// ============================================================================
+
+Filter::Filter(const char* direction) : direction_(direction) {}
+
+void Filter::configure(const Config& cfg) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    cfg_ = cfg;
+    kinds_.clear();
+}
+
+uint32_t Filter::window_ms(const std::string& kind) const {
+    if (!cfg_.enabled || kind.empty()) return 0;
+    auto it = cfg_.per_kind.find(kind);
+    if (it != cfg_.per_kind.end()) return it->second;
+    if (Admission::classify(kind) == Admission::CLASS_CONTROL) return 0;
+    return cfg_.default_window_ms;
+}
+
+void Filter::expire(KindState& state, uint64_t now_ns) {
+    while (!state.order.empty()) {
+        const auto& oldest = state.order.front();
+        bool overfull = state.order.size() > MAX_ENTRIES_PER_KIND;
+        if (!overfull && now_ns - oldest.first < state.window_ns) break;
+        if (overfull && now_ns - oldest.first < state.window_ns) evicted_++;
+
+        // El hash pudo reenviarse de nuevo después: solo se borra si esta
+        // entrada de la cola es la vigente
+        auto it = state.last_sent.find(oldest.second);
+        if (it != state.last_sent.end() && it->second == oldest.first) state.last_sent.erase(it);
+        state.order.pop_front();
+    }
+}
+
+bool Filter::admit(const std::string& kind, const nlohmann::json& msg, size_t bytes) {
+    uint32_t window = window_ms(kind);
+    if (window == 0) return true;
+
+    // El hash se calcula fuera del lock (stats_json() no espera al recorrido)
+    const uint64_t hash = FastHash::json_hash(msg, IGNORED_FIELD);
+    const uint64_t now = now_ns();
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto found = kinds_.find(kind);
+    if (found == kinds_.end()) {
+        if (kinds_.size() >= MAX_TRACKED_KINDS) {
+            untracked_++;
+            return true;
+        }
+        found = kinds_.emplace(kind, KindState()).first;
+        found->second.window_ns = static_cast<uint64_t>(window) * 1000000ULL;
+    }
+    KindState& state = found->second;
+    expire(state, now);
+
+    checked_++;
+    state.checked++;
+
+    auto last = state.last_sent.find(hash);
+    if (last != state.last_sent.end() && now - last->second < state.window_ns) {
+        suppressed_++;
+        suppressed_bytes_ += bytes;
+        state.suppressed++;
+        state.suppressed_bytes += bytes;
+        return false;
+    }
+
+    state.last_sent[hash] = now;
+    state.order.emplace_back(now, hash);
+    if (state.order.size() > MAX_ENTRIES_PER_KIND) expire(state, now);
+    return true;
+}
+
+nlohmann::json Filter::stats_json() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    nlohmann::json stats = {
+        {"direction",        direction_},
+        {"enabled",          cfg_.enabled},
+        {"checked",          checked_},
+        {"suppressed",       suppressed_},
+        {"suppressed_bytes", suppressed_bytes_},
+        {"evicted",          evicted_},
+        {"untracked",        untracked_}
+    };
+
+    std::vector<std::pair<std::string, const KindState*>> top;
+    for (const auto& kv : kinds_) top.emplace_back(kv.first, &kv.second);
+    std::sort(top.begin(), top.end(), [](const auto& a, const auto& b) {
+        return a.second->suppressed > b.second->suppressed;
+    });
+    if (top.size() > STATS_TOP_KINDS) top.resize(STATS_TOP_KINDS);
+
+    nlohmann::json kinds = nlohmann::json::object();
+    for (const auto& kv : top) {
+        const KindState& s = *kv.second;
+        kinds[kv.first] = {
+            {"window_ms",        s.window_ns / 1000000ULL},
+            {"checked",          s.checked},
+            {"suppressed",       s.suppressed},
+            {"suppressed_bytes", s.suppressed_bytes},
+            {"remembered",       s.order.size()}
+        };
+    }
+    stats["kinds"] = kinds;
+    return stats;
+}
+
+}  // namespace Dedup
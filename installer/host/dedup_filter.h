@@ -0,0 +1,91 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <nlohmann/json.hpp>
+
+/**
+ * @brief Supresión de mensajes duplicados en una ventana de tiempo
+ *
+ * La extensión reenvía el mismo TAB_STATE / DOM_SNAPSHOT varias veces por
+ * segundo aunque nada cambió, y Brain a veces repite un comando idéntico.
+ * Cada copia cuesta un frame, un dump y crédito en el link. Con --dedup el
+ * host compara cada mensaje contra los que ya reenvió del mismo kind:
+ *
+ *   - hash de contenido de 64 bits (fast_hash.h) sobre el JSON ya parseado,
+ *     ignorando "timestamp" de primer nivel (cada copia trae uno nuevo);
+ *   - si el mismo hash salió hace menos de la ventana del kind, se descarta.
+ *     La ventana se cuenta desde la última copia reenviada, no desde la
+ *     última suprimida: un estado que se repite sin parar igual sale una vez
+ *     por ventana, y Brain nunca lo pierde de vista más que eso.
+ *
+ * Ventanas (--dedup): lista "kind=ms" separada por comas, "*" = default para
+ * los kinds sin entrada propia. "*" no aplica a los kinds CONTROL de
+ * admission_control.h (handshake, HEARTBEAT, RESPONSE...): solo se deduplican
+ * si se nombran. "off" o ausente = desactivado.
+ *
+ *   --dedup "TAB_STATE=500,DOM_SNAPSHOT=2000,*=100"
+ *
+ * Un Filter por dirección (chrome_to_brain, brain_to_chrome); lo suprimido
+ * se cuenta por kind en stats["dedup"], que va a Brain en cada HEARTBEAT.
+ */
+namespace Dedup {
+
+    struct Config {
+        bool     enabled = false;
+        uint32_t default_window_ms = 0;          // "*"; 0 = solo los kinds nombrados
+        std::map<std::string, uint32_t> per_kind;
+    };
+
+    /** Parsea --dedup sobre cfg. @return false con error si la spec es inválida */
+    bool parse_config(const std::string& spec, Config& cfg, std::string& error);
+
+    class Filter {
+    public:
+        explicit Filter(const char* direction);
+
+        /** Solo antes de arrancar el thread que llama a admit(). */
+        void configure(const Config& cfg);
+
+        bool enabled() const { return cfg_.enabled; }
+
+        /** Ventana del kind en ms, 0 si no se deduplica. */
+        uint32_t window_ms(const std::string& kind) const;
+
+        /**
+         * @brief Decide si el mensaje sigue
+         * @return false si es copia de uno reenviado dentro de la ventana
+         */
+        bool admit(const std::string& kind, const nlohmann::json& msg, size_t bytes);
+
+        nlohmann::json stats_json() const;
+
+    private:
+        struct KindState {
+            uint64_t window_ns = 0;
+            std::deque<std::pair<uint64_t, uint64_t>> order;      // (forwarded_ns, hash)
+            std::unordered_map<uint64_t, uint64_t>    last_sent;  // hash → forwarded_ns
+            uint64_t checked          = 0;
+            uint64_t suppressed       = 0;
+            uint64_t suppressed_bytes = 0;
+        };
+
+        void expire(KindState& state, uint64_t now_ns);
+
+        const char*          direction_;
+        Config               cfg_;
+        mutable std::mutex   mutex_;
+        std::unordered_map<std::string, KindState> kinds_;
+        uint64_t             checked_          = 0;
+        uint64_t             suppressed_       = 0;
+        uint64_t             suppressed_bytes_ = 0;
+        uint64_t             evicted_          = 0;   // hashes sacados antes de vencer (tope por kind)
+        uint64_t             untracked_        = 0;   // kinds por encima del tope, sin deduplicar
+    };
+
+}  // namespace Dedup
@@ -0,0 +1,295 @@
+#include "delta_encoder.h"
+
+#include <algorithm>
+#include <chrono>
+#include <sstream>
+
+namespace Delta {
+
+namespace {
+
+const char* DELTA_TYPE = "STATE_DELTA";
+const char* META_FIELD = "_delta";
+
+uint64_t now_ns() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+std::string trim(const std::string& s) {
+    size_t b = s.find_first_not_of(" \t");
+    if (b == std::string::npos) return "";
+    size_t e = s.find_last_not_of(" \t");
+    return s.substr(b, e - b + 1);
+}
+
+// Un objeto con un miembro null no sobrevive a merge-patch: aplicarlo borra
+// el miembro. Los arrays se copian tal cual, así que adentro no importa.
+bool has_null_member(const nlohmann::json& value) {
+    if (!value.is_object()) return false;
+    for (const auto& item : value.items()) {
+        if (item.value().is_null() || has_null_member(item.value())) return true;
+    }
+    return false;
+}
+
+}  // namespace
+
+// ============================================================================
+// CONFIGURACIÓN
+// ============================================================================
+
+const char* format_name(Format format) {
+    switch (format) {
+        case FORMAT_MERGE_PATCH: return "merge-patch";
+        case FORMAT_JSON_PATCH:  return "json-patch";
+        default:                 return "none";
+    }
+}
+
+Format parse_format(const std::string& name) {
+    if (name == "merge-patch") return FORMAT_MERGE_PATCH;
+    if (name == "json-patch")  return FORMAT_JSON_PATCH;
+    return FORMAT_NONE;
+}
+
+bool parse_config(const std::string& spec, Config& cfg, std::string& error) {
+    if (trim(spec) == "off") {
+        cfg.kinds.clear();
+        return true;
+    }
+
+    std::stringstream ss(spec);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        item = trim(item);
+        if (item.empty()) continue;
+
+        size_t colon = item.find(':');
+        std::string kind = trim(item.substr(0, colon));
+        std::string field = colon == std::string::npos ? "" : trim(item.substr(colon + 1));
+        if (kind.empty() || (colon != std::string::npos && field.empty())) {
+            error = "expected kind[:key_field], got '" + item + "'";
+            return false;
+        }
+        cfg.kinds[kind] = field;
+    }
+    return true;
+}
+
+bool create_merge_patch(const nlohmann::json& before, const nlohmann::json& after, nlohmann::json& patch) {
+    if (!before.is_object() || !after.is_object()) {
+        if (after.is_null() || has_null_member(after)) return false;
+        patch = after;
+        return true;
+    }
+
+    patch = nlohmann::json::object();
+    for (auto it = before.begin(); it != before.end(); ++it) {
+        if (!after.contains(it.key())) patch[it.key()] = nullptr;
+    }
+    for (auto it = after.begin(); it != after.end(); ++it) {
+        auto old = before.find(it.key());
+        if (old != before.end() && *old == it.value()) continue;
+        if (it.value().is_null()) return false;
+
+        if (old == before.end()) {
+            if (has_null_member(it.value())) return false;
+            patch[it.key()] = it.value();
+        } else if (!create_merge_patch(*old, it.value(), patch[it.key()])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// ============================================================================
+// ENCODER
+// ============================================================================
+
+Encoder::Encoder(size_t snapshot_every, uint32_t snapshot_interval_ms, size_t max_keys)
+    : snapshot_every_(snapshot_every),
+      snapshot_interval_ns_(static_cast<uint64_t>(snapshot_interval_ms) * 1000000ULL),
+      max_keys_(max_keys) {}
+
+void Encoder::configure(const Config& cfg) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    cfg_ = cfg;
+    keys_.clear();
+}
+
+nlohmann::json Encoder::announce_json() const {
+    if (cfg_.kinds.empty()) return nullptr;
+    nlohmann::json kinds = nlohmann::json::array();
+    for (const auto& kv : cfg_.kinds) kinds.push_back(kv.first);
+    return {
+        {"formats", nlohmann::json::array({format_name(FORMAT_MERGE_PATCH), format_name(FORMAT_JSON_PATCH)})},
+        {"kinds",   kinds}
+    };
+}
+
+void Encoder::on_register_ack(const nlohmann::json& ack) {
+    Format format = FORMAT_NONE;
+    auto it = ack.find("delta");
+    if (configured() && it != ack.end() && it->is_object()) {
+        format = parse_format(it->value("format", ""));
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    keys_.clear();
+    format_ = format;
+    if (format != FORMAT_NONE) connections_++;
+}
+
+void Encoder::request_resync(const std::string& key) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    resyncs_++;
+    auto it = keys_.find(key);
+    if (it != keys_.end()) it->second.resync = true;
+}
+
+bool Encoder::active() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return format_ != FORMAT_NONE;
+}
+
+std::string Encoder::key_for(const std::string& kind, const nlohmann::json& msg) const {
+    const std::string& field = cfg_.kinds.at(kind);
+    if (field.empty()) return kind;
+    auto it = msg.find(field);
+    if (it == msg.end()) return kind;
+    return kind + "/" + (it->is_string() ? it->get<std::string>() : it->dump());
+}
+
+void Encoder::evict_oldest() {
+    auto oldest = std::min_element(keys_.begin(), keys_.end(), [](const auto& a, const auto& b) {
+        return a.second.last_used_ns < b.second.last_used_ns;
+    });
+    if (oldest == keys_.end()) return;
+    keys_.erase(oldest);
+    evicted_++;
+}
+
+bool Encoder::encode(const std::string& kind, nlohmann::json& msg, std::string& out) {
+    // cfg_ no cambia después de configure(): se consulta sin el lock
+    if (!msg.is_object() || cfg_.kinds.find(kind) == cfg_.kinds.end()) return false;
+
+    const uint64_t start = now_ns();
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (format_ == FORMAT_NONE) return false;
+
+    const std::string key = key_for(kind, msg);
+    auto found = keys_.find(key);
+    if (found == keys_.end()) {
+        if (keys_.size() >= max_keys_) evict_oldest();
+        found = keys_.emplace(key, KeyState()).first;
+    }
+    KeyState& state = found->second;
+
+    // El mensaje completo hace falta siempre: es el snapshot o la vara con
+    // la que se mide si el patch ahorra algo
+    std::string full = msg.dump();
+    const size_t full_size = full.size();
+
+    bool snapshot = state.seq == 0 || state.resync ||
+                    state.since_snapshot >= snapshot_every_ ||
+                    start - state.snapshot_ns >= snapshot_interval_ns_;
+    if (!snapshot) {
+        nlohmann::json patch;
+        bool expressible = true;
+        if (format_ == FORMAT_MERGE_PATCH) {
+            expressible = create_merge_patch(state.doc, msg, patch);
+        } else {
+            patch = nlohmann::json::diff(state.doc, msg);
+        }
+
+        if (expressible) {
+            nlohmann::json frame = {
+                {"type",     DELTA_TYPE},
+                {META_FIELD, {{"key", key}, {"seq", state.seq + 1}, {"base", state.seq},
+                              {"format", format_name(format_)}}},
+                {"patch",    std::move(patch)}
+            };
+            out = frame.dump();
+        }
+        if (!expressible || out.size() >= full_size) {
+            fallbacks_++;
+            snapshot = true;
+        }
+    }
+
+    KindStats& ks = kind_stats_[kind];
+    if (snapshot) {
+        // Mismo texto que el reenvío normal, con "_delta" al final del objeto
+        nlohmann::json meta = {{"key", key}, {"seq", state.seq + 1}};
+        out = std::move(full);
+        out.pop_back();
+        if (out.size() > 1) out += ',';
+        out += "\"";
+        out += META_FIELD;
+        out += "\":" + meta.dump() + "}";
+        state.snapshot_ns = start;
+        state.since_snapshot = 0;
+        state.resync = false;
+        snapshots_++;
+        ks.snapshots++;
+    } else {
+        state.since_snapshot++;
+        deltas_++;
+        ks.deltas++;
+    }
+    full_bytes_ += full_size;
+    ks.full_bytes += full_size;
+    state.seq++;
+    state.doc = std::move(msg);
+    state.last_used_ns = start;
+    sent_bytes_ += out.size();
+    ks.sent_bytes += out.size();
+
+    uint64_t elapsed = now_ns() - start;
+    diff_ns_total_ += elapsed;
+    diff_ns_max_ = std::max(diff_ns_max_, elapsed);
+    return true;
+}
+
+nlohmann::json Encoder::stats_json() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const uint64_t encoded = snapshots_ + deltas_;
+    const uint64_t saved = full_bytes_ > sent_bytes_ ? full_bytes_ - sent_bytes_ : 0;
+
+    nlohmann::json kinds = nlohmann::json::object();
+    for (const auto& kv : kind_stats_) {
+        const KindStats& s = kv.second;
+        kinds[kv.first] = {
+            {"snapshots",   s.snapshots},
+            {"deltas",      s.deltas},
+            {"full_bytes",  s.full_bytes},
+            {"sent_bytes",  s.sent_bytes}
+        };
+    }
+
+    nlohmann::json configured_kinds = nlohmann::json::object();
+    for (const auto& kv : cfg_.kinds) configured_kinds[kv.first] = kv.second;
+
+    return {
+        {"format",           format_name(format_)},
+        {"configured",       configured_kinds},
+        {"connections",      connections_},
+        {"keys",             keys_.size()},
+        {"snapshots",        snapshots_},
+        {"deltas",           deltas_},
+        {"fallbacks",        fallbacks_},
+        {"resyncs",          resyncs_},
+        {"evicted",          evicted_},
+        {"full_bytes",       full_bytes_},
+        {"sent_bytes",       sent_bytes_},
+        {"bytes_saved",      saved},
+        {"saved_pct",        full_bytes_ ? 100.0 * saved / full_bytes_ : 0.0},
+        {"encode_us_total",  diff_ns_total_ / 1000},
+        {"encode_us_avg",    encoded ? diff_ns_total_ / encoded / 1000.0 : 0.0},
+        {"encode_us_max",    diff_ns_max_ / 1000},
+        {"kinds",            kinds}
+    };
+}
+
+}  // namespace Delta
@@ -0,0 +1,143 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <nlohmann/json.hpp>
+
+/**
+ * @brief Delta encoding de mensajes de estado Chrome → Brain
+ *
+ * TAB_STATE, DOM_SUMMARY y parecidos llevan un documento grande que cambia
+ * poco entre un envío y el siguiente, y se reenviaban enteros cada vez. Para
+ * los kinds configurados (--delta) el host recuerda el último documento
+ * enviado por key y manda a Brain solo la diferencia:
+ *
+ *   snapshot   el mensaje completo + "_delta": {"key": K, "seq": N}
+ *   delta      {"type": "STATE_DELTA",
+ *               "_delta": {"key": K, "seq": N, "base": N-1, "format": F},
+ *               "patch": ...}
+ *
+ * F es "merge-patch" (RFC 7386) o "json-patch" (RFC 6902). Brain aplica el
+ * patch sobre su copia de K, rearma el mensaje completo y lo procesa como
+ * si hubiera llegado así. Si no tiene la base (reconexión, mensaje perdido)
+ * contesta {"type": "DELTA_RESYNC", "key": K} y el próximo mensaje de K va
+ * como snapshot.
+ *
+ * Negociado: el host anuncia "delta": {"formats": [...], "kinds": [...]} en
+ * REGISTER_HOST y solo codifica si el REGISTER_ACK trae "delta": {"format": F}.
+ * Cada conexión empieza sin documentos. También va snapshot cada
+ * snapshot_every deltas o snapshot_interval_ms por key, y cuando el patch
+ * no es más chico que el mensaje (o merge-patch no puede expresar un null).
+ */
+namespace Delta {
+
+    enum Format { FORMAT_NONE = 0, FORMAT_MERGE_PATCH, FORMAT_JSON_PATCH };
+
+    const char* format_name(Format format);
+    Format      parse_format(const std::string& name);
+
+    struct Config {
+        /** kind → campo de primer nivel que distingue documentos ("" = uno por kind) */
+        std::map<std::string, std::string> kinds;
+    };
+
+    /**
+     * @brief Parsea --delta sobre cfg: "TAB_STATE:tab_id,DOM_SUMMARY:url"
+     * @return false con error si la spec es inválida ("off" = ninguno)
+     */
+    bool parse_config(const std::string& spec, Config& cfg, std::string& error);
+
+    /**
+     * @brief Patch merge (RFC 7386) de before → after
+     * @return false si no se puede expresar (un miembro nuevo vale null)
+     */
+    bool create_merge_patch(const nlohmann::json& before, const nlohmann::json& after,
+                            nlohmann::json& patch);
+
+    class Encoder {
+    public:
+        Encoder(size_t snapshot_every, uint32_t snapshot_interval_ms, size_t max_keys);
+
+        Encoder(const Encoder&) = delete;
+        Encoder& operator=(const Encoder&) = delete;
+
+        /** Override de --delta. Solo antes de conectar con Brain. */
+        void configure(const Config& cfg);
+
+        bool configured() const { return !cfg_.kinds.empty(); }
+
+        /** El kind está en --delta (encode() lo miraría). */
+        bool encodes(const std::string& kind) const { return cfg_.kinds.count(kind) > 0; }
+
+        /** "delta" para REGISTER_HOST, null si no hay kinds configurados. */
+        nlohmann::json announce_json() const;
+
+        /**
+         * @brief REGISTER_ACK de una conexión nueva
+         *
+         * Olvida los documentos de la conexión anterior y activa el formato
+         * que eligió Brain, o desactiva si el ACK no trae "delta".
+         */
+        void on_register_ack(const nlohmann::json& ack);
+
+        /** DELTA_RESYNC de Brain: el próximo mensaje de key va completo. */
+        void request_resync(const std::string& key);
+
+        bool active() const;
+
+        /**
+         * @brief Codifica un mensaje de Chrome
+         * @param msg se mueve al estado de la key si devuelve true
+         * @return false si el kind no se codifica (enviar msg.dump() tal cual)
+         */
+        bool encode(const std::string& kind, nlohmann::json& msg, std::string& out);
+
+        nlohmann::json stats_json() const;
+
+    private:
+        struct KeyState {
+            nlohmann::json doc;
+            uint64_t       seq              = 0;
+            uint64_t       snapshot_ns      = 0;
+            uint64_t       last_used_ns     = 0;
+            size_t         since_snapshot   = 0;
+            bool           resync           = false;
+        };
+
+        struct KindStats {
+            uint64_t snapshots  = 0;
+            uint64_t deltas     = 0;
+            uint64_t full_bytes = 0;
+            uint64_t sent_bytes = 0;
+        };
+
+        std::string key_for(const std::string& kind, const nlohmann::json& msg) const;
+        void        evict_oldest();
+
+        const size_t             snapshot_every_;
+        const uint64_t           snapshot_interval_ns_;
+        const size_t             max_keys_;
+
+        Config                   cfg_;
+        mutable std::mutex       mutex_;
+        Format                   format_ = FORMAT_NONE;
+        std::unordered_map<std::string, KeyState> keys_;
+        std::map<std::string, KindStats> kind_stats_;
+
+        uint64_t                 connections_   = 0;   // REGISTER_ACK con delta aceptado
+        uint64_t                 snapshots_     = 0;
+        uint64_t                 deltas_        = 0;
+        uint64_t                 resyncs_       = 0;   // DELTA_RESYNC recibidos
+        uint64_t                 fallbacks_     = 0;   // patch no más chico o no expresable
+        uint64_t                 evicted_       = 0;
+        uint64_t                 full_bytes_    = 0;   // lo que se habría mandado sin delta
+        uint64_t                 sent_bytes_    = 0;
+        uint64_t                 diff_ns_total_ = 0;
+        uint64_t                 diff_ns_max_   = 0;
+    };
+
+}  // namespace Delta
@@ -0,0 +1,194 @@
+#include "extension_logs.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cctype>
+
+#include "synapse_logger.h"
+
+namespace ExtensionLogs {
+
+namespace {
+
+// Un lote cada 100ms como máximo de espera: la línea aparece en el archivo
+// casi enseguida, pero un burst de cientos de logs cuesta un flush y no cientos
+const int    FLUSH_INTERVAL_MS = 100;
+const size_t BATCH_LINES = 256;
+
+// Una entrada gigante (un dump de DOM logueado por error) no debe llenar la cola
+const size_t MAX_MESSAGE_BYTES = 16 * 1024;
+
+const char* LOG_KINDS[] = { "LOG_ENTRY", "log" };
+const char* LEVELS[] = { "DEBUG", "INFO", "WARN", "ERROR", "CRITICAL" };
+
+// Una línea por entrada: los saltos de línea del mensaje se escapan
+void append_single_line(std::string& out, const std::string& text) {
+    for (char c : text) {
+        if (c == '\n')      out += "\\n";
+        else if (c == '\r') out += "\\r";
+        else                out += c;
+    }
+}
+
+}  // namespace
+
+// ============================================================================
+// RECONOCIMIENTO Y FORMATO
+// ============================================================================
+
+bool is_log_entry(const std::string& kind) {
+    for (const char* k : LOG_KINDS) {
+        if (kind == k) return true;
+    }
+    return false;
+}
+
+std::string normalize_level(const nlohmann::json& msg) {
+    auto it = msg.find("level");
+    if (it == msg.end() || !it->is_string()) return "INFO";
+
+    std::string level = it->get<std::string>();
+    std::transform(level.begin(), level.end(), level.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::toupper(c)); });
+    if (level == "WARNING") return "WARN";
+    if (level == "LOG")     return "INFO";
+    if (level == "FATAL")   return "CRITICAL";
+    for (const char* l : LEVELS) {
+        if (level == l) return level;
+    }
+    return "INFO";
+}
+
+std::string format_entry(const nlohmann::json& msg, const std::string& level) {
+    std::string ts;
+    auto t = msg.find("timestamp");
+    if (t != msg.end() && t->is_number()) {
+        ts = SynapseLogManager::format_timestamp_ms(t->get<int64_t>());
+    } else if (t != msg.end() && t->is_string()) {
+        ts = t->get<std::string>();
+    }
+    if (ts.empty()) ts = SynapseLogManager::get_timestamp_ms();
+
+    std::string text;
+    auto source = msg.find("source");
+    if (source != msg.end() && source->is_string()) {
+        text += "[" + source->get<std::string>() + "] ";
+    }
+    auto m = msg.find("message");
+    if (m != msg.end()) {
+        append_single_line(text, m->is_string() ? m->get<std::string>() : m->dump());
+    }
+    auto ctx = msg.find("context");
+    if (ctx != msg.end() && !ctx->is_null()) {
+        text += " ";
+        text += ctx->dump();
+    }
+
+    if (text.size() > MAX_MESSAGE_BYTES) {
+        size_t cut = text.size() - MAX_MESSAGE_BYTES;
+        text.resize(MAX_MESSAGE_BYTES);
+        text += "...(truncated " + std::to_string(cut) + " bytes)";
+    }
+    return SynapseLogManager::format_line(ts, level, "EXTENSION", text);
+}
+
+// ============================================================================
+// BATCHED WRITER
+// ============================================================================
+
+BatchedWriter::BatchedWriter(SinkFn sink, size_t max_queued_bytes)
+    : sink_(std::move(sink)), max_queued_bytes_(max_queued_bytes) {}
+
+BatchedWriter::~BatchedWriter() {
+    stop();
+}
+
+void BatchedWriter::start() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (started_) return;
+    started_ = true;
+    stopping_ = false;
+    writer_ = std::thread(&BatchedWriter::writer_loop, this);
+}
+
+void BatchedWriter::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!started_) return;
+        stopping_ = true;
+    }
+    work_cv_.notify_all();
+    if (writer_.joinable()) writer_.join();
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    started_ = false;
+}
+
+bool BatchedWriter::append(std::string line, const std::string& level) {
+    bool wake = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        const size_t bytes = line.size() + 1;
+        if (!started_ || stopping_ || pending_bytes_ + bytes > max_queued_bytes_) {
+            dropped_++;
+            return false;
+        }
+        pending_bytes_ += bytes;
+        pending_.push_back(std::move(line));
+        by_level_[level]++;
+        wake = pending_.size() >= BATCH_LINES;
+    }
+    if (wake) work_cv_.notify_one();
+    return true;
+}
+
+void BatchedWriter::writer_loop() {
+    std::vector<std::string> batch;
+    std::string block;
+
+    while (true) {
+        bool last = false;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            work_cv_.wait_for(lock, std::chrono::milliseconds(FLUSH_INTERVAL_MS), [this] {
+                return stopping_ || pending_.size() >= BATCH_LINES;
+            });
+            last = stopping_;
+            batch.swap(pending_);
+            pending_bytes_ = 0;
+        }
+
+        if (!batch.empty()) {
+            block.clear();
+            for (const std::string& line : batch) {
+                block += line;
+                block += '\n';
+            }
+            // Fuera del lock: append() no espera al disco
+            sink_(block, batch.size());
+
+            std::lock_guard<std::mutex> lock(mutex_);
+            written_lines_ += batch.size();
+            written_bytes_ += block.size();
+            batches_++;
+            max_batch_ = std::max<uint64_t>(max_batch_, batch.size());
+        }
+        batch.clear();
+        if (last) return;
+    }
+}
+
+nlohmann::json BatchedWriter::stats_json() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return {
+        {"lines_written", written_lines_},
+        {"bytes_written", written_bytes_},
+        {"batches",       batches_},
+        {"max_batch",     max_batch_},
+        {"queued",        pending_.size()},
+        {"dropped",       dropped_},
+        {"by_level",      by_level_}
+    };
+}
+
+}  // namespace ExtensionLogs
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+/**
+ * @brief Logs de la extensión escritos por el host, sin pasar por Brain
+ *
+ * El host es dueño de cortex_extension_YYYYMMDD.log (SynapseLogManager) y
+ * anuncia cortex_log_path en host_ready, pero un LOG_ENTRY de la extensión
+ * viajaba stdin → Brain como cualquier otro mensaje. Ahora:
+ *
+ *   { "type": "LOG_ENTRY", "level": "WARN", "message": "...",
+ *     "timestamp": 1760000000000 | "2026-...", "source": "content", "context": {...} }
+ *
+ * (también con command/event = LOG_ENTRY o "log") se formatea como una línea
+ * del canal EXTENSION y se encola en un BatchedWriter: un thread la escribe
+ * junto con las demás cada FLUSH_INTERVAL_MS o cada BATCH_LINES líneas, con
+ * un solo flush por lote en vez de uno por línea.
+ *
+ * La cola está acotada en bytes: si el disco no da abasto lo que no entra se
+ * descarta y se cuenta. A Brain solo llegan los contadores agregados en
+ * stats["extension_logs"] (HEARTBEAT / STATS_RESPONSE).
+ */
+namespace ExtensionLogs {
+
+    /** true si el kind (ver message_kind()) es una entrada de log de la extensión. */
+    bool is_log_entry(const std::string& kind);
+
+    /** Nivel normalizado: DEBUG | INFO | WARN | ERROR | CRITICAL (default INFO). */
+    std::string normalize_level(const nlohmann::json& msg);
+
+    /**
+     * @brief Línea del canal EXTENSION para un LOG_ENTRY
+     *
+     * timestamp numérico (Date.now() de la extensión) se formatea en UTC;
+     * string se respeta; ausente usa la hora del host.
+     */
+    std::string format_entry(const nlohmann::json& msg, const std::string& level);
+
+    class BatchedWriter {
+    public:
+        /** Recibe un lote ya unido ("línea\n" * lines). Corre en el thread del writer. */
+        using SinkFn = std::function<void(const std::string& block, size_t lines)>;
+
+        BatchedWriter(SinkFn sink, size_t max_queued_bytes);
+        ~BatchedWriter();
+
+        BatchedWriter(const BatchedWriter&) = delete;
+        BatchedWriter& operator=(const BatchedWriter&) = delete;
+
+        void start();
+
+        /** Escribe lo pendiente y detiene el thread. Idempotente. */
+        void stop();
+
+        /**
+         * @brief Encola una línea (sin '\n')
+         * @return false si la cola está llena o el writer detenido (descartada)
+         */
+        bool append(std::string line, const std::string& level);
+
+        nlohmann::json stats_json() const;
+
+    private:
+        void writer_loop();
+
+        SinkFn                    sink_;
+        const size_t              max_queued_bytes_;
+
+        mutable std::mutex        mutex_;
+        std::condition_variable   work_cv_;
+        std::thread               writer_;
+        bool                      started_  = false;
+        bool                      stopping_ = false;
+
+        std::vector<std::string>  pending_;
+        size_t                    pending_bytes_ = 0;
+
+        uint64_t                  written_lines_ = 0;
+        uint64_t                  written_bytes_ = 0;
+        uint64_t                  batches_       = 0;
+        uint64_t                  max_batch_     = 0;
+        uint64_t                  dropped_       = 0;
+        std::map<std::string, uint64_t> by_level_;
+    };
+
+}  // namespace ExtensionLogs
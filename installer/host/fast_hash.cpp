@@ -0,0 +1,216 @@
+#include "fast_hash.h"
+
+#include <cstring>
+
+namespace FastHash {
+
+namespace {
+
+const uint64_t P1 = 11400714785074694791ULL;
+const uint64_t P2 = 14029467366897019727ULL;
+const uint64_t P3 = 1609587929392839161ULL;
+const uint64_t P4 = 9650029242287828579ULL;
+const uint64_t P5 = 2870177450012600261ULL;
+
+inline uint64_t rotl(uint64_t x, int r) {
+    return (x << r) | (x >> (64 - r));
+}
+
+inline uint64_t read64(const unsigned char* p) {
+    uint64_t v;
+    std::memcpy(&v, p, sizeof(v));   // little endian en todas las plataformas soportadas
+    return v;
+}
+
+inline uint32_t read32(const unsigned char* p) {
+    uint32_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+inline uint64_t xxh_round(uint64_t acc, uint64_t input) {
+    acc += input * P2;
+    acc = rotl(acc, 31);
+    return acc * P1;
+}
+
+inline uint64_t merge_round(uint64_t acc, uint64_t val) {
+    acc ^= xxh_round(0, val);
+    return acc * P1 + P4;
+}
+
+inline uint64_t merge_accumulators(uint64_t v1, uint64_t v2, uint64_t v3, uint64_t v4) {
+    uint64_t h = rotl(v1, 1) + rotl(v2, 7) + rotl(v3, 12) + rotl(v4, 18);
+    h = merge_round(h, v1);
+    h = merge_round(h, v2);
+    h = merge_round(h, v3);
+    return merge_round(h, v4);
+}
+
+// Cola de menos de 32 bytes y avalanche final (one-shot y streaming)
+uint64_t finalize(uint64_t h, const unsigned char* p, const unsigned char* end) {
+    while (p + 8 <= end) {
+        h ^= xxh_round(0, read64(p));
+        h = rotl(h, 27) * P1 + P4;
+        p += 8;
+    }
+    if (p + 4 <= end) {
+        h ^= static_cast<uint64_t>(read32(p)) * P1;
+        h = rotl(h, 23) * P2 + P3;
+        p += 4;
+    }
+    while (p < end) {
+        h ^= (*p) * P5;
+        h = rotl(h, 11) * P1;
+        p++;
+    }
+
+    h ^= h >> 33;
+    h *= P2;
+    h ^= h >> 29;
+    h *= P3;
+    h ^= h >> 32;
+    return h;
+}
+
+// Tags de tipo: {"a":1} y {"a":"1"} no deben colisionar
+enum Tag : uint64_t { T_NULL = 1, T_FALSE, T_TRUE, T_INT, T_UINT, T_FLOAT, T_STRING, T_ARRAY, T_OBJECT, T_BINARY };
+
+uint64_t hash_string(const std::string& s) {
+    return xxh64(s.data(), s.size(), T_STRING);
+}
+
+uint64_t hash_value(const nlohmann::json& j, const char* skip) {
+    switch (j.type()) {
+        case nlohmann::json::value_t::null:
+            return T_NULL;
+        case nlohmann::json::value_t::boolean:
+            return j.get<bool>() ? T_TRUE : T_FALSE;
+        case nlohmann::json::value_t::number_integer:
+            return combine(T_INT, static_cast<uint64_t>(j.get<int64_t>()));
+        case nlohmann::json::value_t::number_unsigned:
+            return combine(T_UINT, j.get<uint64_t>());
+        case nlohmann::json::value_t::number_float: {
+            double d = j.get<double>();
+            uint64_t bits;
+            std::memcpy(&bits, &d, sizeof(bits));
+            return combine(T_FLOAT, bits);
+        }
+        case nlohmann::json::value_t::string:
+            return hash_string(j.get_ref<const std::string&>());
+        case nlohmann::json::value_t::array: {
+            uint64_t h = combine(T_ARRAY, j.size());
+            for (const auto& item : j) h = combine(h, hash_value(item, nullptr));
+            return h;
+        }
+        case nlohmann::json::value_t::object: {
+            // nlohmann::json guarda los objetos ordenados por clave
+            uint64_t h = T_OBJECT;
+            for (auto it = j.begin(); it != j.end(); ++it) {
+                if (skip && it.key() == skip) continue;
+                h = combine(h, hash_string(it.key()));
+                h = combine(h, hash_value(it.value(), nullptr));
+            }
+            return h;
+        }
+        case nlohmann::json::value_t::binary: {
+            const auto& bin = j.get_binary();
+            return xxh64(bin.data(), bin.size(), T_BINARY);
+        }
+        default:
+            return 0;
+    }
+}
+
+}  // namespace
+
+// ============================================================================
+// XXH64
+// ============================================================================
+
+uint64_t xxh64(const void* data, size_t len, uint64_t seed) {
+    const unsigned char* p = static_cast<const unsigned char*>(data);
+    const unsigned char* end = p + len;
+    uint64_t h;
+
+    if (len >= 32) {
+        uint64_t v1 = seed + P1 + P2;
+        uint64_t v2 = seed + P2;
+        uint64_t v3 = seed;
+        uint64_t v4 = seed - P1;
+        const unsigned char* limit = end - 32;
+        do {
+            v1 = xxh_round(v1, read64(p));      p += 8;
+            v2 = xxh_round(v2, read64(p));      p += 8;
+            v3 = xxh_round(v3, read64(p));      p += 8;
+            v4 = xxh_round(v4, read64(p));      p += 8;
+        } while (p <= limit);
+
+        h = merge_accumulators(v1, v2, v3, v4);
+    } else {
+        h = seed + P5;
+    }
+
+    h += static_cast<uint64_t>(len);
+    return finalize(h, p, end);
+}
+
+Xxh64State::Xxh64State(uint64_t seed)
+    : seed_(seed), v1_(seed + P1 + P2), v2_(seed + P2), v3_(seed), v4_(seed - P1) {}
+
+void Xxh64State::update(const void* data, size_t len) {
+    const unsigned char* p = static_cast<const unsigned char*>(data);
+    const unsigned char* end = p + len;
+    total_ += len;
+
+    // Completar el bloque de 32 bytes que quedó a medias
+    if (buffered_ + len < sizeof(buffer_)) {
+        std::memcpy(buffer_ + buffered_, p, len);
+        buffered_ += len;
+        return;
+    }
+    if (buffered_ > 0) {
+        size_t fill = sizeof(buffer_) - buffered_;
+        std::memcpy(buffer_ + buffered_, p, fill);
+        v1_ = xxh_round(v1_, read64(buffer_));
+        v2_ = xxh_round(v2_, read64(buffer_ + 8));
+        v3_ = xxh_round(v3_, read64(buffer_ + 16));
+        v4_ = xxh_round(v4_, read64(buffer_ + 24));
+        p += fill;
+        buffered_ = 0;
+    }
+
+    if (p + 32 <= end) {
+        uint64_t v1 = v1_, v2 = v2_, v3 = v3_, v4 = v4_;
+        const unsigned char* limit = end - 32;
+        do {
+            v1 = xxh_round(v1, read64(p));      p += 8;
+            v2 = xxh_round(v2, read64(p));      p += 8;
+            v3 = xxh_round(v3, read64(p));      p += 8;
+            v4 = xxh_round(v4, read64(p));      p += 8;
+        } while (p <= limit);
+        v1_ = v1; v2_ = v2; v3_ = v3; v4_ = v4;
+    }
+
+    if (p < end) {
+        buffered_ = static_cast<size_t>(end - p);
+        std::memcpy(buffer_, p, buffered_);
+    }
+}
+
+uint64_t Xxh64State::digest() const {
+    uint64_t h = total_ >= 32 ? merge_accumulators(v1_, v2_, v3_, v4_) : seed_ + P5;
+    h += total_;
+    return finalize(h, buffer_, buffer_ + buffered_);
+}
+
+uint64_t combine(uint64_t h, uint64_t v) {
+    h ^= xxh_round(0, v);
+    return rotl(h, 27) * P1 + P4;
+}
+
+uint64_t json_hash(const nlohmann::json& j, const char* skip_top_level) {
+    return hash_value(j, skip_top_level);
+}
+
+}  // namespace FastHash
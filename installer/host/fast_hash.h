@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <nlohmann/json.hpp>
+
+/**
+ * @brief Hash de contenido de 64 bits (no criptográfico)
+ *
+ * xxh64 es XXH64 (xxHash): 8 bytes por paso, varios GB/s, suficiente para
+ * comparar mensajes dentro del proceso. No sirve como checksum contra un
+ * peer malicioso; para eso está el SHA-256 de los chunks.
+ */
+namespace FastHash {
+
+    uint64_t xxh64(const void* data, size_t len, uint64_t seed = 0);
+
+    /**
+     * @brief XXH64 incremental: mismo resultado que xxh64() sobre la concatenación
+     *
+     * Para datos que llegan por partes (chunks de un upload, chunk_checksum.h).
+     */
+    class Xxh64State {
+    public:
+        explicit Xxh64State(uint64_t seed = 0);
+
+        void     update(const void* data, size_t len);
+        uint64_t digest() const;
+
+    private:
+        uint64_t      seed_;
+        uint64_t      v1_, v2_, v3_, v4_;
+        uint64_t      total_    = 0;
+        unsigned char buffer_[32];
+        size_t        buffered_ = 0;
+    };
+
+    /** Mezcla v en h (orden importa). */
+    uint64_t combine(uint64_t h, uint64_t v);
+
+    /**
+     * @brief Hash estructural de un JSON sin serializarlo
+     *
+     * Recorre el árbol: claves, tipos y valores. Dos mensajes con el mismo
+     * contenido dan el mismo hash aunque el texto difiera en espacios u
+     * orden de claves. skip_top_level: clave de primer nivel a ignorar
+     * (p.ej. "timestamp"), nullptr para ninguna.
+     */
+    uint64_t json_hash(const nlohmann::json& j, const char* skip_top_level = nullptr);
+
+}  // namespace FastHash
@@ -0,0 +1,92 @@
+#include "flow_control.h"
+
+namespace FlowControl {
+
+// ============================================================================
+// MENSAJES
+// ============================================================================
+
+nlohmann::json window_json(const Window& w) {
+    return {{"window_bytes", w.bytes}, {"window_frames", w.frames}};
+}
+
+bool parse_window(const nlohmann::json& msg, Window& out) {
+    auto it = msg.find("flow_control");
+    if (it == msg.end() || !it->is_object()) return false;
+
+    auto bytes = it->find("window_bytes");
+    auto frames = it->find("window_frames");
+    if (bytes == it->end() || frames == it->end()) return false;
+    if (!bytes->is_number_unsigned() || !frames->is_number_unsigned()) return false;
+
+    out.bytes = bytes->get<uint64_t>();
+    out.frames = frames->get<uint64_t>();
+    return out.bytes > 0 && out.frames > 0;
+}
+
+nlohmann::json credit_message(const Window& grant) {
+    return {{"type", "FLOW_CREDIT"}, {"bytes", grant.bytes}, {"frames", grant.frames}};
+}
+
+// ============================================================================
+// CREDIT GRANTOR (lado consumidor)
+// ============================================================================
+
+CreditGrantor::CreditGrantor(Window window) : window_(window) {}
+
+uint64_t CreditGrantor::reset() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    enabled_ = false;
+    pending_bytes_ = 0;
+    pending_frames_ = 0;
+    return ++epoch_;
+}
+
+void CreditGrantor::enable() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    enabled_ = true;
+}
+
+uint64_t CreditGrantor::epoch() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return epoch_;
+}
+
+bool CreditGrantor::consume(uint64_t epoch, size_t bytes, Window& grant) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!enabled_ || epoch != epoch_) return false;
+
+    pending_bytes_ += bytes;
+    pending_frames_ += 1;
+    consumed_bytes_ += bytes;
+    consumed_frames_ += 1;
+
+    // Media ventana: el peer nunca se queda sin crédito mientras haya
+    // frames nuestros sin devolver, y el costo es un FLOW_CREDIT cada W/2
+    if (pending_bytes_ * 2 < window_.bytes && pending_frames_ * 2 < window_.frames) return false;
+
+    grant.bytes = pending_bytes_;
+    grant.frames = pending_frames_;
+    granted_bytes_ += pending_bytes_;
+    grants_sent_++;
+    pending_bytes_ = 0;
+    pending_frames_ = 0;
+    return true;
+}
+
+nlohmann::json CreditGrantor::stats_json() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return {
+        {"enabled",         enabled_},
+        {"window_bytes",    window_.bytes},
+        {"window_frames",   window_.frames},
+        {"consumed_bytes",  consumed_bytes_},
+        {"consumed_frames", consumed_frames_},
+        {"pending_bytes",   pending_bytes_},
+        {"pending_frames",  pending_frames_},
+        {"granted_bytes",   granted_bytes_},
+        {"grants_sent",     grants_sent_}
+    };
+}
+
+}  // namespace FlowControl
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <nlohmann/json.hpp>
+
+/**
+ * @brief Flow control por créditos en el link Host ↔ Brain
+ *
+ * Negociación (opt-in, ambos lados deben anunciarla):
+ *
+ *   Host  → Brain  REGISTER_HOST { ..., "flow_control": {"window_bytes":W, "window_frames":F} }
+ *                  W/F = crédito que el host otorga a Brain
+ *   Brain → Host   REGISTER_ACK  { ..., "flow_control": {"window_bytes":W, "window_frames":F} }
+ *                  W/F = crédito que Brain otorga al host
+ *
+ * Si REGISTER_ACK no trae flow_control (Brain viejo) el link queda como antes.
+ *
+ * Cada frame que viaja descuenta su payload (sin el header de 4 bytes) y un
+ * frame de la ventana del emisor. Los frames de control pueden sobregirar la
+ * ventana; los BULK esperan en la cola del emisor (ver OutboundScheduler).
+ * El consumidor devuelve crédito con
+ *
+ *   { "type": "FLOW_CREDIT", "bytes": N, "frames": M }
+ *
+ * cuando terminó con los frames: en el host, los mensajes de Brain que van a
+ * Chrome se devuelven recién cuando el writer de stdout los escribió, así un
+ * Chrome lento frena a Brain en vez de llenar la cola del host y bloquear el
+ * reader TCP (con PING/REQUEST_STATS atrás).
+ *
+ * CreditGrantor es el lado consumidor: acumula lo consumido y decide cuándo
+ * mandar FLOW_CREDIT (media ventana, para no mandar un frame por frame).
+ */
+namespace FlowControl {
+
+    struct Window {
+        uint64_t bytes  = 0;
+        uint64_t frames = 0;
+    };
+
+    /** {"window_bytes":..,"window_frames":..} */
+    nlohmann::json window_json(const Window& w);
+
+    /** Lee msg["flow_control"]. @return false si no está o es inválido (peer sin flow control) */
+    bool parse_window(const nlohmann::json& msg, Window& out);
+
+    /** Mensaje FLOW_CREDIT listo para serializar. */
+    nlohmann::json credit_message(const Window& grant);
+
+    class CreditGrantor {
+    public:
+        explicit CreditGrantor(Window window);
+
+        /** Nueva conexión: invalida lo pendiente de la anterior. @return epoch nuevo */
+        uint64_t reset();
+
+        /** El peer confirmó flow control (REGISTER_ACK con flow_control). */
+        void enable();
+
+        uint64_t epoch() const;
+        Window window() const { return window_; }
+
+        /**
+         * @brief Registra un frame del peer ya procesado
+         * @param epoch epoch vigente cuando se recibió (los de conexiones previas se ignoran)
+         * @param grant crédito a devolver si la función retorna true
+         * @return true si hay que enviar FLOW_CREDIT ahora
+         */
+        bool consume(uint64_t epoch, size_t bytes, Window& grant);
+
+        nlohmann::json stats_json() const;
+
+    private:
+        const Window       window_;
+        mutable std::mutex mutex_;
+        uint64_t           epoch_          = 0;
+        bool               enabled_        = false;
+        uint64_t           pending_bytes_  = 0;
+        uint64_t           pending_frames_ = 0;
+        uint64_t           consumed_bytes_ = 0;
+        uint64_t           consumed_frames_ = 0;
+        uint64_t           granted_bytes_  = 0;
+        uint64_t           grants_sent_    = 0;
+    };
+
+}  // namespace FlowControl
@@ -0,0 +1,586 @@
+#include "frame_validator.h"
+
+#include <chrono>
+#include <cstring>
+#include <vector>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+    #include <immintrin.h>
+    #define FRAME_VALIDATOR_X86 1
+    #define TARGET_SSE42 __attribute__((target("sse4.2")))
+    #define TARGET_AVX2  __attribute__((target("avx2")))
+#endif
+
+namespace FrameValidator {
+
+namespace {
+
+const size_t BLOCK = 64;   // bytes por máscara de structure_valid()
+
+uint64_t now_ns() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+// ============================================================================
+// UTF-8 SCALAR
+// ============================================================================
+
+bool utf8_scalar(const unsigned char* p, size_t len) {
+    size_t i = 0;
+    while (i < len) {
+        if (len - i >= 8) {
+            uint64_t v;
+            std::memcpy(&v, p + i, 8);
+            if ((v & 0x8080808080808080ULL) == 0) {
+                i += 8;
+                continue;
+            }
+        }
+        const unsigned char c = p[i];
+        if (c < 0x80) {
+            i++;
+            continue;
+        }
+
+        // Rango del segundo byte según el primero (RFC 3629, tabla 3-7 de Unicode)
+        size_t cont;
+        unsigned char lo = 0x80, hi = 0xBF;
+        if      (c >= 0xC2 && c <= 0xDF) cont = 1;
+        else if (c == 0xE0)              { cont = 2; lo = 0xA0; }
+        else if (c == 0xED)              { cont = 2; hi = 0x9F; }
+        else if (c >= 0xE1 && c <= 0xEF) cont = 2;
+        else if (c == 0xF0)              { cont = 3; lo = 0x90; }
+        else if (c == 0xF4)              { cont = 3; hi = 0x8F; }
+        else if (c >= 0xF1 && c <= 0xF3) cont = 3;
+        else return false;
+
+        if (len - i - 1 < cont) return false;
+        if (p[i + 1] < lo || p[i + 1] > hi) return false;
+        for (size_t k = 2; k <= cont; ++k) {
+            if ((p[i + k] & 0xC0) != 0x80) return false;
+        }
+        i += cont + 1;
+    }
+    return true;
+}
+
+// ============================================================================
+// UTF-8 SIMD (Keiser & Lemire, "Validating UTF-8 In Less Than One
+// Instruction Per Byte", 2021)
+//
+// Cada byte se clasifica por el nibble alto del anterior, el nibble bajo del
+// anterior y el nibble alto propio; el AND de las tres tablas deja un bit por
+// cada error de dos bytes. Las continuaciones 3ª/4ª (prev2 >= 0xE0, prev3 >=
+// 0xF0) se esperan como TWO_CONTS y se cancelan con el XOR.
+// ============================================================================
+
+#if defined(FRAME_VALIDATOR_X86)
+
+const uint8_t TOO_SHORT      = 1 << 0;   // 11______ 0_______ / 11______ 11______
+const uint8_t TOO_LONG       = 1 << 1;   // 0_______ 10______
+const uint8_t OVERLONG_3     = 1 << 2;   // 11100000 100_____
+const uint8_t TOO_LARGE      = 1 << 3;   // 11110100 1001____ y mayores
+const uint8_t SURROGATE      = 1 << 4;   // 11101101 101_____
+const uint8_t OVERLONG_2     = 1 << 5;   // 1100000_ 10______
+const uint8_t TOO_LARGE_1000 = 1 << 6;   // 11110101 1000____ y mayores
+const uint8_t OVERLONG_4     = 1 << 6;   // 11110000 1000____
+const uint8_t TWO_CONTS      = 1 << 7;   // 10______ 10______
+const uint8_t CARRY          = TOO_SHORT | TOO_LONG | TWO_CONTS;
+
+alignas(16) const uint8_t BYTE_1_HIGH[16] = {
+    TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG,   // 0___
+    TWO_CONTS, TWO_CONTS, TWO_CONTS, TWO_CONTS,                                       // 10__
+    TOO_SHORT | OVERLONG_2,                                                           // 1100
+    TOO_SHORT,                                                                        // 1101
+    TOO_SHORT | OVERLONG_3 | SURROGATE,                                               // 1110
+    TOO_SHORT | TOO_LARGE | TOO_LARGE_1000 | OVERLONG_4                               // 1111
+};
+
+alignas(16) const uint8_t BYTE_1_LOW[16] = {
+    CARRY | OVERLONG_3 | OVERLONG_2 | OVERLONG_4,   // ____0000
+    CARRY | OVERLONG_2,                             // ____0001
+    CARRY,
+    CARRY,
+    CARRY | TOO_LARGE,                              // ____0100
+    CARRY | TOO_LARGE | TOO_LARGE_1000,
+    CARRY | TOO_LARGE | TOO_LARGE_1000,
+    CARRY | TOO_LARGE | TOO_LARGE_1000,
+    CARRY | TOO_LARGE | TOO_LARGE_1000,
+    CARRY | TOO_LARGE | TOO_LARGE_1000,
+    CARRY | TOO_LARGE | TOO_LARGE_1000,
+    CARRY | TOO_LARGE | TOO_LARGE_1000,
+    CARRY | TOO_LARGE | TOO_LARGE_1000,
+    CARRY | TOO_LARGE | TOO_LARGE_1000 | SURROGATE, // ____1101
+    CARRY | TOO_LARGE | TOO_LARGE_1000,
+    CARRY | TOO_LARGE | TOO_LARGE_1000
+};
+
+alignas(16) const uint8_t BYTE_2_HIGH[16] = {
+    TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT,   // 0___
+    TOO_LONG | OVERLONG_2 | TWO_CONTS | OVERLONG_3 | TOO_LARGE_1000 | OVERLONG_4,             // 1000
+    TOO_LONG | OVERLONG_2 | TWO_CONTS | OVERLONG_3 | TOO_LARGE,                               // 1001
+    TOO_LONG | OVERLONG_2 | TWO_CONTS | SURROGATE  | TOO_LARGE,                               // 101_
+    TOO_LONG | OVERLONG_2 | TWO_CONTS | SURROGATE  | TOO_LARGE,
+    TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT                                                // 11__
+};
+
+// Un bloque que termina a mitad de secuencia: el que sigue tiene que
+// continuarla (si es ASCII, error)
+alignas(32) const uint8_t INCOMPLETE_MAX[32] = {
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xF0 - 1, 0xE0 - 1, 0xC0 - 1
+};
+
+// ---- SSE4.2: 16 bytes por registro ----------------------------------------
+
+struct Sse42Utf8 {
+    __m128i error;
+    __m128i prev_input;
+    __m128i prev_incomplete;
+
+    TARGET_SSE42 Sse42Utf8()
+        : error(_mm_setzero_si128()), prev_input(_mm_setzero_si128()), prev_incomplete(_mm_setzero_si128()) {}
+
+    TARGET_SSE42 static __m128i high_nibble(__m128i v) {
+        return _mm_and_si128(_mm_srli_epi16(v, 4), _mm_set1_epi8(0x0F));
+    }
+
+    TARGET_SSE42 void check_chunk(__m128i input) {
+        const __m128i prev1 = _mm_alignr_epi8(input, prev_input, 15);
+        const __m128i prev2 = _mm_alignr_epi8(input, prev_input, 14);
+        const __m128i prev3 = _mm_alignr_epi8(input, prev_input, 13);
+
+        const __m128i b1h = _mm_shuffle_epi8(_mm_load_si128(reinterpret_cast<const __m128i*>(BYTE_1_HIGH)),
+                                             high_nibble(prev1));
+        const __m128i b1l = _mm_shuffle_epi8(_mm_load_si128(reinterpret_cast<const __m128i*>(BYTE_1_LOW)),
+                                             _mm_and_si128(prev1, _mm_set1_epi8(0x0F)));
+        const __m128i b2h = _mm_shuffle_epi8(_mm_load_si128(reinterpret_cast<const __m128i*>(BYTE_2_HIGH)),
+                                             high_nibble(input));
+        const __m128i special = _mm_and_si128(_mm_and_si128(b1h, b1l), b2h);
+
+        const __m128i third  = _mm_subs_epu8(prev2, _mm_set1_epi8(static_cast<char>(0xE0 - 0x80)));
+        const __m128i fourth = _mm_subs_epu8(prev3, _mm_set1_epi8(static_cast<char>(0xF0 - 0x80)));
+        const __m128i must23 = _mm_and_si128(_mm_or_si128(third, fourth), _mm_set1_epi8(static_cast<char>(0x80)));
+
+        error = _mm_or_si128(error, _mm_xor_si128(must23, special));
+        prev_input = input;
+    }
+
+    TARGET_SSE42 void check_block(const unsigned char* p) {
+        const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 16));
+        const __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 32));
+        const __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 48));
+        if (_mm_movemask_epi8(_mm_or_si128(_mm_or_si128(a, b), _mm_or_si128(c, d))) == 0) {
+            error = _mm_or_si128(error, prev_incomplete);
+            prev_input = d;
+            return;
+        }
+        check_chunk(a);
+        check_chunk(b);
+        check_chunk(c);
+        check_chunk(d);
+        prev_incomplete = _mm_subs_epu8(d, _mm_loadu_si128(reinterpret_cast<const __m128i*>(INCOMPLETE_MAX + 16)));
+    }
+
+    TARGET_SSE42 bool ok() const { return _mm_testz_si128(error, error) != 0; }
+};
+
+TARGET_SSE42 bool utf8_sse42(const unsigned char* p, size_t len) {
+    Sse42Utf8 checker;
+    size_t i = 0;
+    for (; i + BLOCK <= len; i += BLOCK) checker.check_block(p + i);
+
+    // Cola con ceros (siempre, aunque len sea múltiplo de 64): una secuencia
+    // cortada al final queda como TOO_SHORT o como prev_incomplete
+    unsigned char tail[BLOCK] = {0};
+    std::memcpy(tail, p + i, len - i);
+    checker.check_block(tail);
+    return checker.ok();
+}
+
+// ---- AVX2: 32 bytes por registro ------------------------------------------
+
+struct Avx2Utf8 {
+    __m256i error;
+    __m256i prev_input;
+    __m256i prev_incomplete;
+
+    TARGET_AVX2 Avx2Utf8()
+        : error(_mm256_setzero_si256()), prev_input(_mm256_setzero_si256()),
+          prev_incomplete(_mm256_setzero_si256()) {}
+
+    TARGET_AVX2 static __m256i table(const uint8_t* t) {
+        return _mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i*>(t)));
+    }
+
+    TARGET_AVX2 static __m256i high_nibble(__m256i v) {
+        return _mm256_and_si256(_mm256_srli_epi16(v, 4), _mm256_set1_epi8(0x0F));
+    }
+
+    TARGET_AVX2 void check_chunk(__m256i input) {
+        // alignr trabaja por lane de 128: el lane bajo necesita el final de prev_input
+        const __m256i carried = _mm256_permute2x128_si256(prev_input, input, 0x21);
+        const __m256i prev1 = _mm256_alignr_epi8(input, carried, 15);
+        const __m256i prev2 = _mm256_alignr_epi8(input, carried, 14);
+        const __m256i prev3 = _mm256_alignr_epi8(input, carried, 13);
+
+        const __m256i b1h = _mm256_shuffle_epi8(table(BYTE_1_HIGH), high_nibble(prev1));
+        const __m256i b1l = _mm256_shuffle_epi8(table(BYTE_1_LOW), _mm256_and_si256(prev1, _mm256_set1_epi8(0x0F)));
+        const __m256i b2h = _mm256_shuffle_epi8(table(BYTE_2_HIGH), high_nibble(input));
+        const __m256i special = _mm256_and_si256(_mm256_and_si256(b1h, b1l), b2h);
+
+        const __m256i third  = _mm256_subs_epu8(prev2, _mm256_set1_epi8(static_cast<char>(0xE0 - 0x80)));
+        const __m256i fourth = _mm256_subs_epu8(prev3, _mm256_set1_epi8(static_cast<char>(0xF0 - 0x80)));
+        const __m256i must23 = _mm256_and_si256(_mm256_or_si256(third, fourth),
+                                                _mm256_set1_epi8(static_cast<char>(0x80)));
+
+        error = _mm256_or_si256(error, _mm256_xor_si256(must23, special));
+        prev_input = input;
+    }
+
+    TARGET_AVX2 void check_block(const unsigned char* p) {
+        const __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+        const __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + 32));
+        if (_mm256_movemask_epi8(_mm256_or_si256(a, b)) == 0) {
+            error = _mm256_or_si256(error, prev_incomplete);
+            prev_input = b;
+            return;
+        }
+        check_chunk(a);
+        check_chunk(b);
+        prev_incomplete = _mm256_subs_epu8(b, _mm256_load_si256(reinterpret_cast<const __m256i*>(INCOMPLETE_MAX)));
+    }
+
+    TARGET_AVX2 bool ok() const { return _mm256_testz_si256(error, error) != 0; }
+};
+
+TARGET_AVX2 bool utf8_avx2(const unsigned char* p, size_t len) {
+    Avx2Utf8 checker;
+    size_t i = 0;
+    for (; i + BLOCK <= len; i += BLOCK) checker.check_block(p + i);
+
+    unsigned char tail[BLOCK] = {0};
+    std::memcpy(tail, p + i, len - i);
+    checker.check_block(tail);
+    return checker.ok();
+}
+
+#endif  // FRAME_VALIDATOR_X86
+
+// ============================================================================
+// ESTRUCTURA
+// Por bloque de 64 bytes: máscaras de comillas, barras y llaves/corchetes
+// (cualquiera de los cuatro: c & 0xDF es 0x5B o 0x5D). El resto es común.
+// ============================================================================
+
+struct Masks {
+    uint64_t quote;
+    uint64_t backslash;
+    uint64_t bracket;
+};
+
+// SWAR: bit alto de cada byte de v igual a c (exacto, sin falsos positivos
+// por borrow entre bytes), juntado en 8 bits
+uint64_t byte_eq_mask(uint64_t v, uint8_t c) {
+    const uint64_t LOW7 = 0x7F7F7F7F7F7F7F7FULL;
+    const uint64_t x = v ^ (0x0101010101010101ULL * c);
+    const uint64_t zero_high = ~(((x & LOW7) + LOW7) | x | LOW7);
+    return ((zero_high >> 7) * 0x0102040810204080ULL) >> 56;
+}
+
+Masks masks_scalar(const unsigned char* p) {
+    Masks m = {0, 0, 0};
+    for (size_t i = 0; i < BLOCK; i += 8) {
+        uint64_t v;
+        std::memcpy(&v, p + i, 8);   // little endian: byte 0 en los bits bajos
+        const uint64_t folded = v & 0xDFDFDFDFDFDFDFDFULL;
+        m.quote     |= byte_eq_mask(v, '"') << i;
+        m.backslash |= byte_eq_mask(v, '\\') << i;
+        m.bracket   |= (byte_eq_mask(folded, 0x5B) | byte_eq_mask(folded, 0x5D)) << i;
+    }
+    return m;
+}
+
+#if defined(FRAME_VALIDATOR_X86)
+
+TARGET_SSE42 Masks masks_sse42(const unsigned char* p) {
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i slash = _mm_set1_epi8('\\');
+    const __m128i fold  = _mm_set1_epi8(static_cast<char>(0xDF));
+    const __m128i open  = _mm_set1_epi8(0x5B);
+    const __m128i close = _mm_set1_epi8(0x5D);
+    Masks m = {0, 0, 0};
+    for (size_t i = 0; i < BLOCK; i += 16) {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+        const __m128i f = _mm_and_si128(v, fold);
+        m.quote     |= static_cast<uint64_t>(static_cast<uint16_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(v, quote)))) << i;
+        m.backslash |= static_cast<uint64_t>(static_cast<uint16_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(v, slash)))) << i;
+        m.bracket   |= static_cast<uint64_t>(static_cast<uint16_t>(_mm_movemask_epi8(
+                           _mm_or_si128(_mm_cmpeq_epi8(f, open), _mm_cmpeq_epi8(f, close))))) << i;
+    }
+    return m;
+}
+
+TARGET_AVX2 Masks masks_avx2(const unsigned char* p) {
+    const __m256i quote = _mm256_set1_epi8('"');
+    const __m256i slash = _mm256_set1_epi8('\\');
+    const __m256i fold  = _mm256_set1_epi8(static_cast<char>(0xDF));
+    const __m256i open  = _mm256_set1_epi8(0x5B);
+    const __m256i close = _mm256_set1_epi8(0x5D);
+    Masks m = {0, 0, 0};
+    for (size_t i = 0; i < BLOCK; i += 32) {
+        const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i));
+        const __m256i f = _mm256_and_si256(v, fold);
+        m.quote     |= static_cast<uint64_t>(static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, quote)))) << i;
+        m.backslash |= static_cast<uint64_t>(static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, slash)))) << i;
+        m.bracket   |= static_cast<uint64_t>(static_cast<uint32_t>(_mm256_movemask_epi8(
+                           _mm256_or_si256(_mm256_cmpeq_epi8(f, open), _mm256_cmpeq_epi8(f, close))))) << i;
+    }
+    return m;
+}
+
+#endif  // FRAME_VALIDATOR_X86
+
+// Bit i prendido ⇒ XOR de los bits 0..i
+uint64_t prefix_xor(uint64_t x) {
+    x ^= x << 1;
+    x ^= x << 2;
+    x ^= x << 4;
+    x ^= x << 8;
+    x ^= x << 16;
+    x ^= x << 32;
+    return x;
+}
+
+bool is_json_space(unsigned char c) {
+    return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+}
+
+class StructureScanner {
+public:
+    explicit StructureScanner(size_t last) : last_(last) {}
+
+    bool block(const unsigned char* p, size_t offset, const Masks& m) {
+        const uint64_t escapes = escaped(m.backslash);
+        const uint64_t in_string = prefix_xor(m.quote & ~escapes) ^ string_carry_;
+        string_carry_ = static_cast<uint64_t>(static_cast<int64_t>(in_string) >> 63);
+
+        uint64_t brackets = m.bracket & ~in_string & ~escapes;
+        while (brackets) {
+            const unsigned pos = static_cast<unsigned>(__builtin_ctzll(brackets));
+            brackets &= brackets - 1;
+            const unsigned char c = p[pos];
+            if (c == '{' || c == '[') {
+                push(c == '[');
+                continue;
+            }
+            if (depth_ == 0 || top() != (c == ']')) return false;
+            depth_--;
+            // El objeto de afuera cierra en el último byte, nada después
+            if (depth_ == 0 && offset + pos != last_) return false;
+        }
+        return true;
+    }
+
+    bool finished() const { return depth_ == 0 && string_carry_ == 0; }
+
+private:
+    static const size_t INLINE_LEVELS = 512;
+
+    // Caracteres escapados: los que siguen a una serie impar de barras. Una
+    // serie que empieza en bit par, sumada a sí misma con los bits impares
+    // prendidos, propaga el carry hasta su final; la paridad del bit donde
+    // termina dice si escapa (simdjson, json_escape_scanner).
+    uint64_t escaped(uint64_t backslash) {
+        const uint64_t ODD_BITS = 0xAAAAAAAAAAAAAAAAULL;
+        if (!backslash) {
+            const uint64_t result = escape_carry_;
+            escape_carry_ = 0;
+            return result;
+        }
+        const uint64_t potential = backslash & ~escape_carry_;
+        const uint64_t code      = (((potential << 1) | ODD_BITS) - potential) ^ ODD_BITS;
+        const uint64_t result    = code ^ (backslash | escape_carry_);
+        escape_carry_ = (code & backslash) >> 63;
+        return result;
+    }
+
+    void push(bool array) {
+        const size_t word = depth_ / 64;
+        uint64_t* stack = word < INLINE_LEVELS / 64 ? inline_stack_ : nullptr;
+        if (!stack) {
+            const size_t spill = word - INLINE_LEVELS / 64;
+            if (spill >= deep_stack_.size()) deep_stack_.push_back(0);
+            stack = &deep_stack_[spill];
+        } else {
+            stack += word;
+        }
+        const uint64_t bit = 1ULL << (depth_ % 64);
+        *stack = array ? (*stack | bit) : (*stack & ~bit);
+        depth_++;
+    }
+
+    bool top() const {
+        const size_t level = depth_ - 1;
+        const size_t word  = level / 64;
+        const uint64_t bits = word < INLINE_LEVELS / 64 ? inline_stack_[word]
+                                                        : deep_stack_[word - INLINE_LEVELS / 64];
+        return (bits >> (level % 64)) & 1;
+    }
+
+    size_t                last_;
+    size_t                depth_         = 0;
+    uint64_t              escape_carry_  = 0;
+    uint64_t              string_carry_  = 0;
+    // 1 bit por nivel: 0 = objeto, 1 = array. Más de INLINE_LEVELS niveles
+    // (no pasa con mensajes reales) sigue en el heap.
+    uint64_t              inline_stack_[INLINE_LEVELS / 64];
+    std::vector<uint64_t> deep_stack_;
+};
+
+// always_inline: se expande dentro de cada wrapper con target, y ahí las
+// máscaras SIMD se pueden inlinear
+template <typename MaskFn>
+__attribute__((always_inline)) inline bool structure_blocks(const unsigned char* p, size_t len, MaskFn masks) {
+    size_t first = 0;
+    while (first < len && is_json_space(p[first])) first++;
+    size_t end = len;
+    while (end > first && is_json_space(p[end - 1])) end--;
+    if (end - first < 2 || p[first] != '{' || p[end - 1] != '}') return false;
+
+    StructureScanner scanner(end - 1);
+    size_t i = 0;
+    for (; i + BLOCK <= len; i += BLOCK) {
+        if (!scanner.block(p + i, i, masks(p + i))) return false;
+    }
+    if (i < len) {
+        unsigned char tail[BLOCK] = {0};
+        std::memcpy(tail, p + i, len - i);
+        if (!scanner.block(tail, i, masks(tail))) return false;
+    }
+    return scanner.finished();
+}
+
+bool structure_scalar(const unsigned char* p, size_t len) { return structure_blocks(p, len, masks_scalar); }
+
+#if defined(FRAME_VALIDATOR_X86)
+TARGET_SSE42 bool structure_sse42(const unsigned char* p, size_t len) { return structure_blocks(p, len, masks_sse42); }
+TARGET_AVX2  bool structure_avx2(const unsigned char* p, size_t len)  { return structure_blocks(p, len, masks_avx2); }
+#endif
+
+Isa detect_best() {
+#if defined(FRAME_VALIDATOR_X86)
+    if (__builtin_cpu_supports("avx2"))   return ISA_AVX2;
+    if (__builtin_cpu_supports("sse4.2")) return ISA_SSE42;
+#endif
+    return ISA_SCALAR;
+}
+
+Isa usable(Isa isa) {
+    return isa_supported(isa) ? isa : best_isa();
+}
+
+}  // namespace
+
+// ============================================================================
+// API
+// ============================================================================
+
+const char* isa_name(Isa isa) {
+    switch (isa) {
+        case ISA_AVX2:  return "avx2";
+        case ISA_SSE42: return "sse4.2";
+        default:        return "scalar";
+    }
+}
+
+const char* result_name(Result result) {
+    switch (result) {
+        case INVALID_UTF8:      return "utf8";
+        case INVALID_STRUCTURE: return "structure";
+        default:                return "valid";
+    }
+}
+
+Isa best_isa() {
+    static const Isa best = detect_best();
+    return best;
+}
+
+bool isa_supported(Isa isa) {
+    return isa <= best_isa();
+}
+
+bool utf8_valid(const char* data, size_t len, Isa isa) {
+    const unsigned char* p = reinterpret_cast<const unsigned char*>(data);
+    switch (usable(isa)) {
+#if defined(FRAME_VALIDATOR_X86)
+        case ISA_AVX2:  return utf8_avx2(p, len);
+        case ISA_SSE42: return utf8_sse42(p, len);
+#endif
+        default:        return utf8_scalar(p, len);
+    }
+}
+
+bool structure_valid(const char* data, size_t len, Isa isa) {
+    const unsigned char* p = reinterpret_cast<const unsigned char*>(data);
+    switch (usable(isa)) {
+#if defined(FRAME_VALIDATOR_X86)
+        case ISA_AVX2:  return structure_avx2(p, len);
+        case ISA_SSE42: return structure_sse42(p, len);
+#endif
+        default:        return structure_scalar(p, len);
+    }
+}
+
+Result check(const char* data, size_t len, Isa isa) {
+    if (!utf8_valid(data, len, isa))      return INVALID_UTF8;
+    if (!structure_valid(data, len, isa)) return INVALID_STRUCTURE;
+    return VALID;
+}
+
+// ============================================================================
+// GATE
+// ============================================================================
+
+Result Gate::check(Source source, const char* data, size_t len) {
+    if (!enabled()) return VALID;
+
+    const uint64_t start = now_ns();
+    const Result result = FrameValidator::check(data, len);
+    Counters& c = counters_[source];
+    c.ns_total.fetch_add(now_ns() - start, std::memory_order_relaxed);
+    c.frames.fetch_add(1, std::memory_order_relaxed);
+    c.bytes.fetch_add(len, std::memory_order_relaxed);
+    if (result == INVALID_UTF8)      c.invalid_utf8.fetch_add(1, std::memory_order_relaxed);
+    if (result == INVALID_STRUCTURE) c.invalid_structure.fetch_add(1, std::memory_order_relaxed);
+    return result;
+}
+
+nlohmann::json Gate::stats_json() const {
+    static const char* const NAMES[SOURCE_COUNT] = {"chrome", "brain", "assembled"};
+
+    nlohmann::json out = {
+        {"enabled", enabled()},
+        {"isa",     isa_name(best_isa())}
+    };
+    for (int s = 0; s < SOURCE_COUNT; ++s) {
+        const Counters& c = counters_[s];
+        const uint64_t bytes = c.bytes.load(std::memory_order_relaxed);
+        const uint64_t ns    = c.ns_total.load(std::memory_order_relaxed);
+        out[NAMES[s]] = {
+            {"frames",            c.frames.load(std::memory_order_relaxed)},
+            {"bytes",             bytes},
+            {"invalid_utf8",      c.invalid_utf8.load(std::memory_order_relaxed)},
+            {"invalid_structure", c.invalid_structure.load(std::memory_order_relaxed)},
+            {"ns_total",          ns},
+            {"gb_per_s",          ns ? static_cast<double>(bytes) / ns : 0.0}
+        };
+    }
+    return out;
+}
+
+}  // namespace FrameValidator
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <nlohmann/json.hpp>
+
+/**
+ * @brief Validación barata de un frame crudo antes de reenviarlo
+ *
+ * No todo lo que el host reenvía pasa por un parse completo: un upload
+ * reensamblado sale tal cual a Brain (chunked_buffer.h) y las proyecciones
+ * solo recorren el texto. Brain y Chrome se caen con UTF-8 inválido, así que
+ * cada frame crudo de stdin, del socket de Brain y de un reensamblado pasa
+ * antes por dos chequeos a velocidad de memoria:
+ *
+ *   utf8_valid()       UTF-8 bien formado (RFC 3629: sin overlongs, sin
+ *                      surrogates, nada arriba de U+10FFFF). Algoritmo de
+ *                      lookup de Keiser & Lemire: tres tablas de 16 entradas
+ *                      por nibble con pshufb, 16 (SSE4.2) o 32 (AVX2) bytes
+ *                      por paso; un bloque ASCII solo mira el bit alto.
+ *   structure_valid()  Un solo objeto JSON: primer y último byte no blanco
+ *                      son '{' y '}', llaves y corchetes balanceados y del
+ *                      mismo tipo fuera de strings, strings cerrados. Las
+ *                      comillas y barras salen como máscaras de 64 bits por
+ *                      bloque; el estado "dentro de string" es el prefix-XOR
+ *                      de las comillas no escapadas.
+ *
+ * No reemplaza al parser: un frame que pasa puede igual ser JSON inválido
+ * (un número mal escrito); el que no pasa seguro lo es.
+ *
+ * La ISA se elige en runtime (AVX2 > SSE4.2 > scalar); el parámetro isa es
+ * para el benchmark y para comparar las implementaciones.
+ */
+namespace FrameValidator {
+
+    enum Isa { ISA_SCALAR = 0, ISA_SSE42, ISA_AVX2 };
+
+    enum Result { VALID = 0, INVALID_UTF8, INVALID_STRUCTURE };
+
+    const char* isa_name(Isa isa);
+    const char* result_name(Result result);
+
+    /** La mejor ISA que soporta la CPU. */
+    Isa  best_isa();
+    bool isa_supported(Isa isa);
+
+    bool utf8_valid(const char* data, size_t len, Isa isa = best_isa());
+    bool structure_valid(const char* data, size_t len, Isa isa = best_isa());
+
+    /** Los dos chequeos, UTF-8 primero. */
+    Result check(const char* data, size_t len, Isa isa = best_isa());
+
+    /**
+     * @brief Chequeo de los frames del host con contadores por origen
+     *
+     * --validate-frames off lo desactiva (check() siempre VALID). Thread-safe.
+     */
+    class Gate {
+    public:
+        enum Source { FROM_CHROME = 0, FROM_BRAIN, ASSEMBLED, SOURCE_COUNT };
+
+        void set_enabled(bool enabled) { enabled_.store(enabled); }
+        bool enabled() const { return enabled_.load(); }
+
+        Result check(Source source, const char* data, size_t len);
+
+        nlohmann::json stats_json() const;
+
+    private:
+        struct Counters {
+            std::atomic<uint64_t> frames{0};
+            std::atomic<uint64_t> bytes{0};
+            std::atomic<uint64_t> invalid_utf8{0};
+            std::atomic<uint64_t> invalid_structure{0};
+            std::atomic<uint64_t> ns_total{0};
+        };
+
+        std::atomic<bool> enabled_{true};
+        Counters          counters_[SOURCE_COUNT];
+    };
+
+}  // namespace FrameValidator
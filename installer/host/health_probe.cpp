@@ -0,0 +1,276 @@
+#include "health_probe.h"
+#include "platform_utils.h"
+#include "synapse_logger.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+#ifdef _WIN32
+    #include <io.h>
+#else
+    #include <fcntl.h>
+    #include <netinet/tcp.h>
+#endif
+
+namespace HealthProbe {
+
+namespace {
+
+const int    PONG_TIMEOUT_MS = 1000;
+const int    BURST_FRAMES    = 16;
+const size_t MAX_BURST_BYTES = 512 * 1024;   // Brain corta frames > 1MB
+const char*  PROBE_TARGET    = "__health_probe__";
+
+using Clock = std::chrono::steady_clock;
+
+double elapsed_ms(Clock::time_point since) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - since).count();
+}
+
+Percentiles percentiles(std::vector<double> v) {
+    Percentiles p;
+    if (v.empty()) return p;
+    std::sort(v.begin(), v.end());
+    auto at = [&](double q) { return v[std::min(v.size() - 1, static_cast<size_t>(q * v.size()))]; };
+    p.p50 = at(0.50);
+    p.p99 = at(0.99);
+    p.max = v.back();
+    return p;
+}
+
+void set_recv_timeout(socket_t sock, int ms) {
+#ifdef _WIN32
+    DWORD tv = static_cast<DWORD>(ms);
+#else
+    struct timeval tv;
+    tv.tv_sec  = ms / 1000;
+    tv.tv_usec = (ms % 1000) * 1000;
+#endif
+    setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, reinterpret_cast<const char*>(&tv), sizeof(tv));
+}
+
+bool send_frame(socket_t sock, const std::string& payload) {
+    std::string frame(4 + payload.size(), '\0');
+    uint32_t net_len = htonl(static_cast<uint32_t>(payload.size()));
+    std::memcpy(&frame[0], &net_len, 4);
+    std::memcpy(&frame[4], payload.data(), payload.size());
+
+    size_t sent = 0;
+    while (sent < frame.size()) {
+        int n = send(sock, frame.data() + sent, static_cast<int>(frame.size() - sent), 0);
+        if (n <= 0) return false;
+        sent += static_cast<size_t>(n);
+    }
+    return true;
+}
+
+bool recv_exact(socket_t sock, char* buf, size_t len) {
+    size_t got = 0;
+    while (got < len) {
+        int n = recv(sock, buf + got, static_cast<int>(len - got), 0);
+        if (n <= 0) return false;
+        got += static_cast<size_t>(n);
+    }
+    return true;
+}
+
+bool recv_frame(socket_t sock, std::string& out) {
+    uint32_t net_len = 0;
+    if (!recv_exact(sock, reinterpret_cast<char*>(&net_len), 4)) return false;
+    uint32_t len = ntohl(net_len);
+    if (len > 1024 * 1024) return false;
+    out.resize(len);
+    return len == 0 || recv_exact(sock, &out[0], len);
+}
+
+/** Espera el PONG con ese seq, descartando cualquier otro frame. */
+bool wait_pong(socket_t sock, int seq) {
+    std::string frame;
+    while (recv_frame(sock, frame)) {
+        nlohmann::json msg = nlohmann::json::parse(frame, nullptr, false);
+        if (msg.is_object() && msg.value("type", "") == "PONG" && msg.value("seq", -1) == seq) return true;
+    }
+    return false;
+}
+
+std::string ping_payload(int seq, size_t pad) {
+    nlohmann::json ping;
+    ping["type"] = "PING";
+    ping["seq"] = seq;
+    ping["target_profile"] = PROBE_TARGET;
+    if (pad > 0) ping["pad"] = std::string(pad, 'x');
+    return ping.dump();
+}
+
+}  // namespace
+
+// ============================================================================
+// BRAIN
+// ============================================================================
+
+BrainResult probe_brain(int port, int pings, size_t burst_bytes) {
+    BrainResult r;
+    if (!PlatformUtils::initialize_networking()) {
+        r.error = "networking init failed";
+        return r;
+    }
+
+    socket_t sock = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    if (sock == INVALID_SOCK) {
+        r.error = "socket() failed";
+        PlatformUtils::cleanup_networking();
+        return r;
+    }
+
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(static_cast<uint16_t>(port));
+    inet_pton(AF_INET, "127.0.0.1", &addr.sin_addr);
+
+    auto t0 = Clock::now();
+    if (connect(sock, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+        r.error = "connection refused on 127.0.0.1:" + std::to_string(port);
+        close_socket(sock);
+        PlatformUtils::cleanup_networking();
+        return r;
+    }
+    r.connect_ms = elapsed_ms(t0);
+    r.connected = true;
+
+    int one = 1;
+    setsockopt(sock, IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<const char*>(&one), sizeof(one));
+    set_recv_timeout(sock, PONG_TIMEOUT_MS);
+
+    // RTT: PINGs secuenciales
+    std::vector<double> rtts;
+    int seq = 0;
+    for (int i = 0; i < pings; ++i, ++seq) {
+        auto sent_at = Clock::now();
+        if (!send_frame(sock, ping_payload(seq, 0))) {
+            r.error = "send failed";
+            break;
+        }
+        r.pings_sent++;
+        if (!wait_pong(sock, seq)) {
+            r.error = "no PONG within " + std::to_string(PONG_TIMEOUT_MS) + "ms (Brain without PING support?)";
+            break;
+        }
+        r.pongs++;
+        rtts.push_back(elapsed_ms(sent_at));
+    }
+    r.rtt_ms = percentiles(rtts);
+
+    // Throughput: ráfaga de PINGs con relleno, todos en vuelo
+    burst_bytes = std::min(burst_bytes, MAX_BURST_BYTES);
+    if (r.error.empty() && burst_bytes > 0) {
+        int first = seq;
+        auto burst_start = Clock::now();
+        size_t bytes = 0;
+        bool ok = true;
+        for (int i = 0; i < BURST_FRAMES && ok; ++i, ++seq) {
+            std::string payload = ping_payload(seq, burst_bytes);
+            bytes += 4 + payload.size();
+            ok = send_frame(sock, payload);
+        }
+        for (int s = first; s < seq && ok; ++s) ok = wait_pong(sock, s);
+
+        if (ok) {
+            r.burst_bytes = bytes;
+            double secs = elapsed_ms(burst_start) / 1000.0;
+            r.burst_mb_s = secs > 0 ? (bytes / (1024.0 * 1024.0)) / secs : 0;
+        } else {
+            r.error = "burst did not complete";
+        }
+    }
+
+    close_socket(sock);
+    PlatformUtils::cleanup_networking();
+    return r;
+}
+
+// ============================================================================
+// DISCO
+// ============================================================================
+
+DiskResult probe_disk(const std::string& dir, int writes) {
+    DiskResult r;
+#ifdef _WIN32
+    r.path = dir + "\\.health_probe_" + std::to_string(PlatformUtils::get_current_pid()) + ".log";
+#else
+    r.path = dir + "/.health_probe_" + std::to_string(PlatformUtils::get_current_pid()) + ".log";
+#endif
+
+    std::vector<double> samples;
+    {
+        std::ofstream out(r.path, std::ios::app);
+        if (!out.is_open()) {
+            r.error = "cannot open " + r.path;
+            return r;
+        }
+        std::string line = SynapseLogManager::format_line(SynapseLogManager::get_timestamp_ms(), "INFO", "HOST",
+                                                          "HEALTH_PROBE " + std::string(120, 'x'));
+        for (int i = 0; i < writes; ++i) {
+            auto t0 = Clock::now();
+            out << line << "\n";
+            out.flush();
+            samples.push_back(elapsed_ms(t0) * 1000.0);
+        }
+        r.writes = samples.size();
+        r.ok = out.good();
+        if (!r.ok) r.error = "write failed";
+    }
+
+    // fsync aparte: log_native no lo hace, pero indica cuánto cuesta llegar al disco real
+    r.fsync_ms = -1;
+#ifdef _WIN32
+    FILE* f = std::fopen(r.path.c_str(), "ab");
+    if (f) {
+        auto t0 = Clock::now();
+        if (_commit(_fileno(f)) == 0) r.fsync_ms = elapsed_ms(t0);
+        std::fclose(f);
+    }
+#else
+    int fd = open(r.path.c_str(), O_WRONLY | O_APPEND);
+    if (fd >= 0) {
+        auto t0 = Clock::now();
+        if (fsync(fd) == 0) r.fsync_ms = elapsed_ms(t0);
+        close(fd);
+    }
+#endif
+
+    std::remove(r.path.c_str());
+    r.write_us = percentiles(samples);
+    return r;
+}
+
+// ============================================================================
+// TELEMETRY
+// ============================================================================
+
+TelemetryResult probe_telemetry(const std::string& telemetry_path, const std::string& launch_id) {
+    TelemetryResult r;
+    r.path = telemetry_path;
+
+    auto t0 = Clock::now();
+    std::ifstream tf(telemetry_path, std::ios::binary);
+    if (!tf.is_open()) return r;
+    std::string content((std::istreambuf_iterator<char>(tf)), std::istreambuf_iterator<char>());
+    r.read_ms = elapsed_ms(t0);
+    r.file_found = true;
+    r.bytes = content.size();
+
+    if (!launch_id.empty()) {
+        auto t1 = Clock::now();
+        r.host_log_path = SynapseLogManager::find_telemetry_stream_path(content, "host_" + launch_id);
+        r.lookup_us = elapsed_ms(t1) * 1000.0;
+        r.key_found = !r.host_log_path.empty();
+    }
+    return r;
+}
+
+}  // namespace HealthProbe
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/**
+ * @brief Sondas activas de `--health`: Brain, disco de logs y telemetry.json
+ *
+ * Permiten diagnosticar entornos lentos antes de que Chrome lance el host:
+ *
+ *   probe_brain      connect + PING/PONG sin REGISTER_HOST (RTT) + ráfaga de
+ *                    PINGs con relleno (throughput de framing BE)
+ *   probe_disk       latencia de escritura + flush por línea, como log_native,
+ *                    sobre un archivo temporal en el directorio de logs
+ *   probe_telemetry  lectura de telemetry.json + búsqueda de host_{launch_id}
+ *
+ * Brain responde PONG a PING de conexiones no registradas. Los PING llevan
+ * target_profile "__health_probe__" para que un Brain sin handler de PING no
+ * los haga broadcast a los hosts conectados (solo loguea "Target offline").
+ */
+namespace HealthProbe {
+
+    struct Percentiles {
+        double p50 = 0;
+        double p99 = 0;
+        double max = 0;
+    };
+
+    struct BrainResult {
+        bool        connected   = false;
+        std::string error;
+        double      connect_ms  = 0;
+        size_t      pings_sent  = 0;
+        size_t      pongs       = 0;
+        Percentiles rtt_ms;
+        size_t      burst_bytes = 0;   // bytes enviados en la ráfaga de throughput
+        double      burst_mb_s  = 0;
+    };
+
+    struct DiskResult {
+        bool        ok       = false;
+        std::string path;
+        std::string error;
+        size_t      writes   = 0;
+        Percentiles write_us;          // << línea + flush()
+        double      fsync_ms = 0;      // -1 si la plataforma no lo soporta
+    };
+
+    struct TelemetryResult {
+        bool        file_found = false;
+        bool        key_found  = false;
+        std::string path;
+        std::string host_log_path;
+        size_t      bytes      = 0;
+        double      read_ms    = 0;
+        double      lookup_us  = 0;
+    };
+
+    /**
+     * @brief Conecta a 127.0.0.1:port y mide PING/PONG
+     * @param pings       RTTs a medir (secuenciales)
+     * @param burst_bytes relleno por PING en la ráfaga de throughput (0 = sin ráfaga)
+     */
+    BrainResult probe_brain(int port, int pings, size_t burst_bytes);
+
+    /** Escribe `writes` líneas de log con flush en un archivo temporal de `dir` y lo borra. */
+    DiskResult probe_disk(const std::string& dir, int writes);
+
+    /** Lee telemetry.json y busca host_{launch_id} (si launch_id no está vacío). */
+    TelemetryResult probe_telemetry(const std::string& telemetry_path, const std::string& launch_id);
+
+}  // namespace HealthProbe
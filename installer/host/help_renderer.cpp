@@ -66,9 +66,77 @@ std::vector<CategoryDescriptor> HelpRenderer::build_command_registry() {
             CommandDescriptor cmd;
             cmd.name        = "--health";
             cmd.short_flag  = "";
-            cmd.description = "Run health checks: platform, STDIO, network stack";
-            cmd.usage       = "bloom-host --health";
+            cmd.description = "Run health checks: platform, STDIO, network stack, log disk latency, "
+                              "telemetry.json lookup and (optional) Brain PING/PONG probe";
+            cmd.usage       = "bloom-host --health [--probe-brain] [--json]";
             cmd.category    = "SYSTEM";
+            CommandDescriptor::Option probe_opt;
+            probe_opt.flag        = "--probe-brain";
+            probe_opt.description = "Connect to Brain and measure connect time, PING/PONG RTT and framing throughput";
+            cmd.options.push_back(probe_opt);
+            CommandDescriptor::Option pings_opt;
+            pings_opt.flag        = "--pings";
+            pings_opt.description = "PING/PONG round trips for --probe-brain (default 20)";
+            cmd.options.push_back(pings_opt);
+            CommandDescriptor::Option port_opt;
+            port_opt.flag        = "--service-port";
+            port_opt.description = "Brain TCP port to probe (default 5678)";
+            cmd.options.push_back(port_opt);
+            CommandDescriptor::Option base_opt;
+            base_opt.flag        = "--user-base-dir";
+            base_opt.description = "BloomNucleus base dir for the log disk and telemetry.json checks";
+            cmd.options.push_back(base_opt);
+            CommandDescriptor::Option lid_opt;
+            lid_opt.flag        = "--launch-id";
+            lid_opt.description = "Look up host_{launch_id} in telemetry.json";
+            cmd.options.push_back(lid_opt);
+            CommandDescriptor::Option json_opt;
+            json_opt.flag        = "--json";
+            json_opt.description = "Output as JSON (machine-readable)";
+            cmd.options.push_back(json_opt);
+            cat.commands.push_back(cmd);
+        }
+
+        // --bench
+        {
+            CommandDescriptor cmd;
+            cmd.name        = "--bench";
+            cmd.short_flag  = "";
+            cmd.description = "Run in-process micro-benchmarks: framing, chunk reassembly, JSON routing, logger";
+            cmd.usage       = "bloom-host --bench [--json]";
+            cmd.category    = "SYSTEM";
+            CommandDescriptor::Option json_opt;
+            json_opt.flag        = "--json";
+            json_opt.description = "Output as JSON (machine-readable)";
+            cmd.options.push_back(json_opt);
+            cat.commands.push_back(cmd);
+        }
+
+        // --analyze-log
+        {
+            CommandDescriptor cmd;
+            cmd.name        = "--analyze-log";
+            cmd.short_flag  = "";
+            cmd.description = "Analyze host/cortex logs offline: msg/s and bytes/s per minute, message sizes, "
+                              "chunk assembly times, traffic gaps and Brain reconnect windows";
+            cmd.usage       = "bloom-host --analyze-log <dir> [--analyze-log <dir>...] [--gap-sec N] [--json]";
+            cmd.category    = "SYSTEM";
+            CommandDescriptor::Option dir_opt;
+            dir_opt.flag        = "<dir>";
+            dir_opt.description = "logs/host/profiles/, a profile dir or a launch dir (searched recursively)";
+            cmd.options.push_back(dir_opt);
+            CommandDescriptor::Option gap_opt;
+            gap_opt.flag        = "--gap-sec";
+            gap_opt.description = "Minimum silence between CHROME_MSG/BRAIN_MSG lines reported as a gap (default 60)";
+            cmd.options.push_back(gap_opt);
+            CommandDescriptor::Option threads_opt;
+            threads_opt.flag        = "--threads";
+            threads_opt.description = "Parser threads (default: hardware concurrency)";
+            cmd.options.push_back(threads_opt);
+            CommandDescriptor::Option json_opt;
+            json_opt.flag        = "--json";
+            json_opt.description = "Output as JSON, including every per-minute row";
+            cmd.options.push_back(json_opt);
             cat.commands.push_back(cmd);
         }
 
@@ -155,6 +223,76 @@ std::vector<CategoryDescriptor> HelpRenderer::build_command_registry() {
             lid_opt.description = "Launch identifier passed by Chrome via NM manifest args";
             cmd.options.push_back(lid_opt);
 
+            CommandDescriptor::Option port_opt;
+            port_opt.flag        = "--service-port";
+            port_opt.description = "Brain TCP port (default 5678). Used by bloom-host-bench with a mock Brain";
+            cmd.options.push_back(port_opt);
+
+            CommandDescriptor::Option dead_opt;
+            dead_opt.flag        = "--brain-dead-ms";
+            dead_opt.description = "Declare Brain dead after this many ms without traffic (PING probes "
+                                   "after a third of it) and reconnect at once. 0 disables (default 10000)";
+            cmd.options.push_back(dead_opt);
+
+            CommandDescriptor::Option request_opt;
+            request_opt.flag        = "--request-timeout-ms";
+            request_opt.description = "Send REQUEST_TIMEOUT to Brain when the extension does not answer a "
+                                      "command with an id within this many ms. 0 disables (default 30000)";
+            cmd.options.push_back(request_opt);
+
+            CommandDescriptor::Option limits_opt;
+            limits_opt.flag        = "--rate-limits";
+            limits_opt.description = "Chrome->Brain admission limits: comma list of key=rate[/burst] with key = "
+                                     "a command/type/event, @normal, @low or @total; 'on' uses the built-in "
+                                     "limits, 'off' disables (default)";
+            cmd.options.push_back(limits_opt);
+
+            CommandDescriptor::Option dedup_opt;
+            dedup_opt.flag        = "--dedup";
+            dedup_opt.description = "Drop identical messages (ignoring timestamp) seen again within a window, "
+                                    "both links: comma list of kind=ms, '*' for other non-control kinds; "
+                                    "'off' disables (default)";
+            cmd.options.push_back(dedup_opt);
+
+            CommandDescriptor::Option delta_opt;
+            delta_opt.flag        = "--delta";
+            delta_opt.description = "Send state messages to Brain as patches against the last copy per key: "
+                                    "comma list of kind[:key_field]. Active only if Brain accepts it in "
+                                    "REGISTER_ACK; 'off' disables (default)";
+            cmd.options.push_back(delta_opt);
+
+            CommandDescriptor::Option splice_opt;
+            splice_opt.flag        = "--splice";
+            splice_opt.description = "Linux: forward Chrome->Brain frames of at least this many bytes from stdin "
+                                     "to the Brain socket with splice(2) when no stage needs the body; "
+                                     "requires --validate-frames off. "
+                                     "'on' uses 262144, 'off' or 0 disables (default)";
+            cmd.options.push_back(splice_opt);
+
+            CommandDescriptor::Option validate_opt;
+            validate_opt.flag        = "--validate-frames";
+            validate_opt.description = "Reject raw frames from Chrome, Brain and reassembled uploads with invalid "
+                                       "UTF-8 or unbalanced JSON brackets before parsing or forwarding them "
+                                       "(SIMD). 'on' (default) or 'off'";
+            cmd.options.push_back(validate_opt);
+
+            CommandDescriptor::Option alloc_opt;
+            alloc_opt.flag        = "--alloc-track";
+            alloc_opt.description = "Count heap allocations per pipeline stage and message type "
+                                    "(also BLOOM_HOST_ALLOC_TRACK=1). Reported in HEARTBEAT stats";
+            cmd.options.push_back(alloc_opt);
+
+            CommandDescriptor::Option capture_opt;
+            capture_opt.flag        = "--capture";
+            capture_opt.description = "Record every framed message (both directions, monotonic "
+                                      "timestamps) to capture_{launch_id}.bcap in the launch log dir";
+            cmd.options.push_back(capture_opt);
+
+            CommandDescriptor::Option redact_opt;
+            redact_opt.flag        = "--capture-redact";
+            redact_opt.description = "Like --capture, but store only sizes and command/type/event/id metadata";
+            cmd.options.push_back(redact_opt);
+
             cat.commands.push_back(cmd);
         }
 
@@ -282,6 +420,10 @@ void HelpRenderer::print_usage() {
             + Colors::dim("                   # System information", use_colors));
     writeln("    " + Colors::apply(Colors::GREEN, "bloom-host --health", use_colors)
             + Colors::dim("                 # Run health checks", use_colors));
+    writeln("    " + Colors::apply(Colors::GREEN, "bloom-host --bench --json", use_colors)
+            + Colors::dim("           # Self benchmark, JSON output", use_colors));
+    writeln("    " + Colors::apply(Colors::GREEN, "bloom-host --analyze-log logs/host/profiles", use_colors)
+            + Colors::dim("  # Offline log analysis", use_colors));
     writeln("    " + Colors::apply(Colors::GREEN, "bloom-host --init --profile-id <id> --launch-id <id>", use_colors)
             + Colors::dim("         # Pre-init (Sentinel)", use_colors));
     writeln("    " + Colors::apply(Colors::GREEN, "bloom-host --init --json --profile-id <id> --launch-id <id>", use_colors)
@@ -0,0 +1,197 @@
+#include "link_liveness.h"
+
+#include <algorithm>
+#include <chrono>
+
+namespace Liveness {
+
+namespace {
+
+const char* PROBE_SEQ_PREFIX = "liveness-";
+const int   MIN_TICK_MS = 50;
+const int   MAX_TICK_MS = 1000;
+
+uint64_t now_ns() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+int64_t ns_to_ms(uint64_t ns) {
+    return static_cast<int64_t>(ns / 1000000);
+}
+
+}  // namespace
+
+// ============================================================================
+// PEER MONITOR
+// ============================================================================
+
+PeerMonitor::PeerMonitor(int dead_ms) : dead_ms_(std::max(0, dead_ms)) {
+    last_activity_ns_.store(now_ns());
+}
+
+int PeerMonitor::tick_ms() const {
+    // D + tick es la peor latencia de detección; más de ~6 ticks por bound
+    // no mejora nada y despierta al thread TCP en vano
+    return std::clamp(dead_ms_ / 6, MIN_TICK_MS, MAX_TICK_MS);
+}
+
+void PeerMonitor::on_connected() {
+    on_activity();
+    std::lock_guard<std::mutex> lock(mutex_);
+    last_probe_ns_ = 0;
+    probe_sent_ns_ = 0;
+}
+
+void PeerMonitor::on_activity() {
+    last_activity_ns_.store(now_ns(), std::memory_order_relaxed);
+}
+
+PeerMonitor::Verdict PeerMonitor::on_timeout() {
+    if (!enabled()) return ALIVE;
+
+    uint64_t now = now_ns();
+    uint64_t idle = now - std::min(now, last_activity_ns_.load(std::memory_order_relaxed));
+    uint64_t dead_ns = static_cast<uint64_t>(dead_ms_) * 1000000;
+    if (idle >= dead_ns) return DEAD;
+
+    // Un probe por cada D/3 de silencio: el PONG (o cualquier otro frame)
+    // reinicia la cuenta, así que un link sano y ocioso cuesta un PING cada D/3
+    uint64_t probe_after_ns = dead_ns / 3;
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (idle >= probe_after_ns && now - last_probe_ns_ >= probe_after_ns) return PROBE;
+    return ALIVE;
+}
+
+std::string PeerMonitor::probe_frame() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    uint64_t now = now_ns();
+    last_probe_ns_ = now;
+    probe_sent_ns_ = now;
+    probes_sent_++;
+    nlohmann::json ping = {{"type", "PING"}, {"seq", PROBE_SEQ_PREFIX + std::to_string(++probe_seq_)}};
+    return ping.dump();
+}
+
+bool PeerMonitor::is_probe_reply(const nlohmann::json& msg) {
+    auto seq = msg.find("seq");
+    return seq != msg.end() && seq->is_string() &&
+           seq->get_ref<const std::string&>().rfind(PROBE_SEQ_PREFIX, 0) == 0;
+}
+
+void PeerMonitor::on_probe_reply(const nlohmann::json& msg) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (probe_sent_ns_ == 0) return;
+    if (msg.value("seq", std::string()) != PROBE_SEQ_PREFIX + std::to_string(probe_seq_)) return;
+
+    uint64_t rtt_us = (now_ns() - probe_sent_ns_) / 1000;
+    probe_sent_ns_ = 0;
+    probe_replies_++;
+    last_probe_rtt_us_ = rtt_us;
+    max_probe_rtt_us_ = std::max(max_probe_rtt_us_, rtt_us);
+}
+
+int64_t PeerMonitor::on_dead() {
+    uint64_t now = now_ns();
+    int64_t idle_ms = ns_to_ms(now - std::min(now, last_activity_ns_.load()));
+    std::lock_guard<std::mutex> lock(mutex_);
+    dead_events_++;
+    // Si ya había un failover abierto (Brain aceptó el connect pero nunca
+    // respondió), se mide desde la primera detección
+    if (dead_at_ns_ == 0) {
+        dead_at_ns_ = now;
+        pending_detect_ms_ = idle_ms;
+    }
+    probe_sent_ns_ = 0;
+    return idle_ms;
+}
+
+bool PeerMonitor::on_registered(int64_t& detect_ms, int64_t& reconnect_ms, int64_t& total_ms) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (dead_at_ns_ == 0) return false;
+
+    detect_ms = pending_detect_ms_;
+    reconnect_ms = ns_to_ms(now_ns() - dead_at_ns_);
+    total_ms = detect_ms + reconnect_ms;
+    dead_at_ns_ = 0;
+
+    failovers_++;
+    last_detect_ms_ = detect_ms;
+    last_reconnect_ms_ = reconnect_ms;
+    last_total_ms_ = total_ms;
+    max_total_ms_ = std::max(max_total_ms_, total_ms);
+    return true;
+}
+
+nlohmann::json PeerMonitor::stats_json() const {
+    uint64_t now = now_ns();
+    int64_t idle_ms = ns_to_ms(now - std::min(now, last_activity_ns_.load()));
+    std::lock_guard<std::mutex> lock(mutex_);
+    return {
+        {"dead_ms",            dead_ms_},
+        {"last_rx_age_ms",     idle_ms},
+        {"probes_sent",        probes_sent_},
+        {"probe_replies",      probe_replies_},
+        {"last_probe_rtt_us",  last_probe_rtt_us_},
+        {"max_probe_rtt_us",   max_probe_rtt_us_},
+        {"dead_peer_events",   dead_events_},
+        {"failovers",          failovers_},
+        {"last_failover_ms",   {
+            {"detect",    last_detect_ms_},
+            {"reconnect", last_reconnect_ms_},
+            {"total",     last_total_ms_}
+        }},
+        {"max_failover_ms",    max_total_ms_}
+    };
+}
+
+// ============================================================================
+// RECV CON TIMEOUT
+// ============================================================================
+
+RecvStatus recv_exact(socket_t sock, char* buf, size_t len, PeerMonitor& monitor,
+                      const std::function<void()>& send_probe,
+                      const std::atomic<bool>& stop) {
+    size_t got = 0;
+    while (got < len) {
+#ifdef _WIN32
+        // Sin SO_RCVTIMEO: después de que vence Winsock no garantiza el estado
+        // del socket. Se espera con select() y recv() solo corre con algo listo
+        // (sin MSG_WAITALL, que además descarta lo parcial)
+        int ready = monitor.enabled() ? PlatformUtils::wait_readable(sock, monitor.tick_ms()) : 1;
+        if (ready < 0) return RECV_FAILED;
+        int n = ready > 0 ? recv(sock, buf + got, static_cast<int>(len - got), 0) : -1;
+        const bool timed_out = ready == 0;
+#else
+        int n = recv(sock, buf + got, static_cast<int>(len - got), MSG_WAITALL);
+        const bool timed_out = n < 0 && PlatformUtils::last_recv_timed_out();
+#endif
+        if (n > 0) {
+            got += static_cast<size_t>(n);
+            monitor.on_activity();
+            continue;
+        }
+        if (n == 0) return RECV_CLOSED;
+        if (!timed_out) return RECV_FAILED;
+        if (stop.load()) return RECV_STOPPED;
+
+        switch (monitor.on_timeout()) {
+            case PeerMonitor::DEAD:  return RECV_DEAD;
+            case PeerMonitor::PROBE: send_probe(); break;
+            default: break;
+        }
+    }
+    return RECV_OK;
+}
+
+const char* recv_status_name(RecvStatus status) {
+    switch (status) {
+        case RECV_OK:      return "ok";
+        case RECV_CLOSED:  return "closed";
+        case RECV_DEAD:    return "dead_peer";
+        case RECV_STOPPED: return "shutdown";
+        default:           return "error";
+    }
+}
+
+}  // namespace Liveness
@@ -0,0 +1,117 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <nlohmann/json.hpp>
+
+#include "platform_utils.h"
+
+/**
+ * @brief Detección de Brain colgado en el link TCP
+ *
+ * Si Brain se cuelga sin cerrar el socket, recv() bloquea para siempre y los
+ * send() siguen entrando al buffer del kernel: el host nunca se entera. Con un
+ * bound D (--brain-dead-ms):
+ *
+ *   - el socket tiene SO_RCVTIMEO = tick_ms() (en Windows, select() con
+ *     tick_ms() antes de cada recv()) y keepalive TCP con intervalos
+ *     cortos (útil si el peer deja de existir; en loopback lo habitual es que
+ *     el proceso siga vivo y solo la aplicación esté trabada);
+ *   - cada byte recibido (y cada mensaje terminado de procesar) marca
+ *     actividad;
+ *   - tras D/3 de silencio se manda un PING con seq "liveness-N" (Brain lo
+ *     responde con PONG sin rutear, igual que al probe de --health);
+ *   - tras D de silencio el peer se declara muerto: se cierra el socket y se
+ *     reconecta sin backoff.
+ *
+ * El tiempo de failover (silencio hasta declararlo + reconexión hasta
+ * REGISTER_ACK) queda en el log (BRAIN_FAILOVER) y en stats["brain_link"].
+ */
+namespace Liveness {
+
+    class PeerMonitor {
+    public:
+        enum Verdict { ALIVE, PROBE, DEAD };
+
+        /** dead_ms = 0 desactiva la detección (recv bloqueante como antes). */
+        explicit PeerMonitor(int dead_ms);
+
+        /** Override de --brain-dead-ms. Solo antes de lanzar el thread TCP. */
+        void set_dead_ms(int dead_ms) { dead_ms_ = dead_ms > 0 ? dead_ms : 0; }
+
+        bool enabled() const { return dead_ms_ > 0; }
+        int  dead_ms() const { return dead_ms_; }
+
+        /** Timeout de recv(): granularidad con la que se revisa el silencio. */
+        int tick_ms() const;
+
+        /** Socket nuevo: el silencio se cuenta desde ahora. */
+        void on_connected();
+
+        /** Llegaron bytes o se terminó de procesar un mensaje. */
+        void on_activity();
+
+        /** recv() expiró sin datos. PROBE: enviar probe_frame() ahora. */
+        Verdict on_timeout();
+
+        /** PING de liveness serializado (registra seq y hora de envío). */
+        std::string probe_frame();
+
+        /** PONG de Brain a uno de nuestros probes (no es para Chrome). */
+        static bool is_probe_reply(const nlohmann::json& msg);
+        void on_probe_reply(const nlohmann::json& msg);
+
+        /** Peer declarado muerto. @return silencio observado en ms */
+        int64_t on_dead();
+
+        /**
+         * @brief REGISTER_ACK tras reconectar
+         * @return true si cierra un failover (detect/reconnect/total en ms)
+         */
+        bool on_registered(int64_t& detect_ms, int64_t& reconnect_ms, int64_t& total_ms);
+
+        nlohmann::json stats_json() const;
+
+    private:
+        int                    dead_ms_;
+        std::atomic<uint64_t>  last_activity_ns_{0};
+
+        mutable std::mutex     mutex_;
+        uint64_t               last_probe_ns_      = 0;
+        uint64_t               probe_seq_          = 0;
+        uint64_t               probe_sent_ns_      = 0;   // != 0 mientras el probe espera PONG
+        uint64_t               probes_sent_        = 0;
+        uint64_t               probe_replies_      = 0;
+        uint64_t               last_probe_rtt_us_  = 0;
+        uint64_t               max_probe_rtt_us_   = 0;
+        uint64_t               dead_events_        = 0;
+        uint64_t               dead_at_ns_         = 0;   // != 0 hasta el próximo REGISTER_ACK
+        int64_t                pending_detect_ms_  = 0;
+        uint64_t               failovers_          = 0;
+        int64_t                last_detect_ms_     = -1;
+        int64_t                last_reconnect_ms_  = -1;
+        int64_t                last_total_ms_      = -1;
+        int64_t                max_total_ms_       = -1;
+    };
+
+    enum RecvStatus { RECV_OK, RECV_CLOSED, RECV_FAILED, RECV_DEAD, RECV_STOPPED };
+
+    /**
+     * @brief Lee exactamente len bytes, revisando el silencio en cada timeout
+     *
+     * Con SO_RCVTIMEO, recv(MSG_WAITALL) puede volver con un frame a medias:
+     * lo parcial se acumula y se sigue leyendo. En Windows la espera es
+     * PlatformUtils::wait_readable(). send_probe se invoca cuando el monitor
+     * pide un PING.
+     */
+    RecvStatus recv_exact(socket_t sock, char* buf, size_t len, PeerMonitor& monitor,
+                          const std::function<void()>& send_probe,
+                          const std::atomic<bool>& stop);
+
+    const char* recv_status_name(RecvStatus status);
+
+}  // namespace Liveness
@@ -0,0 +1,785 @@
+#include "log_analyzer.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <filesystem>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <nlohmann/json.hpp>
+#include <thread>
+
+#ifdef _WIN32
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+namespace fs = std::filesystem;
+
+namespace LogAnalyzer {
+
+namespace {
+
+const size_t RANGE_BYTES     = 8 * 1024 * 1024;   // rango mínimo por tarea
+const size_t MAX_MINUTE_ROWS = 60;                // tabla de texto; --json las lista todas
+const size_t MAX_EVENT_ROWS  = 20;                // gaps / reconexiones en texto
+
+enum Direction { CHROME_IN = 0, CHROME_OUT, BRAIN_IN, DIR_COUNT };
+const char* DIR_NAMES[DIR_COUNT] = {"chrome_in", "chrome_out", "brain_in"};
+
+enum EventKind : uint8_t { EV_CHUNK_START, EV_CHUNK_DONE, EV_CHUNK_BAD, EV_TCP_UP, EV_TCP_DOWN };
+
+struct Event {
+    int64_t  ts;
+    uint32_t value;
+    uint8_t  kind;
+};
+
+struct Minute {
+    uint64_t msgs[DIR_COUNT]  = {};
+    uint64_t bytes[DIR_COUNT] = {};
+    uint64_t c2b = 0;
+    uint64_t b2c = 0;
+};
+
+struct Window {
+    size_t  launch;
+    int64_t start;
+    int64_t end;   // -1: sin cierre antes del fin del log
+};
+
+// ============================================================================
+// ARCHIVOS MAPEADOS
+// ============================================================================
+
+class MappedFile {
+public:
+    MappedFile() = default;
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    ~MappedFile() { unmap(); }
+
+    bool map(const std::string& path) {
+#ifdef _WIN32
+        file_ = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr,
+                            OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file_ == INVALID_HANDLE_VALUE) return false;
+        LARGE_INTEGER sz;
+        if (!GetFileSizeEx(file_, &sz) || sz.QuadPart == 0) return false;
+        mapping_ = CreateFileMappingA(file_, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (!mapping_) return false;
+        data_ = static_cast<const char*>(MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0));
+        if (!data_) return false;
+        size_ = static_cast<size_t>(sz.QuadPart);
+#else
+        int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0) return false;
+        struct stat st;
+        if (fstat(fd, &st) != 0 || st.st_size == 0) {
+            close(fd);
+            return false;
+        }
+        void* p = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if (p == MAP_FAILED) return false;
+        madvise(p, static_cast<size_t>(st.st_size), MADV_SEQUENTIAL);
+        data_ = static_cast<const char*>(p);
+        size_ = static_cast<size_t>(st.st_size);
+#endif
+        return true;
+    }
+
+    const char* data() const { return data_; }
+    size_t size() const { return size_; }
+
+private:
+    void unmap() {
+#ifdef _WIN32
+        if (data_) UnmapViewOfFile(data_);
+        if (mapping_) CloseHandle(mapping_);
+        if (file_ != INVALID_HANDLE_VALUE) CloseHandle(file_);
+#else
+        if (data_) munmap(const_cast<char*>(data_), size_);
+#endif
+        data_ = nullptr;
+    }
+
+#ifdef _WIN32
+    HANDLE file_    = INVALID_HANDLE_VALUE;
+    HANDLE mapping_ = nullptr;
+#endif
+    const char* data_ = nullptr;
+    size_t      size_ = 0;
+};
+
+// ============================================================================
+// TIMESTAMPS
+// ============================================================================
+
+// Días desde 1970-01-01 (algoritmo civil de Howard Hinnant)
+int64_t days_from_civil(int64_t y, unsigned m, unsigned d) {
+    y -= m <= 2;
+    const int64_t era = (y >= 0 ? y : y - 399) / 400;
+    const unsigned yoe = static_cast<unsigned>(y - era * 400);
+    const unsigned doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+    const unsigned doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + static_cast<int64_t>(doe) - 719468;
+}
+
+void civil_from_days(int64_t z, int& y, unsigned& m, unsigned& d) {
+    z += 719468;
+    const int64_t era = (z >= 0 ? z : z - 146096) / 146097;
+    const unsigned doe = static_cast<unsigned>(z - era * 146097);
+    const unsigned yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    const unsigned doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    const unsigned mp = (5 * doy + 2) / 153;
+    d = doy - (153 * mp + 2) / 5 + 1;
+    m = mp < 10 ? mp + 3 : mp - 9;
+    y = static_cast<int>(static_cast<int64_t>(yoe) + era * 400 + (m <= 2));
+}
+
+bool digits(const char* p, int n, int& out) {
+    int v = 0;
+    for (int i = 0; i < n; ++i) {
+        if (p[i] < '0' || p[i] > '9') return false;
+        v = v * 10 + (p[i] - '0');
+    }
+    out = v;
+    return true;
+}
+
+/** "YYYY-MM-DD HH:MM:SS.mmm" → ms desde epoch (el log no lleva zona; se trata como naive). */
+bool parse_ts(const char* p, int64_t& ms) {
+    int y, mo, d, h, mi, s, frac;
+    if (!digits(p, 4, y) || p[4] != '-' || !digits(p + 5, 2, mo) || p[7] != '-' ||
+        !digits(p + 8, 2, d) || p[10] != ' ' || !digits(p + 11, 2, h) || p[13] != ':' ||
+        !digits(p + 14, 2, mi) || p[16] != ':' || !digits(p + 17, 2, s) || p[19] != '.' ||
+        !digits(p + 20, 3, frac)) {
+        return false;
+    }
+    int64_t days = days_from_civil(y, static_cast<unsigned>(mo), static_cast<unsigned>(d));
+    ms = ((days * 24 + h) * 60 + mi) * 60000LL + s * 1000LL + frac;
+    return true;
+}
+
+std::string format_ts(int64_t ms, bool with_ms = true) {
+    if (ms < 0) return "-";
+    int64_t days = ms / 86400000;
+    int64_t rem  = ms % 86400000;
+    int y;
+    unsigned m, d;
+    civil_from_days(days, y, m, d);
+    char buf[48];
+    if (with_ms) {
+        std::snprintf(buf, sizeof(buf), "%04d-%02u-%02u %02d:%02d:%02d.%03d", y, m, d,
+                      static_cast<int>(rem / 3600000), static_cast<int>(rem / 60000 % 60),
+                      static_cast<int>(rem / 1000 % 60), static_cast<int>(rem % 1000));
+    } else {
+        std::snprintf(buf, sizeof(buf), "%04d-%02u-%02u %02d:%02d", y, m, d,
+                      static_cast<int>(rem / 3600000), static_cast<int>(rem / 60000 % 60));
+    }
+    return buf;
+}
+
+// ============================================================================
+// PARSEO POR RANGO
+// ============================================================================
+
+struct RangeResult {
+    uint64_t lines      = 0;
+    uint64_t parsed     = 0;
+    uint64_t unparsed   = 0;
+    uint64_t keepalives = 0;
+    uint64_t too_big    = 0;
+    uint64_t bad_chunks = 0;
+    std::map<int64_t, Minute> minutes;
+    std::vector<uint32_t> sizes[DIR_COUNT];
+    std::vector<Event> events;           // en orden de archivo
+    std::vector<Window> gaps;            // internos al rango
+    int64_t first_ts      = -1;
+    int64_t last_ts       = -1;
+    int64_t first_traffic = -1;          // tráfico del host (CHROME_MSG / BRAIN_MSG) para gaps
+    int64_t last_traffic  = -1;
+};
+
+struct Task {
+    size_t file;
+    size_t begin;
+    size_t end;
+};
+
+inline bool starts_with(const char* p, const char* end, const char* lit, size_t n) {
+    return static_cast<size_t>(end - p) >= n && std::memcmp(p, lit, n) == 0;
+}
+#define STARTS(p, end, lit) starts_with(p, end, lit, sizeof(lit) - 1)
+
+/** Valor numérico de `key` (p. ej. " size=") dentro de [p, end). */
+bool find_number(const char* p, const char* end, const char* key, size_t key_len, uint64_t& out) {
+    const char* hit = std::search(p, end, key, key + key_len);
+    if (hit == end) return false;
+    hit += key_len;
+    if (hit == end || *hit < '0' || *hit > '9') return false;
+    uint64_t v = 0;
+    while (hit < end && *hit >= '0' && *hit <= '9') v = v * 10 + static_cast<uint64_t>(*hit++ - '0');
+    out = v;
+    return true;
+}
+
+void count(RangeResult& r, Direction dir, int64_t ts, uint64_t size) {
+    Minute& m = r.minutes[ts / 60000];
+    m.msgs[dir]++;
+    m.bytes[dir] += size;
+    r.sizes[dir].push_back(static_cast<uint32_t>(std::min<uint64_t>(size, UINT32_MAX)));
+}
+
+void host_traffic(RangeResult& r, int64_t ts, int64_t gap_ms, size_t launch) {
+    if (r.first_traffic < 0) r.first_traffic = ts;
+    if (r.last_traffic >= 0 && ts - r.last_traffic >= gap_ms) r.gaps.push_back({launch, r.last_traffic, ts});
+    r.last_traffic = ts;
+}
+
+void parse_line(const char* line, const char* end, RangeResult& r, int64_t gap_ms, size_t launch) {
+    r.lines++;
+    if (line == end || *line != '[') {
+        if (line != end && !STARTS(line, end, "=====")) r.unparsed++;
+        return;
+    }
+
+    // [YYYY-MM-DD HH:MM:SS.mmm] [LEVEL] [SRC] MSG
+    int64_t ts;
+    if (end - line < 27 || !parse_ts(line + 1, ts) || line[24] != ']') {
+        r.unparsed++;
+        return;
+    }
+    const char* p = line + 26;
+    const char* level_end = std::find(p, end, ']');
+    if (level_end == end || end - level_end < 3) {
+        r.unparsed++;
+        return;
+    }
+    const char* src = level_end + 3;                  // "] [" → SRC
+    const char* src_end = std::find(src, end, ']');
+    if (src_end == end) {
+        r.unparsed++;
+        return;
+    }
+    const char* msg = std::min(src_end + 2, end);
+    bool host = (src_end - src == 4 && std::memcmp(src, "HOST", 4) == 0);
+
+    r.parsed++;
+    if (r.first_ts < 0) r.first_ts = ts;
+    r.last_ts = ts;
+
+    uint64_t size = 0;
+    if (host) {
+        if (STARTS(msg, end, "CHROME_MSG ")) {
+            find_number(msg, end, " size=", 6, size);
+            count(r, CHROME_IN, ts, size);
+            host_traffic(r, ts, gap_ms, launch);
+        } else if (STARTS(msg, end, "BRAIN_MSG ")) {
+            find_number(msg, end, " size=", 6, size);
+            count(r, BRAIN_IN, ts, size);
+            host_traffic(r, ts, gap_ms, launch);
+        } else if (STARTS(msg, end, "CHROME_TO_BRAIN")) {
+            r.minutes[ts / 60000].c2b++;
+        } else if (STARTS(msg, end, "BRAIN_TO_CHROME")) {
+            r.minutes[ts / 60000].b2c++;
+        } else if (STARTS(msg, end, "TCP_CONNECTED")) {
+            r.events.push_back({ts, 0, EV_TCP_UP});
+        } else if (STARTS(msg, end, "TCP_DISCONNECTED")) {
+            r.events.push_back({ts, 0, EV_TCP_DOWN});
+        } else if (STARTS(msg, end, "MSG_TOO_BIG")) {
+            r.too_big++;
+        }
+    } else {
+        if (STARTS(msg, end, "CHROME_OUT command=keepalive")) {
+            r.keepalives++;
+        } else if (STARTS(msg, end, "CHROME_OUT ")) {
+            // "CHROME_OUT command=host_ready version=..." es informativa, sin size=
+            if (find_number(msg, end, " size=", 6, size)) count(r, CHROME_OUT, ts, size);
+        } else if (STARTS(msg, end, "CHUNK_IN seq=0 ")) {
+            uint64_t total = 0;
+            find_number(msg, end, " total=", 7, total);
+            r.events.push_back({ts, static_cast<uint32_t>(total), EV_CHUNK_START});
+        } else if (STARTS(msg, end, "CHUNK_ASSEMBLED")) {
+            find_number(msg, end, " size=", 6, size);
+            r.events.push_back({ts, static_cast<uint32_t>(std::min<uint64_t>(size, UINT32_MAX)), EV_CHUNK_DONE});
+        } else if (STARTS(msg, end, "CHUNK_INVALID_CHECKSUM")) {
+            r.bad_chunks++;
+            r.events.push_back({ts, 0, EV_CHUNK_BAD});
+        }
+    }
+}
+
+void parse_range(const char* data, const Task& t, RangeResult& r, int64_t gap_ms, size_t launch) {
+    const char* p = data + t.begin;
+    const char* end = data + t.end;
+    while (p < end) {
+        const char* nl = static_cast<const char*>(std::memchr(p, '\n', static_cast<size_t>(end - p)));
+        const char* line_end = nl ? nl : end;
+        const char* trimmed = line_end;
+        if (trimmed > p && trimmed[-1] == '\r') --trimmed;
+        parse_line(p, trimmed, r, gap_ms, launch);
+        p = nl ? nl + 1 : end;
+    }
+}
+
+// ============================================================================
+// DESCUBRIMIENTO
+// ============================================================================
+
+struct LogFile {
+    std::string path;
+    size_t      launch;
+    bool        host;
+    MappedFile  map;
+};
+
+struct Launch {
+    std::string dir;
+    std::string profile;
+    std::string launch_id;
+    int64_t  first_ts = -1;
+    int64_t  last_ts  = -1;
+    uint64_t msgs[DIR_COUNT]  = {};
+    uint64_t bytes[DIR_COUNT] = {};
+    uint64_t chunks_ok   = 0;
+    uint64_t chunks_bad  = 0;
+    uint64_t chunks_open = 0;
+    size_t   gaps        = 0;
+    size_t   reconnects  = 0;
+};
+
+bool is_log_name(const std::string& name, bool& host) {
+    auto ends_log = name.size() > 4 && name.compare(name.size() - 4, 4, ".log") == 0;
+    if (!ends_log) return false;
+    if (name.rfind("host_boot_", 0) == 0) return false;   // diagnóstico de arranque, sin tráfico
+    if (name.rfind("host_", 0) == 0) {
+        host = true;
+        return true;
+    }
+    if (name.rfind("cortex_extension_", 0) == 0) {
+        host = false;
+        return true;
+    }
+    return false;
+}
+
+void discover(const std::vector<std::string>& roots, std::vector<Launch>& launches,
+              std::vector<std::unique_ptr<LogFile>>& files) {
+    std::map<std::string, std::vector<std::pair<std::string, bool>>> by_dir;
+    for (const auto& root : roots) {
+        std::error_code ec;
+        if (fs::is_regular_file(root, ec)) {
+            bool host;
+            fs::path p(root);
+            if (is_log_name(p.filename().string(), host)) by_dir[p.parent_path().string()].push_back({root, host});
+            continue;
+        }
+        for (fs::recursive_directory_iterator it(root, fs::directory_options::skip_permission_denied, ec), endit;
+             !ec && it != endit; it.increment(ec)) {
+            if (!it->is_regular_file(ec)) continue;
+            bool host;
+            if (is_log_name(it->path().filename().string(), host)) {
+                by_dir[it->path().parent_path().string()].push_back({it->path().string(), host});
+            }
+        }
+    }
+
+    for (auto& [dir, entries] : by_dir) {
+        std::sort(entries.begin(), entries.end());   // host_YYYYMMDD → orden cronológico
+        Launch l;
+        l.dir = dir;
+        fs::path p(dir);
+        l.launch_id = p.filename().string();
+        l.profile = p.parent_path().filename().string();
+        size_t idx = launches.size();
+        launches.push_back(l);
+        for (const auto& [path, host] : entries) {
+            auto f = std::make_unique<LogFile>();
+            f->path = path;
+            f->launch = idx;
+            f->host = host;
+            files.push_back(std::move(f));
+        }
+    }
+}
+
+// ============================================================================
+// ESTADÍSTICAS
+// ============================================================================
+
+struct SizeStats {
+    uint64_t count = 0;
+    uint64_t total = 0;
+    uint64_t p50 = 0, p99 = 0, max = 0;
+    std::vector<uint64_t> buckets;   // buckets[i]: tamaños en (2^(i-1), 2^i]
+};
+
+SizeStats size_stats(std::vector<uint32_t>& v) {
+    SizeStats s;
+    s.count = v.size();
+    if (v.empty()) return s;
+    for (uint32_t x : v) {
+        s.total += x;
+        size_t b = 0;
+        while ((uint64_t{1} << b) < x) ++b;
+        if (s.buckets.size() <= b) s.buckets.resize(b + 1, 0);
+        s.buckets[b]++;
+    }
+    auto at = [&](double q) {
+        size_t k = std::min(v.size() - 1, static_cast<size_t>(q * v.size()));
+        std::nth_element(v.begin(), v.begin() + static_cast<std::ptrdiff_t>(k), v.end());
+        return static_cast<uint64_t>(v[k]);
+    };
+    s.p50 = at(0.50);
+    s.p99 = at(0.99);
+    s.max = *std::max_element(v.begin(), v.end());
+    return s;
+}
+
+std::string human_bytes(double b) {
+    char buf[32];
+    if (b >= 1024.0 * 1024.0) std::snprintf(buf, sizeof(buf), "%.1fM", b / (1024.0 * 1024.0));
+    else if (b >= 1024.0)     std::snprintf(buf, sizeof(buf), "%.1fK", b / 1024.0);
+    else                      std::snprintf(buf, sizeof(buf), "%.0f", b);
+    return buf;
+}
+
+double pct(std::vector<double>& v, double q) {
+    if (v.empty()) return 0;
+    size_t k = std::min(v.size() - 1, static_cast<size_t>(q * v.size()));
+    std::nth_element(v.begin(), v.begin() + static_cast<std::ptrdiff_t>(k), v.end());
+    return v[k];
+}
+
+}  // namespace
+
+// ============================================================================
+// ENTRY POINT
+// ============================================================================
+
+int run(const Options& opt) {
+    std::vector<Launch> launches;
+    std::vector<std::unique_ptr<LogFile>> files;
+    discover(opt.roots, launches, files);
+
+    if (files.empty()) {
+        std::cerr << "No host_*.log / cortex_extension_*.log found under:";
+        for (const auto& r : opt.roots) std::cerr << " " << r;
+        std::cerr << std::endl;
+        return 1;
+    }
+
+    // Rangos de líneas completas: los archivos grandes se reparten entre workers
+    auto t0 = std::chrono::steady_clock::now();
+    uint64_t total_bytes = 0;
+    std::vector<Task> tasks;
+    for (size_t i = 0; i < files.size(); ++i) {
+        if (!files[i]->map.map(files[i]->path)) continue;
+        const char* data = files[i]->map.data();
+        size_t size = files[i]->map.size();
+        total_bytes += size;
+        size_t begin = 0;
+        while (begin < size) {
+            size_t end = std::min(size, begin + RANGE_BYTES);
+            if (end < size) {
+                const void* nl = std::memchr(data + end, '\n', size - end);
+                end = nl ? static_cast<size_t>(static_cast<const char*>(nl) - data) + 1 : size;
+            }
+            tasks.push_back({i, begin, end});
+            begin = end;
+        }
+    }
+
+    unsigned threads = opt.threads ? opt.threads : std::max(1u, std::thread::hardware_concurrency());
+    threads = static_cast<unsigned>(std::max<size_t>(1, std::min<size_t>(threads, tasks.size())));
+    const int64_t gap_ms = static_cast<int64_t>(opt.gap_sec) * 1000;
+
+    std::vector<RangeResult> results(tasks.size());
+    std::atomic<size_t> next{0};
+    auto worker = [&]() {
+        for (size_t i = next++; i < tasks.size(); i = next++) {
+            const LogFile& f = *files[tasks[i].file];
+            parse_range(f.map.data(), tasks[i], results[i], gap_ms, f.launch);
+        }
+    };
+    std::vector<std::thread> pool;
+    for (unsigned i = 1; i < threads; ++i) pool.emplace_back(worker);
+    worker();
+    for (auto& t : pool) t.join();
+    double parse_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+
+    // ------------------------------------------------------------------------
+    // Merge: métricas conmutativas se suman; eventos y gaps se cosen por launch
+    // ------------------------------------------------------------------------
+    uint64_t lines = 0, parsed = 0, unparsed = 0, keepalives = 0, too_big = 0, bad_chunks = 0;
+    std::map<int64_t, Minute> minutes;
+    std::vector<uint32_t> sizes[DIR_COUNT];
+    std::vector<std::vector<Event>> events(launches.size());
+    std::vector<int64_t> last_traffic(launches.size(), -1);
+    std::vector<Window> gaps;
+
+    for (size_t i = 0; i < tasks.size(); ++i) {
+        RangeResult& r = results[i];
+        const LogFile& f = *files[tasks[i].file];
+        Launch& l = launches[f.launch];
+
+        lines += r.lines;
+        parsed += r.parsed;
+        unparsed += r.unparsed;
+        keepalives += r.keepalives;
+        too_big += r.too_big;
+        bad_chunks += r.bad_chunks;
+
+        for (const auto& [minute, m] : r.minutes) {
+            Minute& dst = minutes[minute];
+            for (int d = 0; d < DIR_COUNT; ++d) {
+                dst.msgs[d] += m.msgs[d];
+                dst.bytes[d] += m.bytes[d];
+                l.msgs[d] += m.msgs[d];
+                l.bytes[d] += m.bytes[d];
+            }
+            dst.c2b += m.c2b;
+            dst.b2c += m.b2c;
+        }
+        for (int d = 0; d < DIR_COUNT; ++d) sizes[d].insert(sizes[d].end(), r.sizes[d].begin(), r.sizes[d].end());
+        events[f.launch].insert(events[f.launch].end(), r.events.begin(), r.events.end());
+
+        if (r.first_ts >= 0 && (l.first_ts < 0 || r.first_ts < l.first_ts)) l.first_ts = r.first_ts;
+        if (r.last_ts > l.last_ts) l.last_ts = r.last_ts;
+
+        if (f.host && r.first_traffic >= 0) {
+            int64_t& prev = last_traffic[f.launch];
+            if (prev >= 0 && r.first_traffic - prev >= gap_ms) gaps.push_back({f.launch, prev, r.first_traffic});
+            gaps.insert(gaps.end(), r.gaps.begin(), r.gaps.end());
+            prev = r.last_traffic;
+        }
+    }
+    for (const auto& g : gaps) launches[g.launch].gaps++;
+
+    // Chunks: CHUNK_IN seq=0 → CHUNK_ASSEMBLED / CHUNK_INVALID_CHECKSUM en FIFO.
+    // El log no lleva message_id: con uploads intercalados el emparejado es aproximado.
+    std::vector<double> chunk_ms;
+    std::vector<uint32_t> chunk_sizes;
+    std::vector<Window> reconnects;
+    for (size_t li = 0; li < launches.size(); ++li) {
+        auto& ev = events[li];
+        std::stable_sort(ev.begin(), ev.end(), [](const Event& a, const Event& b) { return a.ts < b.ts; });
+        std::deque<int64_t> open_chunks;
+        int64_t down = -1;
+        for (const Event& e : ev) {
+            switch (e.kind) {
+                case EV_CHUNK_START:
+                    open_chunks.push_back(e.ts);
+                    break;
+                case EV_CHUNK_DONE:
+                case EV_CHUNK_BAD:
+                    if (!open_chunks.empty()) {
+                        if (e.kind == EV_CHUNK_DONE) {
+                            chunk_ms.push_back(static_cast<double>(e.ts - open_chunks.front()));
+                            chunk_sizes.push_back(e.value);
+                        }
+                        open_chunks.pop_front();
+                    }
+                    if (e.kind == EV_CHUNK_DONE) launches[li].chunks_ok++;
+                    else                         launches[li].chunks_bad++;
+                    break;
+                case EV_TCP_DOWN:
+                    if (down < 0) down = e.ts;
+                    break;
+                case EV_TCP_UP:
+                    if (down >= 0) {
+                        reconnects.push_back({li, down, e.ts});
+                        launches[li].reconnects++;
+                        down = -1;
+                    }
+                    break;
+            }
+        }
+        launches[li].chunks_open = open_chunks.size();
+        // Desconexión sin TCP_CONNECTED posterior: normalmente el shutdown del host
+        if (down >= 0) reconnects.push_back({li, down, -1});
+    }
+
+    SizeStats stats[DIR_COUNT];
+    for (int d = 0; d < DIR_COUNT; ++d) stats[d] = size_stats(sizes[d]);
+    SizeStats assembled = size_stats(chunk_sizes);
+    std::vector<double> chunk_sorted = chunk_ms;
+    double chunk_p50 = pct(chunk_sorted, 0.50), chunk_p99 = pct(chunk_sorted, 0.99);
+    double chunk_max = chunk_ms.empty() ? 0 : *std::max_element(chunk_ms.begin(), chunk_ms.end());
+
+    auto by_duration = [](const Window& a, const Window& b) {
+        int64_t da = a.end < 0 ? -1 : a.end - a.start;
+        int64_t db = b.end < 0 ? -1 : b.end - b.start;
+        return da > db;
+    };
+    std::sort(gaps.begin(), gaps.end(), by_duration);
+    std::sort(reconnects.begin(), reconnects.end(), by_duration);
+
+    double parse_mb_s = parse_ms > 0 ? (total_bytes / (1024.0 * 1024.0)) / (parse_ms / 1000.0) : 0;
+
+    // ------------------------------------------------------------------------
+    // Salida
+    // ------------------------------------------------------------------------
+    if (opt.as_json) {
+        nlohmann::json out;
+        out["files"] = files.size();
+        out["bytes"] = total_bytes;
+        out["lines"] = lines;
+        out["parsed"] = parsed;
+        out["unparsed"] = unparsed;
+        out["threads"] = threads;
+        out["parse_ms"] = parse_ms;
+        out["parse_mb_per_sec"] = parse_mb_s;
+        out["gap_sec"] = opt.gap_sec;
+        out["errors"] = {{"msg_too_big", too_big}, {"chunk_invalid_checksum", bad_chunks}};
+        out["keepalives"] = keepalives;
+
+        out["launches"] = nlohmann::json::array();
+        for (const auto& l : launches) {
+            nlohmann::json j = {{"profile", l.profile}, {"launch", l.launch_id}, {"dir", l.dir},
+                                {"first", format_ts(l.first_ts)}, {"last", format_ts(l.last_ts)},
+                                {"chunks_assembled", l.chunks_ok}, {"chunks_invalid", l.chunks_bad},
+                                {"chunks_incomplete", l.chunks_open},
+                                {"gaps", l.gaps}, {"reconnects", l.reconnects}};
+            for (int d = 0; d < DIR_COUNT; ++d) {
+                j["messages"][DIR_NAMES[d]] = l.msgs[d];
+                j["bytes"][DIR_NAMES[d]] = l.bytes[d];
+            }
+            out["launches"].push_back(j);
+        }
+
+        out["per_minute"] = nlohmann::json::array();
+        for (const auto& [minute, m] : minutes) {
+            nlohmann::json j = {{"minute", format_ts(minute * 60000, false)},
+                                {"chrome_to_brain", m.c2b}, {"brain_to_chrome", m.b2c}};
+            for (int d = 0; d < DIR_COUNT; ++d) {
+                j[DIR_NAMES[d]] = {{"messages", m.msgs[d]}, {"bytes", m.bytes[d]},
+                                   {"msg_per_sec", m.msgs[d] / 60.0}, {"bytes_per_sec", m.bytes[d] / 60.0}};
+            }
+            out["per_minute"].push_back(j);
+        }
+
+        auto size_json = [](const SizeStats& s) {
+            nlohmann::json j = {{"count", s.count}, {"total", s.total},
+                                {"mean", s.count ? static_cast<double>(s.total) / s.count : 0.0},
+                                {"p50", s.p50}, {"p99", s.p99}, {"max", s.max}};
+            j["histogram"] = nlohmann::json::array();
+            for (size_t b = 0; b < s.buckets.size(); ++b) {
+                if (s.buckets[b]) j["histogram"].push_back({{"le", uint64_t{1} << b}, {"count", s.buckets[b]}});
+            }
+            return j;
+        };
+        for (int d = 0; d < DIR_COUNT; ++d) out["sizes"][DIR_NAMES[d]] = size_json(stats[d]);
+
+        out["chunks"] = {{"assembled", chunk_ms.size()}, {"p50_ms", chunk_p50}, {"p99_ms", chunk_p99},
+                         {"max_ms", chunk_max}, {"sizes", size_json(assembled)}};
+
+        auto windows_json = [&](const std::vector<Window>& v) {
+            nlohmann::json arr = nlohmann::json::array();
+            for (const auto& w : v) {
+                arr.push_back({{"profile", launches[w.launch].profile}, {"launch", launches[w.launch].launch_id},
+                               {"start", format_ts(w.start)},
+                               {"end", w.end < 0 ? nlohmann::json(nullptr) : nlohmann::json(format_ts(w.end))},
+                               {"seconds", w.end < 0 ? nlohmann::json(nullptr)
+                                                     : nlohmann::json((w.end - w.start) / 1000.0)}});
+            }
+            return arr;
+        };
+        out["gaps"] = windows_json(gaps);
+        out["reconnects"] = windows_json(reconnects);
+
+        std::cout << out.dump(2) << std::endl;
+        return 0;
+    }
+
+    std::cout << "=== BLOOM-HOST LOG ANALYSIS ===" << std::endl << std::endl;
+    std::printf("Files:    %zu (%s) in %zu launch(es)\n", files.size(), human_bytes(static_cast<double>(total_bytes)).c_str(),
+                launches.size());
+    std::printf("Lines:    %llu parsed, %llu unparsed\n", static_cast<unsigned long long>(parsed),
+                static_cast<unsigned long long>(unparsed));
+    std::printf("Parse:    %.1f ms on %u thread(s), %.1f MB/s\n", parse_ms, threads, parse_mb_s);
+    std::printf("Errors:   MSG_TOO_BIG=%llu CHUNK_INVALID_CHECKSUM=%llu\n", static_cast<unsigned long long>(too_big),
+                static_cast<unsigned long long>(bad_chunks));
+
+    std::cout << std::endl << "--- LAUNCHES ---" << std::endl;
+    std::printf("%-24s %-23s %10s %10s %10s %7s %5s %5s\n", "launch", "first", "chrome_in", "chrome_out", "brain_in",
+                "chunks", "gaps", "reconn");
+    for (const auto& l : launches) {
+        std::printf("%-24s %-23s %10llu %10llu %10llu %7llu %5zu %5zu\n", l.launch_id.c_str(), format_ts(l.first_ts).c_str(),
+                    static_cast<unsigned long long>(l.msgs[CHROME_IN]), static_cast<unsigned long long>(l.msgs[CHROME_OUT]),
+                    static_cast<unsigned long long>(l.msgs[BRAIN_IN]), static_cast<unsigned long long>(l.chunks_ok),
+                    l.gaps, l.reconnects);
+    }
+
+    std::cout << std::endl << "--- PER MINUTE (msg/s | bytes/s) ---" << std::endl;
+    std::printf("%-16s %16s %16s %16s %7s %7s\n", "minute", "chrome_in", "chrome_out", "brain_in", "c2b", "b2c");
+    size_t shown = 0;
+    for (const auto& [minute, m] : minutes) {
+        if (shown++ == MAX_MINUTE_ROWS) break;
+        char cols[DIR_COUNT][32];
+        for (int d = 0; d < DIR_COUNT; ++d) {
+            std::snprintf(cols[d], sizeof(cols[d]), "%.2f | %s", m.msgs[d] / 60.0, human_bytes(m.bytes[d] / 60.0).c_str());
+        }
+        std::printf("%-16s %16s %16s %16s %7llu %7llu\n", format_ts(minute * 60000, false).c_str(), cols[0], cols[1],
+                    cols[2], static_cast<unsigned long long>(m.c2b), static_cast<unsigned long long>(m.b2c));
+    }
+    if (minutes.size() > MAX_MINUTE_ROWS) {
+        std::printf("... %zu more minute(s), use --json for all\n", minutes.size() - MAX_MINUTE_ROWS);
+    }
+
+    std::cout << std::endl << "--- MESSAGE SIZES (bytes) ---" << std::endl;
+    std::printf("%-12s %10s %10s %10s %10s %10s\n", "direction", "count", "mean", "p50", "p99", "max");
+    for (int d = 0; d < DIR_COUNT; ++d) {
+        const SizeStats& s = stats[d];
+        std::printf("%-12s %10llu %10.0f %10llu %10llu %10llu\n", DIR_NAMES[d], static_cast<unsigned long long>(s.count),
+                    s.count ? static_cast<double>(s.total) / s.count : 0.0, static_cast<unsigned long long>(s.p50),
+                    static_cast<unsigned long long>(s.p99), static_cast<unsigned long long>(s.max));
+    }
+    std::printf("keepalives: %llu (excluded from chrome_out)\n", static_cast<unsigned long long>(keepalives));
+
+    std::cout << std::endl << "--- CHUNK ASSEMBLY (CHUNK_IN seq=0 -> CHUNK_ASSEMBLED) ---" << std::endl;
+    if (chunk_ms.empty()) {
+        std::cout << "no chunked messages" << std::endl;
+    } else {
+        std::printf("assembled=%zu  p50=%.0fms  p99=%.0fms  max=%.0fms  size p50=%s max=%s\n", chunk_ms.size(),
+                    chunk_p50, chunk_p99, chunk_max, human_bytes(static_cast<double>(assembled.p50)).c_str(),
+                    human_bytes(static_cast<double>(assembled.max)).c_str());
+    }
+    uint64_t open_total = 0;
+    for (const auto& l : launches) open_total += l.chunks_open;
+    if (open_total) std::printf("incomplete (started, never assembled): %llu\n", static_cast<unsigned long long>(open_total));
+
+    auto print_windows = [&](const char* title, const std::vector<Window>& v) {
+        std::cout << std::endl << "--- " << title << " ---" << std::endl;
+        if (v.empty()) {
+            std::cout << "none" << std::endl;
+            return;
+        }
+        for (size_t i = 0; i < v.size() && i < MAX_EVENT_ROWS; ++i) {
+            const Window& w = v[i];
+            if (w.end < 0) {
+                std::printf("%-24s %s -> (end of log)\n", launches[w.launch].launch_id.c_str(), format_ts(w.start).c_str());
+            } else {
+                std::printf("%-24s %s -> %s  %.1fs\n", launches[w.launch].launch_id.c_str(), format_ts(w.start).c_str(),
+                            format_ts(w.end).c_str(), (w.end - w.start) / 1000.0);
+            }
+        }
+        if (v.size() > MAX_EVENT_ROWS) std::printf("... %zu more\n", v.size() - MAX_EVENT_ROWS);
+    };
+    std::string gap_title = "TRAFFIC GAPS >= " + std::to_string(opt.gap_sec) + "s (CHROME_MSG / BRAIN_MSG)";
+    print_windows(gap_title.c_str(), gaps);
+    print_windows("BRAIN RECONNECT WINDOWS (TCP_DISCONNECTED -> TCP_CONNECTED)", reconnects);
+    return 0;
+}
+
+}  // namespace LogAnalyzer
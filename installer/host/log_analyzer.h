@@ -0,0 +1,43 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+/**
+ * @brief Análisis offline de logs: `bloom-host --analyze-log <dir> [--analyze-log <dir>...]`
+ *
+ * Reconstruye throughput y latencias a partir de host_*.log y
+ * cortex_extension_*.log, sin necesidad de captura previa. Cada <dir> puede
+ * ser logs/host/profiles/, un perfil o un launch: se recorre recursivamente y
+ * cada directorio con logs cuenta como un launch.
+ *
+ * Los archivos se mapean en memoria y se parten en rangos de líneas completas
+ * que se procesan en paralelo (un worker por core); las métricas conmutativas
+ * se suman y los eventos ordenados (chunks, TCP) se cosen por launch.
+ *
+ * Líneas usadas:
+ *   host    CHROME_MSG size=N        chrome_in
+ *           BRAIN_MSG size=N         brain_in
+ *           CHROME_TO_BRAIN          forward c2b
+ *           BRAIN_TO_CHROME          forward b2c
+ *           TCP_CONNECTED / TCP_DISCONNECTED   ventanas de reconexión
+ *   cortex  CHROME_OUT size=N        chrome_out (keepalive contado aparte)
+ *           CHUNK_IN seq= (header) → CHUNK_ASSEMBLED size=N   tiempo de ensamblado
+ *
+ * Reporte: msg/s y bytes/s por minuto, distribución de tamaños (log2),
+ * tiempos de ensamblado de chunks, gaps sin tráfico >= gap_sec y ventanas
+ * de reconexión con Brain.
+ */
+namespace LogAnalyzer {
+
+    struct Options {
+        std::vector<std::string> roots;
+        bool     as_json = false;
+        int      gap_sec = 60;      // --gap-sec: silencio mínimo reportado como gap
+        unsigned threads = 0;       // --threads: 0 = hardware_concurrency
+    };
+
+    /** Punto de entrada de --analyze-log. @return exit code (1 si no hay logs) */
+    int run(const Options& opt);
+
+}  // namespace LogAnalyzer
@@ -0,0 +1,78 @@
+#include "message_utils.h"
+
+#include <iostream>
+
+namespace MessageUtils {
+
+// ============================================================================
+// HELPERS SEGUROS PARA JSON
+// ============================================================================
+
+std::string json_get_string_safe(const nlohmann::json& j, const std::string& key, const std::string& fallback) {
+    try {
+        if (!j.contains(key)) return fallback;
+        
+        const auto& val = j[key];
+        
+        if (val.is_string()) {
+            return val.get<std::string>();
+        } else if (val.is_number_integer()) {
+            return std::to_string(val.get<int64_t>());
+        } else if (val.is_number_float()) {
+            return std::to_string(val.get<double>());
+        } else if (val.is_boolean()) {
+            return val.get<bool>() ? "true" : "false";
+        }
+        
+        return fallback;
+    } catch (const std::exception& e) {
+        std::cerr << "[JSON_SAFE] Error extracting '" << key << "': " << e.what() << std::endl;
+        return fallback;
+    }
+}
+
+std::string json_value_to_string(const nlohmann::json& val) {
+    try {
+        if (val.is_string()) return val.get<std::string>();
+        if (val.is_number_integer()) return std::to_string(val.get<int64_t>());
+        if (val.is_number_float()) return std::to_string(val.get<double>());
+        if (val.is_boolean()) return val.get<bool>() ? "true" : "false";
+        if (val.is_null()) return "";
+        return val.dump();
+    } catch (...) {
+        return "";
+    }
+}
+
+std::string message_kind(const nlohmann::json& msg, const std::string& command, const std::string& type) {
+    if (!command.empty()) return command;
+    if (!type.empty()) return type;
+    return json_get_string_safe(msg, "event");
+}
+
+// ============================================================================
+// EXTRACCIÓN DE IDENTIDAD SIN PARSE
+// ============================================================================
+
+bool extract_profile_id_from_raw(const std::string& msg_str, std::string& out_profile_id) {
+    size_t pos = msg_str.find("\"profile_id\"");
+    if (pos == std::string::npos) return false;
+    
+    size_t start = msg_str.find("\"", pos + 13);
+    if (start == std::string::npos) return false;
+    start++;
+    
+    size_t end = msg_str.find("\"", start);
+    if (end == std::string::npos) return false;
+    
+    if (end - start != 36) return false;
+    if (msg_str[start + 8]  != '-' || msg_str[start + 13] != '-' ||
+        msg_str[start + 18] != '-' || msg_str[start + 23] != '-') {
+        return false;
+    }
+    
+    out_profile_id.assign(msg_str, start, 36);
+    return true;
+}
+
+}  // namespace MessageUtils
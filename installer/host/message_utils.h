@@ -0,0 +1,40 @@
+#pragma once
+
+#include <string>
+#include <nlohmann/json.hpp>
+
+/**
+ * @brief Helpers de extracción de campos sobre mensajes Synapse
+ *
+ * Funciones puras (sin estado global) usadas en el hot path de
+ * handle_chrome_message / handle_service_message. Viven fuera de
+ * bloom-host.cpp para que los micro-benchmarks (bench/) las enlacen
+ * sin arrastrar main() ni los threads del host.
+ */
+namespace MessageUtils {
+
+    /**
+     * @brief Lee j[key] como string aunque el valor sea número o booleano.
+     * @return fallback si la clave no existe o el valor es objeto/array/null
+     */
+    std::string json_get_string_safe(const nlohmann::json& j, const std::string& key,
+                                     const std::string& fallback = "");
+
+    /** Representación string de cualquier valor JSON ("" para null). */
+    std::string json_value_to_string(const nlohmann::json& val);
+
+    /**
+     * @brief Clave de atribución de un mensaje: command > type > event.
+     * La extensión usa "event" para notificaciones y "command"/"type" para el resto.
+     */
+    std::string message_kind(const nlohmann::json& msg, const std::string& command,
+                             const std::string& type);
+
+    /**
+     * @brief Busca "profile_id":"<uuid>" en el mensaje crudo, sin parsear JSON.
+     * @param out_profile_id UUID de 36 caracteres si se encontró
+     * @return true si hay un candidato con forma de UUID
+     */
+    bool extract_profile_id_from_raw(const std::string& msg_str, std::string& out_profile_id);
+
+}  // namespace MessageUtils
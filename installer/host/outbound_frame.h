@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/**
+ * @brief Frame de salida con lugar para el header de longitud delante del payload
+ *
+ * Los dos sinks (stdout de Chrome en little endian, socket de Brain en big
+ * endian) anteponen 4 bytes de longitud. Con el lugar ya reservado el writer
+ * escribe el header en esos bytes y manda el frame entero con un solo
+ * write/send, sin armar otro buffer. Un mensaje reensamblado de chunks
+ * (chunked_buffer.h) se decodifica directo en este layout y pasa por move
+ * hasta el writer thread.
+ *
+ *   data = [HEADER_ROOM bytes libres][payload]
+ */
+struct OutboundFrame {
+    static constexpr size_t HEADER_ROOM = 4;
+
+    std::string data;
+
+    OutboundFrame() : data(HEADER_ROOM, '\0') {}
+
+    /** Copia payload detrás del lugar del header (la única copia del camino normal). */
+    static OutboundFrame copy_of(const char* payload, size_t size) {
+        OutboundFrame frame;
+        frame.data.reserve(HEADER_ROOM + size);
+        frame.data.append(payload, size);
+        return frame;
+    }
+    static OutboundFrame copy_of(const std::string& payload) { return copy_of(payload.data(), payload.size()); }
+
+    const char* payload() const { return data.data() + HEADER_ROOM; }
+    size_t      size()    const { return data.size() - HEADER_ROOM; }
+
+    /** Payload como string (copia): logs, captura, tests. */
+    std::string payload_str() const { return data.substr(HEADER_ROOM); }
+
+    /** Escribe la longitud en el lugar reservado. @return el frame completo listo para el sink */
+    const std::string& with_header_le() {
+        uint32_t len = static_cast<uint32_t>(size());
+        uint8_t* h = reinterpret_cast<uint8_t*>(&data[0]);
+        h[0] = static_cast<uint8_t>(len);
+        h[1] = static_cast<uint8_t>(len >> 8);
+        h[2] = static_cast<uint8_t>(len >> 16);
+        h[3] = static_cast<uint8_t>(len >> 24);
+        return data;
+    }
+    const std::string& with_header_be() {
+        uint32_t len = static_cast<uint32_t>(size());
+        uint8_t* h = reinterpret_cast<uint8_t*>(&data[0]);
+        h[0] = static_cast<uint8_t>(len >> 24);
+        h[1] = static_cast<uint8_t>(len >> 16);
+        h[2] = static_cast<uint8_t>(len >> 8);
+        h[3] = static_cast<uint8_t>(len);
+        return data;
+    }
+};
@@ -0,0 +1,328 @@
+#include "outbound_scheduler.h"
+
+#include <chrono>
+#include <iostream>
+
+namespace {
+
+const char* CLASS_NAMES[OutboundScheduler::PRIORITY_COUNT] = {"control", "bulk"};
+
+uint64_t now_ns() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+}  // namespace
+
+OutboundScheduler::OutboundScheduler(const char* p_name, WriteFn p_write_fn, size_t p_max_bulk_bytes)
+    : name(p_name), write_fn(std::move(p_write_fn)), max_bulk_bytes(p_max_bulk_bytes) {}
+
+OutboundScheduler::~OutboundScheduler() {
+    stop();
+}
+
+void OutboundScheduler::start() {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (started) return;
+    started = true;
+    stopping = false;
+    writer = std::thread(&OutboundScheduler::writer_loop, this);
+}
+
+// ============================================================================
+// PRODUCTORES
+// ============================================================================
+
+bool OutboundScheduler::enqueue(OutboundFrame frame, Priority priority, DoneFn on_done) {
+    std::unique_lock<std::mutex> lock(mutex);
+    ClassStats& st = stats[priority];
+
+    if (priority == BULK && st.queued_bytes > 0 && st.queued_bytes + frame.size() > max_bulk_bytes) {
+        // Backpressure: igual que el write bloqueante anterior, pero sin
+        // retener el lock de stdout/socket que necesitan los frames de control
+        st.producer_blocked++;
+        space_cv.wait(lock, [&] {
+            return stopping || st.queued_bytes == 0 || st.queued_bytes + frame.size() <= max_bulk_bytes;
+        });
+    }
+
+    if (stopping || !started) {
+        st.dropped++;
+        return false;
+    }
+
+    st.enqueued++;
+    st.queued_bytes += frame.size();
+    queues[priority].push_back({std::move(frame), now_ns(), std::move(on_done)});
+    if (queues[priority].size() > st.max_depth) st.max_depth = queues[priority].size();
+
+    lock.unlock();
+    work_cv.notify_one();
+    return true;
+}
+
+bool OutboundScheduler::write_direct(size_t frame_bytes, const std::function<bool()>& write) {
+    std::unique_lock<std::mutex> lock(mutex);
+    ClassStats& st = stats[BULK];
+    uint64_t enqueued_ns = now_ns();
+
+    // Mismo orden que un enqueue BULK: detrás de lo ya encolado
+    direct_cv.wait(lock, [&] {
+        return stopping || !started ||
+               (!writing && queues[BULK].empty() && bulk_has_credit(frame_bytes));
+    });
+    if (stopping || !started) {
+        st.dropped++;
+        return false;
+    }
+
+    st.enqueued++;
+    writing = true;
+    if (credits.tracking) {
+        credits.bytes -= static_cast<int64_t>(frame_bytes);
+        credits.frames -= 1;
+    }
+    uint64_t start = now_ns();
+    lock.unlock();
+
+    bool ok = write();
+    uint64_t write_ns = now_ns() - start;
+
+    lock.lock();
+    if (ok) {
+        st.written++;
+        st.bytes_written += frame_bytes;
+    } else {
+        st.failed++;
+    }
+    uint64_t wait_ns = start - enqueued_ns;
+    st.wait_total_ns += wait_ns;
+    if (wait_ns > st.wait_max_ns) st.wait_max_ns = wait_ns;
+    st.write_total_ns += write_ns;
+    if (write_ns > st.write_max_ns) st.write_max_ns = write_ns;
+    writing = false;
+    if (queues[CONTROL].empty() && queues[BULK].empty()) idle_cv.notify_all();
+    lock.unlock();
+
+    work_cv.notify_one();
+    return ok;
+}
+
+bool OutboundScheduler::drain(int timeout_ms) {
+    std::unique_lock<std::mutex> lock(mutex);
+    return idle_cv.wait_for(lock, std::chrono::milliseconds(timeout_ms), [this] {
+        return !started || (!writing && queues[CONTROL].empty() && queues[BULK].empty());
+    });
+}
+
+void OutboundScheduler::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!started) return;
+        stopping = true;
+    }
+    work_cv.notify_all();
+    space_cv.notify_all();
+    direct_cv.notify_all();
+    if (writer.joinable()) writer.join();
+
+    std::lock_guard<std::mutex> lock(mutex);
+    for (int p = 0; p < PRIORITY_COUNT; ++p) {
+        stats[p].dropped += queues[p].size();
+        stats[p].queued_bytes = 0;
+        queues[p].clear();
+    }
+    started = false;
+    idle_cv.notify_all();
+}
+
+// ============================================================================
+// CRÉDITOS
+// ============================================================================
+
+void OutboundScheduler::begin_credits() {
+    std::lock_guard<std::mutex> lock(mutex);
+    credits.used = true;
+    credits.tracking = true;
+    credits.gating = false;
+    credits.window_bytes = 0;
+    credits.window_frames = 0;
+    credits.bytes = 0;
+    credits.frames = 0;
+    if (credits.stall_start_ns) close_credit_stall();
+}
+
+void OutboundScheduler::enable_credits(uint64_t window_bytes, uint64_t window_frames) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        // Lo escrito desde begin_credits() ya está descontado (saldo negativo)
+        credits.tracking = true;
+        credits.gating = true;
+        credits.window_bytes = window_bytes;
+        credits.window_frames = window_frames;
+        credits.bytes += static_cast<int64_t>(window_bytes);
+        credits.frames += static_cast<int64_t>(window_frames);
+    }
+    work_cv.notify_one();
+    direct_cv.notify_all();
+}
+
+void OutboundScheduler::disable_credits() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (credits.stall_start_ns) close_credit_stall();
+        credits.tracking = false;
+        credits.gating = false;
+    }
+    work_cv.notify_one();
+    direct_cv.notify_all();
+}
+
+void OutboundScheduler::grant(uint64_t bytes, uint64_t frames) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!credits.tracking) return;
+        credits.bytes += static_cast<int64_t>(bytes);
+        credits.frames += static_cast<int64_t>(frames);
+        credits.granted_bytes += bytes;
+        credits.grants++;
+    }
+    work_cv.notify_one();
+    direct_cv.notify_all();
+}
+
+void OutboundScheduler::update_credit_stall() {
+    bool stalled = !queues[BULK].empty() && !bulk_has_credit(queues[BULK].front().frame.size());
+    if (stalled && !credits.stall_start_ns) {
+        credits.stalls++;
+        credits.stall_start_ns = now_ns();
+    } else if (!stalled && credits.stall_start_ns) {
+        close_credit_stall();
+    }
+}
+
+void OutboundScheduler::close_credit_stall() {
+    uint64_t stall_ns = now_ns() - credits.stall_start_ns;
+    credits.stall_total_ns += stall_ns;
+    if (stall_ns > credits.stall_max_ns) credits.stall_max_ns = stall_ns;
+    credits.stall_start_ns = 0;
+}
+
+bool OutboundScheduler::bulk_has_credit(size_t frame_bytes) const {
+    if (!credits.gating) return true;
+    if (credits.frames < 1) return false;
+    if (credits.bytes >= static_cast<int64_t>(frame_bytes)) return true;
+    // Frame más grande que la ventana: pasa sólo con todo el crédito devuelto
+    return credits.bytes >= static_cast<int64_t>(credits.window_bytes);
+}
+
+// ============================================================================
+// WRITER THREAD
+// ============================================================================
+
+void OutboundScheduler::writer_loop() {
+    std::cerr << "[OUTBOUND:" << name << "] Writer thread started" << std::endl;
+
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        auto bulk_ready = [this] {
+            return !queues[BULK].empty() && bulk_has_credit(queues[BULK].front().frame.size());
+        };
+        update_credit_stall();
+        // writing acá solo puede ser un write_direct() en curso
+        work_cv.wait(lock, [&] { return stopping || (!writing && (!queues[CONTROL].empty() || bulk_ready())); });
+        if (stopping) break;
+        update_credit_stall();
+
+        // CONTROL siempre primero (aunque BULK esté sin crédito); BULK de a un
+        // frame para volver a mirar CONTROL
+        Priority p = queues[CONTROL].empty() ? BULK : CONTROL;
+        Entry entry = std::move(queues[p].front());
+        queues[p].pop_front();
+        writing = true;
+        if (credits.tracking) {
+            credits.bytes -= static_cast<int64_t>(entry.frame.size());
+            credits.frames -= 1;
+        }
+
+        uint64_t start = now_ns();
+        uint64_t wait_ns = start - entry.enqueued_ns;
+        lock.unlock();
+
+        bool ok = write_fn(entry.frame);
+        uint64_t write_ns = now_ns() - start;
+        if (entry.on_done) entry.on_done();
+
+        lock.lock();
+        ClassStats& st = stats[p];
+        st.queued_bytes -= entry.frame.size();
+        if (ok) {
+            st.written++;
+            st.bytes_written += entry.frame.size();
+        } else {
+            st.failed++;
+        }
+        st.wait_total_ns += wait_ns;
+        if (wait_ns > st.wait_max_ns) st.wait_max_ns = wait_ns;
+        st.write_total_ns += write_ns;
+        if (write_ns > st.write_max_ns) st.write_max_ns = write_ns;
+        writing = false;
+
+        if (p == BULK) space_cv.notify_all();
+        if (queues[CONTROL].empty() && queues[BULK].empty()) idle_cv.notify_all();
+        if (queues[BULK].empty()) direct_cv.notify_all();
+    }
+
+    std::cerr << "[OUTBOUND:" << name << "] Writer thread exiting" << std::endl;
+}
+
+// ============================================================================
+// MÉTRICAS
+// ============================================================================
+
+uint64_t OutboundScheduler::bulk_queued_bytes() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return stats[BULK].queued_bytes;
+}
+
+nlohmann::json OutboundScheduler::stats_json() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    nlohmann::json out;
+    for (int p = 0; p < PRIORITY_COUNT; ++p) {
+        const ClassStats& st = stats[p];
+        uint64_t done = st.written + st.failed;
+        out[CLASS_NAMES[p]] = {
+            {"enqueued",         st.enqueued},
+            {"written",          st.written},
+            {"failed",           st.failed},
+            {"dropped",          st.dropped},
+            {"bytes_written",    st.bytes_written},
+            {"depth",            queues[p].size()},
+            {"max_depth",        st.max_depth},
+            {"queued_bytes",     st.queued_bytes},
+            {"wait_avg_us",      done ? st.wait_total_ns / done / 1000.0 : 0.0},
+            {"wait_max_us",      st.wait_max_ns / 1000.0},
+            {"write_avg_us",     done ? st.write_total_ns / done / 1000.0 : 0.0},
+            {"write_max_us",     st.write_max_ns / 1000.0},
+            {"producer_blocked", st.producer_blocked}
+        };
+    }
+    if (!credits.used) return out;
+
+    uint64_t stall_total = credits.stall_total_ns;
+    if (credits.stall_start_ns) stall_total += now_ns() - credits.stall_start_ns;
+    out["credits"] = {
+        {"enabled",          credits.gating},
+        {"window_bytes",     credits.window_bytes},
+        {"window_frames",    credits.window_frames},
+        {"available_bytes",  credits.bytes},
+        {"available_frames", credits.frames},
+        {"granted_bytes",    credits.granted_bytes},
+        {"grants",           credits.grants},
+        {"stalls",           credits.stalls},
+        {"stalled_now",      credits.stall_start_ns != 0},
+        {"stall_total_ms",   stall_total / 1e6},
+        {"stall_max_ms",     credits.stall_max_ns / 1e6}
+    };
+    return out;
+}
@@ -0,0 +1,169 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <nlohmann/json.hpp>
+
+#include "outbound_frame.h"
+
+/**
+ * @brief Cola de salida con prioridades por sink (stdout de Chrome, socket de Brain)
+ *
+ * Cada sink tiene un writer thread propio y dos clases:
+ *
+ *   CONTROL  PONG, HEARTBEAT, PROFILE_CONNECTED, REGISTER_HOST, keepalive,
+ *            host_ready, respuestas host-local. Nunca bloquea al productor.
+ *   BULK     mensajes ruteados Chrome ↔ Brain. El productor se bloquea si la
+ *            cola supera max_bulk_bytes (misma backpressure que el write directo).
+ *
+ * El writer siempre vacía CONTROL antes de tomar el siguiente frame BULK, así
+ * que la latencia de un frame de control queda acotada por un solo frame bulk
+ * en vuelo. Un frame no se parte en el cable (rompería el framing por longitud):
+ * los transfers grandes ya llegan chunkeados (≤1MB hacia Chrome) y cada chunk
+ * es un punto de preempción.
+ *
+ * Créditos (flow control negociado con Brain, ver flow_control.h): con
+ * begin_credits() cada frame escrito descuenta bytes/frames de la ventana que
+ * otorgó el peer; con enable_credits() BULK espera a tener crédito (CONTROL
+ * puede sobregirar). grant() repone al llegar FLOW_CREDIT.
+ *
+ * Los frames van con lugar para el header de longitud (outbound_frame.h):
+ * el writer lo completa y manda todo con una sola escritura. Un mensaje
+ * reensamblado entra ya en ese layout, por move, sin otra copia.
+ *
+ * write_direct() escribe un frame BULK desde el thread que llama, sin
+ * pasar por un std::string (splice de stdin al socket, splice_forward.h):
+ * espera su turno detrás de lo BULK ya encolado y con crédito, y mientras
+ * escribe el writer thread no toma otro frame.
+ *
+ * Métricas por clase en stats_json(): encolados, escritos, descartados,
+ * profundidad actual/máxima, bytes en cola, espera en cola (avg/max) y
+ * tiempo de escritura; más "credits" con los stalls por falta de crédito.
+ */
+class OutboundScheduler {
+public:
+    enum Priority { CONTROL = 0, BULK = 1, PRIORITY_COUNT = 2 };
+
+    /**
+     * Escribe un frame completo en el sink (completa el header en el lugar
+     * reservado). false = frame perdido (socket caído, pipe roto).
+     */
+    using WriteFn = std::function<bool(OutboundFrame&)>;
+
+    /** Se invoca en el writer thread después de intentar escribir el frame. */
+    using DoneFn = std::function<void()>;
+
+    OutboundScheduler(const char* name, WriteFn write_fn, size_t max_bulk_bytes);
+    ~OutboundScheduler();
+    OutboundScheduler(const OutboundScheduler&) = delete;
+    OutboundScheduler& operator=(const OutboundScheduler&) = delete;
+
+    void start();
+
+    /**
+     * @brief Encola un frame; el scheduler toma el buffer
+     * @return false si el scheduler está detenido y el frame se descartó
+     */
+    bool enqueue(OutboundFrame frame, Priority priority, DoneFn on_done = nullptr);
+
+    /**
+     * @brief Escribe un frame BULK de frame_bytes con write, en el thread que llama
+     *
+     * Espera a que no quede BULK encolado ni escritura en curso y a que haya
+     * crédito. Cuenta en stats y créditos como un frame BULK más.
+     * @return lo que devuelva write; false sin llamarla si el scheduler está detenido
+     */
+    bool write_direct(size_t frame_bytes, const std::function<bool()>& write);
+
+    /**
+     * @brief Espera a que ambas colas se vacíen y no haya escritura en curso
+     * @return true si quedó vacío antes del timeout
+     */
+    bool drain(int timeout_ms);
+
+    /** Detiene el writer; lo que quede en cola se descarta (contado en dropped). */
+    void stop();
+
+    /** Nueva conexión: descuenta desde el próximo frame, sin bloquear aún (ventana desconocida). */
+    void begin_credits();
+
+    /** El peer otorgó una ventana inicial: BULK queda sujeto a crédito. */
+    void enable_credits(uint64_t window_bytes, uint64_t window_frames);
+
+    /** Peer sin flow control (o desconectado): sin descuento ni espera. */
+    void disable_credits();
+
+    /** FLOW_CREDIT del peer. */
+    void grant(uint64_t bytes, uint64_t frames);
+
+    /** Bytes BULK en cola sin escribir (señal de backlog para admission control). */
+    uint64_t bulk_queued_bytes() const;
+
+    /** { "control": {...}, "bulk": {...}, "credits": {...} si se usó begin_credits() } */
+    nlohmann::json stats_json() const;
+
+private:
+    struct Entry {
+        OutboundFrame frame;
+        uint64_t      enqueued_ns;
+        DoneFn        on_done;
+    };
+
+    struct Credits {
+        bool     used            = false;   // algún begin_credits(): reportar en stats
+        bool     tracking        = false;   // descontando frames escritos
+        bool     gating          = false;   // BULK espera crédito
+        uint64_t window_bytes    = 0;
+        uint64_t window_frames   = 0;
+        int64_t  bytes           = 0;       // disponible; CONTROL puede dejarlo negativo
+        int64_t  frames          = 0;
+        uint64_t granted_bytes   = 0;
+        uint64_t grants          = 0;
+        uint64_t stalls          = 0;
+        uint64_t stall_start_ns  = 0;       // != 0 mientras BULK espera crédito
+        uint64_t stall_total_ns  = 0;
+        uint64_t stall_max_ns    = 0;
+    };
+
+    struct ClassStats {
+        uint64_t enqueued      = 0;
+        uint64_t written       = 0;
+        uint64_t failed        = 0;
+        uint64_t dropped       = 0;
+        uint64_t bytes_written = 0;
+        uint64_t queued_bytes  = 0;
+        size_t   max_depth     = 0;
+        uint64_t wait_total_ns = 0;
+        uint64_t wait_max_ns   = 0;
+        uint64_t write_total_ns = 0;
+        uint64_t write_max_ns   = 0;
+        uint64_t producer_blocked = 0;   // enqueue BULK que esperó por max_bulk_bytes
+    };
+
+    void writer_loop();
+    bool bulk_has_credit(size_t frame_bytes) const;
+    void update_credit_stall();
+    void close_credit_stall();
+
+    const char*  name;
+    WriteFn      write_fn;
+    const size_t max_bulk_bytes;
+
+    mutable std::mutex      mutex;
+    std::condition_variable work_cv;     // writer: hay frames o stop
+    std::condition_variable space_cv;    // productores BULK: bajó queued_bytes
+    std::condition_variable idle_cv;     // drain(): colas vacías
+    std::condition_variable direct_cv;   // write_direct(): terminó una escritura o llegó crédito
+    std::deque<Entry>       queues[PRIORITY_COUNT];
+    ClassStats              stats[PRIORITY_COUNT];
+    Credits                 credits;
+    bool                    writing  = false;
+    bool                    stopping = false;
+    bool                    started  = false;
+    std::thread             writer;
+};
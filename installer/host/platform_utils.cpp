@@ -1,12 +1,27 @@
 #include "platform_utils.h"
+#include <fstream>
 #include <iostream>
 
 #ifdef _WIN32
     #include <fcntl.h>
     #include <io.h>
     #include <process.h>
+    #include <psapi.h>
+    #include <mstcpip.h>
 #else
+    #include <cerrno>
     #include <unistd.h>
+    #include <dirent.h>
+    #include <netinet/tcp.h>
+    #include <poll.h>
+    #include <sys/time.h>
+#endif
+
+#if defined(__APPLE__)
+    #include <mach/mach.h>
+    #include <malloc/malloc.h>
+#elif defined(__GLIBC__)
+    #include <malloc.h>
 #endif
 
 namespace PlatformUtils {
@@ -61,4 +76,177 @@ std::string get_cli_argument(int argc, char* argv[], const std::string& flag) {
     return "";
 }
 
+// ============================================================================
+// ESTADÍSTICAS DE PROCESO
+// ============================================================================
+
+#if !defined(_WIN32)
+static int64_t count_dir_entries(const char* path) {
+    DIR* dir = opendir(path);
+    if (!dir) return -1;
+    int64_t count = 0;
+    while (struct dirent* entry = readdir(dir)) {
+        if (entry->d_name[0] != '.') count++;
+    }
+    closedir(dir);
+    return count - 1;   // el propio DIR* abierto para listar
+}
+#endif
+
+ProcessStats get_process_stats() {
+    ProcessStats stats;
+
+#if defined(_WIN32)
+    PROCESS_MEMORY_COUNTERS pmc;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc))) {
+        stats.rss_kb = static_cast<int64_t>(pmc.WorkingSetSize / 1024);
+    }
+    DWORD handles = 0;
+    if (GetProcessHandleCount(GetCurrentProcess(), &handles)) {
+        stats.open_fds = static_cast<int64_t>(handles);
+    }
+#elif defined(__APPLE__)
+    mach_task_basic_info_data_t info;
+    mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+    if (task_info(mach_task_self(), MACH_TASK_BASIC_INFO,
+                  reinterpret_cast<task_info_t>(&info), &count) == KERN_SUCCESS) {
+        stats.rss_kb = static_cast<int64_t>(info.resident_size / 1024);
+    }
+    thread_act_array_t threads;
+    mach_msg_type_number_t thread_count = 0;
+    if (task_threads(mach_task_self(), &threads, &thread_count) == KERN_SUCCESS) {
+        stats.threads = thread_count;
+        for (mach_msg_type_number_t i = 0; i < thread_count; ++i) {
+            mach_port_deallocate(mach_task_self(), threads[i]);
+        }
+        vm_deallocate(mach_task_self(), reinterpret_cast<vm_address_t>(threads),
+                      thread_count * sizeof(thread_act_t));
+    }
+    stats.open_fds = count_dir_entries("/dev/fd");
+
+    malloc_statistics_t zone;
+    malloc_zone_statistics(nullptr, &zone);
+    stats.heap_in_use = static_cast<int64_t>(zone.size_in_use);
+    stats.heap_free   = static_cast<int64_t>(zone.size_allocated - zone.size_in_use);
+#else
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line)) {
+        if (line.compare(0, 6, "VmRSS:") == 0) {
+            stats.rss_kb = std::stoll(line.substr(6));
+        } else if (line.compare(0, 8, "Threads:") == 0) {
+            stats.threads = std::stoll(line.substr(8));
+        }
+    }
+    stats.open_fds = count_dir_entries("/proc/self/fd");
+
+  #if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+    struct mallinfo2 mi = mallinfo2();
+    stats.heap_in_use = static_cast<int64_t>(mi.uordblks + mi.hblkhd);
+    stats.heap_free   = static_cast<int64_t>(mi.fordblks);
+  #endif
+#endif
+
+    return stats;
+}
+
+// ============================================================================
+// SOCKETS
+// ============================================================================
+
+bool set_tcp_keepalive(socket_t sock, int idle_s, int interval_s, int count, int user_timeout_ms) {
+#ifdef _WIN32
+    (void)count;
+    (void)user_timeout_ms;
+    // Windows fija los probes en 10 (Vista+); solo se controlan los tiempos
+    tcp_keepalive ka{};
+    ka.onoff = 1;
+    ka.keepalivetime = static_cast<ULONG>(idle_s) * 1000;
+    ka.keepaliveinterval = static_cast<ULONG>(interval_s) * 1000;
+    DWORD returned = 0;
+    return WSAIoctl(sock, SIO_KEEPALIVE_VALS, &ka, sizeof(ka), nullptr, 0,
+                    &returned, nullptr, nullptr) == 0;
+#else
+    bool ok = true;
+    int on = 1;
+    ok &= setsockopt(sock, SOL_SOCKET, SO_KEEPALIVE, &on, sizeof(on)) == 0;
+  #if defined(__APPLE__)
+    ok &= setsockopt(sock, IPPROTO_TCP, TCP_KEEPALIVE, &idle_s, sizeof(idle_s)) == 0;
+  #else
+    ok &= setsockopt(sock, IPPROTO_TCP, TCP_KEEPIDLE, &idle_s, sizeof(idle_s)) == 0;
+  #endif
+  #ifdef TCP_KEEPINTVL
+    ok &= setsockopt(sock, IPPROTO_TCP, TCP_KEEPINTVL, &interval_s, sizeof(interval_s)) == 0;
+  #endif
+  #ifdef TCP_KEEPCNT
+    ok &= setsockopt(sock, IPPROTO_TCP, TCP_KEEPCNT, &count, sizeof(count)) == 0;
+  #endif
+  #ifdef TCP_USER_TIMEOUT
+    if (user_timeout_ms > 0) {
+        unsigned int timeout = static_cast<unsigned int>(user_timeout_ms);
+        ok &= setsockopt(sock, IPPROTO_TCP, TCP_USER_TIMEOUT, &timeout, sizeof(timeout)) == 0;
+    }
+  #else
+    (void)user_timeout_ms;
+  #endif
+    return ok;
+#endif
+}
+
+bool set_tcp_nodelay(socket_t sock) {
+    int on = 1;
+    return setsockopt(sock, IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<const char*>(&on), sizeof(on)) == 0;
+}
+
+bool set_recv_timeout(socket_t sock, int timeout_ms) {
+#ifdef _WIN32
+    // Ver platform_utils.h: el timeout lo aplica wait_readable()
+    (void)sock;
+    (void)timeout_ms;
+    return true;
+#else
+    timeval tv{};
+    tv.tv_sec = timeout_ms / 1000;
+    tv.tv_usec = (timeout_ms % 1000) * 1000;
+    return setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv)) == 0;
+#endif
+}
+
+int wait_readable(socket_t sock, int timeout_ms) {
+#ifdef _WIN32
+    fd_set readable;
+    FD_ZERO(&readable);
+    FD_SET(sock, &readable);
+    timeval tv{};
+    tv.tv_sec = timeout_ms / 1000;
+    tv.tv_usec = (timeout_ms % 1000) * 1000;
+    int n = select(0, &readable, nullptr, nullptr, &tv);
+    if (n == SOCKET_ERROR) return WSAGetLastError() == WSAEINTR ? 0 : -1;
+#else
+    pollfd pfd{};
+    pfd.fd = sock;
+    pfd.events = POLLIN;
+    int n = poll(&pfd, 1, timeout_ms);
+    if (n < 0) return errno == EINTR ? 0 : -1;
+#endif
+    return n > 0 ? 1 : 0;
+}
+
+bool last_recv_timed_out() {
+#ifdef _WIN32
+    int err = WSAGetLastError();
+    return err == WSAETIMEDOUT || err == WSAEINTR;
+#else
+    return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+#endif
+}
+
+void shutdown_socket(socket_t sock) {
+#ifdef _WIN32
+    shutdown(sock, SD_BOTH);
+#else
+    shutdown(sock, SHUT_RDWR);
+#endif
+}
+
 } // namespace PlatformUtils
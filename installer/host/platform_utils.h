@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstdint>
 #include <string>
 
 #if defined(_WIN32) || defined(__MINGW32__) || defined(__MINGW64__)
@@ -64,4 +65,76 @@ namespace PlatformUtils {
      * @return Valor del argumento, o string vacío si no existe
      */
     std::string get_cli_argument(int argc, char* argv[], const std::string& flag);
+
+    /**
+     * @brief Muestra de recursos del proceso actual
+     *
+     * Campos en -1 cuando la plataforma no los expone:
+     *   heap_* : glibc >= 2.33 (mallinfo2) y macOS (malloc zones)
+     *   threads: Linux y macOS
+     */
+    struct ProcessStats {
+        int64_t rss_kb         = -1;
+        int64_t open_fds       = -1;   // handles en Windows
+        int64_t threads        = -1;
+        int64_t heap_in_use    = -1;   // bytes entregados por el allocator
+        int64_t heap_free      = -1;   // bytes retenidos por el allocator sin usar
+    };
+
+    /**
+     * @brief Lee RSS, descriptores abiertos, threads y estado del heap
+     *
+     * Linux: /proc/self. No es barato (recorre /proc/self/fd): pensado para
+     * HEARTBEAT / REQUEST_STATS, no para el hot path.
+     */
+    ProcessStats get_process_stats();
+
+    // ========================================================================
+    // SOCKETS
+    // ========================================================================
+
+    /**
+     * @brief Activa TCP keepalive con intervalos propios (no los 2h del SO)
+     * @param idle_s     silencio antes del primer probe
+     * @param interval_s separación entre probes
+     * @param count      probes sin respuesta antes de abortar (ignorado en Windows)
+     * @param user_timeout_ms Linux: TCP_USER_TIMEOUT, datos enviados sin ACK
+     *        como máximo este tiempo (0 = default del kernel)
+     * @return false si el SO rechazó alguna opción (el socket sigue usable)
+     */
+    bool set_tcp_keepalive(socket_t sock, int idle_s, int interval_s, int count, int user_timeout_ms);
+
+    /**
+     * @brief TCP_NODELAY: cada send() sale sin esperar el ACK del anterior
+     *
+     * El link con Brain manda un frame entero por send(); con Nagle un frame
+     * chico detrás de otro sin ACK esperaba el delayed ACK del peer (~40ms).
+     */
+    bool set_tcp_nodelay(socket_t sock);
+
+    /**
+     * @brief SO_RCVTIMEO: recv() retorna con timeout en lugar de bloquear. 0 = sin timeout.
+     *
+     * Solo POSIX. En Windows no hace nada: tras vencer SO_RCVTIMEO Winsock
+     * deja el socket en estado indeterminado y no se puede volver a usar;
+     * ahí se espera con wait_readable() antes de cada recv().
+     */
+    bool set_recv_timeout(socket_t sock, int timeout_ms);
+
+    /**
+     * @brief Espera hasta timeout_ms a que recv() tenga algo que devolver
+     * @return 1 listo (datos, FIN o error pendiente), 0 timeout o EINTR, -1 error
+     */
+    int wait_readable(socket_t sock, int timeout_ms);
+
+    /** El último recv() fallido fue por SO_RCVTIMEO (EAGAIN / WSAETIMEDOUT) o EINTR. */
+    bool last_recv_timed_out();
+
+    /**
+     * @brief shutdown() en ambos sentidos sin cerrar el descriptor
+     *
+     * Despierta a cualquier thread bloqueado en send()/recv() sobre el socket;
+     * close() solo no lo garantiza en Linux.
+     */
+    void shutdown_socket(socket_t sock);
 }  // namespace PlatformUtils
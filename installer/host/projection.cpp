@@ -0,0 +1,554 @@
+#include "projection.h"
+
+#include <chrono>
+#include <cstring>
+
+namespace Projection {
+
+namespace {
+
+// Brain controla la tabla: topes para que una spec rara no cueste memoria
+const size_t MAX_KINDS           = 64;
+const size_t MAX_FIELDS_PER_KIND = 64;
+const size_t MAX_POINTER_DEPTH   = 32;
+const char*  WILDCARD            = "*";
+const char*  META_FIELD          = "_projected";
+
+// Campos de primer nivel que sobreviven a cualquier proyección: sin ellos
+// Brain no sabe qué es el mensaje ni a quién responder
+const char* ENVELOPE_FIELDS[] = {
+    "type", "command", "event", "id", "request_id", "timestamp",
+    "profile_id", "launch_id", "target_profile"
+};
+
+uint64_t now_ns() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+bool is_envelope_field(const std::string& key) {
+    for (const char* f : ENVELOPE_FIELDS) {
+        if (key == f) return true;
+    }
+    return false;
+}
+
+// ----------------------------------------------------------------------------
+// Scanner de primer nivel (scan_envelope)
+// ----------------------------------------------------------------------------
+
+inline void skip_ws(const char*& p, const char* end) {
+    while (p < end && (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r')) p++;
+}
+
+// p apunta a la comilla de apertura; queda después de la de cierre. memchr
+// en vez de byte a byte: los strings largos (html, base64) son casi todo
+bool skip_string(const char*& p, const char* end, bool& escaped) {
+    escaped = false;
+    const char* open = p + 1;
+    const char* from = open;
+    while (from < end) {
+        const char* quote = static_cast<const char*>(std::memchr(from, '"', end - from));
+        if (!quote) return false;
+        if (!escaped && std::memchr(from, '\\', quote - from)) escaped = true;
+
+        // Escapada si la precede una cantidad impar de backslashes
+        size_t backslashes = 0;
+        for (const char* b = quote; b > open && b[-1] == '\\'; --b) backslashes++;
+        if (backslashes % 2 == 0) {
+            p = quote + 1;
+            return true;
+        }
+        from = quote + 1;
+    }
+    return false;
+}
+
+bool skip_value(const char*& p, const char* end) {
+    bool escaped = false;
+    if (p >= end) return false;
+    if (*p == '"') return skip_string(p, end, escaped);
+
+    if (*p == '{' || *p == '[') {
+        int depth = 0;
+        while (p < end) {
+            char c = *p;
+            if (c == '"') {
+                if (!skip_string(p, end, escaped)) return false;
+                continue;
+            }
+            if (c == '{' || c == '[') depth++;
+            else if (c == '}' || c == ']') {
+                if (--depth == 0) {
+                    p++;
+                    return true;
+                }
+            }
+            p++;
+        }
+        return false;
+    }
+
+    // Número, true, false, null
+    while (p < end && *p != ',' && *p != '}' && *p != ']' &&
+           *p != ' ' && *p != '\t' && *p != '\n' && *p != '\r') p++;
+    return true;
+}
+
+// Miembros de primer nivel desde la '{'. Con prefix, data es solo el comienzo
+// del mensaje: el scan termina bien en el primer valor contenedor o que no
+// entra completo, si ya vio un kind (lo que sigue se trata como opaco).
+bool scan_members(const char* p, const char* end, Envelope& env, bool prefix) {
+    skip_ws(p, end);
+    if (p >= end || *p != '{') return false;
+    p++;
+
+    auto stop = [&] { return prefix && !env.kind().empty(); };
+
+    for (;;) {
+        skip_ws(p, end);
+        if (p >= end) return stop();
+        if (*p == '}') return true;
+        if (*p != '"') return false;
+
+        const char* key_start = p + 1;
+        bool escaped = false;
+        if (!skip_string(p, end, escaped)) return stop();
+        std::string key = escaped ? std::string() : std::string(key_start, p - 1);
+
+        skip_ws(p, end);
+        if (p >= end) return stop();
+        if (*p != ':') return false;
+        p++;
+        skip_ws(p, end);
+        if (p >= end) return stop();
+
+        std::string* field = nullptr;
+        if      (key == "command") field = &env.command;
+        else if (key == "type")    field = &env.type;
+        else if (key == "event")   field = &env.event;
+        else if (key == "bloom_chunk") env.has_chunk = true;
+
+        if (prefix && !field && (*p == '{' || *p == '[')) return stop();
+
+        if (field) {
+            if (*p != '"') return false;
+            const char* start = p + 1;
+            if (!skip_string(p, end, escaped) || escaped) return false;
+            field->assign(start, p - 1);
+        } else if (key == "id") {
+            const char* start = p;
+            if (*p == '"') {
+                if (!skip_string(p, end, escaped) || escaped) return false;
+                env.id.assign(start + 1, p - 1);
+            } else {
+                if (!skip_value(p, end)) return false;
+                // Mismo criterio que Correlation::request_key: solo enteros
+                bool integer = p > start;
+                for (const char* c = start; c < p; c++) {
+                    if (!((*c >= '0' && *c <= '9') || (*c == '-' && c == start))) integer = false;
+                }
+                env.id = integer ? std::string(start, p) : std::string();
+            }
+        } else if (!skip_value(p, end)) {
+            return stop();
+        }
+
+        skip_ws(p, end);
+        if (p >= end) return stop();
+        if (*p == ',') {
+            p++;
+            continue;
+        }
+        return *p == '}';
+    }
+}
+
+// ----------------------------------------------------------------------------
+// SAX
+// ----------------------------------------------------------------------------
+
+/**
+ * Arma solo lo seleccionado. Cada contenedor abierto que se conserva es un
+ * Frame; los que no, se cuentan en skip_depth_ y su contenido se descarta sin
+ * construir nada.
+ */
+class ProjectingSax {
+public:
+    using json = nlohmann::json;
+
+    ProjectingSax(const Node& root, json& out) : root_(root), out_(out) {
+        frames_.reserve(16);
+    }
+
+    bool null()                                   { return scalar([] { return json(nullptr); }); }
+    bool boolean(bool v)                          { return scalar([v] { return json(v); }); }
+    bool number_integer(json::number_integer_t v) { return scalar([v] { return json(v); }); }
+    bool number_unsigned(json::number_unsigned_t v) { return scalar([v] { return json(v); }); }
+    bool number_float(json::number_float_t v, const std::string&) { return scalar([v] { return json(v); }); }
+    bool string(std::string& v)                   { return scalar([&v] { return json(std::move(v)); }); }
+    bool binary(json::binary_t& v)                { return scalar([&v] { return json(std::move(v)); }); }
+
+    bool start_object(std::size_t) { return open(true); }
+    bool start_array(std::size_t)  { return open(false); }
+    bool end_object()              { return close(); }
+    bool end_array()               { return close(); }
+
+    bool key(std::string& k) {
+        if (skip_depth_ == 0) frames_.back().key.assign(k);
+        return true;
+    }
+
+    bool parse_error(std::size_t, const std::string&, const nlohmann::detail::exception&) {
+        return false;
+    }
+
+private:
+    struct Frame {
+        json*       target;
+        const Node* node;
+        bool        all;
+        bool        array;
+        size_t      index;       // próximo índice (arrays)
+        std::string key;         // último key (objetos)
+    };
+
+    struct Selection {
+        bool        keep = false;
+        bool        all  = false;
+        const Node* node = nullptr;
+    };
+
+    Selection select_child(Frame& f) {
+        Selection s;
+        size_t index = f.array ? f.index++ : 0;
+        if (f.all) {
+            s.keep = s.all = true;
+            return s;
+        }
+        if (frames_.size() == 1 && is_envelope_field(f.key)) {
+            s.keep = s.all = true;
+            return s;
+        }
+
+        const auto& children = f.node->children;
+        auto it = children.find(WILDCARD);
+        if (it == children.end()) it = children.find(f.array ? std::to_string(index) : f.key);
+        if (it == children.end()) return s;
+
+        s.keep = true;
+        s.all  = it->second.all;
+        s.node = &it->second;
+        return s;
+    }
+
+    json* place(Frame& f, json&& value) {
+        if (f.array) {
+            // Índices explícitos conservan su posición
+            size_t index = f.index - 1;
+            while (f.target->size() < index) f.target->push_back(nullptr);
+            f.target->push_back(std::move(value));
+            return &f.target->back();
+        }
+        json& slot = (*f.target)[f.key];
+        slot = std::move(value);
+        return &slot;
+    }
+
+    template <typename Make>
+    bool scalar(Make make) {
+        if (skip_depth_ > 0) return true;
+        if (frames_.empty()) return false;            // la raíz tiene que ser un objeto
+
+        Frame& parent = frames_.back();
+        Selection s = select_child(parent);
+        // Un pointer que sigue más allá de un escalar no lo selecciona
+        if (s.keep && s.all) place(parent, make());
+        return true;
+    }
+
+    bool open(bool object) {
+        if (skip_depth_ > 0) {
+            skip_depth_++;
+            return true;
+        }
+        if (frames_.empty()) {
+            if (!object) return false;
+            out_ = json::object();
+            frames_.push_back({&out_, &root_, false, false, 0, std::string()});
+            return true;
+        }
+
+        Selection s = select_child(frames_.back());
+        if (!s.keep) {
+            skip_depth_ = 1;
+            return true;
+        }
+        json* target = place(frames_.back(), object ? json::object() : json::array());
+        frames_.push_back({target, s.node, s.all, !object, 0, std::string()});
+        return true;
+    }
+
+    bool close() {
+        if (skip_depth_ > 0) skip_depth_--;
+        else                 frames_.pop_back();
+        return true;
+    }
+
+    const Node&        root_;
+    json&              out_;
+    std::vector<Frame> frames_;
+    size_t             skip_depth_ = 0;
+};
+
+bool validate_node(const Node& node, const std::string& path, std::string& error) {
+    if (node.children.size() > 1 && node.children.count(WILDCARD)) {
+        error = "'*' cannot be mixed with other tokens under '" + path + "'";
+        return false;
+    }
+    for (const auto& kv : node.children) {
+        if (!validate_node(kv.second, path + "/" + kv.first, error)) return false;
+    }
+    return true;
+}
+
+}  // namespace
+
+// ============================================================================
+// SOBRE Y POINTERS
+// ============================================================================
+
+const std::string& Envelope::kind() const {
+    if (!command.empty()) return command;
+    if (!type.empty()) return type;
+    return event;
+}
+
+bool scan_envelope(const char* data, size_t size, Envelope& env) {
+    return scan_members(data, data + size, env, false);
+}
+
+bool scan_envelope_prefix(const char* data, size_t size, Envelope& env) {
+    return scan_members(data, data + size, env, true);
+}
+
+bool parse_pointer(const std::string& pointer, std::vector<std::string>& tokens, std::string& error) {
+    tokens.clear();
+    if (pointer.empty() || pointer[0] != '/') {
+        error = "pointer must start with '/': '" + pointer + "'";
+        return false;
+    }
+
+    std::string token;
+    for (size_t i = 1; i <= pointer.size(); ++i) {
+        if (i == pointer.size() || pointer[i] == '/') {
+            tokens.push_back(token);
+            token.clear();
+            continue;
+        }
+        if (pointer[i] == '~') {
+            char next = i + 1 < pointer.size() ? pointer[i + 1] : '\0';
+            if (next != '0' && next != '1') {
+                error = "invalid escape in '" + pointer + "'";
+                return false;
+            }
+            token += next == '0' ? '~' : '/';
+            i++;
+            continue;
+        }
+        token += pointer[i];
+    }
+
+    if (tokens.size() > MAX_POINTER_DEPTH) {
+        error = "pointer deeper than " + std::to_string(MAX_POINTER_DEPTH) + ": '" + pointer + "'";
+        return false;
+    }
+    return true;
+}
+
+// ============================================================================
+// PROYECCIÓN
+// ============================================================================
+
+bool build_spec(const std::string& kind, const nlohmann::json& fields, Spec& spec, std::string& error) {
+    if (kind.empty()) {
+        error = "missing kind";
+        return false;
+    }
+    if (!fields.is_array()) {
+        error = "fields must be an array of JSON pointers";
+        return false;
+    }
+    if (fields.size() > MAX_FIELDS_PER_KIND) {
+        error = "more than " + std::to_string(MAX_FIELDS_PER_KIND) + " fields";
+        return false;
+    }
+
+    spec = Spec();
+    spec.kind = kind;
+    std::vector<std::string> tokens;
+    for (const auto& field : fields) {
+        if (!field.is_string()) {
+            error = "fields must be strings";
+            return false;
+        }
+        const std::string& pointer = field.get_ref<const std::string&>();
+        if (!parse_pointer(pointer, tokens, error)) return false;
+
+        Node* node = &spec.root;
+        for (const auto& token : tokens) {
+            if (node->all) break;                    // un prefijo ya lo selecciona entero
+            node = &node->children[token];
+        }
+        node->all = true;
+        node->children.clear();
+        spec.fields.push_back(pointer);
+    }
+    return validate_node(spec.root, "", error);
+}
+
+bool project(const Spec& spec, const char* data, size_t size, nlohmann::json& out) {
+    ProjectingSax sax(spec.root, out);
+    if (!nlohmann::json::sax_parse(data, data + size, &sax)) return false;
+    out[META_FIELD] = {{"bytes", size}};
+    return true;
+}
+
+// ============================================================================
+// REGISTRY
+// ============================================================================
+
+void Registry::publish(std::shared_ptr<const Table> table) {
+    {
+        std::lock_guard<std::mutex> lock(stats_mutex_);
+        for (auto it = kind_stats_.begin(); it != kind_stats_.end();) {
+            if (table->count(it->first)) ++it;
+            else it = kind_stats_.erase(it);
+        }
+    }
+    std::lock_guard<std::mutex> lock(table_mutex_);
+    count_.store(table->size(), std::memory_order_relaxed);
+    table_ = std::move(table);
+}
+
+bool Registry::set(const std::string& kind, const nlohmann::json& fields, std::string& error) {
+    auto spec = std::make_shared<Spec>();
+    bool clear = fields.is_array() && fields.empty();
+    bool valid = !kind.empty() && (clear || build_spec(kind, fields, *spec, error));
+    if (!valid) {
+        if (kind.empty()) error = "missing kind";
+        std::lock_guard<std::mutex> lock(stats_mutex_);
+        rejected_++;
+        return false;
+    }
+
+    std::shared_ptr<Table> table;
+    {
+        std::lock_guard<std::mutex> lock(table_mutex_);
+        table = std::make_shared<Table>(*table_);
+    }
+    if (clear) {
+        table->erase(kind);
+    } else {
+        if (!table->count(kind) && table->size() >= MAX_KINDS) {
+            error = "more than " + std::to_string(MAX_KINDS) + " projected kinds";
+            std::lock_guard<std::mutex> lock(stats_mutex_);
+            rejected_++;
+            return false;
+        }
+        (*table)[kind] = spec;
+    }
+    publish(table);
+
+    std::lock_guard<std::mutex> lock(stats_mutex_);
+    updates_++;
+    return true;
+}
+
+void Registry::replace_all(const nlohmann::json& projections, std::vector<std::string>& rejected) {
+    auto table = std::make_shared<Table>();
+    if (projections.is_object()) {
+        for (const auto& item : projections.items()) {
+            std::string error;
+            auto spec = std::make_shared<Spec>();
+            if (table->size() >= MAX_KINDS) {
+                error = "more than " + std::to_string(MAX_KINDS) + " projected kinds";
+            } else if (build_spec(item.key(), item.value(), *spec, error)) {
+                (*table)[item.key()] = spec;
+                continue;
+            }
+            rejected.push_back(item.key() + ": " + error);
+        }
+    }
+    if (!rejected.empty()) {
+        std::lock_guard<std::mutex> lock(stats_mutex_);
+        rejected_ += rejected.size();
+    }
+    publish(table);
+}
+
+SpecPtr Registry::find(const std::string& kind) const {
+    if (kind.empty() || !active()) return nullptr;
+    std::lock_guard<std::mutex> lock(table_mutex_);
+    auto it = table_->find(kind);
+    return it == table_->end() ? nullptr : it->second;
+}
+
+bool Registry::project(const Spec& spec, const char* data, size_t size, nlohmann::json& out) {
+    const uint64_t start = now_ns();
+    bool ok = Projection::project(spec, data, size, out);
+    const uint64_t elapsed = now_ns() - start;
+
+    std::lock_guard<std::mutex> lock(stats_mutex_);
+    if (!ok) fallbacks_++;
+    else     kind_stats_[spec.kind].sax_ns += elapsed;
+    return ok;
+}
+
+void Registry::on_forwarded(const Spec& spec, size_t in_bytes, size_t out_bytes) {
+    std::lock_guard<std::mutex> lock(stats_mutex_);
+    KindStats& s = kind_stats_[spec.kind];
+    s.messages++;
+    s.in_bytes += in_bytes;
+    s.out_bytes += out_bytes;
+}
+
+nlohmann::json Registry::stats_json() const {
+    std::shared_ptr<const Table> table;
+    {
+        std::lock_guard<std::mutex> lock(table_mutex_);
+        table = table_;
+    }
+
+    std::lock_guard<std::mutex> lock(stats_mutex_);
+    uint64_t in_total = 0, out_total = 0;
+    nlohmann::json kinds = nlohmann::json::object();
+    for (const auto& kv : *table) {
+        KindStats s;
+        auto it = kind_stats_.find(kv.first);
+        if (it != kind_stats_.end()) s = it->second;
+        in_total += s.in_bytes;
+        out_total += s.out_bytes;
+        kinds[kv.first] = {
+            {"fields",     kv.second->fields},
+            {"messages",   s.messages},
+            {"in_bytes",   s.in_bytes},
+            {"out_bytes",  s.out_bytes},
+            {"sax_us_avg", s.messages ? s.sax_ns / s.messages / 1000.0 : 0.0}
+        };
+    }
+
+    const uint64_t saved = in_total > out_total ? in_total - out_total : 0;
+    return {
+        {"kinds",       kinds},
+        {"updates",     updates_},
+        {"rejected",    rejected_},
+        {"fallbacks",   fallbacks_},
+        {"in_bytes",    in_total},
+        {"out_bytes",   out_total},
+        {"bytes_saved", saved},
+        {"saved_pct",   in_total ? 100.0 * saved / in_total : 0.0}
+    };
+}
+
+}  // namespace Projection
@@ -0,0 +1,168 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+/**
+ * @brief Proyección de campos registrada por Brain (pushdown al host)
+ *
+ * Las respuestas pesadas de la extensión (DOM_SNAPSHOT, RESPONSE de
+ * tab.query con cientos de tabs...) viajaban enteras aunque Brain mirara
+ * tres campos. Brain registra por kind una lista de JSON Pointers (RFC 6901)
+ * y el host reenvía solo eso:
+ *
+ *   REGISTER_ACK   "projections": {"DOM_SNAPSHOT": ["/url", "/title"], ...}
+ *                  reemplaza la tabla entera (conexión nueva = tabla nueva)
+ *   SET_PROJECTION {"type": "SET_PROJECTION", "kind": K, "fields": [...]}
+ *                  cambia un kind en caliente; "fields": [] lo borra.
+ *                  Contesta PROJECTION_ACK {"kind", "fields", "ok", "error"}
+ *
+ * Los RESPONSE se proyectan por el command que los pidió: "RESPONSE/tab.query"
+ * (command del request pendiente en request_tracker.h) y si no, "RESPONSE".
+ *
+ * El mensaje proyectado se arma con un parser SAX directo desde el texto
+ * crudo: lo que no está seleccionado se recorre pero nunca se materializa
+ * como DOM. Se conservan siempre los campos de sobre (type, command, event,
+ * id, request_id, timestamp, profile_id, launch_id, target_profile) y se
+ * agrega "_projected": {"bytes": N} con el tamaño original.
+ *
+ * Extensión al RFC: el token "*" selecciona todos los elementos de un array
+ * (o miembros de un objeto) y lo que sigue se aplica a cada uno: "*" entre
+ * "/payload/tabs" y "/url" deja solo la url de cada tab. No se puede mezclar
+ * con tokens explícitos bajo el mismo padre. Un índice explícito ("/tabs/2")
+ * conserva la posición rellenando con null.
+ */
+namespace Projection {
+
+    /** Campos de primer nivel leídos sin parsear (scan_envelope). */
+    struct Envelope {
+        std::string command;
+        std::string type;
+        std::string event;
+        std::string id;            // string o el texto del entero
+        bool        has_chunk = false;
+
+        /** Igual que message_kind(): command > type > event. */
+        const std::string& kind() const;
+    };
+
+    /**
+     * @brief Lee los campos de sobre del primer nivel sin construir el DOM
+     * @return false si no es un objeto o algún campo de sobre trae escapes
+     *         o un tipo inesperado (el caller hace el parse completo)
+     */
+    bool scan_envelope(const char* data, size_t size, Envelope& env);
+    inline bool scan_envelope(const std::string& raw, Envelope& env) { return scan_envelope(raw.data(), raw.size(), env); }
+
+    /**
+     * @brief scan_envelope() sobre el comienzo de un mensaje (splice_forward.h)
+     *
+     * Termina en el primer miembro contenedor o que no entra en data. El
+     * sobre tiene que ir antes del payload, como lo arma la extensión; un
+     * command/type/event que aparezca después no se ve.
+     * @return false si no encontró un kind antes de ese punto
+     */
+    bool scan_envelope_prefix(const char* data, size_t size, Envelope& env);
+
+    /** Tokens de un JSON Pointer ("~1" → "/", "~0" → "~"). */
+    bool parse_pointer(const std::string& pointer, std::vector<std::string>& tokens,
+                       std::string& error);
+
+    /** Trie de tokens; all = el subárbol entero queda. */
+    struct Node {
+        bool                        all = false;
+        std::map<std::string, Node> children;
+    };
+
+    struct Spec {
+        std::string              kind;
+        std::vector<std::string> fields;
+        Node                     root;
+    };
+
+    using SpecPtr = std::shared_ptr<const Spec>;
+
+    /**
+     * @brief Arma la spec de un kind
+     * @return false con error si fields no es un array de pointers válidos
+     */
+    bool build_spec(const std::string& kind, const nlohmann::json& fields, Spec& spec,
+                    std::string& error);
+
+    /**
+     * @brief Proyecta raw según spec con el parser SAX
+     * @return false si raw no es un objeto JSON válido
+     */
+    bool project(const Spec& spec, const char* data, size_t size, nlohmann::json& out);
+    inline bool project(const Spec& spec, const std::string& raw, nlohmann::json& out) {
+        return project(spec, raw.data(), raw.size(), out);
+    }
+
+    class Registry {
+    public:
+        Registry() = default;
+
+        Registry(const Registry&) = delete;
+        Registry& operator=(const Registry&) = delete;
+
+        /** SET_PROJECTION: fields vacío borra el kind. */
+        bool set(const std::string& kind, const nlohmann::json& fields, std::string& error);
+
+        /**
+         * @brief "projections" del REGISTER_ACK
+         *
+         * Reemplaza la tabla entera (vacía si el ACK no trae nada). Los kinds
+         * inválidos se saltean y se devuelven en rejected.
+         */
+        void replace_all(const nlohmann::json& projections, std::vector<std::string>& rejected);
+
+        /** Chequeo barato antes de scan_envelope(). */
+        bool active() const { return count_.load(std::memory_order_relaxed) > 0; }
+
+        SpecPtr find(const std::string& kind) const;
+
+        /**
+         * @brief Proyecta y cuenta el tiempo del parse SAX
+         * @return false si raw no se pudo proyectar (el caller parsea completo)
+         */
+        bool project(const Spec& spec, const char* data, size_t size, nlohmann::json& out);
+        bool project(const Spec& spec, const std::string& raw, nlohmann::json& out) {
+            return project(spec, raw.data(), raw.size(), out);
+        }
+
+        /** Bytes que entraron y salieron de un mensaje proyectado y reenviado. */
+        void on_forwarded(const Spec& spec, size_t in_bytes, size_t out_bytes);
+
+        nlohmann::json stats_json() const;
+
+    private:
+        using Table = std::map<std::string, SpecPtr>;
+
+        struct KindStats {
+            uint64_t messages  = 0;
+            uint64_t in_bytes  = 0;
+            uint64_t out_bytes = 0;
+            uint64_t sax_ns    = 0;
+        };
+
+        void publish(std::shared_ptr<const Table> table);
+
+        mutable std::mutex           table_mutex_;
+        std::shared_ptr<const Table> table_ = std::make_shared<Table>();
+        std::atomic<size_t>          count_{0};
+
+        mutable std::mutex           stats_mutex_;
+        std::map<std::string, KindStats> kind_stats_;
+        uint64_t                     updates_   = 0;   // SET_PROJECTION aceptados
+        uint64_t                     rejected_  = 0;   // specs inválidas
+        uint64_t                     fallbacks_ = 0;   // SAX falló, parse completo
+    };
+
+}  // namespace Projection
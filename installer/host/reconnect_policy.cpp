@@ -0,0 +1,100 @@
+#include "reconnect_policy.h"
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+#include "platform_utils.h"
+
+namespace Reconnect {
+
+namespace {
+
+const int READY_POLL_MS = 100;
+const size_t READY_MAX_BYTES = 4096;   // el archivo real tiene ~80 bytes
+
+}  // namespace
+
+// ============================================================================
+// BACKOFF
+// ============================================================================
+
+Backoff::Backoff(int p_base_ms, int p_cap_ms)
+    : base_ms(p_base_ms), cap_ms(p_cap_ms), prev_ms(p_base_ms) {
+    // Semilla distinta por proceso aunque arranquen en el mismo tick
+    std::random_device rd;
+    uint64_t ticks = static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+    std::seed_seq seq{rd(), static_cast<unsigned>(PlatformUtils::get_current_pid()),
+                      static_cast<unsigned>(ticks), static_cast<unsigned>(ticks >> 32)};
+    rng.seed(seq);
+}
+
+int Backoff::next_ms() {
+    int upper = std::min(cap_ms, std::max(base_ms, prev_ms * 3));
+    std::uniform_int_distribution<int> dist(base_ms, upper);
+    prev_ms = dist(rng);
+    return prev_ms;
+}
+
+void Backoff::reset() {
+    prev_ms = base_ms;
+}
+
+int Backoff::spread_ms(int max_ms) {
+    if (max_ms <= 0) return 0;
+    std::uniform_int_distribution<int> dist(0, max_ms);
+    return dist(rng);
+}
+
+// ============================================================================
+// SEÑAL DE READINESS
+// ============================================================================
+
+std::string ready_file_path(const std::string& base_dir) {
+    if (base_dir.empty()) return "";
+#ifdef _WIN32
+    return base_dir + "\\workers\\brain\\brain.ready";
+#else
+    return base_dir + "/workers/brain/brain.ready";
+#endif
+}
+
+std::string read_ready_stamp(const std::string& path) {
+    if (path.empty()) return "";
+    std::ifstream in(path, std::ios::binary);
+    if (!in) return "";
+    std::string stamp(READY_MAX_BYTES, '\0');
+    in.read(&stamp[0], static_cast<std::streamsize>(stamp.size()));
+    stamp.resize(static_cast<size_t>(in.gcount()));
+    return stamp;
+}
+
+WakeReason wait_for_brain(const std::string& path, const std::string& baseline,
+                          int timeout_ms, const std::atomic<bool>& stop) {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+    while (!stop.load()) {
+        auto now = std::chrono::steady_clock::now();
+        if (now >= deadline) return WAKE_TIMER;
+
+        // Brain escribe el archivo con rename atómico: un stamp no vacío y
+        // distinto del previo al connect() fallido es un Brain nuevo escuchando
+        std::string stamp = read_ready_stamp(path);
+        if (!stamp.empty() && stamp != baseline) return WAKE_READY;
+
+        auto left = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - now);
+        std::this_thread::sleep_for(std::min(left, std::chrono::milliseconds(READY_POLL_MS)));
+    }
+    return WAKE_SHUTDOWN;
+}
+
+const char* wake_reason_name(WakeReason reason) {
+    switch (reason) {
+        case WAKE_READY:    return "ready";
+        case WAKE_SHUTDOWN: return "shutdown";
+        default:            return "timer";
+    }
+}
+
+}  // namespace Reconnect
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <random>
+#include <string>
+
+/**
+ * @brief Política de reconexión TCP con Brain
+ *
+ * Backoff con "decorrelated jitter": cada espera es uniforme en
+ * [base, 3 × espera anterior], recortada a cap. Los hosts de todos los
+ * perfiles pierden la conexión en el mismo instante cuando Brain se reinicia;
+ * con el backoff exponencial determinístico reintentaban en lockstep.
+ *
+ * Señal de readiness: Brain escribe <base_dir>/workers/brain/brain.ready
+ * (pid, puerto, timestamp) apenas está escuchando y lo borra al cerrar.
+ * Mientras espera, el host sondea ese archivo y reintenta en cuanto su
+ * contenido cambia, en lugar de dormir hasta 16 s con Brain ya disponible.
+ * Sondear un archivo chico cada READY_POLL_MS es portable (sin inotify /
+ * ReadDirectoryChangesW / kqueue) y barato frente al resto del host.
+ */
+namespace Reconnect {
+
+    class Backoff {
+    public:
+        Backoff(int base_ms, int cap_ms);
+
+        /** Próxima espera en ms. */
+        int next_ms();
+
+        /** Conexión exitosa: la próxima secuencia arranca desde base. */
+        void reset();
+
+        /** Uniforme en [0, max_ms]: dispersión tras la señal de readiness. */
+        int spread_ms(int max_ms);
+
+    private:
+        const int    base_ms;
+        const int    cap_ms;
+        int          prev_ms;
+        std::mt19937 rng;
+    };
+
+    /** <base_dir>/workers/brain/brain.ready, o "" si base_dir está vacío. */
+    std::string ready_file_path(const std::string& base_dir);
+
+    /** Contenido actual del archivo de readiness ("" si no existe). */
+    std::string read_ready_stamp(const std::string& path);
+
+    enum WakeReason { WAKE_TIMER, WAKE_READY, WAKE_SHUTDOWN };
+
+    /**
+     * @brief Espera timeout_ms, o menos si Brain publica readiness nueva
+     * @param baseline stamp tomado ANTES del intento de conexión que falló, así
+     *        una señal escrita entre el connect() y esta llamada no se pierde
+     */
+    WakeReason wait_for_brain(const std::string& path, const std::string& baseline,
+                              int timeout_ms, const std::atomic<bool>& stop);
+
+    const char* wake_reason_name(WakeReason reason);
+
+}  // namespace Reconnect
@@ -0,0 +1,387 @@
+#include "request_tracker.h"
+
+#include <algorithm>
+#include <chrono>
+
+namespace Correlation {
+
+namespace {
+
+// Comandos que la extensión ejecuta sin contestar (executeCommand en background.js)
+const char* NO_REPLY_COMMANDS[] = { "keepalive", "window.close" };
+
+const int      MIN_TIMEOUT_MS = 100;
+const int      MAX_TIMEOUT_MS = 600000;
+const uint64_t TIMER_IDLE_NS  = 1000000000ULL;   // sin pendientes: revisar stop una vez por segundo
+const size_t   MAX_COMMANDS   = 64;              // commands con stats propias; el resto va a "*other*"
+const char*    OTHER_COMMAND  = "*other*";
+const size_t   REPORT_TOP_COMMANDS = 10;
+
+uint64_t now_ns() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+size_t round_up_pow2(size_t n) {
+    size_t p = 8;
+    while (p < n) p <<= 1;
+    return p;
+}
+
+size_t hist_bucket(uint64_t us) {
+    size_t b = 0;
+    while (us > 1 && b + 1 < 32) {
+        us >>= 1;
+        b++;
+    }
+    return b;
+}
+
+}  // namespace
+
+// ============================================================================
+// CLAVES
+// ============================================================================
+
+std::string request_key(const nlohmann::json& msg) {
+    auto it = msg.find("id");
+    if (it == msg.end()) return "";
+    if (it->is_string()) return it->get<std::string>();
+    if (it->is_number_integer()) return it->dump();
+    return "";
+}
+
+uint64_t hash_key(const std::string& key) {
+    uint64_t h = 14695981039346656037ULL;
+    for (unsigned char c : key) {
+        h ^= c;
+        h *= 1099511628211ULL;
+    }
+    return h ? h : 1;
+}
+
+// ============================================================================
+// PENDING TABLE
+// ============================================================================
+
+PendingTable::PendingTable(size_t slots)
+    : slots_(round_up_pow2(slots)), mask_(slots_.size() - 1) {}
+
+size_t PendingTable::locate(uint64_t hash, const std::string& key) const {
+    for (size_t i = hash & mask_, probes = 0; probes < slots_.size(); i = (i + 1) & mask_, ++probes) {
+        const Pending& slot = slots_[i];
+        if (slot.hash == 0) break;
+        if (slot.hash == hash && slot.key == key) return i;
+    }
+    return slots_.size();
+}
+
+PendingTable::InsertResult PendingTable::insert(Pending&& entry) {
+    size_t found = locate(entry.hash, entry.key);
+    if (found != slots_.size()) {
+        slots_[found] = std::move(entry);
+        return REPLACED;
+    }
+    if ((size_ + 1) * 4 > slots_.size() * 3) return FULL;
+
+    size_t i = entry.hash & mask_;
+    size_t probes = 0;
+    while (slots_[i].hash != 0) {
+        i = (i + 1) & mask_;
+        probes++;
+    }
+    slots_[i] = std::move(entry);
+    size_++;
+    max_probe_ = std::max(max_probe_, probes);
+    return INSERTED;
+}
+
+Pending* PendingTable::find(uint64_t hash, const std::string& key) {
+    size_t i = locate(hash, key);
+    return i == slots_.size() ? nullptr : &slots_[i];
+}
+
+const Pending* PendingTable::find(uint64_t hash, const std::string& key) const {
+    size_t i = locate(hash, key);
+    return i == slots_.size() ? nullptr : &slots_[i];
+}
+
+bool PendingTable::take(uint64_t hash, const std::string& key, Pending& out) {
+    size_t i = locate(hash, key);
+    if (i == slots_.size()) return false;
+    out = std::move(slots_[i]);
+    erase_at(i);
+    return true;
+}
+
+void PendingTable::erase_at(size_t hole) {
+    // Backward shift: cada entrada siguiente del cluster cuyo slot "home" no
+    // cae entre el hueco y su posición actual se mueve al hueco
+    for (size_t j = (hole + 1) & mask_; slots_[j].hash != 0; j = (j + 1) & mask_) {
+        size_t home = slots_[j].hash & mask_;
+        bool stays = hole <= j ? (hole < home && home <= j) : (hole < home || home <= j);
+        if (!stays) {
+            slots_[hole] = std::move(slots_[j]);
+            hole = j;
+        }
+    }
+    slots_[hole] = Pending();
+    size_--;
+}
+
+uint64_t PendingTable::take_expired(uint64_t now_ns, std::vector<Pending>& out) {
+    uint64_t next = 0;
+    for (size_t i = 0; i < slots_.size() && size_ > 0;) {
+        Pending& slot = slots_[i];
+        if (slot.hash != 0 && slot.deadline_ns <= now_ns) {
+            // Sin avanzar: el backward shift puede haber traído otra entrada a i
+            out.push_back(std::move(slot));
+            erase_at(i);
+            continue;
+        }
+        if (slot.hash != 0 && (next == 0 || slot.deadline_ns < next)) next = slot.deadline_ns;
+        ++i;
+    }
+    return next;
+}
+
+// ============================================================================
+// TRACKER
+// ============================================================================
+
+Tracker::Tracker(int timeout_ms, size_t slots)
+    : timeout_ms_(std::max(0, timeout_ms)), table_(slots) {
+    commands_.push_back(CommandStats());
+    commands_[0].name = OTHER_COMMAND;
+}
+
+Tracker::~Tracker() {
+    stop();
+}
+
+void Tracker::start(TimeoutFn on_timeout) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (started_ || !enabled()) return;
+    on_timeout_ = std::move(on_timeout);
+    started_ = true;
+    stopping_ = false;
+    timer_ = std::thread(&Tracker::timer_loop, this);
+}
+
+void Tracker::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!started_) return;
+        stopping_ = true;
+    }
+    timer_cv_.notify_all();
+    if (timer_.joinable()) timer_.join();
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    started_ = false;
+}
+
+uint16_t Tracker::command_index(const std::string& command) {
+    auto it = command_ids_.find(command);
+    if (it != command_ids_.end()) return it->second;
+    if (commands_.size() >= MAX_COMMANDS) return 0;
+
+    uint16_t index = static_cast<uint16_t>(commands_.size());
+    commands_.push_back(CommandStats());
+    commands_.back().name = command;
+    command_ids_.emplace(command, index);
+    return index;
+}
+
+std::string Tracker::track(const nlohmann::json& msg, const std::string& command) {
+    if (!enabled() || command.empty()) return "";
+    for (const char* c : NO_REPLY_COMMANDS) {
+        if (command == c) return "";
+    }
+    auto expect = msg.find("expect_response");
+    if (expect != msg.end() && expect->is_boolean() && !expect->get<bool>()) return "";
+
+    std::string key = request_key(msg);
+    if (key.empty()) return "";
+
+    int timeout_ms = timeout_ms_;
+    auto custom = msg.find("timeout_ms");
+    if (custom != msg.end() && custom->is_number()) {
+        timeout_ms = std::clamp(custom->get<int>(), MIN_TIMEOUT_MS, MAX_TIMEOUT_MS);
+    }
+
+    Pending entry;
+    entry.hash = hash_key(key);
+    entry.queued_ns = now_ns();
+    entry.deadline_ns = entry.queued_ns + static_cast<uint64_t>(timeout_ms) * 1000000ULL;
+    entry.numeric_id = msg["id"].is_number_integer();
+    entry.key = key;
+
+    bool wake = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        entry.command = command_index(command);
+        const uint64_t deadline = entry.deadline_ns;
+        const uint16_t cmd = entry.command;
+        switch (table_.insert(std::move(entry))) {
+            case PendingTable::FULL:
+                untracked_full_++;
+                return "";
+            case PendingTable::REPLACED:
+                replaced_++;
+                break;
+            default:
+                break;
+        }
+        commands_[cmd].tracked++;
+        if (next_deadline_ns_ == 0 || deadline < next_deadline_ns_) {
+            next_deadline_ns_ = deadline;
+            wake = true;
+        }
+    }
+    if (wake) timer_cv_.notify_one();
+    return key;
+}
+
+void Tracker::on_written(const std::string& key) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Pending* entry = table_.find(hash_key(key), key);
+    if (entry && entry->written_ns == 0) entry->written_ns = now_ns();
+}
+
+void Tracker::cancel(const std::string& key) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Pending entry;
+    if (table_.take(hash_key(key), key, entry)) {
+        commands_[entry.command].tracked--;
+        cancelled_++;
+    }
+}
+
+bool Tracker::on_response(const nlohmann::json& msg) {
+    if (!enabled()) return false;
+    return on_response_key(request_key(msg));
+}
+
+bool Tracker::on_response_key(const std::string& key) {
+    if (!enabled() || key.empty()) return false;
+
+    uint64_t now = now_ns();
+    std::lock_guard<std::mutex> lock(mutex_);
+    Pending entry;
+    if (!table_.take(hash_key(key), key, entry)) {
+        unmatched_++;
+        return false;
+    }
+
+    // Tiempo de la extensión: desde que el comando salió por stdout. Si el
+    // RESPONSE le ganó al callback del writer, desde que se encoló.
+    uint64_t start = entry.written_ns ? entry.written_ns : entry.queued_ns;
+    uint64_t us = (now - std::min(now, start)) / 1000;
+    CommandStats& st = commands_[entry.command];
+    st.completed++;
+    st.total_us += us;
+    st.max_us = std::max(st.max_us, us);
+    st.hist[hist_bucket(us)]++;
+    return true;
+}
+
+std::string Tracker::pending_command(const std::string& key) const {
+    if (!enabled() || key.empty()) return "";
+    std::lock_guard<std::mutex> lock(mutex_);
+    const Pending* entry = table_.find(hash_key(key), key);
+    return entry ? commands_[entry->command].name : "";
+}
+
+void Tracker::timer_loop() {
+    std::vector<Pending> expired;
+    std::vector<std::string> names;
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    while (!stopping_) {
+        uint64_t now = now_ns();
+        if (next_deadline_ns_ == 0 || now < next_deadline_ns_) {
+            uint64_t wait = next_deadline_ns_ == 0 ? TIMER_IDLE_NS
+                                                   : std::min(TIMER_IDLE_NS, next_deadline_ns_ - now);
+            timer_cv_.wait_for(lock, std::chrono::nanoseconds(wait));
+            continue;
+        }
+
+        expired.clear();
+        names.clear();
+        next_deadline_ns_ = table_.take_expired(now, expired);
+        for (const Pending& entry : expired) {
+            commands_[entry.command].timeouts++;
+            names.push_back(commands_[entry.command].name);
+        }
+
+        lock.unlock();
+        for (size_t i = 0; i < expired.size(); ++i) {
+            uint64_t waited_ms = (now - std::min(now, expired[i].queued_ns)) / 1000000;
+            if (on_timeout_) on_timeout_(expired[i], names[i], waited_ms);
+        }
+        lock.lock();
+    }
+}
+
+nlohmann::json Tracker::stats_json() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    nlohmann::json out;
+    out["enabled"] = enabled();
+    if (!enabled()) return out;
+
+    uint64_t tracked = 0, completed = 0, timeouts = 0;
+    std::vector<const CommandStats*> active;
+    for (const CommandStats& st : commands_) {
+        tracked += st.tracked;
+        completed += st.completed;
+        timeouts += st.timeouts;
+        if (st.tracked > 0) active.push_back(&st);
+    }
+    std::sort(active.begin(), active.end(), [](const CommandStats* a, const CommandStats* b) {
+        return a->tracked > b->tracked;
+    });
+
+    // Percentiles aproximados: límite superior del bucket log2 que los contiene
+    auto percentile_us = [](const CommandStats& st, double pct) -> uint64_t {
+        if (st.completed == 0) return 0;
+        uint64_t rank = static_cast<uint64_t>(st.completed * pct / 100.0);
+        uint64_t seen = 0;
+        for (size_t b = 0; b < HIST_BUCKETS; ++b) {
+            seen += st.hist[b];
+            if (seen > rank) return std::min(st.max_us, uint64_t(2) << b);
+        }
+        return st.max_us;
+    };
+
+    nlohmann::json commands = nlohmann::json::array();
+    for (size_t i = 0; i < active.size() && i < REPORT_TOP_COMMANDS; ++i) {
+        const CommandStats& st = *active[i];
+        commands.push_back({
+            {"command",   st.name},
+            {"tracked",   st.tracked},
+            {"completed", st.completed},
+            {"timeouts",  st.timeouts},
+            {"avg_us",    st.completed ? st.total_us / st.completed : 0},
+            {"p50_us",    percentile_us(st, 50)},
+            {"p99_us",    percentile_us(st, 99)},
+            {"max_us",    st.max_us}
+        });
+    }
+
+    out["timeout_ms"]     = timeout_ms_;
+    out["pending"]        = table_.size();
+    out["capacity"]       = table_.capacity();
+    out["max_probe"]      = table_.max_probe();
+    out["tracked"]        = tracked;
+    out["completed"]      = completed;
+    out["timeouts"]       = timeouts;
+    out["unmatched"]      = unmatched_;
+    out["untracked_full"] = untracked_full_;
+    out["replaced"]       = replaced_;
+    out["cancelled"]      = cancelled_;
+    out["commands"]       = commands;
+    return out;
+}
+
+}  // namespace Correlation
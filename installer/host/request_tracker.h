@@ -0,0 +1,171 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+/**
+ * @brief Correlación request/response Brain → Chrome en el host
+ *
+ * Brain manda comandos con "id" ({"command":"tab.query","id":"req-1",...}) y
+ * la extensión contesta {"type":"RESPONSE","id":"req-1","payload":{...}}. El
+ * host los pasaba sin mirar: nadie sabía cuánto tardaba la extensión ni si
+ * un request se perdía. Ahora:
+ *
+ *   - al rutear un comando con id se registra en una tabla open addressing
+ *     (linear probing, borrado con backward shift) indexada por hash del id;
+ *   - el RESPONSE con ese id cierra la entrada y suma el tiempo de servicio
+ *     de la extensión (desde que el frame salió por stdout) a su command;
+ *   - un thread timer expira las entradas vencidas y el host manda
+ *     REQUEST_TIMEOUT a Brain, que no necesita un timer por request.
+ *
+ * No se registran los comandos sin respuesta (keepalive, window.close) ni los
+ * que traen "expect_response": false. "timeout_ms" en el comando reemplaza el
+ * deadline por defecto (--request-timeout-ms).
+ */
+namespace Correlation {
+
+    /** Id de correlación como string ("" si no hay id string o entero). */
+    std::string request_key(const nlohmann::json& msg);
+
+    /** FNV-1a de 64 bits; nunca 0 (0 marca slot vacío). */
+    uint64_t hash_key(const std::string& key);
+
+    struct Pending {
+        uint64_t    hash        = 0;      // 0 = slot vacío
+        uint64_t    queued_ns   = 0;
+        uint64_t    written_ns  = 0;      // 0 hasta que el writer de stdout lo escribe
+        uint64_t    deadline_ns = 0;
+        uint16_t    command     = 0;      // índice en la tabla de commands del Tracker
+        bool        numeric_id  = false;
+        std::string key;
+    };
+
+    /**
+     * @brief Tabla hash de capacidad fija (potencia de 2)
+     *
+     * Sin tombstones: al borrar se corren hacia atrás las entradas del mismo
+     * cluster, así una tabla con mucho churn no degrada las búsquedas.
+     */
+    class PendingTable {
+    public:
+        enum InsertResult { INSERTED, REPLACED, FULL };
+
+        explicit PendingTable(size_t slots);
+
+        /** FULL por encima de 3/4 de ocupación: el request sigue sin trackear. */
+        InsertResult insert(Pending&& entry);
+
+        Pending*       find(uint64_t hash, const std::string& key);
+        const Pending* find(uint64_t hash, const std::string& key) const;
+        bool     take(uint64_t hash, const std::string& key, Pending& out);
+
+        /**
+         * @brief Saca las entradas con deadline_ns <= now
+         * @return deadline más próximo de las que quedan (0 si está vacía)
+         */
+        uint64_t take_expired(uint64_t now_ns, std::vector<Pending>& out);
+
+        size_t size()      const { return size_; }
+        size_t capacity()  const { return slots_.size(); }
+        size_t max_probe() const { return max_probe_; }
+
+    private:
+        size_t locate(uint64_t hash, const std::string& key) const;
+        void   erase_at(size_t index);
+
+        std::vector<Pending> slots_;
+        size_t               mask_;
+        size_t               size_      = 0;
+        size_t               max_probe_ = 0;
+    };
+
+    class Tracker {
+    public:
+        /** Corre en el thread del timer, sin el lock tomado. */
+        using TimeoutFn = std::function<void(const Pending& entry, const std::string& command,
+                                             uint64_t waited_ms)>;
+
+        /** timeout_ms = 0 desactiva la correlación. */
+        Tracker(int timeout_ms, size_t slots);
+        ~Tracker();
+
+        Tracker(const Tracker&) = delete;
+        Tracker& operator=(const Tracker&) = delete;
+
+        /** Override de --request-timeout-ms. Solo antes de start(). */
+        void set_timeout_ms(int timeout_ms) { timeout_ms_ = timeout_ms > 0 ? timeout_ms : 0; }
+
+        bool enabled()    const { return timeout_ms_ > 0; }
+        int  timeout_ms() const { return timeout_ms_; }
+
+        void start(TimeoutFn on_timeout);
+        void stop();
+
+        /**
+         * @brief Comando Brain → Chrome a punto de encolarse
+         * @return key a pasar a on_written() / cancel(), "" si no se registra
+         */
+        std::string track(const nlohmann::json& msg, const std::string& command);
+
+        /** El writer de stdout terminó de escribir el comando. */
+        void on_written(const std::string& key);
+
+        /** El comando no llegó a encolarse (MSG_TOO_BIG, cola detenida). */
+        void cancel(const std::string& key);
+
+        /** RESPONSE de Chrome. @return true si cerró un request pendiente */
+        bool on_response(const nlohmann::json& msg);
+
+        /** on_response() con el id ya extraído (RESPONSE reenviado sin parsear). */
+        bool on_response_key(const std::string& key);
+
+        /** Command del request pendiente con esa key, "" si no hay. No lo cierra. */
+        std::string pending_command(const std::string& key) const;
+
+        nlohmann::json stats_json() const;
+
+    private:
+        static const size_t HIST_BUCKETS = 32;   // log2 de µs
+
+        struct CommandStats {
+            std::string name;
+            uint64_t    tracked   = 0;
+            uint64_t    completed = 0;
+            uint64_t    timeouts  = 0;
+            uint64_t    total_us  = 0;
+            uint64_t    max_us    = 0;
+            uint64_t    hist[HIST_BUCKETS] = {};
+        };
+
+        uint16_t command_index(const std::string& command);
+        void     timer_loop();
+
+        int                      timeout_ms_;
+        TimeoutFn                on_timeout_;
+
+        mutable std::mutex       mutex_;
+        std::condition_variable  timer_cv_;
+        std::thread              timer_;
+        bool                     started_  = false;
+        bool                     stopping_ = false;
+        uint64_t                 next_deadline_ns_ = 0;
+
+        PendingTable             table_;
+        std::vector<CommandStats> commands_;
+        std::unordered_map<std::string, uint16_t> command_ids_;
+
+        uint64_t                 untracked_full_  = 0;   // tabla llena
+        uint64_t                 replaced_        = 0;   // id reutilizado con el anterior pendiente
+        uint64_t                 unmatched_       = 0;   // RESPONSE sin request (tardío o no trackeado)
+        uint64_t                 cancelled_       = 0;
+    };
+
+}  // namespace Correlation
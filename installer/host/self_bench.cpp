@@ -0,0 +1,316 @@
+#include "self_bench.h"
+#include "build_info.h"
+#include "chunked_buffer.h"
+#include "message_utils.h"
+#include "platform_utils.h"
+#include "synapse_logger.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <functional>
+#include <iostream>
+#include <nlohmann/json.hpp>
+#include <thread>
+
+#ifdef _WIN32
+    #include <fcntl.h>
+    #include <io.h>
+#else
+    #include <fcntl.h>
+    #include <unistd.h>
+#endif
+
+namespace SelfBench {
+
+namespace {
+
+const size_t MAX_CHROME_MSG_SIZE = 1020000;   // mismo límite que bloom-host.cpp
+const size_t FRAME_SIZES[]       = {256, 4096, 65536};
+const size_t CHUNK_TOTAL         = 1024 * 1024;
+const size_t CHUNK_BYTES         = 256 * 1024;
+
+volatile size_t g_sink = 0;
+inline void consume(size_t v) { g_sink = g_sink + v; }
+
+uint64_t now_ns() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+/**
+ * Repite op en lotes crecientes hasta cubrir MIN_TIME_MS (tras un lote de
+ * calentamiento). bytes_per_op > 0 habilita MB/s.
+ */
+Result measure(const std::string& name, size_t bytes_per_op, const std::function<void()>& op) {
+    op();
+
+    const uint64_t budget_ns = static_cast<uint64_t>(MIN_TIME_MS) * 1000000ULL;
+    uint64_t iterations = 0, elapsed = 0, batch = 1;
+    uint64_t start = now_ns();
+    while (elapsed < budget_ns) {
+        for (uint64_t i = 0; i < batch; ++i) op();
+        iterations += batch;
+        elapsed = now_ns() - start;
+        if (batch < (1u << 16)) batch *= 2;
+    }
+
+    Result r;
+    r.name        = name;
+    r.iterations  = iterations;
+    r.ns_per_op   = static_cast<double>(elapsed) / iterations;
+    r.ops_per_sec = 1e9 / r.ns_per_op;
+    r.mb_per_sec  = bytes_per_op ? (bytes_per_op * r.ops_per_sec) / (1024.0 * 1024.0) : 0;
+    return r;
+}
+
+std::string make_payload(size_t size) {
+    std::string head = "{\"command\":\"tab.query\",\"id\":\"req-1\",\"profile_id\":"
+                       "\"11111111-2222-3333-4444-555555555555\",\"payload\":{\"text\":\"";
+    std::string tail = "\"}}";
+    size_t pad = size > head.size() + tail.size() ? size - head.size() - tail.size() : 0;
+    return head + std::string(pad, 'x') + tail;
+}
+
+std::string base64_encode(const std::string& data) {
+    static const char table[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    std::string out;
+    out.reserve(((data.size() + 2) / 3) * 4);
+    size_t i = 0;
+    for (; i + 2 < data.size(); i += 3) {
+        uint32_t n = (uint8_t(data[i]) << 16) | (uint8_t(data[i + 1]) << 8) | uint8_t(data[i + 2]);
+        out += table[(n >> 18) & 63]; out += table[(n >> 12) & 63];
+        out += table[(n >> 6) & 63];  out += table[n & 63];
+    }
+    if (i < data.size()) {
+        uint32_t n = uint8_t(data[i]) << 16;
+        if (i + 1 < data.size()) n |= uint8_t(data[i + 1]) << 8;
+        out += table[(n >> 18) & 63]; out += table[(n >> 12) & 63];
+        out += (i + 1 < data.size()) ? table[(n >> 6) & 63] : '=';
+        out += '=';
+    }
+    return out;
+}
+
+/** Silencia fd 2 mientras vive: log_native duplica cada línea a stderr. */
+class StderrSilencer {
+public:
+    StderrSilencer() {
+        std::cerr.flush();
+#ifdef _WIN32
+        saved = _dup(2);
+        int null_fd = _open("NUL", _O_WRONLY);
+        if (null_fd >= 0) { _dup2(null_fd, 2); _close(null_fd); }
+#else
+        saved = dup(2);
+        int null_fd = open("/dev/null", O_WRONLY);
+        if (null_fd >= 0) { dup2(null_fd, 2); close(null_fd); }
+#endif
+    }
+    ~StderrSilencer() {
+        std::cerr.flush();
+        if (saved < 0) return;
+#ifdef _WIN32
+        _dup2(saved, 2);
+        _close(saved);
+#else
+        dup2(saved, 2);
+        close(saved);
+#endif
+    }
+private:
+    int saved = -1;
+};
+
+// ============================================================================
+// CARGAS
+// ============================================================================
+
+void bench_framing(std::vector<Result>& results) {
+    for (size_t size : FRAME_SIZES) {
+        std::string payload = make_payload(size);
+        std::string frame;
+        std::string decoded;
+        std::string suffix = "/" + std::to_string(size);
+
+        // Native Messaging: longitud little-endian nativa (igual que write_message_to_chrome)
+        results.push_back(measure("framing/encode_le" + suffix, payload.size(), [&] {
+            uint32_t len = static_cast<uint32_t>(payload.size());
+            frame.resize(4 + payload.size());
+            std::memcpy(&frame[0], &len, 4);
+            std::memcpy(&frame[4], payload.data(), payload.size());
+            consume(frame.size());
+        }));
+        results.push_back(measure("framing/decode_le" + suffix, payload.size(), [&] {
+            uint32_t len = 0;
+            std::memcpy(&len, frame.data(), 4);
+            if (len > 0 && len <= MAX_CHROME_MSG_SIZE) decoded.assign(frame.data() + 4, len);
+            consume(decoded.size());
+        }));
+
+        // Brain: longitud big-endian (htonl / ntohl)
+        results.push_back(measure("framing/encode_be" + suffix, payload.size(), [&] {
+            uint32_t len = htonl(static_cast<uint32_t>(payload.size()));
+            frame.resize(4 + payload.size());
+            std::memcpy(&frame[0], &len, 4);
+            std::memcpy(&frame[4], payload.data(), payload.size());
+            consume(frame.size());
+        }));
+        results.push_back(measure("framing/decode_be" + suffix, payload.size(), [&] {
+            uint32_t len = 0;
+            std::memcpy(&len, frame.data(), 4);
+            decoded.assign(frame.data() + 4, ntohl(len));
+            consume(decoded.size());
+        }));
+    }
+}
+
+void bench_chunks(std::vector<Result>& results) {
+    std::string payload = make_payload(CHUNK_TOTAL);
+    size_t total_chunks = (payload.size() + CHUNK_BYTES - 1) / CHUNK_BYTES;
+
+    // Frames tal como llegan por stdin; cada iteración los parsea como el host.
+    std::vector<std::string> frames;
+    frames.push_back("{\"bloom_chunk\":{\"type\":\"header\",\"message_id\":\"selfbench\",\"total_chunks\":" +
+                     std::to_string(total_chunks) + ",\"total_size_bytes\":" + std::to_string(payload.size()) + "}}");
+    for (size_t i = 0; i < total_chunks; ++i) {
+        frames.push_back("{\"bloom_chunk\":{\"type\":\"data\",\"message_id\":\"selfbench\",\"seq\":" +
+                         std::to_string(i) + ",\"total\":" + std::to_string(total_chunks) + ",\"data\":\"" +
+                         base64_encode(payload.substr(i * CHUNK_BYTES, CHUNK_BYTES)) + "\"}}");
+    }
+    std::vector<uint8_t> raw(payload.begin(), payload.end());
+    frames.push_back("{\"bloom_chunk\":{\"type\":\"footer\",\"message_id\":\"selfbench\",\"checksum_verify\":\"" +
+                     ChunkedMessageBuffer::calculate_sha256(raw) + "\"}}");
+
+    ChunkedMessageBuffer buffer;
+    bool ok = true;
+    results.push_back(measure("chunk/reassemble_1M", payload.size(), [&] {
+        ChunkedMessageBuffer::Processed r;
+        for (const auto& f : frames) {
+            r = buffer.process_chunk(nlohmann::json::parse(f));
+        }
+        ok = ok && r.result == ChunkedMessageBuffer::COMPLETE_VALID;
+        consume(r.message.size());
+    }));
+    if (!ok) results.back().name += " (CHECKSUM_FAIL)";
+
+    std::vector<uint8_t> data(CHUNK_BYTES, 0x5a);
+    results.push_back(measure("chunk/sha256_256K", data.size(), [&] {
+        consume(ChunkedMessageBuffer::calculate_sha256(data).size());
+    }));
+    std::string encoded = base64_encode(std::string(CHUNK_BYTES, 'z'));
+    results.push_back(measure("chunk/base64_decode_256K", CHUNK_BYTES, [&] {
+        consume(ChunkedMessageBuffer::base64_decode(encoded).size());
+    }));
+}
+
+void bench_routing(std::vector<Result>& results) {
+    for (size_t size : {size_t(1024), size_t(65536)}) {
+        std::string msg = make_payload(size);
+        results.push_back(measure("route/chrome_msg/" + std::to_string(size), msg.size(), [&] {
+            nlohmann::json parsed = nlohmann::json::parse(msg);
+            std::string command = MessageUtils::json_get_string_safe(parsed, "command");
+            std::string type    = MessageUtils::json_get_string_safe(parsed, "type");
+            std::string kind    = MessageUtils::message_kind(parsed, command, type);
+            std::string forwarded = parsed.dump();
+            consume(kind.size() + forwarded.size());
+        }));
+    }
+    std::string big = make_payload(65536);
+    results.push_back(measure("route/profile_id_scan/65536", big.size(), [&] {
+        std::string out;
+        consume(MessageUtils::extract_profile_id_from_raw(big, out) ? out.size() : 0);
+    }));
+}
+
+void bench_logger(std::vector<Result>& results) {
+    std::error_code ec;
+    std::filesystem::path dir = std::filesystem::temp_directory_path(ec) /
+                                ("bloom-host-selfbench-" + std::to_string(PlatformUtils::get_current_pid()));
+    if (ec) return;
+
+    {
+        StderrSilencer silence;
+        SynapseLogManager logger;
+        logger.set_user_base_dir(dir.string());
+        logger.initialize("00000000-0000-4000-8000-5e1fbe0c0000", "000_selfbench");
+        if (logger.is_ready()) {
+            std::string line = "CHROME_MSG command=tab.query type= size=1024";
+            results.push_back(measure("log/log_native", line.size(), [&] {
+                logger.log_native("INFO", line);
+            }));
+            results.push_back(measure("log/log_browser", line.size(), [&] {
+                logger.log_browser("INFO", line);
+            }));
+        }
+    }
+    std::filesystem::remove_all(dir, ec);
+}
+
+}  // namespace
+
+// ============================================================================
+// API
+// ============================================================================
+
+std::vector<Result> run_all() {
+    std::vector<Result> results;
+    bench_framing(results);
+    bench_chunks(results);
+    bench_routing(results);
+    bench_logger(results);
+    return results;
+}
+
+int run(bool as_json) {
+    if (!as_json) {
+        std::cout << "=== BLOOM-HOST SELF BENCHMARK ===" << std::endl << std::endl;
+    }
+
+    std::vector<Result> results = run_all();
+
+    if (as_json) {
+        nlohmann::json out;
+        out["application"] = "bloom-host";
+        out["version"]     = "2.1.0";
+        out["build"]       = BUILD_NUMBER;
+#if defined(_WIN32)
+        out["os"]          = "Windows";
+#elif defined(__APPLE__)
+        out["os"]          = "macOS";
+#else
+        out["os"]          = "Linux";
+#endif
+        out["hardware_threads"] = std::thread::hardware_concurrency();
+        out["min_time_ms"] = MIN_TIME_MS;
+        out["results"]     = nlohmann::json::array();
+        for (const auto& r : results) {
+            out["results"].push_back({
+                {"name",        r.name},
+                {"iterations",  r.iterations},
+                {"ns_per_op",   r.ns_per_op},
+                {"ops_per_sec", r.ops_per_sec},
+                {"mb_per_sec",  r.mb_per_sec}
+            });
+        }
+        std::cout << out.dump(2) << std::endl;
+    } else {
+        std::printf("%-32s %14s %14s %12s\n", "workload", "ns/op", "ops/s", "MB/s");
+        for (const auto& r : results) {
+            if (r.mb_per_sec > 0) {
+                std::printf("%-32s %14.1f %14.0f %12.1f\n", r.name.c_str(), r.ns_per_op, r.ops_per_sec, r.mb_per_sec);
+            } else {
+                std::printf("%-32s %14.1f %14.0f %12s\n", r.name.c_str(), r.ns_per_op, r.ops_per_sec, "-");
+            }
+        }
+        std::cout << std::endl << "bloom-host 2.1.0 build " << BUILD_NUMBER << std::endl;
+    }
+
+    for (const auto& r : results) {
+        if (r.name.find("FAIL") != std::string::npos) return 1;
+    }
+    return 0;
+}
+
+}  // namespace SelfBench
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Auto-benchmark in-process: `bloom-host --bench [--json]`
+ *
+ * Corre micro-cargas sobre el código real del host, sin Chrome ni Brain,
+ * para comparar rendimiento entre máquinas de clientes y entre builds:
+ *
+ *   framing/... encode/decode de frames Native Messaging (LE) y Brain (BE)
+ *   chunk/...   reensamblado bloom_chunk completo (parse + base64 + SHA-256)
+ *   route/...   parse JSON + message_kind + dump (camino handle_chrome_message)
+ *   log/...     SynapseLogManager::log_native contra un directorio temporal
+ *
+ * Cada carga se repite hasta cubrir SelfBench::MIN_TIME_MS. Tarda ~6 s.
+ */
+namespace SelfBench {
+
+    constexpr int MIN_TIME_MS = 250;
+
+    struct Result {
+        std::string name;
+        uint64_t    iterations   = 0;
+        double      ns_per_op    = 0;
+        double      ops_per_sec  = 0;
+        double      mb_per_sec   = 0;   // 0 si la carga no procesa bytes
+    };
+
+    /** Ejecuta todas las cargas en orden. */
+    std::vector<Result> run_all();
+
+    /**
+     * @brief Punto de entrada de `--bench`
+     * @param as_json true: un objeto JSON en stdout; false: tabla
+     * @return exit code (0 = ok)
+     */
+    int run(bool as_json);
+
+}  // namespace SelfBench
@@ -0,0 +1,213 @@
+#include "splice_forward.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+
+#ifdef __linux__
+    #include <fcntl.h>
+    #include <sys/socket.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+namespace Splice {
+
+namespace {
+
+const size_t PIPE_BYTES    = 1024 * 1024;   // F_SETPIPE_SZ del pipe interno (se acepta menos)
+const size_t DISCARD_CHUNK = 64 * 1024;
+
+uint64_t now_ns() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+}  // namespace
+
+#ifdef __linux__
+
+bool supported() { return true; }
+
+Forwarder::Forwarder(size_t min_bytes) : min_bytes_(min_bytes) {}
+
+Forwarder::~Forwarder() {
+    if (pipe_[0] >= 0) ::close(pipe_[0]);
+    if (pipe_[1] >= 0) ::close(pipe_[1]);
+}
+
+bool Forwarder::open(int in_fd, std::string& error) {
+    struct stat st;
+    if (fstat(in_fd, &st) != 0) {
+        error = "fstat failed (errno " + std::to_string(errno) + ")";
+        return false;
+    }
+    if (S_ISFIFO(st.st_mode)) {
+        direct_ = true;
+    } else if (S_ISREG(st.st_mode) || S_ISSOCK(st.st_mode)) {
+        if (pipe2(pipe_, O_CLOEXEC) != 0) {
+            error = "pipe2 failed (errno " + std::to_string(errno) + ")";
+            return false;
+        }
+        fcntl(pipe_[1], F_SETPIPE_SZ, static_cast<int>(PIPE_BYTES));
+        int size = fcntl(pipe_[1], F_GETPIPE_SZ);
+        pipe_bytes_ = size > 0 ? static_cast<size_t>(size) : 65536;
+    } else {
+        error = "input is not a pipe, file or socket";
+        return false;
+    }
+    in_fd_ = in_fd;
+    return true;
+}
+
+// Vacía lo que quedó en el pipe interno cuando el socket falló a mitad
+void Forwarder::drain_pipe(size_t bytes) {
+    char buf[4096];
+    while (bytes > 0) {
+        ssize_t n = ::read(pipe_[0], buf, std::min(bytes, sizeof(buf)));
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return;
+        bytes -= static_cast<size_t>(n);
+    }
+}
+
+bool Forwarder::pump(int out_fd, size_t bytes, size_t& consumed) {
+    uint64_t calls = 0;
+    bool ok = true;
+    while (consumed < bytes) {
+        if (direct_) {
+            ssize_t n = splice(in_fd_, nullptr, out_fd, nullptr, bytes - consumed, SPLICE_F_MOVE);
+            calls++;
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) {
+                ok = false;
+                break;
+            }
+            consumed += static_cast<size_t>(n);
+            continue;
+        }
+
+        ssize_t in = splice(in_fd_, nullptr, pipe_[1], nullptr, std::min(bytes - consumed, pipe_bytes_),
+                            SPLICE_F_MOVE);
+        calls++;
+        if (in < 0 && errno == EINTR) continue;
+        if (in <= 0) {
+            ok = false;
+            break;
+        }
+        consumed += static_cast<size_t>(in);
+
+        size_t left = static_cast<size_t>(in);
+        while (left > 0) {
+            ssize_t out = splice(pipe_[0], nullptr, out_fd, nullptr, left, SPLICE_F_MOVE);
+            calls++;
+            if (out < 0 && errno == EINTR) continue;
+            if (out <= 0) break;
+            left -= static_cast<size_t>(out);
+        }
+        if (left > 0) {
+            drain_pipe(left);
+            ok = false;
+            break;
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(stats_mutex_);
+    calls_ += calls;
+    return ok;
+}
+
+bool Forwarder::send_frame(int sock, const std::string& head, size_t body_bytes, size_t& consumed) {
+    const uint64_t start = now_ns();
+    consumed = 0;
+
+    // Header y prefijo en un solo segmento con lo que sigue (MSG_MORE)
+    bool ok = true;
+    size_t sent = 0;
+    while (sent < head.size()) {
+        ssize_t n = ::send(sock, head.data() + sent, head.size() - sent, MSG_MORE | MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) {
+            ok = false;
+            break;
+        }
+        sent += static_cast<size_t>(n);
+    }
+    if (ok) ok = pump(sock, body_bytes, consumed);
+
+    std::lock_guard<std::mutex> lock(stats_mutex_);
+    if (ok) {
+        frames_++;
+        bytes_ += head.size() + body_bytes;
+        ns_total_ += now_ns() - start;
+    } else {
+        failed_++;
+    }
+    return ok;
+}
+
+size_t Forwarder::discard(size_t bytes) {
+    char buf[DISCARD_CHUNK];
+    size_t done = 0;
+    while (done < bytes) {
+        ssize_t n = ::read(in_fd_, buf, std::min(bytes - done, sizeof(buf)));
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) break;
+        done += static_cast<size_t>(n);
+    }
+    std::lock_guard<std::mutex> lock(stats_mutex_);
+    discarded_bytes_ += done;
+    return done;
+}
+
+#else  // !__linux__
+
+bool supported() { return false; }
+
+Forwarder::Forwarder(size_t min_bytes) : min_bytes_(min_bytes) {}
+
+Forwarder::~Forwarder() {}
+
+bool Forwarder::open(int, std::string& error) {
+    error = "splice(2) requires Linux";
+    return false;
+}
+
+void Forwarder::drain_pipe(size_t) {}
+
+bool Forwarder::pump(int, size_t, size_t&) { return false; }
+
+bool Forwarder::send_frame(int, const std::string&, size_t, size_t& consumed) {
+    consumed = 0;
+    return false;
+}
+
+size_t Forwarder::discard(size_t) { return 0; }
+
+#endif  // __linux__
+
+void Forwarder::on_skipped(const char* reason) {
+    std::lock_guard<std::mutex> lock(stats_mutex_);
+    skipped_[reason]++;
+}
+
+nlohmann::json Forwarder::stats_json() const {
+    std::lock_guard<std::mutex> lock(stats_mutex_);
+    nlohmann::json skipped = nlohmann::json::object();
+    for (const auto& kv : skipped_) skipped[kv.first] = kv.second;
+
+    return {
+        {"enabled",         enabled()},
+        {"min_bytes",       min_bytes_},
+        {"mode",            !enabled() ? "off" : direct_ ? "pipe" : "internal_pipe"},
+        {"frames",          frames_},
+        {"bytes",           bytes_},
+        {"splice_calls",    calls_},
+        {"failed",          failed_},
+        {"discarded_bytes", discarded_bytes_},
+        {"skipped",         skipped},
+        {"mb_per_s",        ns_total_ ? bytes_ / (ns_total_ / 1e9) / 1e6 : 0.0}
+    };
+}
+
+}  // namespace Splice
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <nlohmann/json.hpp>
+
+/**
+ * @brief Reenvío de frames Chrome → Brain sin pasar por memoria (splice(2), Linux)
+ *
+ * Un frame grande que el host no necesita mirar (un RESPONSE con un DOM, un
+ * upload) se copiaba del kernel a un buffer, a un std::string, a un DOM de
+ * nlohmann y de vuelta a un string para el socket. Con el fast path el host
+ * lee solo el header de longitud y un prefijo corto (--splice N: frames de
+ * al menos N bytes; desactivado si no se pasa):
+ *
+ *   - el prefijo alcanza para el sobre (Projection::scan_envelope_prefix):
+ *     kind, id, bloom_chunk. La extensión manda event/type/command antes del
+ *     payload;
+ *   - si ninguna etapa necesita el cuerpo (dedup, delta, proyección,
+ *     suscripción con "where", logs, chunks, handshake, --capture), el header
+ *     se reescribe a big endian, se manda junto con el prefijo y el resto va
+ *     de stdin al socket con splice(2);
+ *   - si no, el caller lee el resto y sigue por el camino de siempre.
+ *
+ * Si stdin es un pipe (Chrome, el bench) el splice va directo pipe → socket;
+ * si es un archivo o socket pasa por un pipe interno. Brain → Chrome no usa
+ * este camino: esos frames tienen el tope de 1 MB de Chrome y el host los
+ * inspecciona todos (handshake, request tracking).
+ *
+ * El frame spliceado no se valida como JSON: llega a Brain tal cual lo
+ * mandó la extensión (el camino normal lo re-serializa). Por eso main() solo
+ * lo abre con --validate-frames off, y con el validador activo el host no
+ * splicea ningún frame (skipped "validate").
+ *
+ * Solo el thread de stdin llama a send_frame() / discard(); stats_json()
+ * puede llamarse desde cualquier thread.
+ */
+namespace Splice {
+
+    /** true si el build tiene splice(2). */
+    bool supported();
+
+    class Forwarder {
+    public:
+        /** min_bytes = 0 desactiva el fast path. */
+        explicit Forwarder(size_t min_bytes);
+        ~Forwarder();
+
+        Forwarder(const Forwarder&) = delete;
+        Forwarder& operator=(const Forwarder&) = delete;
+
+        /** Override de --splice. Solo antes de open(). */
+        void set_min_bytes(size_t min_bytes) { min_bytes_ = min_bytes; }
+
+        /**
+         * @brief Prepara la entrada (stdin) para splice
+         * @return false con error si no se puede (queda desactivado)
+         */
+        bool open(int in_fd, std::string& error);
+
+        bool   enabled()   const { return in_fd_ >= 0 && min_bytes_ > 0; }
+        size_t min_bytes() const { return min_bytes_; }
+
+        /**
+         * @brief Escribe en sock head (header + prefijo ya leído) y body_bytes más de la entrada
+         * @param consumed bytes del cuerpo que salieron de la entrada
+         * @return false si el frame quedó cortado (socket caído o EOF en la entrada)
+         */
+        bool send_frame(int sock, const std::string& head, size_t body_bytes, size_t& consumed);
+
+        /** Lee y tira bytes de la entrada. @return los descartados (menos = EOF) */
+        size_t discard(size_t bytes);
+
+        /** Frame grande que siguió por el camino normal; reason va a stats. */
+        void on_skipped(const char* reason);
+
+        nlohmann::json stats_json() const;
+
+    private:
+        bool   pump(int out_fd, size_t bytes, size_t& consumed);
+        void   drain_pipe(size_t bytes);
+
+        size_t min_bytes_;
+        int    in_fd_    = -1;
+        bool   direct_   = false;     // la entrada ya es un pipe
+        int    pipe_[2]  = {-1, -1};  // pipe interno si no lo es
+        size_t pipe_bytes_ = 0;
+
+        mutable std::mutex stats_mutex_;
+        uint64_t frames_          = 0;
+        uint64_t bytes_           = 0;
+        uint64_t calls_           = 0;   // syscalls splice()
+        uint64_t failed_          = 0;
+        uint64_t discarded_bytes_ = 0;
+        uint64_t ns_total_        = 0;
+        std::map<std::string, uint64_t> skipped_;
+    };
+
+}  // namespace Splice
@@ -0,0 +1,301 @@
+#include "subscription_filter.h"
+
+#include <algorithm>
+
+#include "admission_control.h"
+
+namespace Subscription {
+
+namespace {
+
+const size_t MAX_FILTERS          = 64;
+const size_t MAX_KINDS_PER_FILTER = 64;
+const size_t MAX_PREDICATES       = 8;
+const size_t MAX_DROP_KINDS       = 128;   // kinds con contador de descartes propio
+const size_t STATS_TOP_KINDS      = 10;
+const char*  ANY_KIND             = "*";
+
+bool parse_op(const std::string& name, Predicate::Op& op) {
+    if      (name == "eq")     op = Predicate::EQ;
+    else if (name == "ne")     op = Predicate::NE;
+    else if (name == "in")     op = Predicate::IN;
+    else if (name == "prefix") op = Predicate::PREFIX;
+    else if (name == "exists") op = Predicate::EXISTS;
+    else return false;
+    return true;
+}
+
+const char* op_name(Predicate::Op op) {
+    switch (op) {
+        case Predicate::NE:     return "ne";
+        case Predicate::IN:     return "in";
+        case Predicate::PREFIX: return "prefix";
+        case Predicate::EXISTS: return "exists";
+        default:                return "eq";
+    }
+}
+
+bool parse_predicate(const nlohmann::json& spec, Predicate& pred, std::string& error) {
+    if (!spec.is_object() || !spec.contains("field") || !spec["field"].is_string()) {
+        error = "predicate needs a string \"field\"";
+        return false;
+    }
+    pred.field = spec["field"].get<std::string>();
+    if (!parse_op(spec.value("op", "eq"), pred.op)) {
+        error = "unknown op '" + spec.value("op", "") + "' (eq, ne, in, prefix, exists)";
+        return false;
+    }
+    pred.value = spec.value("value", nlohmann::json());
+    if (pred.op == Predicate::IN && !pred.value.is_array()) {
+        error = "op 'in' needs an array value";
+        return false;
+    }
+    if (pred.op == Predicate::PREFIX && !pred.value.is_string()) {
+        error = "op 'prefix' needs a string value";
+        return false;
+    }
+    return true;
+}
+
+bool parse_filter(const nlohmann::json& spec, size_t index, Filter& filter, std::string& error) {
+    if (!spec.is_object()) {
+        error = "filter " + std::to_string(index) + " is not an object";
+        return false;
+    }
+    filter.id = spec.contains("id") && spec["id"].is_string() ? spec["id"].get<std::string>()
+                                                             : "#" + std::to_string(index);
+
+    auto kinds = spec.find("kinds");
+    if (kinds != spec.end() && !kinds->is_null()) {
+        if (!kinds->is_array() || kinds->size() > MAX_KINDS_PER_FILTER) {
+            error = "filter '" + filter.id + "': kinds must be an array of up to " +
+                    std::to_string(MAX_KINDS_PER_FILTER) + " strings";
+            return false;
+        }
+        for (const auto& kind : *kinds) {
+            if (!kind.is_string() || kind.get_ref<const std::string&>().empty()) {
+                error = "filter '" + filter.id + "': kinds must be non-empty strings";
+                return false;
+            }
+            // "*" = cualquier kind, igual que no poner "kinds"
+            if (kind == ANY_KIND) {
+                filter.kinds.clear();
+                break;
+            }
+            filter.kinds.push_back(kind.get<std::string>());
+        }
+    }
+
+    auto where = spec.find("where");
+    if (where != spec.end() && !where->is_null()) {
+        if (!where->is_array() || where->size() > MAX_PREDICATES) {
+            error = "filter '" + filter.id + "': where must be an array of up to " +
+                    std::to_string(MAX_PREDICATES) + " predicates";
+            return false;
+        }
+        for (const auto& p : *where) {
+            Predicate pred;
+            if (!parse_predicate(p, pred, error)) {
+                error = "filter '" + filter.id + "': " + error;
+                return false;
+            }
+            filter.where.push_back(std::move(pred));
+        }
+    }
+    return true;
+}
+
+}  // namespace
+
+// ============================================================================
+// PREDICADOS Y MATCHER
+// ============================================================================
+
+bool Predicate::matches(const nlohmann::json& msg) const {
+    auto it = msg.find(field);
+    if (it == msg.end()) return op == NE;
+
+    switch (op) {
+        case EQ:     return *it == value;
+        case NE:     return *it != value;
+        case IN:     return std::find(value.begin(), value.end(), *it) != value.end();
+        case PREFIX: return it->is_string() &&
+                            it->get_ref<const std::string&>().compare(
+                                0, value.get_ref<const std::string&>().size(),
+                                value.get_ref<const std::string&>()) == 0;
+        case EXISTS: return true;
+    }
+    return false;
+}
+
+bool Matcher::compile(const nlohmann::json& filters, std::shared_ptr<Matcher>& out, std::string& error) {
+    if (!filters.is_array()) {
+        error = "filters must be an array";
+        return false;
+    }
+    if (filters.size() > MAX_FILTERS) {
+        error = "more than " + std::to_string(MAX_FILTERS) + " filters";
+        return false;
+    }
+
+    auto matcher = std::make_shared<Matcher>();
+    for (size_t i = 0; i < filters.size(); ++i) {
+        auto filter = std::make_unique<Filter>();
+        if (!parse_filter(filters[i], i, *filter, error)) return false;
+        matcher->filters_.push_back(std::move(filter));
+    }
+
+    // Un bucket por kind nombrado, con los filtros "cualquier kind"
+    // intercalados en el orden de la lista (los hits siguen ese orden)
+    for (const auto& filter : matcher->filters_) {
+        if (filter->kinds.empty()) {
+            matcher->add_to_bucket(matcher->any_kind_, filter.get());
+            for (auto& kv : matcher->by_kind_) matcher->add_to_bucket(kv.second, filter.get());
+            continue;
+        }
+        for (const auto& kind : filter->kinds) {
+            auto found = matcher->by_kind_.find(kind);
+            if (found == matcher->by_kind_.end()) {
+                found = matcher->by_kind_.emplace(kind, matcher->any_kind_).first;
+            }
+            if (std::find(found->second.filters.begin(), found->second.filters.end(), filter.get()) ==
+                found->second.filters.end()) {
+                matcher->add_to_bucket(found->second, filter.get());
+            }
+        }
+    }
+
+    out = std::move(matcher);
+    return true;
+}
+
+void Matcher::add_to_bucket(Bucket& bucket, const Filter* filter) {
+    bucket.filters.push_back(filter);
+    if (!bucket.unconditional && filter->where.empty()) bucket.unconditional = filter;
+}
+
+const Matcher::Bucket& Matcher::bucket(const std::string& kind) const {
+    auto it = by_kind_.find(kind);
+    return it == by_kind_.end() ? any_kind_ : it->second;
+}
+
+// ============================================================================
+// REGISTRY
+// ============================================================================
+
+bool Registry::replace(const nlohmann::json& filters, std::string& error) {
+    if (filters.is_null() && !active()) return true;   // ya desactivadas: misma generación
+
+    std::shared_ptr<Matcher> compiled;
+    if (!filters.is_null() && !Matcher::compile(filters, compiled, error)) {
+        std::lock_guard<std::mutex> lock(stats_mutex_);
+        rejected_++;
+        return false;
+    }
+
+    // Los hits son de cada generación; los descartes por kind se acumulan
+    std::atomic_store_explicit(&matcher_, MatcherPtr(std::move(compiled)), std::memory_order_release);
+    active_.store(!filters.is_null(), std::memory_order_relaxed);
+    generation_.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+size_t Registry::filter_count() const {
+    MatcherPtr matcher = current();
+    return matcher ? matcher->filters().size() : 0;
+}
+
+void Registry::count_drop(const std::string& kind, size_t bytes) {
+    std::lock_guard<std::mutex> lock(stats_mutex_);
+    dropped_++;
+    dropped_bytes_ += bytes;
+    auto it = dropped_by_kind_.find(kind);
+    if (it != dropped_by_kind_.end()) it->second++;
+    else if (dropped_by_kind_.size() < MAX_DROP_KINDS) dropped_by_kind_.emplace(kind, 1);
+    else untracked_++;
+}
+
+Decision Registry::check_kind(const std::string& kind, size_t bytes) {
+    Decision decision;
+    decision.matcher = current();
+    if (!decision.matcher || Admission::classify(kind) == Admission::CLASS_CONTROL) return decision;
+
+    decision.bucket = &decision.matcher->bucket(kind);
+    if (decision.bucket->unconditional) {
+        // Un filtro anterior con "where" podría aceptarlo primero: los hits
+        // van al primero de la lista solo si es el incondicional
+        if (decision.bucket->filters.front() == decision.bucket->unconditional) {
+            decision.bucket->unconditional->hits.fetch_add(1, std::memory_order_relaxed);
+            passed_.fetch_add(1, std::memory_order_relaxed);
+            decision.verdict = PASS;
+            return decision;
+        }
+        decision.verdict = CHECK;
+        return decision;
+    }
+    if (decision.bucket->filters.empty()) {
+        count_drop(kind, bytes);
+        decision.verdict = DROP;
+        return decision;
+    }
+    decision.verdict = CHECK;
+    return decision;
+}
+
+bool Registry::check_fields(const Decision& decision, const std::string& kind,
+                            const nlohmann::json& msg, size_t bytes) {
+    if (decision.verdict != CHECK || !decision.bucket) return decision.verdict != DROP;
+
+    for (const Filter* filter : decision.bucket->filters) {
+        bool match = std::all_of(filter->where.begin(), filter->where.end(),
+                                 [&](const Predicate& p) { return p.matches(msg); });
+        if (match) {
+            filter->hits.fetch_add(1, std::memory_order_relaxed);
+            passed_.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+    count_drop(kind, bytes);
+    return false;
+}
+
+nlohmann::json Registry::stats_json() const {
+    MatcherPtr matcher = current();
+
+    nlohmann::json filters = nlohmann::json::array();
+    if (matcher) {
+        for (const auto& f : matcher->filters()) {
+            nlohmann::json where = nlohmann::json::array();
+            for (const auto& p : f->where) {
+                where.push_back({{"field", p.field}, {"op", op_name(p.op)}, {"value", p.value}});
+            }
+            filters.push_back({
+                {"id",    f->id},
+                {"kinds", f->kinds},
+                {"where", where},
+                {"hits",  f->hits.load(std::memory_order_relaxed)}
+            });
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(stats_mutex_);
+    std::vector<std::pair<std::string, uint64_t>> top(dropped_by_kind_.begin(), dropped_by_kind_.end());
+    std::sort(top.begin(), top.end(), [](const auto& a, const auto& b) { return a.second > b.second; });
+    if (top.size() > STATS_TOP_KINDS) top.resize(STATS_TOP_KINDS);
+    nlohmann::json dropped_kinds = nlohmann::json::object();
+    for (const auto& kv : top) dropped_kinds[kv.first] = kv.second;
+
+    return {
+        {"active",        active()},
+        {"generation",    generation()},
+        {"filters",       filters},
+        {"passed",        passed_.load(std::memory_order_relaxed)},
+        {"dropped",       dropped_},
+        {"dropped_bytes", dropped_bytes_},
+        {"dropped_kinds", dropped_kinds},
+        {"untracked",     untracked_},
+        {"rejected",      rejected_}
+    };
+}
+
+}  // namespace Subscription
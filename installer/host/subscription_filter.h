@@ -0,0 +1,148 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+/**
+ * @brief Suscripciones de Brain a eventos de la extensión, evaluadas en el host
+ *
+ * El host reenviaba a Brain todo lo que mandaba la extensión, le interesara o
+ * no. Con una conexión viva Brain puede decir qué quiere recibir:
+ *
+ *   SET_SUBSCRIPTIONS {"type": "SET_SUBSCRIPTIONS", "filters": [
+ *       {"id": "tabs", "kinds": ["TAB_STATE", "tab.updated"]},
+ *       {"id": "nav",  "kinds": ["NAVIGATION"],
+ *        "where": [{"field": "frame_id", "op": "eq", "value": 0}]}
+ *   ]}
+ *   → SUBSCRIPTIONS_ACK {"ok", "active", "filters", "generation", "error"}
+ *
+ * Un mensaje pasa si algún filtro lo acepta: su kind (command > type > event)
+ * está en "kinds" (ausente o "*" = cualquiera) y se cumplen todas las
+ * condiciones de "where" sobre campos de primer nivel (op: eq, ne, in,
+ * prefix, exists). "filters": [] no deja pasar nada; null o ausente
+ * desactiva las suscripciones y vuelve a pasar todo. Un REGISTER_ACK también
+ * las desactiva salvo que traiga "subscriptions": [...].
+ *
+ * Los kinds CONTROL de admission_control.h (handshake, HEARTBEAT,
+ * RESPONSE...) pasan siempre. El filtro compilado (Matcher) es inmutable y se
+ * publica con un store atómico del shared_ptr: el thread de stdin nunca
+ * espera a un SET_SUBSCRIPTIONS. El kind sale del scan del sobre
+ * (projection.h), así que un mensaje sin filtro por campos se descarta antes
+ * del parse; con "where" se evalúa sobre el JSON ya parseado.
+ *
+ * hits de cada filtro = mensajes que dejó pasar (el primero que acepta, en
+ * el orden de la lista). Van a Brain en stats["subscriptions"].
+ */
+namespace Subscription {
+
+    enum Verdict { PASS, DROP, CHECK };
+
+    struct Predicate {
+        enum Op { EQ, NE, IN, PREFIX, EXISTS };
+        std::string    field;
+        Op             op = EQ;
+        nlohmann::json value;
+
+        bool matches(const nlohmann::json& msg) const;
+    };
+
+    struct Filter {
+        std::string              id;
+        std::vector<std::string> kinds;          // vacío = cualquier kind
+        std::vector<Predicate>   where;
+        mutable std::atomic<uint64_t> hits{0};
+    };
+
+    /**
+     * @brief Filtros compilados: kind → filtros candidatos
+     *
+     * Cada bucket ya sabe si alguno de sus filtros no tiene "where" (PASS
+     * directo) o si hace falta mirar campos (CHECK).
+     */
+    class Matcher {
+    public:
+        struct Bucket {
+            std::vector<const Filter*> filters;
+            const Filter*              unconditional = nullptr;
+        };
+
+        /** @return false con error si la lista de filtros es inválida */
+        static bool compile(const nlohmann::json& filters, std::shared_ptr<Matcher>& out,
+                            std::string& error);
+
+        const Bucket& bucket(const std::string& kind) const;
+
+        const std::vector<std::unique_ptr<Filter>>& filters() const { return filters_; }
+
+    private:
+        void add_to_bucket(Bucket& bucket, const Filter* filter);
+
+        std::vector<std::unique_ptr<Filter>>    filters_;
+        std::unordered_map<std::string, Bucket> by_kind_;
+        Bucket                                  any_kind_;
+    };
+
+    using MatcherPtr = std::shared_ptr<const Matcher>;
+
+    /** Resultado de check_kind(); se completa con check_fields() si es CHECK. */
+    struct Decision {
+        Verdict                verdict = PASS;
+        MatcherPtr             matcher;
+        const Matcher::Bucket* bucket = nullptr;
+    };
+
+    class Registry {
+    public:
+        Registry() = default;
+
+        Registry(const Registry&) = delete;
+        Registry& operator=(const Registry&) = delete;
+
+        /**
+         * @brief Reemplaza los filtros (SET_SUBSCRIPTIONS / REGISTER_ACK)
+         * @param filters array de filtros, o null para desactivar
+         * @return false con error si son inválidos (quedan los anteriores)
+         */
+        bool replace(const nlohmann::json& filters, std::string& error);
+
+        /** Chequeo barato antes de scan_envelope(). */
+        bool     active()     const { return active_.load(std::memory_order_relaxed); }
+        uint64_t generation() const { return generation_.load(std::memory_order_relaxed); }
+
+        /** Filtros vigentes (los del último replace() aceptado). */
+        size_t   filter_count() const;
+
+        /** Decisión solo por kind; DROP ya queda contado. */
+        Decision check_kind(const std::string& kind, size_t bytes);
+
+        /** CHECK con el mensaje parseado. @return false si se descarta (contado) */
+        bool check_fields(const Decision& decision, const std::string& kind,
+                          const nlohmann::json& msg, size_t bytes);
+
+        nlohmann::json stats_json() const;
+
+    private:
+        MatcherPtr current() const { return std::atomic_load_explicit(&matcher_, std::memory_order_acquire); }
+        void       count_drop(const std::string& kind, size_t bytes);
+
+        MatcherPtr             matcher_;          // null = sin suscripciones
+        std::atomic<bool>      active_{false};
+        std::atomic<uint64_t>  generation_{0};
+
+        mutable std::mutex     stats_mutex_;
+        std::unordered_map<std::string, uint64_t> dropped_by_kind_;
+        std::atomic<uint64_t>  passed_{0};
+        uint64_t               dropped_       = 0;
+        uint64_t               dropped_bytes_ = 0;
+        uint64_t               untracked_     = 0;   // drops de kinds por encima del tope de stats
+        uint64_t               rejected_      = 0;   // SET_SUBSCRIPTIONS inválidos
+    };
+
+}  // namespace Subscription
@@ -1,4 +1,5 @@
 #include "synapse_logger.h"
+#include "alloc_tracker.h"
 
 #include <sstream>
 #include <thread>
@@ -66,20 +67,28 @@ void SynapseLogManager::set_user_base_dir(const std::string& base_dir) {
 // ============================================================================
 
 std::string SynapseLogManager::get_timestamp_ms() {
-    auto now    = std::chrono::system_clock::now();
-    auto now_t  = std::chrono::system_clock::to_time_t(now);
-    auto now_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
-                      now.time_since_epoch()) % 1000;
+    return format_timestamp_ms(std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count());
+}
+
+std::string SynapseLogManager::format_timestamp_ms(int64_t epoch_ms) {
+    auto now_t  = static_cast<std::time_t>(epoch_ms / 1000);
+    auto now_ms = epoch_ms % 1000;
 
     std::tm tm_utc{};
     gmtime_cross(&now_t, &tm_utc);
 
     std::ostringstream ss;
     ss << std::put_time(&tm_utc, "%Y-%m-%d %H:%M:%S")
-       << "." << std::setfill('0') << std::setw(3) << now_ms.count();
+       << "." << std::setfill('0') << std::setw(3) << now_ms;
     return ss.str();
 }
 
+std::string SynapseLogManager::format_line(const std::string& ts, const std::string& level,
+                                           const char* source, const std::string& message) {
+    return "[" + ts + "] [" + level + "] [" + source + "] " + message;
+}
+
 // ============================================================================
 // Directorio base de logs
 // ============================================================================
@@ -408,6 +417,11 @@ bool SynapseLogManager::is_ready() const {
     return ready;
 }
 
+size_t SynapseLogManager::get_pending_count() {
+    std::lock_guard<std::mutex> lock(pending_mutex);
+    return pending_queue.size();
+}
+
 // ============================================================================
 // Getters
 // ============================================================================
@@ -473,6 +487,27 @@ static std::string extract_json_string(const std::string& json,
     return result;
 }
 
+std::string SynapseLogManager::find_telemetry_stream_path(const std::string& content,
+                                                        const std::string& stream_key) {
+    size_t key_pos = content.find("\"" + stream_key + "\"");
+    if (key_pos == std::string::npos) return "";
+
+    // Find the opening brace of this stream object
+    size_t brace = content.find('{', key_pos);
+    if (brace == std::string::npos) return "";
+
+    // Find the matching closing brace (depth tracking)
+    int depth = 0;
+    size_t end = brace;
+    for (; end < content.size(); ++end) {
+        if (content[end] == '{') ++depth;
+        else if (content[end] == '}') { --depth; if (depth == 0) break; }
+    }
+
+    std::string stream_obj = content.substr(brace, end - brace + 1);
+    return extract_json_string(stream_obj, "path");
+}
+
 bool SynapseLogManager::initialize_from_telemetry(const std::string& p_launch_id,
                                                    const std::string& telemetry_path) {
     if (ready) return true;
@@ -502,28 +537,8 @@ bool SynapseLogManager::initialize_from_telemetry(const std::string& p_launch_id
     std::string host_stream_key  = "host_"   + p_launch_id;
     std::string cortex_stream_key = "cortex_" + p_launch_id;
 
-    auto extract_stream_path = [&](const std::string& stream_key) -> std::string {
-        size_t key_pos = content.find("\"" + stream_key + "\"");
-        if (key_pos == std::string::npos) return "";
-
-        // Find the opening brace of this stream object
-        size_t brace = content.find('{', key_pos);
-        if (brace == std::string::npos) return "";
-
-        // Find the matching closing brace (depth tracking)
-        int depth = 0;
-        size_t end = brace;
-        for (; end < content.size(); ++end) {
-            if (content[end] == '{') ++depth;
-            else if (content[end] == '}') { --depth; if (depth == 0) break; }
-        }
-
-        std::string stream_obj = content.substr(brace, end - brace + 1);
-        return extract_json_string(stream_obj, "path");
-    };
-
-    std::string resolved_host_path   = extract_stream_path(host_stream_key);
-    std::string resolved_cortex_path = extract_stream_path(cortex_stream_key);
+    std::string resolved_host_path   = find_telemetry_stream_path(content, host_stream_key);
+    std::string resolved_cortex_path = find_telemetry_stream_path(content, cortex_stream_key);
 
     if (resolved_host_path.empty()) {
         std::cerr << "[" << get_timestamp_ms() << "] [WARN] [HOST] "
@@ -608,8 +623,9 @@ bool SynapseLogManager::initialize_from_telemetry(const std::string& p_launch_id
 
 void SynapseLogManager::log_native(const std::string& level,
                                    const std::string& message) {
+    AllocTracker::StageScope alloc_stage(AllocTracker::STAGE_LOG);
     std::string ts   = get_timestamp_ms();
-    std::string line = "[" + ts + "] [" + level + "] [HOST] " + message;
+    std::string line = format_line(ts, level, "HOST", message);
 
     std::cerr << line << "\n";
     std::cerr.flush();
@@ -651,7 +667,7 @@ void SynapseLogManager::flush_pending_queue() {
 
     native_log << "--- PENDING LOG FLUSH (" << snapshot.size() << " entries) ---\n";
     for (const auto& e : snapshot) {
-        std::string line = "[" + e.timestamp + "] [" + e.level + "] [HOST] " + e.message;
+        std::string line = format_line(e.timestamp, e.level, "HOST", e.message);
         native_log << line << "\n";
     }
     native_log << "--- END PENDING FLUSH ---\n";
@@ -669,8 +685,9 @@ void SynapseLogManager::flush_pending_queue() {
 void SynapseLogManager::log_browser(const std::string& level,
                                     const std::string& message,
                                     const std::string& timestamp) {
+    AllocTracker::StageScope alloc_stage(AllocTracker::STAGE_LOG);
     std::string ts   = timestamp.empty() ? get_timestamp_ms() : timestamp;
-    std::string line = "[" + ts + "] [" + level + "] [EXTENSION] " + message;
+    std::string line = format_line(ts, level, "EXTENSION", message);
 
     {
         std::lock_guard<std::mutex> lock(browser_mutex);
@@ -685,3 +702,23 @@ void SynapseLogManager::log_browser(const std::string& level,
     std::cerr << line << "\n";
     std::cerr.flush();
 }
+
+// ============================================================================
+// write_browser_block
+// ============================================================================
+
+void SynapseLogManager::write_browser_block(const std::string& block) {
+    AllocTracker::StageScope alloc_stage(AllocTracker::STAGE_LOG);
+    {
+        std::lock_guard<std::mutex> lock(browser_mutex);
+        if (browser_log.is_open()) {
+            browser_log << block;
+            browser_log.flush();
+        }
+    }
+
+    debug_output(block);
+
+    std::cerr << block;
+    std::cerr.flush();
+}
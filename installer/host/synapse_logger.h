@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstdint>
 #include <fstream>
 #include <string>
 #include <mutex>
@@ -59,9 +60,6 @@ private:
     /** Vuelca pending_queue al archivo nativo. Llamar solo con native_mutex tomado y ready==true. */
     void flush_pending_queue();
 
-    /** Timestamp UTC: "YYYY-MM-DD HH:MM:SS.mmm" */
-    std::string get_timestamp_ms();
-
     /**
      * Retorna el directorio raíz de logs de BloomNucleus según el SO.
      *   Windows: %LOCALAPPDATA%\BloomNucleus\logs
@@ -129,9 +127,32 @@ public:
     bool initialize_from_telemetry(const std::string& p_launch_id,
                                    const std::string& telemetry_path);
 
+    /**
+     * @brief Busca active_streams[stream_key]["path"] en el contenido de telemetry.json.
+     * @return Ruta absoluta, o vacío si la clave no existe
+     */
+    static std::string find_telemetry_stream_path(const std::string& content,
+                                                  const std::string& stream_key);
+
+    /** Timestamp UTC: "YYYY-MM-DD HH:MM:SS.mmm" */
+    static std::string get_timestamp_ms();
+
+    /** Mismo formato para un instante en ms desde epoch (Date.now() de la extensión). */
+    static std::string format_timestamp_ms(int64_t epoch_ms);
+
+    /**
+     * @brief Formato común de una línea de log: "[ts] [level] [source] message".
+     * @param source "HOST" (canal nativo) o "EXTENSION" (canal browser)
+     */
+    static std::string format_line(const std::string& ts, const std::string& level,
+                                   const char* source, const std::string& message);
+
     /** true si los archivos están abiertos y listos para escribir. */
     bool is_ready() const;
 
+    /** Entradas en pending_queue (emitidas antes de initialize()). Debe quedar en 0 tras el boot. */
+    size_t get_pending_count();
+
     /** Rutas a los archivos de log creados. Vacías si is_ready() == false. */
     std::string get_log_directory()      const;
     std::string get_host_log_path()      const;
@@ -165,4 +186,12 @@ public:
      */
     void log_browser(const std::string& level, const std::string& message,
                      const std::string& timestamp = "");
+
+    /**
+     * @brief Escribe un lote de líneas ya formateadas en el log de la extensión.
+     * @param block Líneas terminadas en '\n' (ExtensionLogs::BatchedWriter)
+     *
+     * Un solo flush por lote; duplica a stderr igual que log_browser().
+     */
+    void write_browser_block(const std::string& block);
 };
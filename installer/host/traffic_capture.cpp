@@ -0,0 +1,235 @@
+#include "traffic_capture.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <mutex>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+namespace TrafficCapture {
+
+namespace {
+
+const char     MAGIC[8]       = {'B', 'L', 'M', 'C', 'A', 'P', '0', '1'};
+const uint32_t FORMAT_VERSION = 1;
+const uint8_t  REDACTED_BIT   = 0x80;
+const size_t   MAX_PENDING    = 1000;
+const uint64_t FLUSH_EVERY    = 256;   // registros entre flush explícitos
+
+struct PendingRecord {
+    Direction   direction;
+    uint64_t    mono_ns;
+    uint64_t    original_len;
+    std::string stored;
+};
+
+std::atomic<bool>          g_enabled{false};
+bool                       g_redact = false;
+
+std::mutex                 g_mutex;
+std::ofstream              g_out;
+std::string                g_path;
+std::vector<PendingRecord> g_pending;
+uint64_t                   g_last_ns  = 0;
+uint64_t                   g_written  = 0;
+
+uint64_t mono_ns() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+void put_u32(std::ofstream& out, uint32_t v) {
+    char b[4] = { static_cast<char>(v), static_cast<char>(v >> 8),
+                  static_cast<char>(v >> 16), static_cast<char>(v >> 24) };
+    out.write(b, 4);
+}
+
+void put_u64(std::ofstream& out, uint64_t v) {
+    put_u32(out, static_cast<uint32_t>(v));
+    put_u32(out, static_cast<uint32_t>(v >> 32));
+}
+
+void put_varint(std::ofstream& out, uint64_t v) {
+    char buf[10];
+    int n = 0;
+    do {
+        uint8_t byte = v & 0x7F;
+        v >>= 7;
+        if (v) byte |= 0x80;
+        buf[n++] = static_cast<char>(byte);
+    } while (v);
+    out.write(buf, n);
+}
+
+/** Escribe un registro. Llamar con g_mutex tomado y g_out abierto. */
+void write_record(Direction dir, uint64_t ts_ns, uint64_t original_len, const std::string& stored) {
+    uint64_t delta = (g_last_ns == 0 || ts_ns < g_last_ns) ? 0 : ts_ns - g_last_ns;
+    g_last_ns = ts_ns;
+
+    char tag = static_cast<char>(dir | (g_redact ? REDACTED_BIT : 0));
+    g_out.write(&tag, 1);
+    put_varint(g_out, delta);
+    put_varint(g_out, original_len);
+    put_varint(g_out, stored.size());
+    g_out.write(stored.data(), static_cast<std::streamsize>(stored.size()));
+
+    if (++g_written % FLUSH_EVERY == 0) g_out.flush();
+}
+
+}  // namespace
+
+// ============================================================================
+// CONFIGURACIÓN
+// ============================================================================
+
+const char* direction_name(Direction dir) {
+    switch (dir) {
+        case CHROME_IN:  return "chrome_in";
+        case CHROME_OUT: return "chrome_out";
+        case BRAIN_IN:   return "brain_in";
+        case BRAIN_OUT:  return "brain_out";
+        default:         return "unknown";
+    }
+}
+
+void set_enabled(bool enabled, bool redact) {
+    g_redact = redact;
+    g_enabled.store(enabled);
+}
+
+bool is_enabled() {
+    return g_enabled.load(std::memory_order_relaxed);
+}
+
+std::string path() {
+    std::lock_guard<std::mutex> lock(g_mutex);
+    return g_path;
+}
+
+// ============================================================================
+// ESCRITURA
+// ============================================================================
+
+bool open(const std::string& p_path) {
+    if (!is_enabled()) return false;
+
+    std::lock_guard<std::mutex> lock(g_mutex);
+    if (g_out.is_open()) return true;
+
+    g_out.open(p_path, std::ios::binary | std::ios::trunc);
+    if (!g_out.is_open()) return false;
+    g_path = p_path;
+
+    uint64_t wall_ms = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count());
+    g_out.write(MAGIC, sizeof(MAGIC));
+    put_u32(g_out, FORMAT_VERSION);
+    put_u32(g_out, g_redact ? 1u : 0u);
+    put_u64(g_out, wall_ms);
+
+    for (const auto& p : g_pending) {
+        write_record(p.direction, p.mono_ns, p.original_len, p.stored);
+    }
+    g_pending.clear();
+    g_pending.shrink_to_fit();
+    g_out.flush();
+    return true;
+}
+
+void record(Direction dir, const char* data, size_t len) {
+    if (!is_enabled()) return;
+
+    uint64_t ts = mono_ns();
+    std::string stored = g_redact ? redact(data, len) : std::string(data, len);
+
+    std::lock_guard<std::mutex> lock(g_mutex);
+    if (g_out.is_open()) {
+        write_record(dir, ts, len, stored);
+    } else if (g_pending.size() < MAX_PENDING) {
+        g_pending.push_back({dir, ts, len, std::move(stored)});
+    }
+}
+
+uint64_t close() {
+    std::lock_guard<std::mutex> lock(g_mutex);
+    if (g_out.is_open()) {
+        g_out.flush();
+        g_out.close();
+    }
+    return g_written;
+}
+
+std::string redact(const char* data, size_t len) {
+    nlohmann::json meta = nlohmann::json::object();
+    try {
+        nlohmann::json msg = nlohmann::json::parse(data, data + len);
+        if (!msg.is_object()) return "{}";
+        for (const char* key : {"command", "type", "event", "id"}) {
+            auto it = msg.find(key);
+            if (it != msg.end() && (it->is_string() || it->is_number())) meta[key] = *it;
+        }
+        auto chunk = msg.find("bloom_chunk");
+        if (chunk != msg.end() && chunk->is_object()) {
+            meta["chunk"] = chunk->value("type", "");
+        }
+    } catch (...) {
+        meta["unparsed"] = true;
+    }
+    return meta.dump();
+}
+
+// ============================================================================
+// LECTURA
+// ============================================================================
+
+bool Reader::open(const std::string& p_path) {
+    in.open(p_path, std::ios::binary);
+    if (!in.is_open()) return false;
+
+    unsigned char header[24];
+    if (!in.read(reinterpret_cast<char*>(header), sizeof(header))) return false;
+    if (std::memcmp(header, MAGIC, sizeof(MAGIC)) != 0) return false;
+
+    auto u32 = [&](int off) {
+        return static_cast<uint32_t>(header[off]) | (static_cast<uint32_t>(header[off + 1]) << 8) |
+               (static_cast<uint32_t>(header[off + 2]) << 16) | (static_cast<uint32_t>(header[off + 3]) << 24);
+    };
+    version = u32(8);
+    flags   = u32(12);
+    wall_ms = static_cast<uint64_t>(u32(16)) | (static_cast<uint64_t>(u32(20)) << 32);
+    t_ns    = 0;
+    return version == FORMAT_VERSION;
+}
+
+bool Reader::read_varint(uint64_t& out) {
+    out = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        char c;
+        if (!in.get(c)) return false;
+        uint8_t byte = static_cast<uint8_t>(c);
+        out |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) return true;
+    }
+    return false;
+}
+
+bool Reader::next(Record& out) {
+    char tag;
+    if (!in.get(tag)) return false;
+
+    uint64_t delta = 0, original = 0, stored = 0;
+    if (!read_varint(delta) || !read_varint(original) || !read_varint(stored)) return false;
+
+    out.direction    = static_cast<Direction>(static_cast<uint8_t>(tag) & 0x7F);
+    out.redacted     = (static_cast<uint8_t>(tag) & REDACTED_BIT) != 0;
+    out.original_len = original;
+    t_ns            += delta;
+    out.t_ns         = t_ns;
+
+    out.payload.resize(stored);
+    if (stored > 0 && !in.read(&out.payload[0], static_cast<std::streamsize>(stored))) return false;
+    return true;
+}
+
+}  // namespace TrafficCapture
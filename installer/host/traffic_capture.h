@@ -0,0 +1,104 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <fstream>
+#include <string>
+
+/**
+ * @brief Captura binaria de todo el tráfico enmarcado del host
+ *
+ * Registra cada frame en ambas direcciones con timestamp monotónico, para
+ * reproducir formas de tráfico reales con bloom-host-replay (bench/).
+ *
+ * Activación:
+ *   --capture          payload completo
+ *   --capture-redact   solo tamaño + metadata (command/type/event/id/bloom_chunk.type)
+ *
+ * Archivo: {launch_log_dir}/capture_{launch_id}.bcap
+ *
+ * Formato (little-endian, varints LEB128):
+ *   Header (24 bytes):
+ *     char[8]  magic "BLMCAP01"
+ *     uint32   version (1)
+ *     uint32   flags   (bit0 = redacted)
+ *     uint64   wall clock de inicio en ms (epoch), solo informativo
+ *   Registro:
+ *     uint8    direction (Direction) | 0x80 si el payload fue redactado
+ *     varint   delta_ns desde el registro anterior (steady_clock)
+ *     varint   original_len (tamaño del frame real)
+ *     varint   stored_len
+ *     byte[stored_len] payload completo, o JSON de metadata si redactado
+ *
+ * Los frames anteriores a open() (identidad aún sin resolver) se retienen en
+ * memoria, hasta MAX_PENDING, y se vuelcan al abrir el archivo.
+ */
+namespace TrafficCapture {
+
+    enum Direction : uint8_t {
+        CHROME_IN  = 1,   // stdin  (Chrome → host)
+        CHROME_OUT = 2,   // stdout (host → Chrome)
+        BRAIN_IN   = 3,   // TCP    (Brain → host)
+        BRAIN_OUT  = 4    // TCP    (host → Brain)
+    };
+
+    const char* direction_name(Direction dir);
+
+    /** Habilita la captura. Llamar antes de arrancar threads. */
+    void set_enabled(bool enabled, bool redact);
+    bool is_enabled();
+
+    /** Abre el archivo de captura y vuelca lo retenido. false si no se pudo abrir. */
+    bool open(const std::string& path);
+
+    /** Registra un frame (sin el prefijo de longitud). No-op si la captura está deshabilitada. */
+    void record(Direction dir, const char* data, size_t len);
+    inline void record(Direction dir, const std::string& frame) { record(dir, frame.data(), frame.size()); }
+
+    /** Vuelca y cierra. Devuelve la cantidad de registros escritos. */
+    uint64_t close();
+
+    /** Ruta del archivo abierto (vacía si no hay). */
+    std::string path();
+
+    /**
+     * @brief Metadata de un frame para el modo redactado:
+     *        {"command":..,"type":..,"event":..,"id":..,"chunk":..} con solo las claves presentes.
+     */
+    std::string redact(const char* data, size_t len);
+
+    // ========================================================================
+    // LECTURA
+    // ========================================================================
+
+    struct Record {
+        Direction   direction;
+        bool        redacted;
+        uint64_t    t_ns;          // acumulado desde el primer registro
+        uint64_t    original_len;
+        std::string payload;
+    };
+
+    class Reader {
+    public:
+        /** false si el archivo no existe o el header es inválido. */
+        bool open(const std::string& path);
+
+        /** Siguiente registro. false al final del archivo o ante un registro truncado. */
+        bool next(Record& out);
+
+        bool     redacted()      const { return flags & 1u; }
+        uint32_t version_number() const { return version; }
+        uint64_t start_wall_ms() const { return wall_ms; }
+
+    private:
+        bool read_varint(uint64_t& out);
+
+        std::ifstream in;
+        uint32_t      version = 0;
+        uint32_t      flags   = 0;
+        uint64_t      wall_ms = 0;
+        uint64_t      t_ns    = 0;
+    };
+
+}  // namespace TrafficCapture